@@ -2,6 +2,7 @@
  * @file alloc.h
  * @author zx
  * @brief 定义了一、二级配置器,负责内存空间的配置和释放
+ *        第二级配置器的 threads = true 版本使用无锁自由链表(Treiber stack)，可以被多个线程同时使用
  * @version 0.1
  * @date 2025-06-01
  * 
@@ -14,6 +15,9 @@
 #include<cstddef>
 #include<new>
 #include<cstdlib>
+#include<cstring>
+#include<cstdint>
+#include<atomic>
 
 namespace MYSTL
 {
@@ -37,7 +41,7 @@ namespace MYSTL
              *  参数：void (*__f)() - 指向无参数、无返回值函数的指针
              *  返回值：void (*)() - 同样是一个指向无参数、无返回值函数的指针
              */
-            static void (* set_malloc_hander(void* (* f) ()))
+            static void (* set_malloc_hander(void (* f)()))()
             {
                 //1. 记录原来的处理函数
                 void (* old)() = malloc_alloc_oom_hander;
@@ -79,10 +83,41 @@ namespace MYSTL
                 }
                 static void* S_refill(size_t n);//填充自由链表
                 static char* S_chunk_alloc(size_t size, int& nobjs);//S_chunk_alloc的核心职责是管理连续空间，并在必要时将碎片整理到链表。从内存池分配nobjs个大小为size的对象，返回首地址
+
+            //多线程版本（threads == true）使用的变量与函数
+                /*链表头把指针和版本号(tag)打包进一个 64 位整数：低位是指针，高位是 tag。
+                  每次修改链表头都令 tag 加一，这样即使同一个块被取走又放回，CAS 也会因 tag 不同而失败（ABA 问题）。
+                  64 位平台假设用户态地址不超过 48 位*/
+                enum{TAG_SHIFT = sizeof(void*) == 8 ? 48 : 32};
+                static std::atomic<uint64_t> S_mt_free_list[NFREELISTS];//无锁自由链表数组
+                /*每个线程独有的内存池，切割新块时不需要和其他线程竞争*/
+                struct mt_chunk
+                {
+                    char* start_free;
+                    char* end_free;
+                    size_t heap_size;
+                };
+                static uint64_t S_pack(obj* p, uint64_t tag)
+                {
+                    return (uint64_t)(uintptr_t)p | (tag << TAG_SHIFT);
+                }
+                static obj* S_unpack(uint64_t head)
+                {
+                    return (obj*)(uintptr_t)(head & ((((uint64_t)1) << TAG_SHIFT) - 1));
+                }
+                static uint64_t S_next_tag(uint64_t head)
+                {
+                    return (head >> TAG_SHIFT) + 1;
+                }
+                static mt_chunk& S_mt_chunk();//当前线程的内存池
+                static obj* S_mt_pop(size_t index);//从无锁链表中取出一个块，链表为空时返回0
+                static void S_mt_push(size_t index, obj* first, obj* last);//把 first ~ last 一串块放回无锁链表
+                static void* S_mt_refill(size_t n);
+                static char* S_mt_chunk_alloc(size_t size, int& nobjs);
             
             public:
                 static void* allocate(size_t n);//分配 n个字节内存
-                static void* deallocate(void* p, size_t n);//回收用户不用的块
+                static void deallocate(void* p, size_t n);//回收用户不用的块
                 static void* reallocate(void* P,size_t ole_size, size_t new_size);//内存重新分配
     };
     
@@ -113,8 +148,11 @@ namespace MYSTL
 
     /*2：调试功能的适配器：其核心功能是在分配的内存块前额外存储大小信息，以便在释放或重新分配时验证内存操作的正确性。*/
     
+    typedef malloc_alloc_template<0> malloc_alloc;
+    typedef default_alloc_template<false, 0> alloc;
+
     /*3：标准适配器：std::allocator*/
-    template<class TP>
+    template<class Tp>
     class allocator
     {
         typedef alloc Alloc;
@@ -139,13 +177,16 @@ namespace MYSTL
             template <class _Tp1> allocator(const allocator<_Tp1>&) {}
             ~allocator() {}
         //内存分配和释放
-            pointer address(reference x) const;//返回对象地址
-            const_pointer address(const_reference _x) const;//
-            _TP* allocate(size_type _n, const void* =0);
-            void deallocate(pointer _p, size_type _n);
+            pointer address(reference x) const { return &x; }//返回对象地址
+            const_pointer address(const_reference x) const { return &x; }
+            Tp* allocate(size_type n, const void* = 0)
+            {
+                return n != 0 ? static_cast<Tp*>(Alloc::allocate(n * sizeof(Tp))) : 0;
+            }
+            void deallocate(pointer p, size_type n) { Alloc::deallocate(p, n * sizeof(Tp)); }
         //对象构造与析构
-            void construct(pointer _p, const _TP& val);
-            void destory(pointer _P);
+            void construct(pointer p, const Tp& val) { new(p) Tp(val); }
+            void destroy(pointer p) { p->~Tp(); }
     };
 
         /*标准适配器 的特化版本：其目的是为 void 类型提供专门的分配器定义*/
@@ -196,16 +237,16 @@ namespace MYSTL
         pointer address(reference x) const{ return & x;}
         const_pointer address(const_reference x) const{ return & x;}
         //内存分配和释放
-        TP* allocate(size_type n, const void* =0)
+        Tp* allocate(size_type n, const void* =0)
         {
-            return n != 0 ? static_cast<Tp*>(__underlying_alloc.allocate(n * sizeof(Tp))) : 0;
+            return n != 0 ? static_cast<Tp*>(underlying_alloc.allocate(n * sizeof(Tp))) : 0;
         }
         void deallocate(pointer p, size_type n)
         {
             underlying_alloc.deallocate(p, n * sizeof(Tp));
         }
         //对象构造和析构
-        void construct(pointer p, const TP&__p->~_Tp();  val)
+        void construct(pointer p, const Tp& val)
         {
             new(p) Tp(val);
         }
@@ -231,13 +272,15 @@ namespace MYSTL
 
 typedef default_alloc_template<false, 0> alloc;
 typedef default_alloc_template<false, 0> single_client_alloc;
+//启用多线程：无锁自由链表
+typedef default_alloc_template<true, 0> multithread_alloc;
 //分配器特征萃取：
         /*1.通用模板定义*/
         template<class TP, class Allocator>
         struct Alloc_traits
         {
             static const bool S_instanceless = false;//分配器是否有状态
-            typedef typename Allocator::rebind<TP>::other allocator_type;
+            typedef typename Allocator::template rebind<TP>::other allocator_type;
         };
         /*2. STD：：allocator标准分配器特化*/
         template <class Tp, class Tp1>
@@ -302,7 +345,7 @@ typedef default_alloc_template<false, 0> single_client_alloc;
         for(;;)
         {
             my_malloc_handler = malloc_alloc_oom_hander;//获得当前注册的内存不足的处理函数
-            if(0 == my_malloc_handler){std::bad_alloc(); }//抛出异常}
+            if(0 == my_malloc_handler){ throw std::bad_alloc(); }//抛出异常
             //调用处理函数
             (*my_malloc_handler)();
             //再次尝试分配内存
@@ -319,14 +362,15 @@ typedef default_alloc_template<false, 0> single_client_alloc;
         for(;;)
         {
             my_malloc_hander = malloc_alloc_oom_hander;
-            if(my_malloc_hander == 0) { std::bad_alloc();}
-            (*my_malloc_handler)();
+            if(my_malloc_hander == 0) { throw std::bad_alloc();}
+            (*my_malloc_hander)();
             result = realloc(p, n);
             if(result) return result;
         }
 
     }
 
+    template<int inst>
     void* malloc_alloc_template<inst>::allocate(size_t n)
     {
         //1：分配内存
@@ -337,9 +381,11 @@ typedef default_alloc_template<false, 0> single_client_alloc;
         return result;
     }
 
-    void malloc_alloc_template<inst>::deallocate(void* p, size_t n){ free(p);}
+    template<int inst>
+    void malloc_alloc_template<inst>::deallocate(void* p, size_t){ free(p);}
 
-    void* malloc_alloc_template<inst>::reallocate(void* p, size_t old_size, size_t new_size)
+    template<int inst>
+    void* malloc_alloc_template<inst>::reallocate(void* p, size_t, size_t new_size)
     {
         void* result = realloc(p, new_size);
         if(result == 0) result = S_oom_realloc(p, new_size);
@@ -361,6 +407,9 @@ typedef default_alloc_template<false, 0> single_client_alloc;
     template<bool threads, int inst>//自由链表初始化为0
     typename default_alloc_template< threads, inst>::obj*default_alloc_template<threads, inst>::S_free_list[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, };
 
+    template<bool threads, int inst>//无锁自由链表，静态存储期的对象会被零初始化
+    std::atomic<uint64_t> default_alloc_template<threads, inst>::S_mt_free_list[NFREELISTS];
+
     /**
     * @brief S_chunk_alloc的核心职责是管理连续空间，并在必要时将碎片整理到链表。
     *  从内存池分配nobjs个大小为size的对象，返回首地址
@@ -393,15 +442,15 @@ typedef default_alloc_template<false, 0> single_client_alloc;
             //处理内存池碎片
             if(bytes_left > 0)//将当前内存池的剩余碎片加入对应的空闲链表
             {
-                obj* my_free_list = S_free_list + S_freelist_index(bytes_left);//获取剩余块对应的索引
+                obj** my_free_list = S_free_list + S_freelist_index(bytes_left);//获取剩余块对应的索引
                 ((obj*) S_start_free) ->M_free_list_link = * my_free_list;//更新下一个空闲链表为my_free_list
-                *my_free_list = (obj*) S_free_list; //更新my_free_list为空闲链表头指针
+                *my_free_list = (obj*) S_start_free; //更新my_free_list为空闲链表头指针
             }
             S_start_free = (char*) malloc(bytes_to_get);//使用malloc申请__bytes_to_get大小的内存块
             if(S_start_free ==0)//失败，备用方案：扫描其他空闲链表，从更大的空闲链表中 “借” 一个块
             {
                 size_t i;
-                obj* my_free_list;
+                obj** my_free_list;
                 obj* p;
                 for(i = size; i <= (size_t) MAX_BYTES; i+= (size_t) ALIGN)
                 {
@@ -437,7 +486,7 @@ typedef default_alloc_template<false, 0> single_client_alloc;
     {
         int nobjs = 20;
         char* chunk = S_chunk_alloc(n, nobjs);//从内存池分配20个大小为n的块
-        obj* my_free_list;
+        obj** my_free_list;
         obj* result;
         obj* current_obj;
         obj* next_obj;
@@ -449,7 +498,7 @@ typedef default_alloc_template<false, 0> single_client_alloc;
         result = (obj*) chunk;//第一个块返回给调用者
         *my_free_list = next_obj = (obj*)(chunk + n);//第二个块作为链表头
         //构造空闲链表
-        for(i=0; ; i++)
+        for(i=1; ; i++)
         {
             current_obj =next_obj;
             next_obj = (obj*) ((char*) next_obj +n);
@@ -479,8 +528,11 @@ typedef default_alloc_template<false, 0> single_client_alloc;
         if(n > (size_t) MAX_BYTES)//超过128字节，使用第一级分配器
         {
             ret = malloc_alloc::allocate(n);
+        }else if(threads){//多线程：从无锁链表中取块
+            obj* result = S_mt_pop(S_freelist_index(n));
+            ret = result != 0 ? result : S_mt_refill(S_round_up(n));
         }else{//没有超过128字节,使用第二级分配器
-            obj* my_free_list = S_free_list + S_freelist_index(n);
+            obj** my_free_list = S_free_list + S_freelist_index(n);
             
             obj* result  = *my_free_list;
             if(result == 0)//链表为空，调用S_fill重新填充链表
@@ -501,16 +553,18 @@ typedef default_alloc_template<false, 0> single_client_alloc;
      * @tparam inst 
      * @param p 内存指针 
      * @param n 大小n
-     * @return void* 
      */
     template<bool threads, int inst>
-    void* default_alloc_template<threads, inst>::deallocate(void* p, size_t n)
+    void default_alloc_template<threads, inst>::deallocate(void* p, size_t n)
     {
         if( n > (size_t) MAX_BYTES)
         {//大于128
             malloc_alloc::deallocate(p, n);
+        }else if(threads){//多线程：压回无锁链表
+            obj* q = (obj*) p;
+            S_mt_push(S_freelist_index(n), q, q);
         }else{//处理小块内存
-            obj* my_free_list = S_free_list + S_freelist_index(n);//对于大小为n的，对应的空闲大小链表头指针
+            obj** my_free_list = S_free_list + S_freelist_index(n);//对于大小为n的，对应的空闲大小链表头指针
             //将p内存插入对应的空闲链表
             obj* q = (obj*) p;
             q->M_free_list_link = *my_free_list;
@@ -519,6 +573,126 @@ typedef default_alloc_template<false, 0> single_client_alloc;
         }
     }
 
+    /**
+     * @brief 当前线程的内存池。只含平凡成员，线程局部变量不需要初始化守卫
+     */
+    template<bool threads, int inst>
+    typename default_alloc_template<threads, inst>::mt_chunk& default_alloc_template<threads, inst>::S_mt_chunk()
+    {
+        static thread_local mt_chunk chunk = {0, 0, 0};
+        return chunk;
+    }
+
+    /**
+     * @brief 从第 index 个无锁链表中弹出一个块（Treiber stack 的 pop）
+     *  读取 result->M_free_list_link 时 result 可能已被其他线程取走，读到的值可能已经过期；
+     *  但内存池的内存从不归还系统，读取本身是安全的，过期的值也会因 tag 改变而使 CAS 失败
+     * @param index 链表索引
+     * @return obj* 链表为空时返回0
+     */
+    template<bool threads, int inst>
+    typename default_alloc_template<threads, inst>::obj* default_alloc_template<threads, inst>::S_mt_pop(size_t index)
+    {
+        std::atomic<uint64_t>& head = S_mt_free_list[index];
+        uint64_t old_head = head.load(std::memory_order_acquire);
+        for(;;)
+        {
+            obj* result = S_unpack(old_head);
+            if(result == 0) return 0;
+            obj* next = result->M_free_list_link;
+            if(head.compare_exchange_weak(old_head, S_pack(next, S_next_tag(old_head)),
+                                          std::memory_order_acquire, std::memory_order_acquire))
+                return result;
+        }
+    }
+
+    /**
+     * @brief 把已经串好的 first ~ last 一次压入第 index 个无锁链表（Treiber stack 的 push）
+     */
+    template<bool threads, int inst>
+    void default_alloc_template<threads, inst>::S_mt_push(size_t index, obj* first, obj* last)
+    {
+        std::atomic<uint64_t>& head = S_mt_free_list[index];
+        uint64_t old_head = head.load(std::memory_order_relaxed);
+        do
+        {
+            last->M_free_list_link = S_unpack(old_head);
+        }while(!head.compare_exchange_weak(old_head, S_pack(first, S_next_tag(old_head)),
+                                           std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief 多线程版本的 S_chunk_alloc：从当前线程的内存池中切割 nobjs 个大小为 size 的块，
+     *  不足时把剩余碎片放回无锁链表，再向系统申请新的内存池
+     */
+    template<bool threads, int inst>
+    char* default_alloc_template<threads, inst>::S_mt_chunk_alloc(size_t size, int& nobjs)
+    {
+        mt_chunk& chunk = S_mt_chunk();
+        char* result;
+        size_t total_bytes = size * nobjs;
+        size_t bytes_left = chunk.end_free - chunk.start_free;
+        if(bytes_left >= total_bytes)
+        {
+            result = chunk.start_free;
+            chunk.start_free += total_bytes;
+            return result;
+        }else if(bytes_left >= size){
+            nobjs = (int)(bytes_left/size);
+            total_bytes = size * nobjs;
+            result = chunk.start_free;
+            chunk.start_free += total_bytes;
+            return result;
+        }else{
+            size_t bytes_to_get = 2* total_bytes + S_round_up(chunk.heap_size >>4);
+            if(bytes_left > 0)//剩余碎片放回对应的无锁链表
+            {
+                obj* q = (obj*) chunk.start_free;
+                S_mt_push(S_freelist_index(bytes_left), q, q);
+            }
+            chunk.start_free = (char*) malloc(bytes_to_get);
+            if(chunk.start_free == 0)//失败：从更大的无锁链表中借一个块
+            {
+                for(size_t i = size; i <= (size_t) MAX_BYTES; i+= (size_t) ALIGN)
+                {
+                    obj* p = S_mt_pop(S_freelist_index(i));
+                    if(p != 0)
+                    {
+                        chunk.start_free = (char*) p;
+                        chunk.end_free = chunk.start_free + i;
+                        return S_mt_chunk_alloc(size, nobjs);
+                    }
+                }
+                chunk.end_free = 0;
+                chunk.start_free = (char*) malloc_alloc::allocate(bytes_to_get);
+            }
+            chunk.heap_size += bytes_to_get;
+            chunk.end_free = chunk.start_free + bytes_to_get;
+            return S_mt_chunk_alloc(size, nobjs);
+        }
+    }
+
+    /**
+     * @brief 多线程版本的 S_refill：第一个块返回给调用者，其余的块先在本线程串好，再用一次 CAS 整串压入无锁链表
+     */
+    template<bool threads, int inst>
+    void* default_alloc_template<threads, inst>::S_mt_refill(size_t n)
+    {
+        int nobjs = 20;
+        char* chunk = S_mt_chunk_alloc(n, nobjs);
+        if(nobjs == 1) return chunk;
+        obj* first = (obj*)(chunk + n);
+        obj* last = first;
+        for(int i = 2; i < nobjs; i++)
+        {
+            obj* next = (obj*)(chunk + i * n);
+            last->M_free_list_link = next;
+            last = next;
+        }
+        S_mt_push(S_freelist_index(n), first, last);
+        return chunk;
+    }
+
     /**
      * @brief 重新分配内存
      * 
@@ -0,0 +1,94 @@
+/**
+ * @file alloc_bench.cpp
+ * @brief 第二级配置器的多线程竞争测试：1/4/16 个线程同时分配、释放小块内存
+ *        编译：g++ -std=c++11 -O2 -pthread alloc_bench.cpp -o alloc_bench
+ */
+#include<chrono>
+#include<cstdio>
+#include<mutex>
+#include<thread>
+#include<vector>
+
+#include"alloc.h"
+
+namespace
+{
+    const size_t BLOCKS = 10000;//每轮每个线程持有的块数
+    const size_t ROUNDS = 100;//每个线程的轮数
+
+    /*被 threads = false 的版本只能在一把全局锁的保护下共享*/
+    std::mutex global_lock;
+
+    struct malloc_policy
+    {
+        static void* allocate(size_t n) { return malloc(n); }
+        static void deallocate(void* p, size_t) { free(p); }
+    };
+
+    struct locked_policy
+    {
+        static void* allocate(size_t n)
+        {
+            std::lock_guard<std::mutex> lk(global_lock);
+            return MYSTL::alloc::allocate(n);
+        }
+        static void deallocate(void* p, size_t n)
+        {
+            std::lock_guard<std::mutex> lk(global_lock);
+            MYSTL::alloc::deallocate(p, n);
+        }
+    };
+
+    struct lockfree_policy
+    {
+        static void* allocate(size_t n) { return MYSTL::multithread_alloc::allocate(n); }
+        static void deallocate(void* p, size_t n) { MYSTL::multithread_alloc::deallocate(p, n); }
+    };
+
+    /**
+     * @brief 每个线程反复分配 BLOCKS 个大小在 8 ~ 128 之间的块再全部释放，返回耗时（毫秒）
+     */
+    template<class Policy>
+    long long run(size_t nthreads)
+    {
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for(size_t t = 0; t < nthreads; t++)
+        {
+            workers.push_back(std::thread([t]() {
+                std::vector<void*> blocks(BLOCKS);
+                for(size_t r = 0; r < ROUNDS; r++)
+                {
+                    for(size_t i = 0; i < BLOCKS; i++)
+                    {
+                        size_t n = ((i + t) % 16 + 1) * 8;
+                        blocks[i] = Policy::allocate(n);
+                        *(size_t*) blocks[i] = i;
+                    }
+                    for(size_t i = 0; i < BLOCKS; i++)
+                        Policy::deallocate(blocks[i], ((i + t) % 16 + 1) * 8);
+                }
+            }));
+        }
+        for(size_t t = 0; t < nthreads; t++)
+            workers[t].join();
+        auto end = std::chrono::steady_clock::now();
+        return (long long) std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    }
+}
+
+int main()
+{
+    const size_t threads[] = {1, 4, 16};
+    std::printf("| threads |     malloc | alloc + mutex |  lock-free |\n");
+    std::printf("|---------|------------|---------------|------------|\n");
+    for(size_t i = 0; i < 3; i++)
+    {
+        size_t n = threads[i];
+        long long t1 = run<malloc_policy>(n);
+        long long t2 = run<locked_policy>(n);
+        long long t3 = run<lockfree_policy>(n);
+        std::printf("| %7zu | %8lldms | %11lldms | %8lldms |\n", n, t1, t2, t3);
+    }
+    return 0;
+}
@@ -102,13 +102,46 @@ size_t count_if(InputIter first, InputIter last, UnaryPredicate unary_pred)
 /*****************************************************************************************/
 template <class InputIter, class T>
 InputIter
-find(InputIter first, InputIter last, const T& value)
+find_dispatch(InputIter first, InputIter last, const T& value, std::false_type)
 {
   while (first != last && *first != value)
     ++first;
   return first;
 }
 
+// 分段迭代器逐段查找，每一段上使用指针
+template <class SegIter, class T>
+SegIter
+find_dispatch(SegIter first, SegIter last, const T& value, std::true_type)
+{
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto sfirst = traits::segment(first);
+  const auto slast = traits::segment(last);
+  if (sfirst == slast)
+  {
+    auto p = find_dispatch(traits::local(first), traits::local(last), value, std::false_type());
+    return traits::compose(sfirst, p);
+  }
+  auto p = find_dispatch(traits::local(first), traits::end(sfirst), value, std::false_type());
+  if (p != traits::end(sfirst))
+    return traits::compose(sfirst, p);
+  for (++sfirst; sfirst != slast; ++sfirst)
+  {
+    p = find_dispatch(traits::begin(sfirst), traits::end(sfirst), value, std::false_type());
+    if (p != traits::end(sfirst))
+      return traits::compose(sfirst, p);
+  }
+  p = find_dispatch(traits::begin(slast), traits::local(last), value, std::false_type());
+  return traits::compose(slast, p);
+}
+
+template <class InputIter, class T>
+InputIter
+find(InputIter first, InputIter last, const T& value)
+{
+  return find_dispatch(first, last, value, is_segmented_iterator<InputIter>());
+}
+
 /*****************************************************************************************/
 // find_if
 // 在[first, last)区间内找到第一个令一元操作 unary_pred 为 true 的元素并返回指向该元素的迭代器
@@ -1607,8 +1640,9 @@ bool is_permutation_aux(ForwardIter1 first1, ForwardIter1 last1,
     && mystl::is_random_access_iterator<ForwardIter2>::value;
   if (is_ra_it)
   {
-    auto len1 = last1 - first1;
-    auto len2 = last2 - first2;
+    // 对随机访问迭代器 distance 只做一次减法，同时也能让前向迭代器通过编译
+    auto len1 = mystl::distance(first1, last1);
+    auto len2 = mystl::distance(first2, last2);
     if (len1 != len2)
       return false;
   }
@@ -2175,12 +2209,13 @@ template <class RandomIter>
 void partial_sort(RandomIter first, RandomIter middle,
                   RandomIter last)
 {
+  typedef typename iterator_traits<RandomIter>::value_type value_type;
   mystl::make_heap(first, middle);
   for (auto i = middle; i < last; ++i)
   {
     if (*i < *first)
     {
-      mystl::pop_heap_aux(first, middle, i, *i, distance_type(first));
+      mystl::pop_heap_aux(first, middle, i, value_type(*i), distance_type(first));
     }
   }
   mystl::sort_heap(first, middle);
@@ -2191,12 +2226,13 @@ template <class RandomIter, class Compared>
 void partial_sort(RandomIter first, RandomIter middle,
                   RandomIter last, Compared comp)
 {
+  typedef typename iterator_traits<RandomIter>::value_type value_type;
   mystl::make_heap(first, middle, comp);
   for (auto i = middle; i < last; ++i)
   {
     if (comp(*i, *first))
     {
-      mystl::pop_heap_aux(first, middle, i, *i, distance_type(first), comp);
+      mystl::pop_heap_aux(first, middle, i, value_type(*i), distance_type(first), comp);
     }
   }
   mystl::sort_heap(first, middle, comp);
@@ -2386,7 +2422,8 @@ void intro_sort(RandomIter first, RandomIter last, Size depth_limit)
       return;
     }
     --depth_limit;
-    auto mid = mystl::median(*(first), *(first + (last - first) / 2), *(last - 1));
+    typename iterator_traits<RandomIter>::value_type mid =
+      mystl::median(*(first), *(first + (last - first) / 2), *(last - 1));
     auto cut = mystl::unchecked_partition(first, last, mid);
     mystl::intro_sort(cut, last, depth_limit);
     last = cut;
@@ -2412,9 +2449,10 @@ void unchecked_linear_insert(RandomIter last, const T& value)
 template <class RandomIter>
 void unchecked_insertion_sort(RandomIter first, RandomIter last)
 {
+  typedef typename iterator_traits<RandomIter>::value_type value_type;
   for (auto i = first; i != last; ++i)
   {
-    mystl::unchecked_linear_insert(i, *i);
+    mystl::unchecked_linear_insert(i, value_type(*i));
   }
 }
 
@@ -2426,7 +2464,7 @@ void insertion_sort(RandomIter first, RandomIter last)
     return;
   for (auto i = first + 1; i != last; ++i)
   {
-    auto value = *i;
+    typename iterator_traits<RandomIter>::value_type value = *i;
     if (value < *first)
     {
       mystl::copy_backward(first, i, i + 1);
@@ -2499,7 +2537,8 @@ void intro_sort(RandomIter first, RandomIter last,
       return;
     }
     --depth_limit;
-    auto mid = mystl::median(*(first), *(first + (last - first) / 2), *(last - 1));
+    typename iterator_traits<RandomIter>::value_type mid =
+      mystl::median(*(first), *(first + (last - first) / 2), *(last - 1), comp);
     auto cut = mystl::unchecked_partition(first, last, mid, comp);
     mystl::intro_sort(cut, last, depth_limit, comp);
     last = cut;
@@ -2526,9 +2565,10 @@ template <class RandomIter, class Compared>
 void unchecked_insertion_sort(RandomIter first, RandomIter last,
                               Compared comp)
 {
+  typedef typename iterator_traits<RandomIter>::value_type value_type;
   for (auto i = first; i != last; ++i)
   {
-    mystl::unchecked_linear_insert(i, *i, comp);
+    mystl::unchecked_linear_insert(i, value_type(*i), comp);
   }
 }
 
@@ -2540,7 +2580,7 @@ void insertion_sort(RandomIter first, RandomIter last, Compared comp)
     return;
   for (auto i = first + 1; i != last; ++i)
   {
-    auto value = *i;
+    typename iterator_traits<RandomIter>::value_type value = *i;
     if (comp(value, *first))
     {
       mystl::copy_backward(first, i, i + 1);
@@ -60,11 +60,26 @@ const T& min(const T& lhs, const T& rhs, Compare comp)
 // 将两个迭代器所指对象对调
 /*****************************************************************************************/
 template <class FIter1, class FIter2>
-void iter_swap(FIter1 lhs, FIter2 rhs)
+void iter_swap_aux(FIter1 lhs, FIter2 rhs, std::true_type)
 {
   mystl::swap(*lhs, *rhs);
 }
 
+// 解引用得到的是代理对象（如 soa_vector 的行）时，借助一个 value_type 的临时对象对调
+template <class FIter1, class FIter2>
+void iter_swap_aux(FIter1 lhs, FIter2 rhs, std::false_type)
+{
+  typename iterator_traits<FIter1>::value_type tmp = mystl::move(*lhs);
+  *lhs = *rhs;
+  *rhs = mystl::move(tmp);
+}
+
+template <class FIter1, class FIter2>
+void iter_swap(FIter1 lhs, FIter2 rhs)
+{
+  mystl::iter_swap_aux(lhs, rhs, std::is_reference<decltype(*lhs)>());
+}
+
 /*****************************************************************************************/
 // copy
 // 把 [first, last)区间内的元素拷贝到 [result, result + (last - first))内
@@ -116,12 +131,74 @@ unchecked_copy(Tp* first, Tp* last, Up* result)
   return result + n;
 }
 
+// 输出端为分段迭代器、输入端可以随机访问时，按输出端的段拆分，每一段上使用指针
 template <class InputIter, class OutputIter>
-OutputIter copy(InputIter first, InputIter last, OutputIter result)
+OutputIter
+copy_to_segments(InputIter first, InputIter last, OutputIter result, std::false_type)
 {
   return unchecked_copy(first, last, result);
 }
 
+template <class RandomIter, class SegIter>
+SegIter
+copy_to_segments(RandomIter first, RandomIter last, SegIter result, std::true_type)
+{
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto seg = traits::segment(result);
+  auto cur = traits::local(result);
+  for (auto n = last - first; n > 0; )
+  {
+    if (cur == traits::end(seg))
+    {
+      ++seg;
+      cur = traits::begin(seg);
+    }
+    const auto room = traits::end(seg) - cur;
+    const auto len = n < room ? n : room;
+    cur = unchecked_copy(first, first + len, cur);
+    first += len;
+    n -= len;
+  }
+  return traits::compose(seg, cur);
+}
+
+template <class InputIter, class OutputIter>
+OutputIter
+copy_to(InputIter first, InputIter last, OutputIter result)
+{
+  return copy_to_segments(first, last, result, std::integral_constant<bool,
+    is_segmented_iterator<OutputIter>::value && is_random_access_iterator<InputIter>::value>());
+}
+
+// 输入端为分段迭代器时，逐段拷贝，段与段之间保持从前往后的顺序
+template <class InputIter, class OutputIter>
+OutputIter
+copy_from_segments(InputIter first, InputIter last, OutputIter result, std::false_type)
+{
+  return copy_to(first, last, result);
+}
+
+template <class SegIter, class OutputIter>
+OutputIter
+copy_from_segments(SegIter first, SegIter last, OutputIter result, std::true_type)
+{
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto sfirst = traits::segment(first);
+  const auto slast = traits::segment(last);
+  if (sfirst == slast)
+    return copy_to(traits::local(first), traits::local(last), result);
+  result = copy_to(traits::local(first), traits::end(sfirst), result);
+  for (++sfirst; sfirst != slast; ++sfirst)
+    result = copy_to(traits::begin(sfirst), traits::end(sfirst), result);
+  return copy_to(traits::begin(slast), traits::local(last), result);
+}
+
+template <class InputIter, class OutputIter>
+OutputIter copy(InputIter first, InputIter last, OutputIter result)
+{
+  return copy_from_segments(first, last, result, is_segmented_iterator<InputIter>());
+}
+
 /*****************************************************************************************/
 // copy_backward
 // 将 [first, last)区间内的元素拷贝到 [result - (last - first), result)内
@@ -174,11 +251,78 @@ unchecked_copy_backward(Tp* first, Tp* last, Up* result)
   return result;
 }
 
+// 输出端为分段迭代器、输入端可以随机访问时，按输出端的段从后往前拆分
+template <class BidirectionalIter1, class BidirectionalIter2>
+BidirectionalIter2
+copy_backward_to_segments(BidirectionalIter1 first, BidirectionalIter1 last,
+                          BidirectionalIter2 result, std::false_type)
+{
+  return unchecked_copy_backward(first, last, result);
+}
+
+template <class RandomIter, class SegIter>
+SegIter
+copy_backward_to_segments(RandomIter first, RandomIter last, SegIter result, std::true_type)
+{
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto seg = traits::segment(result);
+  auto cur = traits::local(result);
+  for (auto n = last - first; n > 0; )
+  {
+    if (cur == traits::begin(seg))
+    {
+      --seg;
+      cur = traits::end(seg);
+    }
+    const auto room = cur - traits::begin(seg);
+    const auto len = n < room ? n : room;
+    cur = unchecked_copy_backward(last - len, last, cur);
+    last -= len;
+    n -= len;
+  }
+  return traits::compose(seg, cur);
+}
+
+template <class BidirectionalIter1, class BidirectionalIter2>
+BidirectionalIter2
+copy_backward_to(BidirectionalIter1 first, BidirectionalIter1 last, BidirectionalIter2 result)
+{
+  return copy_backward_to_segments(first, last, result, std::integral_constant<bool,
+    is_segmented_iterator<BidirectionalIter2>::value &&
+    is_random_access_iterator<BidirectionalIter1>::value>());
+}
+
+// 输入端为分段迭代器时，从最后一段开始逐段拷贝
+template <class BidirectionalIter1, class BidirectionalIter2>
+BidirectionalIter2
+copy_backward_from_segments(BidirectionalIter1 first, BidirectionalIter1 last,
+                            BidirectionalIter2 result, std::false_type)
+{
+  return copy_backward_to(first, last, result);
+}
+
+template <class SegIter, class BidirectionalIter2>
+BidirectionalIter2
+copy_backward_from_segments(SegIter first, SegIter last,
+                            BidirectionalIter2 result, std::true_type)
+{
+  typedef segmented_iterator_traits<SegIter> traits;
+  const auto sfirst = traits::segment(first);
+  auto slast = traits::segment(last);
+  if (sfirst == slast)
+    return copy_backward_to(traits::local(first), traits::local(last), result);
+  result = copy_backward_to(traits::begin(slast), traits::local(last), result);
+  for (--slast; slast != sfirst; --slast)
+    result = copy_backward_to(traits::begin(slast), traits::end(slast), result);
+  return copy_backward_to(traits::local(first), traits::end(sfirst), result);
+}
+
 template <class BidirectionalIter1, class BidirectionalIter2>
 BidirectionalIter2 
 copy_backward(BidirectionalIter1 first, BidirectionalIter1 last, BidirectionalIter2 result)
 {
-  return unchecked_copy_backward(first, last, result);
+  return copy_backward_from_segments(first, last, result,
+                                     is_segmented_iterator<BidirectionalIter1>());
 }
 
 /*****************************************************************************************/
@@ -402,12 +546,48 @@ unchecked_fill_n(Tp* first, Size n, Up value)
   return first + n;
 }
 
+// 分段迭代器逐段填充，每一段上使用指针
+template <class SegIter, class T>
+void fill_segments(SegIter first, SegIter last, const T& value)
+{
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto sfirst = traits::segment(first);
+  const auto slast = traits::segment(last);
+  if (sfirst == slast)
+  {
+    unchecked_fill_n(traits::local(first), traits::local(last) - traits::local(first), value);
+    return;
+  }
+  unchecked_fill_n(traits::local(first), traits::end(sfirst) - traits::local(first), value);
+  for (++sfirst; sfirst != slast; ++sfirst)
+    unchecked_fill_n(traits::begin(sfirst), traits::end(sfirst) - traits::begin(sfirst), value);
+  unchecked_fill_n(traits::begin(slast), traits::local(last) - traits::begin(slast), value);
+}
+
 template <class OutputIter, class Size, class T>
-OutputIter fill_n(OutputIter first, Size n, const T& value)
+OutputIter fill_n_dispatch(OutputIter first, Size n, const T& value, std::false_type)
 {
   return unchecked_fill_n(first, n, value);
 }
 
+template <class SegIter, class Size, class T>
+SegIter fill_n_dispatch(SegIter first, Size n, const T& value, std::true_type)
+{
+  auto last = first;
+  if (n > 0)
+  {
+    last += n;
+    fill_segments(first, last, value);
+  }
+  return last;
+}
+
+template <class OutputIter, class Size, class T>
+OutputIter fill_n(OutputIter first, Size n, const T& value)
+{
+  return fill_n_dispatch(first, n, value, is_segmented_iterator<OutputIter>());
+}
+
 /*****************************************************************************************/
 // fill
 // 为 [first, last)区间内的所有元素填充新值
@@ -426,15 +606,27 @@ template <class RandomIter, class T>
 void fill_cat(RandomIter first, RandomIter last, const T& value,
               mystl::random_access_iterator_tag)
 {
-  fill_n(first, last - first, value);
+  mystl::fill_n(first, last - first, value);
 }
 
 template <class ForwardIter, class T>
-void fill(ForwardIter first, ForwardIter last, const T& value)
+void fill_dispatch(ForwardIter first, ForwardIter last, const T& value, std::false_type)
 {
   fill_cat(first, last, value, iterator_category(first));
 }
 
+template <class SegIter, class T>
+void fill_dispatch(SegIter first, SegIter last, const T& value, std::true_type)
+{
+  fill_segments(first, last, value);
+}
+
+template <class ForwardIter, class T>
+void fill(ForwardIter first, ForwardIter last, const T& value)
+{
+  fill_dispatch(first, last, value, is_segmented_iterator<ForwardIter>());
+}
+
 /*****************************************************************************************/
 // lexicographical_compare
 // 以字典序排列对两个序列进行比较，当在某个位置发现第一组不相等元素时，有下列几种情况：
@@ -0,0 +1,194 @@
+#ifndef MYTINYSTL_ALIGNED_ALLOCATOR_H_
+#define MYTINYSTL_ALIGNED_ALLOCATOR_H_
+
+// 这个头文件包含一个模板类 aligned_allocator
+// aligned_allocator : 返回按 Align bytes 对齐的空间，并把空间补齐到 Align 的整数倍
+
+// notes:
+//
+// ::operator new 只保证 16 bytes 对齐，SIMD 代码处理 vector<float>::data() 时只能用非对齐的读写。
+// aligned_allocator<T, Align> 分配的每一块空间首地址都是 Align 的倍数，大小上调到 Align 的整数倍，
+// 因此对 [p, p + n) 做向量化时，尾部可以整块读到 Align 边界而不越过分配的空间
+// (多读的部分内容未定义，只能丢弃，不能写入)。
+// 作为 vector 的分配器时保证 data() 对齐，作为 deque 的分配器时保证每一个缓冲区对齐，
+// 见 vector.h 中的 aligned_vector 与 deque.h 中的 aligned_deque。
+//
+// 实现上多申请 Align + sizeof(void*) bytes，在对齐后的首地址之前保存原始指针；
+// 定义 MYSTL_USE_LARGE_ALLOC 后大块内存交给 large_alloc，它按页对齐，不需要额外的空间
+
+#include <new>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "construct.h"
+#include "util.h"
+#include "exceptdef.h"
+
+#ifdef MYSTL_USE_LARGE_ALLOC
+#include "large_alloc.h"
+#endif // MYSTL_USE_LARGE_ALLOC
+
+#ifdef MYSTL_ALLOC_STATS
+#include "alloc_stats.h"
+#endif // MYSTL_ALLOC_STATS
+
+namespace mystl
+{
+
+// 缺省的对齐大小，与 AVX-512 寄存器和 cache line 的宽度相同
+enum { ESimdAlign = 64 };
+
+// 模板类：aligned_allocator
+// 模板参数 T 代表数据类型，Align 代表对齐的字节数，必须是 2 的幂
+template <class T, size_t Align = ESimdAlign>
+class aligned_allocator
+{
+  static_assert(Align != 0 && (Align & (Align - 1)) == 0,
+                "aligned_allocator: Align must be a power of two");
+
+public:
+  typedef T            value_type;
+  typedef T*           pointer;
+  typedef const T*     const_pointer;
+  typedef T&           reference;
+  typedef const T&     const_reference;
+  typedef size_t       size_type;
+  typedef ptrdiff_t    difference_type;
+
+  template <class U>
+  struct rebind
+  {
+    typedef aligned_allocator<U, Align> other;
+  };
+
+  // 实际的对齐大小，不小于 T 自身的对齐要求
+  static constexpr size_type alignment = Align < alignof(T) ? alignof(T) : Align;
+
+public:
+  aligned_allocator() noexcept {}
+  aligned_allocator(const aligned_allocator&) noexcept {}
+  template <class U>
+  aligned_allocator(const aligned_allocator<U, Align>&) noexcept {}
+
+  static T*   allocate();
+  static T*   allocate(size_type n);
+
+  static void deallocate(T* ptr);
+  static void deallocate(T* ptr, size_type n);
+
+  // n 个元素实际占用的字节数，上调到 alignment 的整数倍
+  static size_type padded_bytes(size_type n) noexcept
+  { return (n * sizeof(T) + alignment - 1) & ~(alignment - 1); }
+
+  // 申请 n 个元素时补齐后的空间能容纳的元素个数，不小于 n
+  static size_type good_size(size_type n) noexcept
+  { return n == 0 ? 0 : padded_bytes(n) / sizeof(T); }
+
+  template <class... Args>
+  static void construct(T* ptr, Args&& ...args)
+  { mystl::construct(ptr, mystl::forward<Args>(args)...); }
+
+  static void destroy(T* ptr)
+  { mystl::destroy(ptr); }
+
+private:
+  static void* raw_allocate(size_type bytes);
+  static void  raw_deallocate(void* ptr, size_type bytes) noexcept;
+};
+
+template <class T, size_t Align>
+constexpr typename aligned_allocator<T, Align>::size_type aligned_allocator<T, Align>::alignment;
+
+template <class T, size_t Align>
+void* aligned_allocator<T, Align>::raw_allocate(size_type bytes)
+{
+  if (bytes > static_cast<size_type>(-1) / 2)
+    throw std::bad_alloc();
+#ifdef MYSTL_USE_LARGE_ALLOC
+  if (alignment <= static_cast<size_type>(EPageBytes) && mystl::large_alloc::is_large(bytes))
+    return mystl::large_alloc::allocate(bytes);
+#endif // MYSTL_USE_LARGE_ALLOC
+  // 原始指针保存在对齐后首地址之前的 sizeof(void*) bytes 中
+  void* raw = ::operator new(bytes + alignment + sizeof(void*));
+  const uintptr_t start = reinterpret_cast<uintptr_t>(raw) + sizeof(void*);
+  const uintptr_t mask = static_cast<uintptr_t>(alignment - 1);
+  void* result = reinterpret_cast<void*>((start + mask) & ~mask);
+  static_cast<void**>(result)[-1] = raw;
+  return result;
+}
+
+template <class T, size_t Align>
+void aligned_allocator<T, Align>::raw_deallocate(void* ptr, size_type bytes) noexcept
+{
+#ifdef MYSTL_USE_LARGE_ALLOC
+  if (alignment <= static_cast<size_type>(EPageBytes) && mystl::large_alloc::is_large(bytes))
+  {
+    mystl::large_alloc::deallocate(ptr, bytes);
+    return;
+  }
+#else
+  (void)bytes;
+#endif // MYSTL_USE_LARGE_ALLOC
+  ::operator delete(static_cast<void**>(ptr)[-1]);
+}
+
+template <class T, size_t Align>
+T* aligned_allocator<T, Align>::allocate()
+{
+  return allocate(1);
+}
+
+template <class T, size_t Align>
+T* aligned_allocator<T, Align>::allocate(size_type n)
+{
+  if (n == 0)
+    return nullptr;
+  THROW_LENGTH_ERROR_IF(n > static_cast<size_type>(-1) / sizeof(T) / 2,
+                        "aligned_allocator<T>::allocate too many elements");
+  const size_type bytes = padded_bytes(n);
+  void* p = raw_allocate(bytes);
+#ifdef MYSTL_ALLOC_STATS
+  mystl::alloc_stats::record_allocate(mystl::alloc_stats::entry<T>(), bytes);
+#endif // MYSTL_ALLOC_STATS
+  return static_cast<T*>(p);
+}
+
+template <class T, size_t Align>
+void aligned_allocator<T, Align>::deallocate(T* ptr)
+{
+  deallocate(ptr, 1);
+}
+
+// 与 allocate 一样按补齐后的大小释放，n 必须与申请时相同
+template <class T, size_t Align>
+void aligned_allocator<T, Align>::deallocate(T* ptr, size_type n)
+{
+  if (ptr == nullptr)
+    return;
+  const size_type bytes = padded_bytes(n);
+#ifdef MYSTL_ALLOC_STATS
+  mystl::alloc_stats::record_deallocate(mystl::alloc_stats::entry<T>(), bytes);
+#endif // MYSTL_ALLOC_STATS
+  raw_deallocate(ptr, bytes);
+}
+
+// aligned_allocator 没有状态，对齐大小相同的实例都相等
+template <class T, class U, size_t Align>
+bool operator==(const aligned_allocator<T, Align>&, const aligned_allocator<U, Align>&) noexcept
+{
+  return true;
+}
+
+template <class T, class U, size_t Align>
+bool operator!=(const aligned_allocator<T, Align>&, const aligned_allocator<U, Align>&) noexcept
+{
+  return false;
+}
+
+template <class T, size_t Align>
+struct is_trivially_relocatable<aligned_allocator<T, Align>> : std::true_type {};
+
+} // namespace mystl
+#endif // !MYTINYSTL_ALIGNED_ALLOCATOR_H_
+
@@ -3,19 +3,32 @@
 
 // 这个头文件包含一个类 alloc，用于分配和回收内存，以内存池的方式实现
 //
-// 从 v2.0.0 版本开始，将不再使用内存池，这个文件将被弃用，但暂时保留
+// 内存池把 <= 4096 bytes 的区块分为 56 个 size class，每个线程持有一份线程缓存：
+// 分配与回收小区块时只操作本线程的自由链表，不需要加锁。
+// 线程缓存为空时，从全局仓库(depot)中成批取回区块；缓存过长或线程退出时，
+// 再把区块成批归还仓库。在 A 线程分配、B 线程释放的区块会进入 B 的线程缓存，
+// 之后可能经由仓库回到任意线程，因此跨线程释放是安全的。
+// 线程缓存还会定期回收：每释放 EScavengeInterval 次，检查每个自由链表在这段时间内的最低长度，
+// 这部分区块整段时间都没有被用到，把其中一半归还仓库，避免空闲线程长期占着区块。
+// 内存池申请到的内存不会还给系统，这与 SGI STL 的第二级配置器一致。
 //
-// 注意！！！
-// 我知道这个文件里很多实现是错的，这是很久很久前写的了，后面已经不用这个东西了，
-// 所以我也没再维护，有诸多问题，已经有人在issue中都提了，free_list的修改，
-// 指针作为参数时没实际修改到原指针，等等。相信会看这么仔细的，大部分都是
-// 初学C++的朋友，大佬都不会看这些玩具了，所以其中的错误，就留给对内存池实现
-// 感兴趣的朋友去修改啦！
+// 区块至少按 8 bytes 对齐，对齐要求更高的类型不应使用这个内存池。
+//
+// 在包含 allocator.h 之前定义 MYSTL_USE_POOL_ALLOC，可以令 mystl::allocator<T> 改用这个内存池，
+// 这个宏必须对程序中所有的编译单元一致地定义
+//
+// 定义 MYSTL_USE_LARGE_ALLOC 时，不小于 MYSTL_LARGE_ALLOC_THRESHOLD 的请求交给 large_alloc
 
 #include <new>
+#include <mutex>
 
 #include <cstddef>
-#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef MYSTL_USE_LARGE_ALLOC
+#include "large_alloc.h"
+#endif // MYSTL_USE_LARGE_ALLOC
 
 namespace mystl
 {
@@ -31,10 +44,10 @@ union FreeList
 // 不同内存范围的上调大小
 enum
 {
-  EAlign128 = 8, 
-  EAlign256 = 16, 
+  EAlign128 = 8,
+  EAlign256 = 16,
   EAlign512 = 32,
-  EAlign1024 = 64, 
+  EAlign1024 = 64,
   EAlign2048 = 128,
   EAlign4096 = 256
 };
@@ -45,62 +58,119 @@ enum { ESmallObjectBytes = 4096 };
 // free lists 个数
 enum { EFreeListsNumber = 56 };
 
+// 线程缓存与仓库之间每次搬运的字节数，决定了每个 size class 一批有多少个区块
+enum { EBatchBytes = 8192 };
+
+// 一批区块的数量上下限
+enum { EBatchMinObjects = 2, EBatchMaxObjects = 64 };
+
+// 线程缓存每释放多少次区块，检查一次是否有多余的区块需要归还仓库
+enum { EScavengeInterval = 1024 };
+
+// 线程缓存的状态
+enum
+{
+  ECacheUninit = 0,  // 还未注册线程退出时的回收
+  ECacheActive = 1,  // 正常使用中
+  ECacheDead = 2     // 线程缓存已被回收，之后的请求直接访问仓库
+};
+
+// 结构体: alloc_thread_cache
+// 每个线程独有的自由链表，只能是平凡类型，这样线程局部变量不需要初始化守卫
+struct alloc_thread_cache
+{
+  FreeList* free_list[EFreeListsNumber];  // 自由链表
+  size_t    length[EFreeListsNumber];     // 每个自由链表中的区块数量
+  size_t    limit[EFreeListsNumber];      // 自由链表长度的上限，为 0 表示还未设置
+  size_t    low[EFreeListsNumber];        // 上次回收以来自由链表的最低长度
+  size_t    ops;                          // 上次回收以来的释放次数
+  int       state;                        // 缓存状态
+};
+
+// 结构体: alloc_depot
+// 全局仓库，每个 size class 一把锁，另有一把锁保护内存池本身
+struct alloc_depot
+{
+  std::mutex lock[EFreeListsNumber];
+  FreeList*  free_list[EFreeListsNumber];
+
+  std::mutex chunk_lock;
+  char*      start_free;  // 内存池起始位置
+  char*      end_free;    // 内存池结束位置
+  size_t     heap_size;   // 申请 heap 空间附加值大小
+
+  alloc_depot() noexcept
+    :start_free(nullptr), end_free(nullptr), heap_size(0)
+  {
+    for (size_t i = 0; i < EFreeListsNumber; ++i)
+      free_list[i] = nullptr;
+  }
+};
+
 // 空间配置类 alloc
 // 如果内存较大，超过 4096 bytes，直接调用 std::malloc, std::free
 // 当内存较小时，以内存池管理，每次配置一大块内存，并维护对应的自由链表
 class alloc
 {
-private:
-  static char*  start_free;                      // 内存池起始位置
-  static char*  end_free;                        // 内存池结束位置
-  static size_t heap_size;                       // 申请 heap 空间附加值大小
-  
-  static FreeList* free_list[EFreeListsNumber];  // 自由链表
-
 public:
   static void* allocate(size_t n);
   static void  deallocate(void* p, size_t n);
   static void* reallocate(void* p, size_t old_size, size_t new_size);
 
+  // 本线程缓存中大小为 n 的 size class 现有的区块数
+  static size_t cached_blocks(size_t n) noexcept;
+
+  // 申请 n bytes 时实际得到的区块大小，大于 4096 bytes 时为 n
+  static size_t good_size(size_t n) noexcept;
+
 private:
   static size_t M_align(size_t bytes);
   static size_t M_round_up(size_t bytes);
   static size_t M_freelist_index(size_t bytes);
-  static void*  M_refill(size_t n);
-  static char*  M_chunk_alloc(size_t size, size_t &nobj);
-};
+  static size_t M_batch_size(size_t bytes);
 
-// 静态成员变量初始化
+  // 线程退出时把线程缓存中的区块全部归还仓库
+  struct cache_guard
+  {
+    ~cache_guard() { M_release_cache(); }
+  };
 
-char*  alloc::start_free = nullptr;
-char*  alloc::end_free = nullptr;
-size_t alloc::heap_size = 0;
+  static alloc_thread_cache& M_cache() noexcept;
+  static alloc_depot&        M_depot();
 
-FreeList* alloc::free_list[EFreeListsNumber] = {
-  nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,
-  nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,
-  nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,
-  nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,
-  nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,
-  nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,
-  nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr
-  };
+  static void*  M_refill(size_t index, size_t bytes);
+  static void   M_overflow(size_t index, size_t bytes);
+  static void   M_scavenge();
+  static void   M_activate_cache();
+  static void   M_release_cache();
+
+  static size_t M_fetch(size_t index, size_t bytes, size_t nblock, FreeList*& head);
+  static void   M_release(size_t index, FreeList* first, FreeList* last);
+  static char*  M_chunk_alloc(size_t size, size_t& nblock);
+};
 
 // 分配大小为 n 的空间， n > 0
 inline void* alloc::allocate(size_t n)
 {
-  FreeList* my_free_list;
-  FreeList* result;
   if (n > static_cast<size_t>(ESmallObjectBytes))
-    return std::malloc(n);
-  my_free_list = free_list[M_freelist_index(n)];
-  result = my_free_list;
-  if (result == nullptr)
   {
-    void* r = M_refill(M_round_up(n));
-    return r;
+#ifdef MYSTL_USE_LARGE_ALLOC
+    if (large_alloc::is_large(n))
+      return large_alloc::allocate(n);
+#endif // MYSTL_USE_LARGE_ALLOC
+    void* p = std::malloc(n);
+    if (p == nullptr)
+      throw std::bad_alloc();
+    return p;
   }
-  my_free_list = result->next;
+  const size_t index = M_freelist_index(n);
+  alloc_thread_cache& cache = M_cache();
+  FreeList* result = cache.free_list[index];
+  if (result == nullptr)
+    return M_refill(index, M_round_up(n));
+  cache.free_list[index] = result->next;
+  if (--cache.length[index] < cache.low[index])
+    cache.low[index] = cache.length[index];
   return result;
 }
 
@@ -109,22 +179,67 @@ inline void alloc::deallocate(void* p, size_t n)
 {
   if (n > static_cast<size_t>(ESmallObjectBytes))
   {
+#ifdef MYSTL_USE_LARGE_ALLOC
+    if (large_alloc::is_large(n))
+    {
+      large_alloc::deallocate(p, n);
+      return;
+    }
+#endif // MYSTL_USE_LARGE_ALLOC
     std::free(p);
     return;
   }
-  FreeList* q = reinterpret_cast<FreeList*>(p);
-  FreeList* my_free_list;
-  my_free_list = free_list[M_freelist_index(n)];
-  q->next = my_free_list;
-  my_free_list = q;
+  const size_t index = M_freelist_index(n);
+  alloc_thread_cache& cache = M_cache();
+  FreeList* q = static_cast<FreeList*>(p);
+  q->next = cache.free_list[index];
+  cache.free_list[index] = q;
+  if (++cache.length[index] > cache.limit[index])
+    M_overflow(index, M_round_up(n));
+  else if (++cache.ops >= static_cast<size_t>(EScavengeInterval))
+    M_scavenge();
 }
 
-// 重新分配空间，接受三个参数，参数一为指向新空间的指针，参数二为原来空间的大小，参数三为申请空间的大小
+// 重新分配空间，接受三个参数，参数一为指向原空间的指针，参数二为原来空间的大小，参数三为申请空间的大小
 inline void* alloc::reallocate(void* p, size_t old_size, size_t new_size)
 {
+#ifdef MYSTL_USE_LARGE_ALLOC
+  // 两端都是大块时由 mremap 调整映射，不复制数据
+  if (large_alloc::is_large(old_size) && large_alloc::is_large(new_size))
+    return large_alloc::reallocate(p, old_size, new_size);
+#endif // MYSTL_USE_LARGE_ALLOC
+  if (old_size > static_cast<size_t>(ESmallObjectBytes) &&
+      new_size > static_cast<size_t>(ESmallObjectBytes)
+#ifdef MYSTL_USE_LARGE_ALLOC
+      && !large_alloc::is_large(old_size) && !large_alloc::is_large(new_size)
+#endif // MYSTL_USE_LARGE_ALLOC
+      )
+  {
+    void* r = std::realloc(p, new_size);
+    if (r == nullptr)
+      throw std::bad_alloc();
+    return r;
+  }
+  if (old_size <= static_cast<size_t>(ESmallObjectBytes) &&
+      new_size <= static_cast<size_t>(ESmallObjectBytes) &&
+      M_round_up(old_size) == M_round_up(new_size))
+    return p;
+  void* r = allocate(new_size);
+  std::memcpy(r, p, old_size < new_size ? old_size : new_size);
   deallocate(p, old_size);
-  p = allocate(new_size);
-  return p;
+  return r;
+}
+
+inline size_t alloc::cached_blocks(size_t n) noexcept
+{
+  if (n > static_cast<size_t>(ESmallObjectBytes))
+    return 0;
+  return M_cache().length[M_freelist_index(n)];
+}
+
+inline size_t alloc::good_size(size_t n) noexcept
+{
+  return n > static_cast<size_t>(ESmallObjectBytes) ? n : M_round_up(n);
 }
 
 // bytes 对应上调大小
@@ -153,110 +268,229 @@ inline size_t alloc::M_freelist_index(size_t bytes)
   if (bytes <= 512)
   {
     return bytes <= 256
-      ? bytes <= 128 
-        ? ((bytes + EAlign128 - 1) / EAlign128 - 1) 
+      ? bytes <= 128
+        ? ((bytes + EAlign128 - 1) / EAlign128 - 1)
         : (15 + (bytes + EAlign256 - 129) / EAlign256)
       : (23 + (bytes + EAlign512 - 257) / EAlign512);
   }
   return bytes <= 2048
-    ? bytes <= 1024 
+    ? bytes <= 1024
       ? (31 + (bytes + EAlign1024 - 513) / EAlign1024)
       : (39 + (bytes + EAlign2048 - 1025) / EAlign2048)
     : (47 + (bytes + EAlign4096 - 2049) / EAlign4096);
 }
 
-// 重新填充 free list
-void* alloc::M_refill(size_t n)
+// 线程缓存与仓库之间一次搬运的区块数量，bytes 为上调后的区块大小
+inline size_t alloc::M_batch_size(size_t bytes)
+{
+  const size_t n = EBatchBytes / bytes;
+  if (n < static_cast<size_t>(EBatchMinObjects))
+    return EBatchMinObjects;
+  return n > static_cast<size_t>(EBatchMaxObjects) ? static_cast<size_t>(EBatchMaxObjects) : n;
+}
+
+// 本线程的缓存，零初始化，不需要构造
+inline alloc_thread_cache& alloc::M_cache() noexcept
 {
-  size_t nblock = 10;
-  char* c = M_chunk_alloc(n, nblock);
-  FreeList* my_free_list;
-  FreeList* result, *cur, *next;
-  // 如果只有一个区块，就把这个区块返回给调用者，free list 没有增加新节点
-  if (nblock == 1)
-    return c;
-  // 否则把一个区块给调用者，剩下的纳入 free list 作为新节点
-  my_free_list = free_list[M_freelist_index(n)];
-  result = (FreeList*)c;
-  my_free_list = next = (FreeList*)(c + n);
-  for (size_t i = 1; ; ++i)
+  static thread_local alloc_thread_cache cache;
+  return cache;
+}
+
+// 全局仓库，一经构造就不再析构，保证其它静态对象析构时仍可以释放内存
+inline alloc_depot& alloc::M_depot()
+{
+  static alloc_depot* depot = new alloc_depot;
+  return *depot;
+}
+
+// 线程缓存为空时，从仓库取回一批区块，返回其中一个给调用者
+inline void* alloc::M_refill(size_t index, size_t bytes)
+{
+  alloc_thread_cache& cache = M_cache();
+  if (cache.state == ECacheUninit)
+    M_activate_cache();
+  FreeList* head = nullptr;
+  if (cache.state == ECacheDead)
   {
-    cur = next;
-    next = (FreeList*)((char*)next + n);
-    if (nblock - 1 == i)
-    {
-      cur->next = nullptr;
-      break;
-    }
-    else
+    M_fetch(index, bytes, 1, head);
+    return head;
+  }
+  const size_t batch = M_batch_size(bytes);
+  const size_t n = M_fetch(index, bytes, batch, head);
+  cache.free_list[index] = head->next;
+  cache.length[index] = n - 1;
+  cache.limit[index] = 2 * batch;
+  cache.low[index] = 0;
+  return head;
+}
+
+// 线程缓存过长时，把一批区块归还仓库
+inline void alloc::M_overflow(size_t index, size_t bytes)
+{
+  alloc_thread_cache& cache = M_cache();
+  if (cache.state == ECacheUninit)
+    M_activate_cache();
+  if (cache.state == ECacheDead)
+  { // 线程缓存已被回收，limit 始终为 0，区块直接还给仓库
+    FreeList* q = cache.free_list[index];
+    cache.free_list[index] = nullptr;
+    cache.length[index] = 0;
+    q->next = nullptr;
+    M_release(index, q, q);
+    return;
+  }
+  const size_t n = M_batch_size(bytes);
+  if (cache.limit[index] == 0)
+  { // 这个 size class 第一次有区块被释放到本线程
+    cache.limit[index] = 2 * n;
+    if (cache.length[index] <= cache.limit[index])
+      return;
+  }
+  FreeList* first = cache.free_list[index];
+  FreeList* last = first;
+  for (size_t i = 1; i < n; ++i)
+    last = last->next;
+  cache.free_list[index] = last->next;
+  cache.length[index] -= n;
+  if (cache.length[index] < cache.low[index])
+    cache.low[index] = cache.length[index];
+  M_release(index, first, last);
+}
+
+// 定期回收：每个自由链表中，上次回收以来始终没有被取走的区块有 low 个，把其中一半归还仓库
+inline void alloc::M_scavenge()
+{
+  alloc_thread_cache& cache = M_cache();
+  cache.ops = 0;
+  if (cache.state != ECacheActive)
+    return;
+  for (size_t i = 0; i < EFreeListsNumber; ++i)
+  {
+    const size_t n = (cache.low[i] + 1) / 2;
+    if (n > 0)
     {
-      cur->next = next;
+      FreeList* first = cache.free_list[i];
+      FreeList* last = first;
+      for (size_t k = 1; k < n; ++k)
+        last = last->next;
+      cache.free_list[i] = last->next;
+      cache.length[i] -= n;
+      M_release(i, first, last);
     }
+    cache.low[i] = cache.length[i];
   }
-  return result;
 }
 
-// 从内存池中取空间给 free list 使用，条件不允许时，会调整 nblock
-char* alloc::M_chunk_alloc(size_t size, size_t& nblock)
+// 本线程第一次取得或释放区块时，注册线程退出时的回收
+inline void alloc::M_activate_cache()
 {
-  char* result;
-  size_t need_bytes = size * nblock;
-  size_t pool_bytes = end_free - start_free;
+  static thread_local cache_guard guard;
+  (void)guard;
+  M_cache().state = ECacheActive;
+}
 
-  // 如果内存池剩余大小完全满足需求量，返回它
-  if (pool_bytes >= need_bytes)
+// 把线程缓存中的所有区块归还仓库，之后本线程的请求都直接访问仓库
+inline void alloc::M_release_cache()
+{
+  alloc_thread_cache& cache = M_cache();
+  cache.state = ECacheDead;
+  for (size_t i = 0; i < EFreeListsNumber; ++i)
   {
-    result = start_free;
-    start_free += need_bytes;
-    return result;
+    cache.limit[i] = 0;
+    cache.low[i] = 0;
+    FreeList* first = cache.free_list[i];
+    if (first == nullptr)
+      continue;
+    FreeList* last = first;
+    while (last->next != nullptr)
+      last = last->next;
+    M_release(i, first, last);
+    cache.free_list[i] = nullptr;
+    cache.length[i] = 0;
   }
+}
 
-  // 如果内存池剩余大小不能完全满足需求量，但至少可以分配一个或一个以上的区块，就返回它
-  else if (pool_bytes >= size)
+// 从仓库取出至多 nblock 个区块，仓库为空时从内存池切分，返回实际取得的数量
+inline size_t alloc::M_fetch(size_t index, size_t bytes, size_t nblock, FreeList*& head)
+{
+  alloc_depot& depot = M_depot();
   {
-    nblock = pool_bytes / size;
-    need_bytes = size * nblock;
-    result = start_free;
-    start_free += need_bytes;
-    return result;
+    std::lock_guard<std::mutex> lk(depot.lock[index]);
+    FreeList* first = depot.free_list[index];
+    if (first != nullptr)
+    {
+      FreeList* last = first;
+      size_t n = 1;
+      for (; n < nblock && last->next != nullptr; ++n)
+        last = last->next;
+      depot.free_list[index] = last->next;
+      last->next = nullptr;
+      head = first;
+      return n;
+    }
   }
+  char* c = M_chunk_alloc(bytes, nblock);
+  FreeList* cur = reinterpret_cast<FreeList*>(c);
+  head = cur;
+  for (size_t i = 1; i < nblock; ++i)
+  {
+    FreeList* next = reinterpret_cast<FreeList*>(c + i * bytes);
+    cur->next = next;
+    cur = next;
+  }
+  cur->next = nullptr;
+  return nblock;
+}
 
-  // 如果内存池剩余大小连一个区块都无法满足
-  else
+// 把 [first, last] 这一段链表归还仓库
+inline void alloc::M_release(size_t index, FreeList* first, FreeList* last)
+{
+  alloc_depot& depot = M_depot();
+  std::lock_guard<std::mutex> lk(depot.lock[index]);
+  last->next = depot.free_list[index];
+  depot.free_list[index] = first;
+}
+
+// 从内存池中取空间给 free list 使用，条件不允许时，会调整 nblock
+inline char* alloc::M_chunk_alloc(size_t size, size_t& nblock)
+{
+  alloc_depot& depot = M_depot();
+  std::lock_guard<std::mutex> lk(depot.chunk_lock);
+  size_t need_bytes = size * nblock;
+  size_t pool_bytes = depot.end_free - depot.start_free;
+
+  // 如果内存池剩余大小不能满足一个区块，把剩余空间放入仓库，再申请 heap 空间
+  if (pool_bytes < size)
   {
     if (pool_bytes > 0)
-    { // 如果内存池还有剩余，把剩余的空间加入到 free list 中
-      FreeList* my_free_list = free_list[M_freelist_index(pool_bytes)];
-      ((FreeList*)start_free)->next = my_free_list;
-      my_free_list = (FreeList*)start_free;
+    { // 剩余空间可能不是某个 size class 的大小，放入不大于它的那个 size class
+      size_t index = M_freelist_index(pool_bytes);
+      if (M_round_up(pool_bytes) != pool_bytes)
+        --index;
+      FreeList* rest = reinterpret_cast<FreeList*>(depot.start_free);
+      M_release(index, rest, rest);
     }
-    // 申请 heap 空间
-    size_t bytes_to_get = (need_bytes << 1) + M_round_up(heap_size >> 4);
-    start_free = (char*)std::malloc(bytes_to_get);
-    if (!start_free)
-    { // heap 空间也不够
-      FreeList* my_free_list, *p;
-      // 试着查找有无未用区块，且区块足够大的 free list
-      for (size_t i = size; i <= ESmallObjectBytes; i += M_align(i))
-      {
-        my_free_list = free_list[M_freelist_index(i)];
-        p = my_free_list;
-        if (p)
-        {
-          my_free_list = p->next;
-          start_free = (char*)p;
-          end_free = start_free + i;
-          return M_chunk_alloc(size, nblock);
-        }
-      }
-      std::printf("out of memory");
-      end_free = nullptr;
+    size_t bytes_to_get = (need_bytes << 1) + M_round_up(depot.heap_size >> 4);
+    depot.start_free = static_cast<char*>(std::malloc(bytes_to_get));
+    if (!depot.start_free)
+    {
+      depot.end_free = nullptr;
       throw std::bad_alloc();
     }
-    end_free = start_free + bytes_to_get;
-    heap_size += bytes_to_get;
-    return M_chunk_alloc(size, nblock);
+    depot.end_free = depot.start_free + bytes_to_get;
+    depot.heap_size += bytes_to_get;
+    pool_bytes = bytes_to_get;
   }
+
+  // 如果内存池剩余大小不能完全满足需求量，但至少可以分配一个区块，就调整 nblock
+  if (pool_bytes < need_bytes)
+  {
+    nblock = pool_bytes / size;
+    need_bytes = size * nblock;
+  }
+  char* result = depot.start_free;
+  depot.start_free += need_bytes;
+  return result;
 }
 
 } // namespace mystl
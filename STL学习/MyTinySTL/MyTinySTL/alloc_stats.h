@@ -0,0 +1,224 @@
+#ifndef MYTINYSTL_ALLOC_STATS_H_
+#define MYTINYSTL_ALLOC_STATS_H_
+
+// 这个头文件包含一个类 alloc_stats，按元素类型统计 mystl::allocator 的分配情况
+//
+// 每个类型记录分配、释放的次数，当前占用、累计与峰值字节数，以及按 2 的幂划分的请求大小分布。
+// 容器通过 rebind 为节点分配空间，因此 list、map 等容器的节点类型会单独成为一项，
+// 可以据此找出占用堆空间最多的容器。
+//
+// 在包含 allocator.h 之前定义 MYSTL_ALLOC_STATS 后，mystl::allocator 才会记录统计，
+// 未定义时没有任何开销；Linux 下程序退出时把统计结果与未释放的空间输出到 stderr。
+// 注意：退出时仍未析构的全局对象持有的空间也会被当作未释放的空间
+
+#include <atomic>
+#include <typeinfo>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
+
+namespace mystl
+{
+
+// 请求大小分布的级数，第 k 级为 [2^k, 2^(k+1)) bytes，最后一级包含更大的请求
+enum { EStatsBuckets = 32 };
+
+// 一种元素类型的统计记录
+struct alloc_stats_entry
+{
+  const char*              name;
+  std::atomic<size_t>      allocs;
+  std::atomic<size_t>      deallocs;
+  std::atomic<size_t>      live_bytes;
+  std::atomic<size_t>      peak_bytes;
+  std::atomic<size_t>      total_bytes;
+  std::atomic<size_t>      hist[EStatsBuckets];
+  alloc_stats_entry*       next;
+
+  explicit alloc_stats_entry(const char* type_name);
+};
+
+// 统计类，所有函数都是静态的
+class alloc_stats
+{
+public:
+  // 类型 T 的统计记录，第一次使用时加入全局链表
+  template <class T>
+  static alloc_stats_entry& entry();
+
+  static void record_allocate(alloc_stats_entry& e, size_t bytes) noexcept;
+  static void record_deallocate(alloc_stats_entry& e, size_t bytes) noexcept;
+
+  // 全局链表的表头，按第一次使用的逆序排列
+  static alloc_stats_entry* head() noexcept { return M_head().load(std::memory_order_acquire); }
+
+  // 所有类型当前未释放的字节数
+  static size_t live_bytes() noexcept;
+
+  // 把统计结果输出到 out
+  static void dump(std::FILE* out);
+
+  // 清空所有计数，只应在没有其它线程分配时调用
+  static void reset() noexcept;
+
+  static size_t bucket(size_t bytes) noexcept;
+
+private:
+  static std::atomic<alloc_stats_entry*>& M_head() noexcept;
+  static void M_register(alloc_stats_entry* e) noexcept;
+  static const char* M_demangle(const char* name) noexcept;
+  static void M_dump_at_exit();
+};
+
+inline alloc_stats_entry::alloc_stats_entry(const char* type_name)
+  : name(type_name), allocs(0), deallocs(0), live_bytes(0),
+    peak_bytes(0), total_bytes(0), next(nullptr)
+{
+  for (size_t i = 0; i < static_cast<size_t>(EStatsBuckets); ++i)
+    hist[i].store(0, std::memory_order_relaxed);
+}
+
+inline std::atomic<alloc_stats_entry*>& alloc_stats::M_head() noexcept
+{
+  static std::atomic<alloc_stats_entry*> head(nullptr);
+  return head;
+}
+
+template <class T>
+alloc_stats_entry& alloc_stats::entry()
+{
+  // 局部静态变量的初始化是线程安全的，每个类型只注册一次
+  struct holder
+  {
+    alloc_stats_entry e;
+    holder() : e(M_demangle(typeid(T).name())) { M_register(&e); }
+  };
+  static holder h;
+  return h.e;
+}
+
+// 加入全局链表，第一次注册时安排退出时输出
+inline void alloc_stats::M_register(alloc_stats_entry* e) noexcept
+{
+#if defined(__linux__) && defined(MYSTL_ALLOC_STATS)
+  static const int registered = std::atexit(&alloc_stats::M_dump_at_exit);
+  (void)registered;
+#endif
+  alloc_stats_entry* old = M_head().load(std::memory_order_relaxed);
+  do
+  {
+    e->next = old;
+  } while (!M_head().compare_exchange_weak(old, e, std::memory_order_release,
+                                           std::memory_order_relaxed));
+}
+
+// 把编译器生成的类型名还原成源代码中的写法，失败时返回原名
+inline const char* alloc_stats::M_demangle(const char* name) noexcept
+{
+#if defined(__GNUC__)
+  int status = 0;
+  char* s = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  if (status == 0 && s != nullptr)
+    return s;  // 记录与程序同寿命，不释放
+#endif
+  return name;
+}
+
+inline size_t alloc_stats::bucket(size_t bytes) noexcept
+{
+  size_t k = 0;
+  while (bytes > 1 && k + 1 < static_cast<size_t>(EStatsBuckets))
+  {
+    bytes >>= 1;
+    ++k;
+  }
+  return k;
+}
+
+inline void alloc_stats::record_allocate(alloc_stats_entry& e, size_t bytes) noexcept
+{
+  e.allocs.fetch_add(1, std::memory_order_relaxed);
+  e.total_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  e.hist[bucket(bytes)].fetch_add(1, std::memory_order_relaxed);
+  const size_t live = e.live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  size_t peak = e.peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak &&
+         !e.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+  {
+  }
+}
+
+inline void alloc_stats::record_deallocate(alloc_stats_entry& e, size_t bytes) noexcept
+{
+  e.deallocs.fetch_add(1, std::memory_order_relaxed);
+  e.live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+inline size_t alloc_stats::live_bytes() noexcept
+{
+  size_t n = 0;
+  for (alloc_stats_entry* e = head(); e != nullptr; e = e->next)
+    n += e->live_bytes.load(std::memory_order_relaxed);
+  return n;
+}
+
+inline void alloc_stats::dump(std::FILE* out)
+{
+  std::fprintf(out, "[------------------ mystl::allocator statistics -----------------]\n");
+  size_t leaked = 0;
+  for (alloc_stats_entry* e = head(); e != nullptr; e = e->next)
+  {
+    const size_t allocs = e->allocs.load(std::memory_order_relaxed);
+    const size_t deallocs = e->deallocs.load(std::memory_order_relaxed);
+    const size_t live = e->live_bytes.load(std::memory_order_relaxed);
+    std::fprintf(out, "%s\n", e->name);
+    std::fprintf(out, "  allocs %zu  deallocs %zu  total %zu B  peak %zu B  live %zu B\n",
+                 allocs, deallocs, e->total_bytes.load(std::memory_order_relaxed),
+                 e->peak_bytes.load(std::memory_order_relaxed), live);
+    for (size_t k = 0; k < static_cast<size_t>(EStatsBuckets); ++k)
+    {
+      const size_t c = e->hist[k].load(std::memory_order_relaxed);
+      if (c == 0)
+        continue;
+      if (k + 1 < static_cast<size_t>(EStatsBuckets))
+        std::fprintf(out, "    [%zu, %zu) B : %zu\n",
+                     static_cast<size_t>(1) << k, static_cast<size_t>(1) << (k + 1), c);
+      else
+        std::fprintf(out, "    [%zu, ...) B : %zu\n", static_cast<size_t>(1) << k, c);
+    }
+    if (live != 0 || allocs != deallocs)
+    {
+      std::fprintf(out, "  LEAK: %zu blocks, %zu B not deallocated\n", allocs - deallocs, live);
+      leaked += live;
+    }
+  }
+  std::fprintf(out, "[------------------ leaked bytes in total: %zu ------------------]\n", leaked);
+}
+
+inline void alloc_stats::reset() noexcept
+{
+  for (alloc_stats_entry* e = head(); e != nullptr; e = e->next)
+  {
+    e->allocs.store(0, std::memory_order_relaxed);
+    e->deallocs.store(0, std::memory_order_relaxed);
+    e->live_bytes.store(0, std::memory_order_relaxed);
+    e->peak_bytes.store(0, std::memory_order_relaxed);
+    e->total_bytes.store(0, std::memory_order_relaxed);
+    for (size_t k = 0; k < static_cast<size_t>(EStatsBuckets); ++k)
+      e->hist[k].store(0, std::memory_order_relaxed);
+  }
+}
+
+inline void alloc_stats::M_dump_at_exit()
+{
+  dump(stderr);
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_ALLOC_STATS_H_
+
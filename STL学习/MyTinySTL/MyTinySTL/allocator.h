@@ -2,9 +2,33 @@
 #define MYTINYSTL_ALLOCATOR_H_
 
 // 这个头文件包含一个模板类 allocator，用于管理内存的分配、释放，对象的构造、析构
+//
+// 默认使用 ::operator new / ::operator delete，定义 MYSTL_USE_POOL_ALLOC 后改用 alloc.h 中的内存池，
+// 定义 MYSTL_USE_LARGE_ALLOC 后，大块内存改用 large_alloc.h 中的 mmap + 大页路径，
+// 定义 MYSTL_ALLOC_STATS 后，按元素类型记录分配统计，见 alloc_stats.h
+//
+// 另外包含 allocator_traits，容器通过它使用分配器，因此分配器可以带有状态
+//
+// reallocate / try_expand 供元素可以逐字节复制的容器扩容时使用：大块内存由 mremap 调整映射，
+// 内存池中的中等区块交给 realloc，其它情况退回分配、复制、释放
+
+#include <cstring>
 
 #include "construct.h"
 #include "util.h"
+#include "exceptdef.h"
+
+#ifdef MYSTL_USE_POOL_ALLOC
+#include "alloc.h"
+#endif // MYSTL_USE_POOL_ALLOC
+
+#ifdef MYSTL_USE_LARGE_ALLOC
+#include "large_alloc.h"
+#endif // MYSTL_USE_LARGE_ALLOC
+
+#ifdef MYSTL_ALLOC_STATS
+#include "alloc_stats.h"
+#endif // MYSTL_ALLOC_STATS
 
 namespace mystl
 {
@@ -23,13 +47,32 @@ public:
   typedef size_t       size_type;
   typedef ptrdiff_t    difference_type;
 
+  template <class U>
+  struct rebind
+  {
+    typedef allocator<U> other;
+  };
+
 public:
+  allocator() noexcept {}
+  allocator(const allocator&) noexcept {}
+  template <class U>
+  allocator(const allocator<U>&) noexcept {}
+
   static T*   allocate();
   static T*   allocate(size_type n);
 
   static void deallocate(T* ptr);
   static void deallocate(T* ptr, size_type n);
 
+  // 按字节搬移原有内容，只能用于可以逐字节复制的类型
+  static T*   reallocate(T* ptr, size_type old_n, size_type new_n);
+  // 只尝试原地扩展，对任何类型都安全
+  static bool try_expand(T* ptr, size_type old_n, size_type new_n) noexcept;
+
+  // 申请 n 个元素时实际得到的区块能容纳的元素个数，不小于 n
+  static size_type good_size(size_type n) noexcept;
+
   static void construct(T* ptr);
   static void construct(T* ptr, const T& value);
   static void construct(T* ptr, T&& value);
@@ -39,12 +82,70 @@ public:
 
   static void destroy(T* ptr);
   static void destroy(T* first, T* last);
+
+private:
+  static void* raw_allocate(size_type bytes);
+  static void* raw_allocate_aux(size_type bytes);
+  static void  raw_deallocate(void* ptr, size_type bytes);
+  static void  record_reallocate(size_type old_bytes, size_type new_bytes) noexcept;
 };
 
+template <class T>
+void* allocator<T>::raw_allocate(size_type bytes)
+{
+  void* p = raw_allocate_aux(bytes);
+#ifdef MYSTL_ALLOC_STATS
+  // 先分配再记录，分配失败抛出异常时不计数
+  mystl::alloc_stats::record_allocate(mystl::alloc_stats::entry<T>(), bytes);
+#endif // MYSTL_ALLOC_STATS
+  return p;
+}
+
+// 内存池只保证 8 bytes 对齐，对齐要求更高的类型仍交给 ::operator new
+// large_alloc 按页对齐，可以满足任何类型
+template <class T>
+void* allocator<T>::raw_allocate_aux(size_type bytes)
+{
+#ifdef MYSTL_USE_LARGE_ALLOC
+  if (mystl::large_alloc::is_large(bytes))
+    return mystl::large_alloc::allocate(bytes);
+#endif // MYSTL_USE_LARGE_ALLOC
+#ifdef MYSTL_USE_POOL_ALLOC
+  if (alignof(T) <= static_cast<size_type>(EAlign128))
+    return mystl::alloc::allocate(bytes);
+#endif // MYSTL_USE_POOL_ALLOC
+  return ::operator new(bytes);
+}
+
+template <class T>
+void allocator<T>::raw_deallocate(void* ptr, size_type bytes)
+{
+#ifdef MYSTL_ALLOC_STATS
+  mystl::alloc_stats::record_deallocate(mystl::alloc_stats::entry<T>(), bytes);
+#endif // MYSTL_ALLOC_STATS
+#ifdef MYSTL_USE_LARGE_ALLOC
+  if (mystl::large_alloc::is_large(bytes))
+  {
+    mystl::large_alloc::deallocate(ptr, bytes);
+    return;
+  }
+#endif // MYSTL_USE_LARGE_ALLOC
+#ifdef MYSTL_USE_POOL_ALLOC
+  if (alignof(T) <= static_cast<size_type>(EAlign128))
+  {
+    mystl::alloc::deallocate(ptr, bytes);
+    return;
+  }
+#else
+  (void)bytes;
+#endif // MYSTL_USE_POOL_ALLOC
+  ::operator delete(ptr);
+}
+
 template <class T>
 T* allocator<T>::allocate()
 {
-  return static_cast<T*>(::operator new(sizeof(T)));
+  return static_cast<T*>(raw_allocate(sizeof(T)));
 }
 
 template <class T>
@@ -52,7 +153,7 @@ T* allocator<T>::allocate(size_type n)
 {
   if (n == 0)
     return nullptr;
-  return static_cast<T*>(::operator new(n * sizeof(T)));
+  return static_cast<T*>(raw_allocate(n * sizeof(T)));
 }
 
 template <class T>
@@ -60,15 +161,102 @@ void allocator<T>::deallocate(T* ptr)
 {
   if (ptr == nullptr)
     return;
-  ::operator delete(ptr);
+  raw_deallocate(ptr, sizeof(T));
 }
 
 template <class T>
-void allocator<T>::deallocate(T* ptr, size_type /*size*/)
+void allocator<T>::deallocate(T* ptr, size_type n)
 {
   if (ptr == nullptr)
     return;
-  ::operator delete(ptr);
+  raw_deallocate(ptr, n * sizeof(T));
+}
+
+template <class T>
+T* allocator<T>::reallocate(T* ptr, size_type old_n, size_type new_n)
+{
+  if (ptr == nullptr)
+    return allocate(new_n);
+  if (new_n == 0)
+  {
+    deallocate(ptr, old_n);
+    return nullptr;
+  }
+  const size_type old_bytes = old_n * sizeof(T);
+  const size_type new_bytes = new_n * sizeof(T);
+#ifdef MYSTL_USE_LARGE_ALLOC
+  if (mystl::large_alloc::is_large(old_bytes) && mystl::large_alloc::is_large(new_bytes))
+  {
+    T* r = static_cast<T*>(mystl::large_alloc::reallocate(ptr, old_bytes, new_bytes));
+    record_reallocate(old_bytes, new_bytes);
+    return r;
+  }
+#endif // MYSTL_USE_LARGE_ALLOC
+#ifdef MYSTL_USE_POOL_ALLOC
+  if (alignof(T) <= static_cast<size_type>(EAlign128))
+  {
+    T* r = static_cast<T*>(mystl::alloc::reallocate(ptr, old_bytes, new_bytes));
+    record_reallocate(old_bytes, new_bytes);
+    return r;
+  }
+#endif // MYSTL_USE_POOL_ALLOC
+  T* r = allocate(new_n);
+  std::memcpy(static_cast<void*>(r), static_cast<const void*>(ptr),
+              old_bytes < new_bytes ? old_bytes : new_bytes);
+  deallocate(ptr, old_n);
+  return r;
+}
+
+template <class T>
+bool allocator<T>::try_expand(T* ptr, size_type old_n, size_type new_n) noexcept
+{
+#ifdef MYSTL_USE_LARGE_ALLOC
+  const size_type old_bytes = old_n * sizeof(T);
+  const size_type new_bytes = new_n * sizeof(T);
+  if (ptr != nullptr && new_n >= old_n && mystl::large_alloc::is_large(old_bytes) &&
+      mystl::large_alloc::try_expand(ptr, old_bytes, new_bytes))
+  {
+    record_reallocate(old_bytes, new_bytes);
+    return true;
+  }
+#else
+  (void)ptr;
+  (void)old_n;
+  (void)new_n;
+#endif // MYSTL_USE_LARGE_ALLOC
+  return false;
+}
+
+// 按区块实际的大小上调：内存池按 size class，大块按页，::operator new 至少按 16 bytes 对齐
+template <class T>
+typename allocator<T>::size_type allocator<T>::good_size(size_type n) noexcept
+{
+  const size_type bytes = n * sizeof(T);
+  if (bytes > static_cast<size_type>(-1) / 2)
+    return n;
+  size_type block = (bytes + 15) & ~static_cast<size_type>(15);
+#ifdef MYSTL_USE_LARGE_ALLOC
+  if (mystl::large_alloc::is_large(bytes))
+    return mystl::large_alloc::map_size(bytes) / sizeof(T);
+#endif // MYSTL_USE_LARGE_ALLOC
+#ifdef MYSTL_USE_POOL_ALLOC
+  if (alignof(T) <= static_cast<size_type>(EAlign128))
+    block = mystl::alloc::good_size(bytes);
+#endif // MYSTL_USE_POOL_ALLOC
+  return block / sizeof(T);
+}
+
+template <class T>
+void allocator<T>::record_reallocate(size_type old_bytes, size_type new_bytes) noexcept
+{
+#ifdef MYSTL_ALLOC_STATS
+  auto& e = mystl::alloc_stats::entry<T>();
+  mystl::alloc_stats::record_deallocate(e, old_bytes);
+  mystl::alloc_stats::record_allocate(e, new_bytes);
+#else
+  (void)old_bytes;
+  (void)new_bytes;
+#endif // MYSTL_ALLOC_STATS
 }
 
 template <class T>
@@ -108,6 +296,356 @@ void allocator<T>::destroy(T* first, T* last)
   mystl::destroy(first, last);
 }
 
+// mystl::allocator 没有状态，任意两个实例都相等
+template <class T, class U>
+bool operator==(const allocator<T>&, const allocator<U>&) noexcept
+{
+  return true;
+}
+
+template <class T, class U>
+bool operator!=(const allocator<T>&, const allocator<U>&) noexcept
+{
+  return false;
+}
+
+template <class T>
+struct is_trivially_relocatable<allocator<T>> : std::true_type {};
+
+/*****************************************************************************************/
+// allocator_traits
+// 萃取分配器的型别与行为，分配器没有提供的部分使用默认实现
+
+template <class...>
+struct alloc_void
+{
+  typedef void type;
+};
+
+// 萃取 propagate_on_container_xxx 等标记，未定义时取默认值
+#define MYSTL_ALLOC_FLAG_TRAITS(NAME, DEFAULT)                                  \
+template <class Alloc, class = void>                                            \
+struct alloc_##NAME                                                             \
+{                                                                               \
+  typedef DEFAULT type;                                                         \
+};                                                                              \
+template <class Alloc>                                                          \
+struct alloc_##NAME<Alloc, typename alloc_void<typename Alloc::NAME>::type>     \
+{                                                                               \
+  typedef std::integral_constant<bool, Alloc::NAME::value> type;                \
+};
+
+MYSTL_ALLOC_FLAG_TRAITS(propagate_on_container_copy_assignment, std::false_type)
+MYSTL_ALLOC_FLAG_TRAITS(propagate_on_container_move_assignment, std::false_type)
+MYSTL_ALLOC_FLAG_TRAITS(propagate_on_container_swap, std::false_type)
+MYSTL_ALLOC_FLAG_TRAITS(is_always_equal, typename std::is_empty<Alloc>::type)
+
+#undef MYSTL_ALLOC_FLAG_TRAITS
+
+// rebind：优先使用 Alloc::rebind<U>::other，否则替换 Alloc 的第一个模板参数
+template <class Alloc, class U>
+struct alloc_rebind_first;
+
+template <template <class, class...> class Alloc, class T, class... Args, class U>
+struct alloc_rebind_first<Alloc<T, Args...>, U>
+{
+  typedef Alloc<U, Args...> type;
+};
+
+template <class Alloc, class U, class = void>
+struct alloc_rebind
+{
+  typedef typename alloc_rebind_first<Alloc, U>::type type;
+};
+
+template <class Alloc, class U>
+struct alloc_rebind<Alloc, U, 
+  typename alloc_void<typename Alloc::template rebind<U>::other>::type>
+{
+  typedef typename Alloc::template rebind<U>::other type;
+};
+
+// 检查分配器是否提供 construct / destroy / select_on_container_copy_construction
+template <class Alloc, class U, class... Args>
+struct alloc_has_construct
+{
+  template <class A, class = decltype(std::declval<A&>().construct(
+    std::declval<U*>(), std::declval<Args>()...))>
+  static std::true_type test(int);
+  template <class A>
+  static std::false_type test(...);
+
+  typedef decltype(test<Alloc>(0)) type;
+};
+
+template <class Alloc, class U>
+struct alloc_has_destroy
+{
+  template <class A, class = decltype(std::declval<A&>().destroy(std::declval<U*>()))>
+  static std::true_type test(int);
+  template <class A>
+  static std::false_type test(...);
+
+  typedef decltype(test<Alloc>(0)) type;
+};
+
+template <class Alloc>
+struct alloc_has_reallocate
+{
+  template <class A, class = decltype(std::declval<A&>().reallocate(
+    std::declval<typename A::value_type*>(), size_t(), size_t()))>
+  static std::true_type test(int);
+  template <class A>
+  static std::false_type test(...);
+
+  typedef decltype(test<Alloc>(0)) type;
+};
+
+template <class Alloc>
+struct alloc_has_try_expand
+{
+  template <class A, class = decltype(std::declval<A&>().try_expand(
+    std::declval<typename A::value_type*>(), size_t(), size_t()))>
+  static std::true_type test(int);
+  template <class A>
+  static std::false_type test(...);
+
+  typedef decltype(test<Alloc>(0)) type;
+};
+
+template <class Alloc>
+struct alloc_has_good_size
+{
+  template <class A, class = decltype(std::declval<const A&>().good_size(size_t()))>
+  static std::true_type test(int);
+  template <class A>
+  static std::false_type test(...);
+
+  typedef decltype(test<Alloc>(0)) type;
+};
+
+template <class Alloc>
+struct alloc_has_select
+{
+  template <class A, class = decltype(
+    std::declval<const A&>().select_on_container_copy_construction())>
+  static std::true_type test(int);
+  template <class A>
+  static std::false_type test(...);
+
+  typedef decltype(test<Alloc>(0)) type;
+};
+
+template <class Alloc>
+struct allocator_traits
+{
+  typedef Alloc                                   allocator_type;
+  typedef typename Alloc::value_type              value_type;
+  typedef value_type*                             pointer;
+  typedef const value_type*                       const_pointer;
+  typedef size_t                                  size_type;
+  typedef ptrdiff_t                               difference_type;
+
+  typedef typename alloc_propagate_on_container_copy_assignment<Alloc>::type
+    propagate_on_container_copy_assignment;
+  typedef typename alloc_propagate_on_container_move_assignment<Alloc>::type
+    propagate_on_container_move_assignment;
+  typedef typename alloc_propagate_on_container_swap<Alloc>::type
+    propagate_on_container_swap;
+  typedef typename alloc_is_always_equal<Alloc>::type
+    is_always_equal;
+
+  template <class U>
+  using rebind_alloc = typename alloc_rebind<Alloc, U>::type;
+
+  template <class U>
+  using rebind_traits = allocator_traits<rebind_alloc<U>>;
+
+  static pointer allocate(allocator_type& a, size_type n)
+  {
+    return a.allocate(n);
+  }
+
+  static void deallocate(allocator_type& a, pointer p, size_type n)
+  {
+    a.deallocate(p, n);
+  }
+
+  // 把 old_n 个元素的空间调整为 new_n 个，原有内容按字节搬移，只能用于可以逐字节复制的类型
+  static pointer reallocate(allocator_type& a, pointer p, size_type old_n, size_type new_n)
+  {
+    return reallocate_aux(typename alloc_has_reallocate<Alloc>::type(), a, p, old_n, new_n);
+  }
+
+  // 尝试原地把空间扩展为 new_n 个元素，分配器不支持时返回 false
+  static bool try_expand(allocator_type& a, pointer p, size_type old_n, size_type new_n)
+  {
+    return try_expand_aux(typename alloc_has_try_expand<Alloc>::type(), a, p, old_n, new_n);
+  }
+
+  // 申请 n 个元素时实际能用的元素个数，分配器不支持时返回 n
+  static size_type good_size(const allocator_type& a, size_type n)
+  {
+    return good_size_aux(typename alloc_has_good_size<Alloc>::type(), a, n);
+  }
+
+  template <class U, class... Args>
+  static void construct(allocator_type& a, U* p, Args&& ...args)
+  {
+    construct_aux(typename alloc_has_construct<Alloc, U, Args...>::type(),
+                  a, p, mystl::forward<Args>(args)...);
+  }
+
+  template <class U>
+  static void destroy(allocator_type& a, U* p)
+  {
+    destroy_aux(typename alloc_has_destroy<Alloc, U>::type(), a, p);
+  }
+
+  template <class Iter>
+  static void destroy(allocator_type& a, Iter first, Iter last)
+  {
+    destroy_range(typename alloc_has_destroy<Alloc, 
+                  typename iterator_traits<Iter>::value_type>::type(), a, first, last);
+  }
+
+  static allocator_type select_on_container_copy_construction(const allocator_type& a)
+  {
+    return select_aux(typename alloc_has_select<Alloc>::type(), a);
+  }
+
+private:
+  static pointer reallocate_aux(std::true_type, allocator_type& a, pointer p,
+                                size_type old_n, size_type new_n)
+  { return a.reallocate(p, old_n, new_n); }
+  static pointer reallocate_aux(std::false_type, allocator_type& a, pointer p,
+                                size_type old_n, size_type new_n)
+  {
+    pointer r = a.allocate(new_n);
+    if (p != nullptr)
+    {
+      std::memcpy(static_cast<void*>(r), static_cast<const void*>(p),
+                  (old_n < new_n ? old_n : new_n) * sizeof(value_type));
+      a.deallocate(p, old_n);
+    }
+    return r;
+  }
+
+  static bool try_expand_aux(std::true_type, allocator_type& a, pointer p,
+                             size_type old_n, size_type new_n)
+  { return a.try_expand(p, old_n, new_n); }
+  static bool try_expand_aux(std::false_type, allocator_type&, pointer,
+                             size_type, size_type)
+  { return false; }
+
+  static size_type good_size_aux(std::true_type, const allocator_type& a, size_type n)
+  { return a.good_size(n); }
+  static size_type good_size_aux(std::false_type, const allocator_type&, size_type n)
+  { return n; }
+
+  template <class U, class... Args>
+  static void construct_aux(std::true_type, allocator_type& a, U* p, Args&& ...args)
+  { a.construct(p, mystl::forward<Args>(args)...); }
+  template <class U, class... Args>
+  static void construct_aux(std::false_type, allocator_type&, U* p, Args&& ...args)
+  { mystl::construct(p, mystl::forward<Args>(args)...); }
+
+  template <class U>
+  static void destroy_aux(std::true_type, allocator_type& a, U* p)
+  { a.destroy(p); }
+  template <class U>
+  static void destroy_aux(std::false_type, allocator_type&, U* p)
+  { mystl::destroy(p); }
+
+  template <class Iter>
+  static void destroy_range(std::true_type, allocator_type& a, Iter first, Iter last)
+  {
+    for (; first != last; ++first)
+      a.destroy(&*first);
+  }
+  template <class Iter>
+  static void destroy_range(std::false_type, allocator_type&, Iter first, Iter last)
+  { mystl::destroy(first, last); }
+
+  static allocator_type select_aux(std::true_type, const allocator_type& a)
+  { return a.select_on_container_copy_construction(); }
+  static allocator_type select_aux(std::false_type, const allocator_type& a)
+  { return a; }
+};
+
+/*****************************************************************************************/
+// 容器复制、移动赋值及交换时，依照 propagate_on_container_xxx 决定是否传递分配器
+
+template <class Alloc>
+void alloc_copy_assign(Alloc& lhs, const Alloc& rhs, std::true_type)
+{
+  lhs = rhs;
+}
+
+template <class Alloc>
+void alloc_copy_assign(Alloc&, const Alloc&, std::false_type) {}
+
+template <class Alloc>
+void alloc_on_copy_assign(Alloc& lhs, const Alloc& rhs)
+{
+  mystl::alloc_copy_assign(lhs, rhs, typename 
+    allocator_traits<Alloc>::propagate_on_container_copy_assignment());
+}
+
+template <class Alloc>
+void alloc_move_assign(Alloc& lhs, Alloc& rhs, std::true_type)
+{
+  lhs = mystl::move(rhs);
+}
+
+template <class Alloc>
+void alloc_move_assign(Alloc&, Alloc&, std::false_type) {}
+
+template <class Alloc>
+void alloc_on_move_assign(Alloc& lhs, Alloc& rhs)
+{
+  mystl::alloc_move_assign(lhs, rhs, typename 
+    allocator_traits<Alloc>::propagate_on_container_move_assignment());
+}
+
+template <class Alloc>
+void alloc_swap(Alloc& lhs, Alloc& rhs, std::true_type)
+{
+  mystl::swap(lhs, rhs);
+}
+
+template <class Alloc>
+void alloc_swap(Alloc& lhs, Alloc& rhs, std::false_type)
+{
+  // 不传递分配器时，交换两个不相等分配器的容器是未定义行为
+  MYSTL_DEBUG(lhs == rhs);
+  (void)lhs;
+  (void)rhs;
+}
+
+template <class Alloc>
+void alloc_on_swap(Alloc& lhs, Alloc& rhs)
+{
+  mystl::alloc_swap(lhs, rhs, typename 
+    allocator_traits<Alloc>::propagate_on_container_swap());
+}
+
+// 复制赋值时若需要传递分配器，且两个分配器不相等，原有的空间必须先用旧分配器释放
+template <class Alloc>
+bool alloc_copy_needs_reset(const Alloc& lhs, const Alloc& rhs)
+{
+  return allocator_traits<Alloc>::propagate_on_container_copy_assignment::value &&
+    !allocator_traits<Alloc>::is_always_equal::value && !(lhs == rhs);
+}
+
+// 移动赋值时能否直接接管对方的空间
+template <class Alloc>
+bool alloc_move_can_steal(const Alloc& lhs, const Alloc& rhs)
+{
+  return allocator_traits<Alloc>::propagate_on_container_move_assignment::value ||
+    allocator_traits<Alloc>::is_always_equal::value || lhs == rhs;
+}
+
 } // namespace mystl
 #endif // !MYTINYSTL_ALLOCATOR_H_
 
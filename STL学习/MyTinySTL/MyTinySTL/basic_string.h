@@ -268,30 +268,32 @@ struct char_traits<char32_t>
 
 // 模板类 basic_string
 // 参数一代表字符类型，参数二代表萃取字符类型的方式，缺省使用 mystl::char_traits
-template <class CharType, class CharTraits = mystl::char_traits<CharType>>
+// 参数三代表分配器类型，缺省使用 mystl::allocator
+template <class CharType, class CharTraits = mystl::char_traits<CharType>,
+          class Alloc = mystl::allocator<CharType>>
 class basic_string
 {
 public:
   typedef CharTraits                               traits_type;
   typedef CharTraits                               char_traits;
 
-  typedef mystl::allocator<CharType>               allocator_type;
-  typedef mystl::allocator<CharType>               data_allocator;
+  typedef Alloc                                    allocator_type;
+  typedef mystl::allocator_traits<Alloc>           alloc_traits;
 
-  typedef typename allocator_type::value_type      value_type;
-  typedef typename allocator_type::pointer         pointer;
-  typedef typename allocator_type::const_pointer   const_pointer;
-  typedef typename allocator_type::reference       reference;
-  typedef typename allocator_type::const_reference const_reference;
-  typedef typename allocator_type::size_type       size_type;
-  typedef typename allocator_type::difference_type difference_type;
+  typedef typename alloc_traits::value_type        value_type;
+  typedef typename alloc_traits::pointer           pointer;
+  typedef typename alloc_traits::const_pointer     const_pointer;
+  typedef value_type&                              reference;
+  typedef const value_type&                        const_reference;
+  typedef typename alloc_traits::size_type         size_type;
+  typedef typename alloc_traits::difference_type   difference_type;
 
   typedef value_type*                              iterator;
   typedef const value_type*                        const_iterator;
   typedef mystl::reverse_iterator<iterator>        reverse_iterator;
   typedef mystl::reverse_iterator<const_iterator>  const_reverse_iterator;
 
-  allocator_type get_allocator() { return allocator_type(); }
+  allocator_type get_allocator() const { return alloc_; }
 
   static_assert(std::is_pod<CharType>::value, "Character type of basic_string must be a POD");
   static_assert(std::is_same<CharType, typename traits_type::char_type>::value,
@@ -303,9 +305,10 @@ public:
   static constexpr size_type npos = static_cast<size_type>(-1);
 
 private:
-  iterator  buffer_;  // 储存字符串的起始位置
-  size_type size_;    // 大小
-  size_type cap_;     // 容量
+  iterator       buffer_;  // 储存字符串的起始位置
+  size_type      size_;    // 大小
+  size_type      cap_;     // 容量
+  allocator_type alloc_;   // 分配器
 
 public:
   // 构造、复制、移动、析构函数
@@ -313,54 +316,72 @@ public:
   basic_string() noexcept
   { try_init(); }
 
-  basic_string(size_type n, value_type ch)
-    :buffer_(nullptr), size_(0), cap_(0)
+  explicit basic_string(const allocator_type& alloc) noexcept
+    :alloc_(alloc)
+  { try_init(); }
+
+  basic_string(size_type n, value_type ch,
+               const allocator_type& alloc = allocator_type())
+    :buffer_(nullptr), size_(0), cap_(0), alloc_(alloc)
   {
     fill_init(n, ch);
   }
 
-  basic_string(const basic_string& other, size_type pos)
-    :buffer_(nullptr), size_(0), cap_(0)
+  basic_string(const basic_string& other, size_type pos,
+               const allocator_type& alloc = allocator_type())
+    :buffer_(nullptr), size_(0), cap_(0), alloc_(alloc)
   {
     init_from(other.buffer_, pos, other.size_ - pos);
   }
-  basic_string(const basic_string& other, size_type pos, size_type count)
-    :buffer_(nullptr), size_(0), cap_(0)
+  basic_string(const basic_string& other, size_type pos, size_type count,
+               const allocator_type& alloc = allocator_type())
+    :buffer_(nullptr), size_(0), cap_(0), alloc_(alloc)
   {
     init_from(other.buffer_, pos, count);
   }
 
-  basic_string(const_pointer str)
-    :buffer_(nullptr), size_(0), cap_(0)
+  basic_string(const_pointer str, const allocator_type& alloc = allocator_type())
+    :buffer_(nullptr), size_(0), cap_(0), alloc_(alloc)
   {
     init_from(str, 0, char_traits::length(str));
   }
-  basic_string(const_pointer str, size_type count)
-    :buffer_(nullptr), size_(0), cap_(0)
+  basic_string(const_pointer str, size_type count,
+               const allocator_type& alloc = allocator_type())
+    :buffer_(nullptr), size_(0), cap_(0), alloc_(alloc)
   {
     init_from(str, 0, count);
   }
 
   template <class Iter, typename std::enable_if<
     mystl::is_input_iterator<Iter>::value, int>::type = 0>
-  basic_string(Iter first, Iter last)
+  basic_string(Iter first, Iter last, const allocator_type& alloc = allocator_type())
+    :buffer_(nullptr), size_(0), cap_(0), alloc_(alloc)
   { copy_init(first, last, iterator_category(first)); }
 
   basic_string(const basic_string& rhs) 
-    :buffer_(nullptr), size_(0), cap_(0)
+    :buffer_(nullptr), size_(0), cap_(0),
+     alloc_(alloc_traits::select_on_container_copy_construction(rhs.alloc_))
+  {
+    init_from(rhs.buffer_, 0, rhs.size_);
+  }
+  basic_string(const basic_string& rhs, const allocator_type& alloc)
+    :buffer_(nullptr), size_(0), cap_(0), alloc_(alloc)
   {
     init_from(rhs.buffer_, 0, rhs.size_);
   }
   basic_string(basic_string&& rhs) noexcept
-    :buffer_(rhs.buffer_), size_(rhs.size_), cap_(rhs.cap_)
+    :buffer_(rhs.buffer_), size_(rhs.size_), cap_(rhs.cap_), alloc_(mystl::move(rhs.alloc_))
   {
     rhs.buffer_ = nullptr;
     rhs.size_ = 0;
     rhs.cap_ = 0;
   }
+  basic_string(basic_string&& rhs, const allocator_type& alloc);
 
   basic_string& operator=(const basic_string& rhs);
-  basic_string& operator=(basic_string&& rhs) noexcept;
+  basic_string& operator=(basic_string&& rhs) noexcept(
+    alloc_traits::propagate_on_container_move_assignment::value ||
+    alloc_traits::is_always_equal::value);
 
   basic_string& operator=(const_pointer str);
   basic_string& operator=(value_type ch);
@@ -532,7 +553,7 @@ public:
   basic_string substr(size_type index, size_type count = npos)
   {
     count = mystl::min(count, size_ - index);
-    return basic_string(buffer_ + index, buffer_ + index + count);
+    return basic_string(buffer_ + index, buffer_ + index + count, alloc_);
   }
 
   // replace
@@ -659,7 +680,7 @@ public:
   {
     value_type* buf = new value_type[4096];
     is >> buf;
-    basic_string tmp(buf);
+    basic_string tmp(buf, str.alloc_);
     str = std::move(tmp);
     delete[]buf;
     return is;
@@ -717,46 +738,85 @@ private:
 /*****************************************************************************************/
 
 // 复制赋值操作符
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 operator=(const basic_string& rhs)
 {
   if (this != &rhs)
   {
-    basic_string tmp(rhs);
-    swap(tmp);
+    if (mystl::alloc_copy_needs_reset(alloc_, rhs.alloc_))
+      destroy_buffer();  // 原有空间必须由原来的分配器释放
+    mystl::alloc_on_copy_assign(alloc_, rhs.alloc_);
+    basic_string tmp(rhs, alloc_);
+    mystl::swap(buffer_, tmp.buffer_);
+    mystl::swap(size_, tmp.size_);
+    mystl::swap(cap_, tmp.cap_);
   }
   return *this;
 }
 
+// 指定分配器的移动构造函数，分配器不相等时只能复制字符
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>::
+basic_string(basic_string&& rhs, const allocator_type& alloc)
+  :buffer_(nullptr), size_(0), cap_(0), alloc_(alloc)
+{
+  if (alloc_ == rhs.alloc_)
+  {
+    buffer_ = rhs.buffer_;
+    size_ = rhs.size_;
+    cap_ = rhs.cap_;
+    rhs.buffer_ = nullptr;
+    rhs.size_ = 0;
+    rhs.cap_ = 0;
+  }
+  else
+  {
+    init_from(rhs.buffer_, 0, rhs.size_);
+  }
+}
+
 // 移动赋值操作符
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
-operator=(basic_string&& rhs) noexcept
-{
-  destroy_buffer();
-  buffer_ = rhs.buffer_;
-  size_ = rhs.size_;
-  cap_ = rhs.cap_;
-  rhs.buffer_ = nullptr;
-  rhs.size_ = 0;
-  rhs.cap_ = 0;
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
+operator=(basic_string&& rhs) noexcept(
+  alloc_traits::propagate_on_container_move_assignment::value ||
+  alloc_traits::is_always_equal::value)
+{
+  if (this == &rhs)
+    return *this;
+  if (mystl::alloc_move_can_steal(alloc_, rhs.alloc_))
+  {
+    destroy_buffer();
+    mystl::alloc_on_move_assign(alloc_, rhs.alloc_);
+    buffer_ = rhs.buffer_;
+    size_ = rhs.size_;
+    cap_ = rhs.cap_;
+    rhs.buffer_ = nullptr;
+    rhs.size_ = 0;
+    rhs.cap_ = 0;
+  }
+  else
+  { // 分配器不相等且不传递，不能接管对方的空间
+    clear();
+    append(rhs.buffer_, rhs.size_);
+  }
   return *this;
 }
 
 // 用一个字符串赋值
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 operator=(const_pointer str)
 {
   const size_type len = char_traits::length(str);
   if (cap_ < len)
   {
-    auto new_buffer = data_allocator::allocate(len + 1);
-    data_allocator::deallocate(buffer_);
+    auto new_buffer = alloc_traits::allocate(alloc_, len + 1);
+    alloc_traits::deallocate(alloc_, buffer_, cap_);
     buffer_ = new_buffer;
     cap_ = len + 1;
   }
@@ -766,15 +826,15 @@ operator=(const_pointer str)
 }
 
 // 用一个字符赋值
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 operator=(value_type ch)
 {
   if (cap_ < 1)
   {
-    auto new_buffer = data_allocator::allocate(2);
-    data_allocator::deallocate(buffer_);
+    auto new_buffer = alloc_traits::allocate(alloc_, 2);
+    alloc_traits::deallocate(alloc_, buffer_, cap_);
     buffer_ = new_buffer;
     cap_ = 2;
   }
@@ -784,24 +844,22 @@ operator=(value_type ch)
 }
 
 // 预留储存空间
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 reserve(size_type n)
 {
   if (cap_ < n)
   {
     THROW_LENGTH_ERROR_IF(n > max_size(), "n can not larger than max_size()"
                           "in basic_string<Char,Traits>::reserve(n)");
-    auto new_buffer = data_allocator::allocate(n);
-    char_traits::move(new_buffer, buffer_, size_);
-    buffer_ = new_buffer;
+    buffer_ = alloc_traits::reallocate(alloc_, buffer_, cap_, n);
     cap_ = n;
   }
 }
 
 // 减少不用的空间
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 shrink_to_fit()
 {
   if (size_ != cap_)
@@ -811,9 +869,9 @@ shrink_to_fit()
 }
 
 // 在 pos 处插入一个元素
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::iterator
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::iterator
+basic_string<CharType, CharTraits, Alloc>::
 insert(const_iterator pos, value_type ch)
 {
   iterator r = const_cast<iterator>(pos);
@@ -828,9 +886,9 @@ insert(const_iterator pos, value_type ch)
 }
 
 // 在 pos 处插入 n 个元素
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::iterator
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::iterator
+basic_string<CharType, CharTraits, Alloc>::
 insert(const_iterator pos, size_type count, value_type ch)
 {
   iterator r = const_cast<iterator>(pos);
@@ -853,10 +911,10 @@ insert(const_iterator pos, size_type count, value_type ch)
 }
 
 // 在 pos 处插入 [first, last) 内的元素
-template <class CharType, class CharTraits>
+template <class CharType, class CharTraits, class Alloc>
 template <class Iter>
-typename basic_string<CharType, CharTraits>::iterator
-basic_string<CharType, CharTraits>::
+typename basic_string<CharType, CharTraits, Alloc>::iterator
+basic_string<CharType, CharTraits, Alloc>::
 insert(const_iterator pos, Iter first, Iter last)
 {
   iterator r = const_cast<iterator>(pos);
@@ -880,9 +938,9 @@ insert(const_iterator pos, Iter first, Iter last)
 }
 
 // 在末尾添加 count 个 ch
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>& 
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>& 
+basic_string<CharType, CharTraits, Alloc>::
 append(size_type count, value_type ch)
 {
   THROW_LENGTH_ERROR_IF(size_ > max_size() - count,
@@ -897,9 +955,9 @@ append(size_type count, value_type ch)
 }
 
 // 在末尾添加 [str[pos] str[pos+count]) 一段
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>& 
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>& 
+basic_string<CharType, CharTraits, Alloc>::
 append(const basic_string& str, size_type pos, size_type count)
 {
   THROW_LENGTH_ERROR_IF(size_ > max_size() - count,
@@ -916,9 +974,9 @@ append(const basic_string& str, size_type pos, size_type count)
 }
 
 // 在末尾添加 [s, s+count) 一段
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>& 
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>& 
+basic_string<CharType, CharTraits, Alloc>::
 append(const_pointer s, size_type count)
 {
   THROW_LENGTH_ERROR_IF(size_ > max_size() - count,
@@ -933,9 +991,9 @@ append(const_pointer s, size_type count)
 }
 
 // 删除 pos 处的元素
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::iterator
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::iterator
+basic_string<CharType, CharTraits, Alloc>::
 erase(const_iterator pos)
 {
   MYSTL_DEBUG(pos != end());
@@ -946,9 +1004,9 @@ erase(const_iterator pos)
 }
 
 // 删除 [first, last) 的元素
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::iterator
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::iterator
+basic_string<CharType, CharTraits, Alloc>::
 erase(const_iterator first, const_iterator last)
 {
   if (first == begin() && last == end())
@@ -964,8 +1022,8 @@ erase(const_iterator first, const_iterator last)
 }
 
 // 重置容器大小
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 resize(size_type count, value_type ch)
 {
   if (count < size_)
@@ -979,16 +1037,16 @@ resize(size_type count, value_type ch)
 }
 
 // 比较两个 basic_string，小于返回 -1，大于返回 1，等于返回 0
-template <class CharType, class CharTraits>
-int basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+int basic_string<CharType, CharTraits, Alloc>::
 compare(const basic_string& other) const
 {
   return compare_cstr(buffer_, size_, other.buffer_, other.size_);
 }
 
 // 从 pos1 下标开始的 count1 个字符跟另一个 basic_string 比较
-template <class CharType, class CharTraits>
-int basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+int basic_string<CharType, CharTraits, Alloc>::
 compare(size_type pos1, size_type count1, const basic_string& other) const
 {
   auto n1 = mystl::min(count1, size_ - pos1);
@@ -996,8 +1054,8 @@ compare(size_type pos1, size_type count1, const basic_string& other) const
 }
 
 // 从 pos1 下标开始的 count1 个字符跟另一个 basic_string 下标 pos2 开始的 count2 个字符比较
-template <class CharType, class CharTraits>
-int basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+int basic_string<CharType, CharTraits, Alloc>::
 compare(size_type pos1, size_type count1, const basic_string& other,
         size_type pos2, size_type count2) const
 {
@@ -1007,8 +1065,8 @@ compare(size_type pos1, size_type count1, const basic_string& other,
 }
 
 // 跟一个字符串比较
-template <class CharType, class CharTraits>
-int basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+int basic_string<CharType, CharTraits, Alloc>::
 compare(const_pointer s) const
 {
   auto n2 = char_traits::length(s);
@@ -1016,8 +1074,8 @@ compare(const_pointer s) const
 }
 
 // 从下标 pos1 开始的 count1 个字符跟另一个字符串比较
-template <class CharType, class CharTraits>
-int basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+int basic_string<CharType, CharTraits, Alloc>::
 compare(size_type pos1, size_type count1, const_pointer s) const
 {
   auto n1 = mystl::min(count1, size_ - pos1);
@@ -1026,8 +1084,8 @@ compare(size_type pos1, size_type count1, const_pointer s) const
 }
 
 // 从下标 pos1 开始的 count1 个字符跟另一个字符串的前 count2 个字符比较
-template <class CharType, class CharTraits>
-int basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+int basic_string<CharType, CharTraits, Alloc>::
 compare(size_type pos1, size_type count1, const_pointer s, size_type count2) const
 {
   auto n1 = mystl::min(count1, size_ - pos1);
@@ -1035,8 +1093,8 @@ compare(size_type pos1, size_type count1, const_pointer s, size_type count2) con
 }
 
 // 反转 basic_string
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 reverse() noexcept
 {
   for (auto i = begin(), j = end(); i < j;)
@@ -1046,8 +1104,8 @@ reverse() noexcept
 }
 
 // 交换两个 basic_string
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 swap(basic_string& rhs) noexcept
 {
   if (this != &rhs)
@@ -1055,13 +1113,14 @@ swap(basic_string& rhs) noexcept
     mystl::swap(buffer_, rhs.buffer_);
     mystl::swap(size_, rhs.size_);
     mystl::swap(cap_, rhs.cap_);
+    mystl::alloc_on_swap(alloc_, rhs.alloc_);
   }
 }
 
 // 从下标 pos 开始查找字符为 ch 的元素，若找到返回其下标，否则返回 npos
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find(value_type ch, size_type pos) const noexcept
 {
   for (auto i = pos; i < size_; ++i)
@@ -1073,9 +1132,9 @@ find(value_type ch, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始查找字符串 str，若找到返回起始位置的下标，否则返回 npos
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find(const_pointer str, size_type pos) const noexcept
 {
   const auto len = char_traits::length(str);
@@ -1102,9 +1161,9 @@ find(const_pointer str, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始查找字符串 str 的前 count 个字符，若找到返回起始位置的下标，否则返回 npos
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find(const_pointer str, size_type pos, size_type count) const noexcept
 {
   if (count == 0)
@@ -1130,9 +1189,9 @@ find(const_pointer str, size_type pos, size_type count) const noexcept
 }
 
 // 从下标 pos 开始查找字符串 str，若找到返回起始位置的下标，否则返回 npos
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find(const basic_string& str, size_type pos) const noexcept
 {
   const size_type count = str.size_;
@@ -1159,9 +1218,9 @@ find(const basic_string& str, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始反向查找值为 ch 的元素，与 find 类似
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 rfind(value_type ch, size_type pos) const noexcept
 {
   if (pos >= size_)
@@ -1175,9 +1234,9 @@ rfind(value_type ch, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始反向查找字符串 str，与 find 类似
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 rfind(const_pointer str, size_type pos) const noexcept
 {
   if (pos >= size_)
@@ -1219,9 +1278,9 @@ rfind(const_pointer str, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始反向查找字符串 str 前 count 个字符，与 find 类似
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 rfind(const_pointer str, size_type pos, size_type count) const noexcept
 {
   if (count == 0)
@@ -1248,9 +1307,9 @@ rfind(const_pointer str, size_type pos, size_type count) const noexcept
 }
 
 // 从下标 pos 开始反向查找字符串 str，与 find 类似
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 rfind(const basic_string& str, size_type pos) const noexcept
 {
   const size_type count = str.size_;
@@ -1278,9 +1337,9 @@ rfind(const basic_string& str, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始查找 ch 出现的第一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_of(value_type ch, size_type pos) const noexcept
 {
   for (auto i = pos; i < size_; ++i)
@@ -1292,9 +1351,9 @@ find_first_of(value_type ch, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始查找字符串 s 其中的一个字符出现的第一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_of(const_pointer s, size_type pos) const noexcept
 {
   const size_type len = char_traits::length(s);
@@ -1311,9 +1370,9 @@ find_first_of(const_pointer s, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始查找字符串 s 
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_of(const_pointer s, size_type pos, size_type count) const noexcept
 {
   for (auto i = pos; i < size_; ++i)
@@ -1329,9 +1388,9 @@ find_first_of(const_pointer s, size_type pos, size_type count) const noexcept
 }
 
 // 从下标 pos 开始查找字符串 str 其中一个字符出现的第一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_of(const basic_string& str, size_type pos) const noexcept
 {
   for (auto i = pos; i < size_; ++i)
@@ -1347,9 +1406,9 @@ find_first_of(const basic_string& str, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始查找与 ch 不相等的第一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_not_of(value_type ch, size_type pos) const noexcept
 {
   for (auto i = pos; i < size_; ++i)
@@ -1361,9 +1420,9 @@ find_first_not_of(value_type ch, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始查找与字符串 s 其中一个字符不相等的第一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_not_of(const_pointer s, size_type pos) const noexcept
 {
   const size_type len = char_traits::length(s);
@@ -1380,9 +1439,9 @@ find_first_not_of(const_pointer s, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始查找与字符串 s 前 count 个字符中不相等的第一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_not_of(const_pointer s, size_type pos, size_type count) const noexcept
 {
   for (auto i = pos; i < size_; ++i)
@@ -1398,9 +1457,9 @@ find_first_not_of(const_pointer s, size_type pos, size_type count) const noexcep
 }
 
 // 从下标 pos 开始查找与字符串 str 的字符中不相等的第一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_not_of(const basic_string& str, size_type pos) const noexcept
 {
   for (auto i = pos; i < size_; ++i)
@@ -1416,9 +1475,9 @@ find_first_not_of(const basic_string& str, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始查找与 ch 相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_of(value_type ch, size_type pos) const noexcept
 {
   for (auto i = size_ - 1; i >= pos; --i)
@@ -1430,9 +1489,9 @@ find_last_of(value_type ch, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始查找与字符串 s 其中一个字符相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_of(const_pointer s, size_type pos) const noexcept
 {
   const size_type len = char_traits::length(s);
@@ -1449,9 +1508,9 @@ find_last_of(const_pointer s, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始查找与字符串 s 前 count 个字符中相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_of(const_pointer s, size_type pos, size_type count) const noexcept
 {
   for (auto i = size_ - 1; i >= pos; --i)
@@ -1467,9 +1526,9 @@ find_last_of(const_pointer s, size_type pos, size_type count) const noexcept
 }
 
 // 从下标 pos 开始查找与字符串 str 字符中相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_of(const basic_string& str, size_type pos) const noexcept
 {
   for (auto i = size_ - 1; i >= pos; --i)
@@ -1485,9 +1544,9 @@ find_last_of(const basic_string& str, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始查找与 ch 字符不相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_not_of(value_type ch, size_type pos) const noexcept
 {
   for (auto i = size_ - 1; i >= pos; --i)
@@ -1499,9 +1558,9 @@ find_last_not_of(value_type ch, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始查找与字符串 s 的字符中不相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_not_of(const_pointer s, size_type pos) const noexcept
 {
   const size_type len = char_traits::length(s);
@@ -1518,9 +1577,9 @@ find_last_not_of(const_pointer s, size_type pos) const noexcept
 }
 
 // 从下标 pos 开始查找与字符串 s 前 count 个字符中不相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_not_of(const_pointer s, size_type pos, size_type count) const noexcept
 {
   for (auto i = size_ - 1; i >= pos; --i)
@@ -1536,9 +1595,9 @@ find_last_not_of(const_pointer s, size_type pos, size_type count) const noexcept
 }
 
 // 从下标 pos 开始查找与字符串 str 字符中不相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_not_of(const basic_string& str, size_type pos) const noexcept
 {
   for (auto i = size_ - 1; i >= pos; --i)
@@ -1554,9 +1613,9 @@ find_last_not_of(const basic_string& str, size_type pos) const noexcept
 }
 
 // 返回从下标 pos 开始字符为 ch 的元素出现的次数
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 count(value_type ch, size_type pos) const noexcept
 {
   size_type n = 0;
@@ -1572,15 +1631,15 @@ count(value_type ch, size_type pos) const noexcept
 // helper function
 
 // 尝试初始化一段 buffer，若分配失败则忽略，不会抛出异常
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 try_init() noexcept
 {
   try
   {
-    buffer_ = data_allocator::allocate(static_cast<size_type>(STRING_INIT_SIZE));
+    buffer_ = alloc_traits::allocate(alloc_, static_cast<size_type>(STRING_INIT_SIZE));
     size_ = 0;
-    cap_ = 0;
+    cap_ = static_cast<size_type>(STRING_INIT_SIZE);
   }
   catch (...)
   {
@@ -1592,28 +1651,28 @@ try_init() noexcept
 }
 
 // fill_init 函数
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 fill_init(size_type n, value_type ch)
 {
   const auto init_size = mystl::max(static_cast<size_type>(STRING_INIT_SIZE), n + 1);
-  buffer_ = data_allocator::allocate(init_size);
+  buffer_ = alloc_traits::allocate(alloc_, init_size);
   char_traits::fill(buffer_, ch, n);
   size_ = n;
   cap_ = init_size;
 }
 
 // copy_init 函数
-template <class CharType, class CharTraits>
+template <class CharType, class CharTraits, class Alloc>
 template <class Iter>
-void basic_string<CharType, CharTraits>::
+void basic_string<CharType, CharTraits, Alloc>::
 copy_init(Iter first, Iter last, mystl::input_iterator_tag)
 {
   size_type n = mystl::distance(first, last);
   const auto init_size = mystl::max(static_cast<size_type>(STRING_INIT_SIZE), n + 1);
   try
   {
-    buffer_ = data_allocator::allocate(init_size);
+    buffer_ = alloc_traits::allocate(alloc_, init_size);
     size_ = n;
     cap_ = init_size;
   }
@@ -1628,16 +1687,16 @@ copy_init(Iter first, Iter last, mystl::input_iterator_tag)
     append(*first);
 }
 
-template <class CharType, class CharTraits>
+template <class CharType, class CharTraits, class Alloc>
 template <class Iter>
-void basic_string<CharType, CharTraits>::
+void basic_string<CharType, CharTraits, Alloc>::
 copy_init(Iter first, Iter last, mystl::forward_iterator_tag)
 {
   const size_type n = mystl::distance(first, last);
   const auto init_size = mystl::max(static_cast<size_type>(STRING_INIT_SIZE), n + 1);
   try
   {
-    buffer_ = data_allocator::allocate(init_size);
+    buffer_ = alloc_traits::allocate(alloc_, init_size);
     size_ = n;
     cap_ = init_size;
     mystl::uninitialized_copy(first, last, buffer_);
@@ -1652,25 +1711,25 @@ copy_init(Iter first, Iter last, mystl::forward_iterator_tag)
 }
 
 // init_from 函数
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 init_from(const_pointer src, size_type pos, size_type count)
 {
   const auto init_size = mystl::max(static_cast<size_type>(STRING_INIT_SIZE), count + 1);
-  buffer_ = data_allocator::allocate(init_size);
+  buffer_ = alloc_traits::allocate(alloc_, init_size);
   char_traits::copy(buffer_, src + pos, count);
   size_ = count;
   cap_ = init_size;
 }
 
 // destroy_buffer 函数
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 destroy_buffer()
 {
   if (buffer_ != nullptr)
   {
-    data_allocator::deallocate(buffer_, cap_);
+    alloc_traits::deallocate(alloc_, buffer_, cap_);
     buffer_ = nullptr;
     size_ = 0;
     cap_ = 0;
@@ -1678,9 +1737,9 @@ destroy_buffer()
 }
 
 // to_raw_pointer 函数
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::const_pointer
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::const_pointer
+basic_string<CharType, CharTraits, Alloc>::
 to_raw_pointer() const
 {
   *(buffer_ + size_) = value_type();
@@ -1688,29 +1747,31 @@ to_raw_pointer() const
 }
 
 // reinsert 函数
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 reinsert(size_type size)
 {
-  auto new_buffer = data_allocator::allocate(size);
+  auto new_buffer = alloc_traits::allocate(alloc_, size);
   try
   {
     char_traits::move(new_buffer, buffer_, size);
   }
   catch (...)
   {
-    data_allocator::deallocate(new_buffer);
+    alloc_traits::deallocate(alloc_, new_buffer, size);
+    throw;
   }
+  alloc_traits::deallocate(alloc_, buffer_, cap_);
   buffer_ = new_buffer;
   size_ = size;
   cap_ = size;
 }
 
 // append_range，末尾追加一段 [first, last) 内的字符
-template <class CharType, class CharTraits>
+template <class CharType, class CharTraits, class Alloc>
 template <class Iter>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 append_range(Iter first, Iter last)
 {
   const size_type n = mystl::distance(first, last);
@@ -1725,8 +1786,8 @@ append_range(Iter first, Iter last)
   return *this;
 }
 
-template <class CharType, class CharTraits>
-int basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+int basic_string<CharType, CharTraits, Alloc>::
 compare_cstr(const_pointer s1, size_type n1, const_pointer s2, size_type n2) const
 {
   auto rlen = mystl::min(n1, n2);
@@ -1738,9 +1799,9 @@ compare_cstr(const_pointer s1, size_type n1, const_pointer s2, size_type n2) con
 }
 
 // 把 first 开始的 count1 个字符替换成 str 开始的 count2 个字符
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>& 
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>& 
+basic_string<CharType, CharTraits, Alloc>::
 replace_cstr(const_iterator first, size_type count1, const_pointer str, size_type count2)
 {
   if (static_cast<size_type>(cend() - first) < count1)
@@ -1772,9 +1833,9 @@ replace_cstr(const_iterator first, size_type count1, const_pointer str, size_typ
 }
 
 // 把 first 开始的 count1 个字符替换成 count2 个 ch 字符
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 replace_fill(const_iterator first, size_type count1, size_type count2, value_type ch)
 {
   if (static_cast<size_type>(cend() - first) < count1)
@@ -1806,10 +1867,10 @@ replace_fill(const_iterator first, size_type count1, size_type count2, value_typ
 }
 
 // 把 [first, last) 的字符替换成 [first2, last2)
-template <class CharType, class CharTraits>
+template <class CharType, class CharTraits, class Alloc>
 template <class Iter>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 replace_copy(const_iterator first, const_iterator last, Iter first2, Iter last2)
 {
   size_type len1 = last - first;
@@ -1839,53 +1900,49 @@ replace_copy(const_iterator first, const_iterator last, Iter first2, Iter last2)
 }
 
 // reallocate 函数
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+// 字符可以按字节搬移，交给分配器原地扩展或重新映射
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 reallocate(size_type need)
 {
   const auto new_cap = mystl::max(cap_ + need, cap_ + (cap_ >> 1));
-  auto new_buffer = data_allocator::allocate(new_cap);
-  char_traits::move(new_buffer, buffer_, size_);
-  data_allocator::deallocate(buffer_);
-  buffer_ = new_buffer;
+  buffer_ = alloc_traits::reallocate(alloc_, buffer_, cap_, new_cap);
   cap_ = new_cap;
 }
 
 // reallocate_and_fill 函数
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::iterator
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::iterator
+basic_string<CharType, CharTraits, Alloc>::
 reallocate_and_fill(iterator pos, size_type n, value_type ch)
 {
   const auto r = pos - buffer_;
   const auto old_cap = cap_;
   const auto new_cap = mystl::max(old_cap + n, old_cap + (old_cap >> 1));
-  auto new_buffer = data_allocator::allocate(new_cap);
-  auto e1 = char_traits::move(new_buffer, buffer_, r) + r;
-  auto e2 = char_traits::fill(e1, ch, n) + n;
-  char_traits::move(e2, buffer_ + r, size_ - r);
-  data_allocator::deallocate(buffer_, old_cap);
-  buffer_ = new_buffer;
-  size_ += n;
+  // 字符可以平凡搬移，原地调整空间后再挪动插入点之后的部分
+  buffer_ = alloc_traits::reallocate(alloc_, buffer_, old_cap, new_cap);
   cap_ = new_cap;
+  mystl::uninitialized_relocate_backward(buffer_ + r, buffer_ + size_, buffer_ + size_ + n);
+  char_traits::fill(buffer_ + r, ch, n);
+  size_ += n;
   return buffer_ + r;
 }
 
 // reallocate_and_copy 函数
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::iterator
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::iterator
+basic_string<CharType, CharTraits, Alloc>::
 reallocate_and_copy(iterator pos, const_iterator first, const_iterator last)
 {
   const auto r = pos - buffer_;
   const auto old_cap = cap_;
   const size_type n = mystl::distance(first, last);
   const auto new_cap = mystl::max(old_cap + n, old_cap + (old_cap >> 1));
-  auto new_buffer = data_allocator::allocate(new_cap);
+  auto new_buffer = alloc_traits::allocate(alloc_, new_cap);
   auto e1 = char_traits::move(new_buffer, buffer_, r) + r;
   auto e2 = mystl::uninitialized_copy_n(first, n, e1) + n;
   char_traits::move(e2, buffer_ + r, size_ - r);
-  data_allocator::deallocate(buffer_, old_cap);
+  alloc_traits::deallocate(alloc_, buffer_, old_cap);
   buffer_ = new_buffer;
   size_ += n;
   cap_ = new_cap;
@@ -1896,177 +1953,181 @@ reallocate_and_copy(iterator pos, const_iterator first, const_iterator last)
 // 重载全局操作符
 
 // 重载 operator+
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(const basic_string<CharType, CharTraits>& lhs, 
-          const basic_string<CharType, CharTraits>& rhs)
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(const basic_string<CharType, CharTraits, Alloc>& lhs, 
+          const basic_string<CharType, CharTraits, Alloc>& rhs)
 {
-  basic_string<CharType, CharTraits> tmp(lhs);
+  basic_string<CharType, CharTraits, Alloc> tmp(lhs);
   tmp.append(rhs);
   return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(const CharType* lhs, const basic_string<CharType, CharTraits>& rhs)
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(const CharType* lhs, const basic_string<CharType, CharTraits, Alloc>& rhs)
 {
-  basic_string<CharType, CharTraits> tmp(lhs);
+  basic_string<CharType, CharTraits, Alloc> tmp(lhs);
   tmp.append(rhs);
   return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(CharType ch, const basic_string<CharType, CharTraits>& rhs)
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(CharType ch, const basic_string<CharType, CharTraits, Alloc>& rhs)
 {
-  basic_string<CharType, CharTraits> tmp(1, ch);
+  basic_string<CharType, CharTraits, Alloc> tmp(1, ch);
   tmp.append(rhs);
   return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(const basic_string<CharType, CharTraits>& lhs, const CharType* rhs)
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(const basic_string<CharType, CharTraits, Alloc>& lhs, const CharType* rhs)
 {
-  basic_string<CharType, CharTraits> tmp(lhs);
+  basic_string<CharType, CharTraits, Alloc> tmp(lhs);
   tmp.append(rhs);
   return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(const basic_string<CharType, CharTraits>& lhs, CharType ch)
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(const basic_string<CharType, CharTraits, Alloc>& lhs, CharType ch)
 {
-  basic_string<CharType, CharTraits> tmp(lhs);
+  basic_string<CharType, CharTraits, Alloc> tmp(lhs);
   tmp.append(1, ch);
   return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(basic_string<CharType, CharTraits>&& lhs,
-          const basic_string<CharType, CharTraits>& rhs)
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(basic_string<CharType, CharTraits, Alloc>&& lhs,
+          const basic_string<CharType, CharTraits, Alloc>& rhs)
 {
-  basic_string<CharType, CharTraits> tmp(mystl::move(lhs));
+  basic_string<CharType, CharTraits, Alloc> tmp(mystl::move(lhs));
   tmp.append(rhs);
   return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(const basic_string<CharType, CharTraits>& lhs,
-          basic_string<CharType, CharTraits>&& rhs)
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(const basic_string<CharType, CharTraits, Alloc>& lhs,
+          basic_string<CharType, CharTraits, Alloc>&& rhs)
 {
-  basic_string<CharType, CharTraits> tmp(mystl::move(rhs));
+  basic_string<CharType, CharTraits, Alloc> tmp(mystl::move(rhs));
   tmp.insert(tmp.begin(), lhs.begin(), lhs.end());
   return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(basic_string<CharType, CharTraits>&& lhs,
-          basic_string<CharType, CharTraits>&& rhs)
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(basic_string<CharType, CharTraits, Alloc>&& lhs,
+          basic_string<CharType, CharTraits, Alloc>&& rhs)
 {
-  basic_string<CharType, CharTraits> tmp(mystl::move(lhs));
+  basic_string<CharType, CharTraits, Alloc> tmp(mystl::move(lhs));
   tmp.append(rhs);
   return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(const CharType* lhs, basic_string<CharType, CharTraits>&& rhs)
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(const CharType* lhs, basic_string<CharType, CharTraits, Alloc>&& rhs)
 {
-  basic_string<CharType, CharTraits> tmp(mystl::move(rhs));
+  basic_string<CharType, CharTraits, Alloc> tmp(mystl::move(rhs));
   tmp.insert(tmp.begin(), lhs, lhs + char_traits<CharType>::length(lhs));
   return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(CharType ch, basic_string<CharType, CharTraits>&& rhs)
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(CharType ch, basic_string<CharType, CharTraits, Alloc>&& rhs)
 {
-  basic_string<CharType, CharTraits> tmp(mystl::move(rhs));
+  basic_string<CharType, CharTraits, Alloc> tmp(mystl::move(rhs));
   tmp.insert(tmp.begin(), ch);
   return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(basic_string<CharType, CharTraits>&& lhs, const CharType* rhs)
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(basic_string<CharType, CharTraits, Alloc>&& lhs, const CharType* rhs)
 {
-  basic_string<CharType, CharTraits> tmp(mystl::move(lhs));
+  basic_string<CharType, CharTraits, Alloc> tmp(mystl::move(lhs));
   tmp.append(rhs);
   return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(basic_string<CharType, CharTraits>&& lhs, CharType ch)
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(basic_string<CharType, CharTraits, Alloc>&& lhs, CharType ch)
 {
-  basic_string<CharType, CharTraits> tmp(mystl::move(lhs));
+  basic_string<CharType, CharTraits, Alloc> tmp(mystl::move(lhs));
   tmp.append(1, ch);
   return tmp;
 }
 
 // 重载比较操作符
-template <class CharType, class CharTraits>
-bool operator==(const basic_string<CharType, CharTraits>& lhs,
-                const basic_string<CharType, CharTraits>& rhs)
+template <class CharType, class CharTraits, class Alloc>
+bool operator==(const basic_string<CharType, CharTraits, Alloc>& lhs,
+                const basic_string<CharType, CharTraits, Alloc>& rhs)
 {
   return lhs.size() == rhs.size() && lhs.compare(rhs) == 0;
 }
 
-template <class CharType, class CharTraits>
-bool operator!=(const basic_string<CharType, CharTraits>& lhs,
-                const basic_string<CharType, CharTraits>& rhs)
+template <class CharType, class CharTraits, class Alloc>
+bool operator!=(const basic_string<CharType, CharTraits, Alloc>& lhs,
+                const basic_string<CharType, CharTraits, Alloc>& rhs)
 {
   return lhs.size() != rhs.size() || lhs.compare(rhs) != 0;
 }
 
-template <class CharType, class CharTraits>
-bool operator<(const basic_string<CharType, CharTraits>& lhs,
-               const basic_string<CharType, CharTraits>& rhs)
+template <class CharType, class CharTraits, class Alloc>
+bool operator<(const basic_string<CharType, CharTraits, Alloc>& lhs,
+               const basic_string<CharType, CharTraits, Alloc>& rhs)
 {
   return lhs.compare(rhs) < 0;
 }
 
-template <class CharType, class CharTraits>
-bool operator<=(const basic_string<CharType, CharTraits>& lhs,
-                const basic_string<CharType, CharTraits>& rhs)
+template <class CharType, class CharTraits, class Alloc>
+bool operator<=(const basic_string<CharType, CharTraits, Alloc>& lhs,
+                const basic_string<CharType, CharTraits, Alloc>& rhs)
 {
   return lhs.compare(rhs) <= 0;
 }
 
-template <class CharType, class CharTraits>
-bool operator>(const basic_string<CharType, CharTraits>& lhs,
-               const basic_string<CharType, CharTraits>& rhs)
+template <class CharType, class CharTraits, class Alloc>
+bool operator>(const basic_string<CharType, CharTraits, Alloc>& lhs,
+               const basic_string<CharType, CharTraits, Alloc>& rhs)
 {
   return lhs.compare(rhs) > 0;
 }
 
-template <class CharType, class CharTraits>
-bool operator>=(const basic_string<CharType, CharTraits>& lhs,
-                const basic_string<CharType, CharTraits>& rhs)
+template <class CharType, class CharTraits, class Alloc>
+bool operator>=(const basic_string<CharType, CharTraits, Alloc>& lhs,
+                const basic_string<CharType, CharTraits, Alloc>& rhs)
 {
   return lhs.compare(rhs) >= 0;
 }
 
 // 重载 mystl 的 swap
-template <class CharType, class CharTraits>
-void swap(basic_string<CharType, CharTraits>& lhs,
-          basic_string<CharType, CharTraits>& rhs) noexcept
+template <class CharType, class CharTraits, class Alloc>
+void swap(basic_string<CharType, CharTraits, Alloc>& lhs,
+          basic_string<CharType, CharTraits, Alloc>& rhs) noexcept
 {
   lhs.swap(rhs);
 }
 
-// 特化 mystl::hash
-template <class CharType, class CharTraits>
-struct hash<basic_string<CharType, CharTraits>>
+// basic_string 只保存指向堆上空间的指针，分配器可以平凡搬移时 basic_string 也可以
+template <class CharType, class CharTraits, class Alloc>
+struct is_trivially_relocatable<basic_string<CharType, CharTraits, Alloc>>
+  : mystl::is_trivially_relocatable<Alloc> {};
+
+// 特化 mystl::hash，使用每次读入 8 个字节的 hash_bytes
+template <class CharType, class CharTraits, class Alloc>
+struct hash<basic_string<CharType, CharTraits, Alloc>>
 {
-  size_t operator()(const basic_string<CharType, CharTraits>& str)
+  size_t operator()(const basic_string<CharType, CharTraits, Alloc>& str) const noexcept
   {
-    return bitwise_hash((const unsigned char*)str.c_str(),
-                        str.size() * sizeof(CharType));
+    return hash_bytes(str.data(), str.size() * sizeof(CharType));
   }
 };
 
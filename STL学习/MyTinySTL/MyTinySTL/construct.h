@@ -52,6 +52,9 @@ void destroy_one(Ty* pointer, std::false_type)
   }
 }
 
+template <class Ty>
+void destroy(Ty* pointer);
+
 template <class ForwardIter>
 void destroy_cat(ForwardIter , ForwardIter , std::true_type) {}
 
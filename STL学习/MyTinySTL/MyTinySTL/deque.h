@@ -14,6 +14,14 @@
 //   * push_front
 //   * push_back
 //   * insert
+//   * push_back_n
+//
+// 缓冲区：
+// 每个缓冲区的元素个数由模板参数 BufSize 指定，为 0 时使用 deque_buf_size 的缺省值(约 4096 bytes)。
+// 头尾弹出使缓冲区变空时，缓冲区先放入一个容量为 DEQUE_SPARE_BUFFERS 的空闲缓存，之后的插入优先取用，
+// 这样在缓冲区边界附近来回 push_back / pop_front 的队列不会反复申请、释放内存；
+// map 的一侧用完而另一侧还有一半以上空闲时，把节点移回 map 中央，不重新分配 map。
+// shrink_to_fit 会同时释放空闲缓存
 
 #include <initializer_list>
 
@@ -40,18 +48,25 @@ namespace mystl
 #define DEQUE_MAP_INIT_SIZE 8
 #endif
 
-template <class T>
+// deque 缓存的空闲缓冲区的最大个数，至少为 1
+#ifndef DEQUE_SPARE_BUFFERS
+#define DEQUE_SPARE_BUFFERS 2
+#endif
+
+// 缓冲区的元素个数，BufSize 不为 0 时直接使用 BufSize
+template <class T, size_t BufSize = 0>
 struct deque_buf_size
 {
-  static constexpr size_t value = sizeof(T) < 256 ? 4096 / sizeof(T) : 16;
+  static constexpr size_t value = BufSize != 0 ? BufSize
+    : sizeof(T) < 256 ? 4096 / sizeof(T) : 16;
 };
 
 // deque 的迭代器设计
-template <class T, class Ref, class Ptr>
+template <class T, class Ref, class Ptr, size_t BufSize = 0>
 struct deque_iterator : public iterator<random_access_iterator_tag, T>
 {
-  typedef deque_iterator<T, T&, T*>             iterator;
-  typedef deque_iterator<T, const T&, const T*> const_iterator;
+  typedef deque_iterator<T, T&, T*, BufSize>             iterator;
+  typedef deque_iterator<T, const T&, const T*, BufSize> const_iterator;
   typedef deque_iterator                        self;
 
   typedef T            value_type;
@@ -62,7 +77,7 @@ struct deque_iterator : public iterator<random_access_iterator_tag, T>
   typedef T*           value_pointer;
   typedef T**          map_pointer;
 
-  static const size_type buffer_size = deque_buf_size<T>::value;
+  static const size_type buffer_size = deque_buf_size<T, BufSize>::value;
 
   // 迭代器所含成员数据
   value_pointer cur;    // 指向所在缓冲区的当前元素
@@ -203,35 +218,68 @@ struct deque_iterator : public iterator<random_access_iterator_tag, T>
   bool operator>=(const self& rhs) const { return !(*this < rhs); }
 };
 
+// deque_iterator 是分段迭代器，每个缓冲区为一段
+template <class T, class Ref, class Ptr, size_t BufSize>
+struct segmented_iterator_traits<deque_iterator<T, Ref, Ptr, BufSize>>
+{
+  typedef std::true_type                            is_segmented;
+  typedef deque_iterator<T, Ref, Ptr, BufSize>      iterator;
+  typedef typename iterator::map_pointer            segment_iterator;
+  typedef Ptr                                       local_iterator;
+
+  static segment_iterator segment(const iterator& it) { return it.node; }
+  static local_iterator   local(const iterator& it)   { return it.cur; }
+
+  static local_iterator   begin(segment_iterator seg) { return *seg; }
+  static local_iterator   end(segment_iterator seg)   { return *seg + iterator::buffer_size; }
+
+  static iterator compose(segment_iterator seg, local_iterator p)
+  {
+    if (p == end(seg))
+    { // 与 operator++ 一致，段尾用下一段的头部表示
+      ++seg;
+      p = begin(seg);
+    }
+    iterator it;
+    it.set_node(seg);
+    it.cur = const_cast<T*>(p);
+    return it;
+  }
+};
+
 // 模板类 deque
-// 模板参数代表数据类型
-template <class T>
+// 模板参数 T 代表数据类型，Alloc 代表分配器类型，BufSize 代表每个缓冲区的元素个数(0 表示使用缺省值)
+template <class T, class Alloc = mystl::allocator<T>, size_t BufSize = 0>
 class deque
 {
+  static_assert(DEQUE_SPARE_BUFFERS >= 1, "DEQUE_SPARE_BUFFERS must be at least 1");
+
 public:
   // deque 的型别定义
-  typedef mystl::allocator<T>                      allocator_type;
-  typedef mystl::allocator<T>                      data_allocator;
-  typedef mystl::allocator<T*>                     map_allocator;
-
-  typedef typename allocator_type::value_type      value_type;
-  typedef typename allocator_type::pointer         pointer;
-  typedef typename allocator_type::const_pointer   const_pointer;
-  typedef typename allocator_type::reference       reference;
-  typedef typename allocator_type::const_reference const_reference;
-  typedef typename allocator_type::size_type       size_type;
-  typedef typename allocator_type::difference_type difference_type;
+  typedef Alloc                                    allocator_type;
+  typedef mystl::allocator_traits<Alloc>           alloc_traits;
+  typedef typename alloc_traits::template 
+    rebind_alloc<T*>                               map_allocator;
+  typedef mystl::allocator_traits<map_allocator>   map_alloc_traits;
+
+  typedef typename alloc_traits::value_type        value_type;
+  typedef typename alloc_traits::pointer           pointer;
+  typedef typename alloc_traits::const_pointer     const_pointer;
+  typedef value_type&                              reference;
+  typedef const value_type&                        const_reference;
+  typedef typename alloc_traits::size_type         size_type;
+  typedef typename alloc_traits::difference_type   difference_type;
   typedef pointer*                                 map_pointer;
   typedef const_pointer*                           const_map_pointer;
 
-  typedef deque_iterator<T, T&, T*>                iterator;
-  typedef deque_iterator<T, const T&, const T*>    const_iterator;
+  typedef deque_iterator<T, T&, T*, BufSize>             iterator;
+  typedef deque_iterator<T, const T&, const T*, BufSize> const_iterator;
   typedef mystl::reverse_iterator<iterator>        reverse_iterator;
   typedef mystl::reverse_iterator<const_iterator>  const_reverse_iterator;
 
-  allocator_type get_allocator() { return allocator_type(); }
+  allocator_type get_allocator() const { return alloc_; }
 
-  static const size_type buffer_size = deque_buf_size<T>::value;
+  static const size_type buffer_size = deque_buf_size<T, BufSize>::value;
 
 private:
   // 用以下四个数据来表现一个 deque
@@ -239,6 +287,10 @@ private:
   iterator       end_;       // 指向最后一个结点
   map_pointer    map_;       // 指向一块 map，map 中的每个元素都是一个指针，指向一个缓冲区
   size_type      map_size_;  // map 内指针的数目
+  allocator_type alloc_;     // 缓冲区的分配器，map 使用由它 rebind 得到的分配器
+  // 空闲缓冲区缓存
+  pointer        spare_[DEQUE_SPARE_BUFFERS] = {};
+  size_type      nspare_ = 0;
 
 public:
   // 构造、复制、移动、析构函数
@@ -246,23 +298,39 @@ public:
   deque()
   { fill_init(0, value_type()); }
 
-  explicit deque(size_type n)
+  explicit deque(const allocator_type& alloc)
+    :alloc_(alloc)
+  { fill_init(0, value_type()); }
+
+  explicit deque(size_type n, const allocator_type& alloc = allocator_type())
+    :alloc_(alloc)
   { fill_init(n, value_type()); }
 
-  deque(size_type n, const value_type& value)
+  deque(size_type n, const value_type& value,
+        const allocator_type& alloc = allocator_type())
+    :alloc_(alloc)
   { fill_init(n, value); }
 
   template <class IIter, typename std::enable_if<
     mystl::is_input_iterator<IIter>::value, int>::type = 0>
-  deque(IIter first, IIter last)
+  deque(IIter first, IIter last, const allocator_type& alloc = allocator_type())
+    :alloc_(alloc)
   { copy_init(first, last, iterator_category(first)); }
 
-  deque(std::initializer_list<value_type> ilist)
+  deque(std::initializer_list<value_type> ilist,
+        const allocator_type& alloc = allocator_type())
+    :alloc_(alloc)
   {
     copy_init(ilist.begin(), ilist.end(), mystl::forward_iterator_tag());
   }
 
   deque(const deque& rhs)
+    :alloc_(alloc_traits::select_on_container_copy_construction(rhs.alloc_))
+  {
+    copy_init(rhs.begin(), rhs.end(), mystl::forward_iterator_tag());
+  }
+  deque(const deque& rhs, const allocator_type& alloc)
+    :alloc_(alloc)
   {
     copy_init(rhs.begin(), rhs.end(), mystl::forward_iterator_tag());
   }
@@ -270,10 +338,12 @@ public:
     :begin_(mystl::move(rhs.begin_)),
     end_(mystl::move(rhs.end_)),
     map_(rhs.map_),
-    map_size_(rhs.map_size_)
+    map_size_(rhs.map_size_),
+    alloc_(mystl::move(rhs.alloc_))
   {
     rhs.map_ = nullptr;
     rhs.map_size_ = 0;
+    take_spare(rhs);
   }
 
   deque& operator=(const deque& rhs);
@@ -281,7 +351,7 @@ public:
 
   deque& operator=(std::initializer_list<value_type> ilist)
   {
-    deque tmp(ilist);
+    deque tmp(ilist, alloc_);
     swap(tmp);
     return *this;
   }
@@ -289,13 +359,8 @@ public:
   ~deque()
   {
     if (map_ != nullptr)
-    {
-      clear();
-      data_allocator::deallocate(*begin_.node, buffer_size);
-      *begin_.node = nullptr;
-      map_allocator::deallocate(map_, map_size_);
-      map_ = nullptr;
-    }
+      destroy_all();
+    release_spare();
   }
 
 public:
@@ -418,6 +483,15 @@ public:
   void     pop_front();
   void     pop_back();
 
+  // push_back_n / pop_front_n，按缓冲区整段地复制、移动
+
+  template <class IIter, typename std::enable_if<
+    mystl::is_input_iterator<IIter>::value, int>::type = 0>
+  void     push_back_n(IIter first, IIter last)
+  { push_back_dispatch(first, last, iterator_category(first)); }
+  template <class OIter>
+  OIter    pop_front_n(OIter out, size_type n);
+
   // insert
 
   iterator insert(iterator position, const value_type& value);
@@ -443,8 +517,17 @@ private:
 
   // create node / destroy node
   map_pointer create_map(size_type size);
+  void        destroy_map(map_pointer mp, size_type size);
   void        create_buffer(map_pointer nstart, map_pointer nfinish);
   void        destroy_buffer(map_pointer nstart, map_pointer nfinish);
+  void        destroy_all();
+  void        trim_buffers(bool keep_spare) noexcept;
+
+  // spare buffers
+  pointer     get_buffer();
+  void        put_buffer(pointer p) noexcept;
+  void        release_spare() noexcept;
+  void        take_spare(deque& rhs) noexcept;
 
   // initialize
   void        map_init(size_type nelem);
@@ -471,22 +554,37 @@ private:
   void        insert_dispatch(iterator, IIter, IIter, input_iterator_tag);
   template <class FIter>
   void        insert_dispatch(iterator, FIter, FIter, forward_iterator_tag);
+  template <class IIter>
+  void        push_back_dispatch(IIter, IIter, input_iterator_tag);
+  template <class FIter>
+  void        push_back_dispatch(FIter, FIter, forward_iterator_tag);
 
   // reallocate
   void        require_capacity(size_type n, bool front);
   void        reallocate_map_at_front(size_type need);
   void        reallocate_map_at_back(size_type need);
+  void        recenter_map(map_pointer nstart) noexcept;
 
 };
 
 /*****************************************************************************************/
 
 // 复制赋值运算符
-template <class T>
-deque<T>& deque<T>::operator=(const deque& rhs)
+template <class T, class Alloc, size_t BufSize>
+deque<T, Alloc, BufSize>& deque<T, Alloc, BufSize>::operator=(const deque& rhs)
 {
   if (this != &rhs)
   {
+    if (mystl::alloc_copy_needs_reset(alloc_, rhs.alloc_))
+    { // 原有空间必须由原来的分配器释放
+      destroy_all();
+      mystl::alloc_on_copy_assign(alloc_, rhs.alloc_);
+      map_init(0);
+    }
+    else
+    {
+      mystl::alloc_on_copy_assign(alloc_, rhs.alloc_);
+    }
     const auto len = size();
     if (len >= rhs.size())
     {
@@ -503,22 +601,37 @@ deque<T>& deque<T>::operator=(const deque& rhs)
 }
 
 // 移动赋值运算符
-template <class T>
-deque<T>& deque<T>::operator=(deque&& rhs)
+template <class T, class Alloc, size_t BufSize>
+deque<T, Alloc, BufSize>& deque<T, Alloc, BufSize>::operator=(deque&& rhs)
 {
-  clear();
-  begin_ = mystl::move(rhs.begin_);
-  end_ = mystl::move(rhs.end_);
-  map_ = rhs.map_;
-  map_size_ = rhs.map_size_;
-  rhs.map_ = nullptr;
-  rhs.map_size_ = 0;
+  if (this == &rhs)
+    return *this;
+  if (mystl::alloc_move_can_steal(alloc_, rhs.alloc_))
+  {
+    if (map_ != nullptr)
+      destroy_all();
+    mystl::alloc_on_move_assign(alloc_, rhs.alloc_);
+    begin_ = mystl::move(rhs.begin_);
+    end_ = mystl::move(rhs.end_);
+    map_ = rhs.map_;
+    map_size_ = rhs.map_size_;
+    rhs.map_ = nullptr;
+    rhs.map_size_ = 0;
+    release_spare();
+    take_spare(rhs);
+  }
+  else
+  { // 分配器不相等且不传递，只能逐个移动元素
+    clear();
+    for (auto it = rhs.begin_; it != rhs.end_; ++it)
+      emplace_back(mystl::move(*it));
+  }
   return *this;
 }
 
 // 重置容器大小
-template <class T>
-void deque<T>::resize(size_type new_size, const value_type& value)
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::resize(size_type new_size, const value_type& value)
 {
   const auto len = size();
   if (new_size < len)
@@ -531,31 +644,22 @@ void deque<T>::resize(size_type new_size, const value_type& value)
   }
 }
 
-// 减小容器容量
-template <class T>
-void deque<T>::shrink_to_fit() noexcept
+// 减小容器容量，空闲缓存也一并释放
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::shrink_to_fit() noexcept
 {
-  // 至少会留下头部缓冲区
-  for (auto cur = map_; cur < begin_.node; ++cur)
-  {
-    data_allocator::deallocate(*cur, buffer_size);
-    *cur = nullptr;
-  }
-  for (auto cur = end_.node + 1; cur < map_ + map_size_; ++cur)
-  {
-    data_allocator::deallocate(*cur, buffer_size);
-    *cur = nullptr;
-  }
+  trim_buffers(false);
+  release_spare();
 }
 
 // 在头部就地构建元素
-template <class T>
+template <class T, class Alloc, size_t BufSize>
 template <class ...Args>
-void deque<T>::emplace_front(Args&& ...args)
+void deque<T, Alloc, BufSize>::emplace_front(Args&& ...args)
 {
   if (begin_.cur != begin_.first)
   {
-    data_allocator::construct(begin_.cur - 1, mystl::forward<Args>(args)...);
+    alloc_traits::construct(alloc_, begin_.cur - 1, mystl::forward<Args>(args)...);
     --begin_.cur;
   }
   else
@@ -564,7 +668,7 @@ void deque<T>::emplace_front(Args&& ...args)
     try
     {
       --begin_;
-      data_allocator::construct(begin_.cur, mystl::forward<Args>(args)...);
+      alloc_traits::construct(alloc_, begin_.cur, mystl::forward<Args>(args)...);
     }
     catch (...)
     {
@@ -575,27 +679,27 @@ void deque<T>::emplace_front(Args&& ...args)
 }
 
 // 在尾部就地构建元素
-template <class T>
+template <class T, class Alloc, size_t BufSize>
 template <class ...Args>
-void deque<T>::emplace_back(Args&& ...args)
+void deque<T, Alloc, BufSize>::emplace_back(Args&& ...args)
 {
   if (end_.cur != end_.last - 1)
   {
-    data_allocator::construct(end_.cur, mystl::forward<Args>(args)...);
+    alloc_traits::construct(alloc_, end_.cur, mystl::forward<Args>(args)...);
     ++end_.cur;
   }
   else
   {
     require_capacity(1, false);
-    data_allocator::construct(end_.cur, mystl::forward<Args>(args)...);
+    alloc_traits::construct(alloc_, end_.cur, mystl::forward<Args>(args)...);
     ++end_;
   }
 }
 
 // 在 pos 位置就地构建元素
-template <class T>
+template <class T, class Alloc, size_t BufSize>
 template <class ...Args>
-typename deque<T>::iterator deque<T>::emplace(iterator pos, Args&& ...args)
+typename deque<T, Alloc, BufSize>::iterator deque<T, Alloc, BufSize>::emplace(iterator pos, Args&& ...args)
 {
   if (pos.cur == begin_.cur)
   {
@@ -611,12 +715,12 @@ typename deque<T>::iterator deque<T>::emplace(iterator pos, Args&& ...args)
 }
 
 // 在头部插入元素
-template <class T>
-void deque<T>::push_front(const value_type& value)
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::push_front(const value_type& value)
 {
   if (begin_.cur != begin_.first)
   {
-    data_allocator::construct(begin_.cur - 1, value);
+    alloc_traits::construct(alloc_, begin_.cur - 1, value);
     --begin_.cur;
   }
   else
@@ -625,7 +729,7 @@ void deque<T>::push_front(const value_type& value)
     try
     {
       --begin_;
-      data_allocator::construct(begin_.cur, value);
+      alloc_traits::construct(alloc_, begin_.cur, value);
     }
     catch (...)
     {
@@ -636,62 +740,89 @@ void deque<T>::push_front(const value_type& value)
 }
 
 // 在尾部插入元素
-template <class T>
-void deque<T>::push_back(const value_type& value)
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::push_back(const value_type& value)
 {
   if (end_.cur != end_.last - 1)
   {
-    data_allocator::construct(end_.cur, value);
+    alloc_traits::construct(alloc_, end_.cur, value);
     ++end_.cur;
   }
   else
   {
     require_capacity(1, false);
-    data_allocator::construct(end_.cur, value);
+    alloc_traits::construct(alloc_, end_.cur, value);
     ++end_;
   }
 }
 
 // 弹出头部元素
-template <class T>
-void deque<T>::pop_front()
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::pop_front()
 {
   MYSTL_DEBUG(!empty());
   if (begin_.cur != begin_.last - 1)
   {
-    data_allocator::destroy(begin_.cur);
+    alloc_traits::destroy(alloc_, begin_.cur);
     ++begin_.cur;
   }
   else
   {
-    data_allocator::destroy(begin_.cur);
+    alloc_traits::destroy(alloc_, begin_.cur);
     ++begin_;
     destroy_buffer(begin_.node - 1, begin_.node - 1);
   }
 }
 
 // 弹出尾部元素
-template <class T>
-void deque<T>::pop_back()
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::pop_back()
 {
   MYSTL_DEBUG(!empty());
   if (end_.cur != end_.first)
   {
     --end_.cur;
-    data_allocator::destroy(end_.cur);
+    alloc_traits::destroy(alloc_, end_.cur);
   }
   else
   {
     --end_;
-    data_allocator::destroy(end_.cur);
+    alloc_traits::destroy(alloc_, end_.cur);
     destroy_buffer(end_.node + 1, end_.node + 1);
   }
 }
 
+// 把头部的 n 个元素依次移动到 out，并从 deque 中删除，返回 out 的结束位置
+// 每次处理一个缓冲区中的一段，平凡类型的元素复制到指针时使用 memmove
+template <class T, class Alloc, size_t BufSize>
+template <class OIter>
+OIter deque<T, Alloc, BufSize>::pop_front_n(OIter out, size_type n)
+{
+  MYSTL_DEBUG(n <= size());
+  while (n != 0)
+  {
+    const size_type len = mystl::min(n, static_cast<size_type>(begin_.last - begin_.cur));
+    out = mystl::move(begin_.cur, begin_.cur + len, out);
+    alloc_traits::destroy(alloc_, begin_.cur, begin_.cur + len);
+    n -= len;
+    if (begin_.cur + len != begin_.last)
+    {
+      begin_.cur += len;
+    }
+    else
+    { // 缓冲区已取空，此时 end_ 一定在后面的缓冲区中
+      begin_.set_node(begin_.node + 1);
+      begin_.cur = begin_.first;
+      destroy_buffer(begin_.node - 1, begin_.node - 1);
+    }
+  }
+  return out;
+}
+
 // 在 position 处插入元素
-template <class T>
-typename deque<T>::iterator
-deque<T>::insert(iterator position, const value_type& value)
+template <class T, class Alloc, size_t BufSize>
+typename deque<T, Alloc, BufSize>::iterator
+deque<T, Alloc, BufSize>::insert(iterator position, const value_type& value)
 {
   if (position.cur == begin_.cur)
   {
@@ -711,9 +842,9 @@ deque<T>::insert(iterator position, const value_type& value)
   }
 }
 
-template <class T>
-typename deque<T>::iterator
-deque<T>::insert(iterator position, value_type&& value)
+template <class T, class Alloc, size_t BufSize>
+typename deque<T, Alloc, BufSize>::iterator
+deque<T, Alloc, BufSize>::insert(iterator position, value_type&& value)
 {
   if (position.cur == begin_.cur)
   {
@@ -734,8 +865,8 @@ deque<T>::insert(iterator position, value_type&& value)
 }
 
 // 在 position 位置插入 n 个元素
-template <class T>
-void deque<T>::insert(iterator position, size_type n, const value_type& value)
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::insert(iterator position, size_type n, const value_type& value)
 {
   if (position.cur == begin_.cur)
   {
@@ -758,9 +889,9 @@ void deque<T>::insert(iterator position, size_type n, const value_type& value)
 }
 
 // 删除 position 处的元素
-template <class T>
-typename deque<T>::iterator
-deque<T>::erase(iterator position)
+template <class T, class Alloc, size_t BufSize>
+typename deque<T, Alloc, BufSize>::iterator
+deque<T, Alloc, BufSize>::erase(iterator position)
 {
   auto next = position;
   ++next;
@@ -779,9 +910,9 @@ deque<T>::erase(iterator position)
 }
 
 // 删除[first, last)上的元素
-template <class T>
-typename deque<T>::iterator
-deque<T>::erase(iterator first, iterator last)
+template <class T, class Alloc, size_t BufSize>
+typename deque<T, Alloc, BufSize>::iterator
+deque<T, Alloc, BufSize>::erase(iterator first, iterator last)
 {
   if (first == begin_ && last == end_)
   {
@@ -796,14 +927,18 @@ deque<T>::erase(iterator first, iterator last)
     {
       mystl::copy_backward(begin_, first, last);
       auto new_begin = begin_ + len;
-      data_allocator::destroy(begin_.cur, new_begin.cur);
+      alloc_traits::destroy(alloc_, begin_, new_begin);
+      if (begin_.node != new_begin.node)
+        destroy_buffer(begin_.node, new_begin.node - 1);
       begin_ = new_begin;
     }
     else
     {
       mystl::copy(last, end_, first);
       auto new_end = end_ - len;
-      data_allocator::destroy(new_end.cur, end_.cur);
+      alloc_traits::destroy(alloc_, new_end, end_);
+      if (new_end.node != end_.node)
+        destroy_buffer(new_end.node + 1, end_.node);
       end_ = new_end;
     }
     return begin_ + elems_before;
@@ -811,30 +946,30 @@ deque<T>::erase(iterator first, iterator last)
 }
 
 // 清空 deque
-template <class T>
-void deque<T>::clear()
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::clear()
 {
   // clear 会保留头部的缓冲区
   for (map_pointer cur = begin_.node + 1; cur < end_.node; ++cur)
   {
-    data_allocator::destroy(*cur, *cur + buffer_size);
+    alloc_traits::destroy(alloc_, *cur, *cur + buffer_size);
   }
   if (begin_.node != end_.node)
   { // 有两个以上的缓冲区
-    mystl::destroy(begin_.cur, begin_.last);
-    mystl::destroy(end_.first, end_.cur);
+    alloc_traits::destroy(alloc_, begin_.cur, begin_.last);
+    alloc_traits::destroy(alloc_, end_.first, end_.cur);
   }
   else
   {
-    mystl::destroy(begin_.cur, end_.cur);
+    alloc_traits::destroy(alloc_, begin_.cur, end_.cur);
   }
-  shrink_to_fit();
   end_ = begin_;
+  trim_buffers(true);
 }
 
 // 交换两个 deque
-template <class T>
-void deque<T>::swap(deque& rhs) noexcept
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::swap(deque& rhs) noexcept
 {
   if (this != &rhs)
   {
@@ -842,34 +977,49 @@ void deque<T>::swap(deque& rhs) noexcept
     mystl::swap(end_, rhs.end_);
     mystl::swap(map_, rhs.map_);
     mystl::swap(map_size_, rhs.map_size_);
+    for (size_type i = 0; i < mystl::max(nspare_, rhs.nspare_); ++i)
+      mystl::swap(spare_[i], rhs.spare_[i]);
+    mystl::swap(nspare_, rhs.nspare_);
+    mystl::alloc_on_swap(alloc_, rhs.alloc_);
   }
 }
 
 /*****************************************************************************************/
 // helper function
 
-template <class T>
-typename deque<T>::map_pointer
-deque<T>::create_map(size_type size)
+template <class T, class Alloc, size_t BufSize>
+typename deque<T, Alloc, BufSize>::map_pointer
+deque<T, Alloc, BufSize>::create_map(size_type size)
 {
+  map_allocator map_alloc(alloc_);
   map_pointer mp = nullptr;
-  mp = map_allocator::allocate(size);
+  mp = map_alloc_traits::allocate(map_alloc, size);
   for (size_type i = 0; i < size; ++i)
     *(mp + i) = nullptr;
   return mp;
 }
 
+// destroy_map 函数
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::
+destroy_map(map_pointer mp, size_type size)
+{
+  map_allocator map_alloc(alloc_);
+  map_alloc_traits::deallocate(map_alloc, mp, size);
+}
+
 // create_buffer 函数
-template <class T>
-void deque<T>::
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::
 create_buffer(map_pointer nstart, map_pointer nfinish)
 {
   map_pointer cur;
   try
   {
     for (cur = nstart; cur <= nfinish; ++cur)
-    {
-      *cur = data_allocator::allocate(buffer_size);
+    { // 保留在 map 中的缓冲区直接复用
+      if (*cur == nullptr)
+        *cur = get_buffer();
     }
   }
   catch (...)
@@ -877,28 +1027,100 @@ create_buffer(map_pointer nstart, map_pointer nfinish)
     while (cur != nstart)
     {
       --cur;
-      data_allocator::deallocate(*cur, buffer_size);
+      put_buffer(*cur);
       *cur = nullptr;
     }
     throw;
   }
 }
 
-// destroy_buffer 函数
-template <class T>
-void deque<T>::
+// destroy_buffer 函数，缓冲区先放回空闲缓存
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::
 destroy_buffer(map_pointer nstart, map_pointer nfinish)
 {
   for (map_pointer n = nstart; n <= nfinish; ++n)
   {
-    data_allocator::deallocate(*n, buffer_size);
+    put_buffer(*n);
     *n = nullptr;
   }
 }
 
+// destroy_all 函数，释放所有元素、缓冲区以及 map
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::
+destroy_all()
+{
+  clear();
+  alloc_traits::deallocate(alloc_, *begin_.node, buffer_size);
+  *begin_.node = nullptr;
+  release_spare();
+  destroy_map(map_, map_size_);
+  map_ = nullptr;
+  map_size_ = 0;
+}
+
+// trim_buffers 函数，释放 [begin_.node, end_.node] 之外的缓冲区，至少会留下头部缓冲区
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::
+trim_buffers(bool keep_spare) noexcept
+{
+  for (auto cur = map_; cur < map_ + map_size_; ++cur)
+  {
+    if (cur == begin_.node)
+      cur = end_.node;
+    else if (*cur != nullptr)
+    {
+      if (keep_spare)
+        put_buffer(*cur);
+      else
+        alloc_traits::deallocate(alloc_, *cur, buffer_size);
+      *cur = nullptr;
+    }
+  }
+}
+
+// get_buffer 函数，优先取用空闲缓存中的缓冲区
+template <class T, class Alloc, size_t BufSize>
+typename deque<T, Alloc, BufSize>::pointer
+deque<T, Alloc, BufSize>::get_buffer()
+{
+  if (nspare_ != 0)
+    return spare_[--nspare_];
+  return alloc_traits::allocate(alloc_, buffer_size);
+}
+
+// put_buffer 函数，空闲缓存已满时直接释放
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::put_buffer(pointer p) noexcept
+{
+  if (nspare_ < DEQUE_SPARE_BUFFERS)
+    spare_[nspare_++] = p;
+  else
+    alloc_traits::deallocate(alloc_, p, buffer_size);
+}
+
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::release_spare() noexcept
+{
+  while (nspare_ != 0)
+    alloc_traits::deallocate(alloc_, spare_[--nspare_], buffer_size);
+}
+
+// take_spare 函数，接管 rhs 的空闲缓存，调用前自身的缓存必须为空
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::take_spare(deque& rhs) noexcept
+{
+  MYSTL_DEBUG(nspare_ == 0);
+  for (size_type i = 0; i < rhs.nspare_; ++i)
+    spare_[i] = rhs.spare_[i];
+  nspare_ = rhs.nspare_;
+  rhs.nspare_ = 0;
+}
+
 // map_init 函数
-template <class T>
-void deque<T>::
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::
 map_init(size_type nElem)
 {
   const size_type nNode = nElem / buffer_size + 1;  // 需要分配的缓冲区个数
@@ -923,7 +1145,7 @@ map_init(size_type nElem)
   }
   catch (...)
   {
-    map_allocator::deallocate(map_, map_size_);
+    destroy_map(map_, map_size_);
     map_ = nullptr;
     map_size_ = 0;
     throw;
@@ -935,8 +1157,8 @@ map_init(size_type nElem)
 }
 
 // fill_init 函数
-template <class T>
-void deque<T>::
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::
 fill_init(size_type n, const value_type& value)
 {
   map_init(n);
@@ -951,9 +1173,9 @@ fill_init(size_type n, const value_type& value)
 }
 
 // copy_init 函数
-template <class T>
+template <class T, class Alloc, size_t BufSize>
 template <class IIter>
-void deque<T>::
+void deque<T, Alloc, BufSize>::
 copy_init(IIter first, IIter last, input_iterator_tag)
 {
   const size_type n = mystl::distance(first, last);
@@ -962,9 +1184,9 @@ copy_init(IIter first, IIter last, input_iterator_tag)
     emplace_back(*first);
 }
 
-template <class T>
+template <class T, class Alloc, size_t BufSize>
 template <class FIter>
-void deque<T>::
+void deque<T, Alloc, BufSize>::
 copy_init(FIter first, FIter last, forward_iterator_tag)
 {
   const size_type n = mystl::distance(first, last);
@@ -980,8 +1202,8 @@ copy_init(FIter first, FIter last, forward_iterator_tag)
 }
 
 // fill_assign 函数
-template <class T>
-void deque<T>::
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::
 fill_assign(size_type n, const value_type& value)
 {
   if (n > size())
@@ -997,9 +1219,9 @@ fill_assign(size_type n, const value_type& value)
 }
 
 // copy_assign 函数
-template <class T>
+template <class T, class Alloc, size_t BufSize>
 template <class IIter>
-void deque<T>::
+void deque<T, Alloc, BufSize>::
 copy_assign(IIter first, IIter last, input_iterator_tag)
 {
   auto first1 = begin();
@@ -1018,9 +1240,9 @@ copy_assign(IIter first, IIter last, input_iterator_tag)
   }
 }
 
-template <class T>
+template <class T, class Alloc, size_t BufSize>
 template <class FIter>
-void deque<T>::
+void deque<T, Alloc, BufSize>::
 copy_assign(FIter first, FIter last, forward_iterator_tag)
 {  
   const size_type len1 = size();
@@ -1039,10 +1261,10 @@ copy_assign(FIter first, FIter last, forward_iterator_tag)
 }
 
 // insert_aux 函数
-template <class T>
+template <class T, class Alloc, size_t BufSize>
 template <class... Args>
-typename deque<T>::iterator
-deque<T>::
+typename deque<T, Alloc, BufSize>::iterator
+deque<T, Alloc, BufSize>::
 insert_aux(iterator position, Args&& ...args)
 {
   const size_type elems_before = position - begin_;
@@ -1074,8 +1296,8 @@ insert_aux(iterator position, Args&& ...args)
 }
 
 // fill_insert 函数
-template <class T>
-void deque<T>::
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::
 fill_insert(iterator position, size_type n, const value_type& value)
 {
   const size_type elems_before = position - begin_;
@@ -1149,9 +1371,9 @@ fill_insert(iterator position, size_type n, const value_type& value)
 }
 
 // copy_insert
-template <class T>
+template <class T, class Alloc, size_t BufSize>
 template <class FIter>
-void deque<T>::
+void deque<T, Alloc, BufSize>::
 copy_insert(iterator position, FIter first, FIter last, size_type n)
 {
   const size_type elems_before = position - begin_;
@@ -1228,9 +1450,9 @@ copy_insert(iterator position, FIter first, FIter last, size_type n)
 }
 
 // insert_dispatch 函数
-template <class T>
+template <class T, class Alloc, size_t BufSize>
 template <class IIter>
-void deque<T>::
+void deque<T, Alloc, BufSize>::
 insert_dispatch(iterator position, IIter first, IIter last, input_iterator_tag)
 {
   if (last <= first)  return;
@@ -1252,9 +1474,9 @@ insert_dispatch(iterator position, IIter first, IIter last, input_iterator_tag)
   }
 }
 
-template <class T>
+template <class T, class Alloc, size_t BufSize>
 template <class FIter>
-void deque<T>::
+void deque<T, Alloc, BufSize>::
 insert_dispatch(iterator position, FIter first, FIter last, forward_iterator_tag)
 {
   if (last <= first)  return;
@@ -1297,9 +1519,53 @@ insert_dispatch(iterator position, FIter first, FIter last, forward_iterator_tag
   }
 }
 
+// push_back_dispatch 函数
+template <class T, class Alloc, size_t BufSize>
+template <class IIter>
+void deque<T, Alloc, BufSize>::
+push_back_dispatch(IIter first, IIter last, input_iterator_tag)
+{
+  for (; first != last; ++first)
+    emplace_back(*first);
+}
+
+// 先一次性准备好缓冲区，再逐个缓冲区构造，平凡类型从指针复制时使用 memmove
+template <class T, class Alloc, size_t BufSize>
+template <class FIter>
+void deque<T, Alloc, BufSize>::
+push_back_dispatch(FIter first, FIter last, forward_iterator_tag)
+{
+  size_type n = mystl::distance(first, last);
+  if (n == 0)  return;
+  require_capacity(n, false);
+  const auto new_end = end_ + n;
+  auto cur = end_;
+  try
+  {
+    while (n != 0)
+    {
+      const size_type len = mystl::min(n, static_cast<size_type>(cur.last - cur.cur));
+      auto next = first;
+      mystl::advance(next, len);
+      mystl::uninitialized_copy(first, next, cur.cur);
+      first = next;
+      n -= len;
+      cur += len;
+    }
+    end_ = new_end;
+  }
+  catch (...)
+  {
+    alloc_traits::destroy(alloc_, end_, cur);
+    if (new_end.node != end_.node)
+      destroy_buffer(end_.node + 1, new_end.node);
+    throw;
+  }
+}
+
 // require_capacity 函数
-template <class T>
-void deque<T>::require_capacity(size_type n, bool front)
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::require_capacity(size_type n, bool front)
 {
   if (front && (static_cast<size_type>(begin_.cur - begin_.first) < n))
   {
@@ -1324,25 +1590,33 @@ void deque<T>::require_capacity(size_type n, bool front)
 }
 
 // reallocate_map_at_front 函数
-template <class T>
-void deque<T>::reallocate_map_at_front(size_type need_buffer)
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::reallocate_map_at_front(size_type need_buffer)
 {
+  // require_capacity 多申请的缓冲区不在新的 map 中，先收回
+  trim_buffers(true);
+  const size_type old_buffer = end_.node - begin_.node + 1;
+  const size_type new_buffer = old_buffer + need_buffer;
+  if (map_size_ > 2 * new_buffer)
+  { // map 有一半以上空闲，把节点移回中央，复用原来的 map
+    map_pointer nstart = map_ + (map_size_ - new_buffer) / 2 + need_buffer;
+    recenter_map(nstart);
+    create_buffer(nstart - need_buffer, nstart - 1);
+    return;
+  }
   const size_type new_map_size = mystl::max(map_size_ << 1,
                                             map_size_ + need_buffer + DEQUE_MAP_INIT_SIZE);
   map_pointer new_map = create_map(new_map_size);
-  const size_type old_buffer = end_.node - begin_.node + 1;
-  const size_type new_buffer = old_buffer + need_buffer;
 
   // 另新的 map 中的指针指向原来的 buffer，并开辟新的 buffer
   auto begin = new_map + (new_map_size - new_buffer) / 2;
   auto mid = begin + need_buffer;
   auto end = mid + old_buffer;
   create_buffer(begin, mid - 1);
-  for (auto begin1 = mid, begin2 = begin_.node; begin1 != end; ++begin1, ++begin2)
-    *begin1 = *begin2;
+  mystl::uninitialized_relocate(begin_.node, end_.node + 1, mid);
 
   // 更新数据
-  map_allocator::deallocate(map_, map_size_);
+  destroy_map(map_, map_size_);
   map_ = new_map;
   map_size_ = new_map_size;
   begin_ = iterator(*mid + (begin_.cur - begin_.first), mid);
@@ -1350,77 +1624,115 @@ void deque<T>::reallocate_map_at_front(size_type need_buffer)
 }
 
 // reallocate_map_at_back 函数
-template <class T>
-void deque<T>::reallocate_map_at_back(size_type need_buffer)
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::reallocate_map_at_back(size_type need_buffer)
 {
+  // require_capacity 多申请的缓冲区不在新的 map 中，先收回
+  trim_buffers(true);
+  const size_type old_buffer = end_.node - begin_.node + 1;
+  const size_type new_buffer = old_buffer + need_buffer;
+  if (map_size_ > 2 * new_buffer)
+  { // map 有一半以上空闲，把节点移回中央，复用原来的 map
+    map_pointer nstart = map_ + (map_size_ - new_buffer) / 2;
+    recenter_map(nstart);
+    create_buffer(nstart + old_buffer, nstart + new_buffer - 1);
+    return;
+  }
   const size_type new_map_size = mystl::max(map_size_ << 1,
                                             map_size_ + need_buffer + DEQUE_MAP_INIT_SIZE);
   map_pointer new_map = create_map(new_map_size);
-  const size_type old_buffer = end_.node - begin_.node + 1;
-  const size_type new_buffer = old_buffer + need_buffer;
 
   // 另新的 map 中的指针指向原来的 buffer，并开辟新的 buffer
   auto begin = new_map + ((new_map_size - new_buffer) / 2);
   auto mid = begin + old_buffer;
   auto end = mid + need_buffer;
-  for (auto begin1 = begin, begin2 = begin_.node; begin1 != mid; ++begin1, ++begin2)
-    *begin1 = *begin2;
+  mystl::uninitialized_relocate(begin_.node, end_.node + 1, begin);
   create_buffer(mid, end - 1);
 
   // 更新数据
-  map_allocator::deallocate(map_, map_size_);
+  destroy_map(map_, map_size_);
   map_ = new_map;
   map_size_ = new_map_size;
   begin_ = iterator(*begin + (begin_.cur - begin_.first), begin);
   end_ = iterator(*(mid - 1) + (end_.cur - end_.first), mid - 1);
 }
 
+// recenter_map 函数，把 [begin_.node, end_.node] 移到从 nstart 开始的位置
+template <class T, class Alloc, size_t BufSize>
+void deque<T, Alloc, BufSize>::recenter_map(map_pointer nstart) noexcept
+{
+  const size_type old_buffer = end_.node - begin_.node + 1;
+  const difference_type begin_off = begin_.cur - begin_.first;
+  const difference_type end_off = end_.cur - end_.first;
+  map_pointer old_start = begin_.node;
+  if (nstart < old_start)
+    mystl::copy(old_start, old_start + old_buffer, nstart);
+  else
+    mystl::copy_backward(old_start, old_start + old_buffer, nstart + old_buffer);
+  // 没有被覆盖的旧节点置空，map 中只有 [begin_.node, end_.node] 持有缓冲区
+  for (map_pointer cur = old_start; cur < old_start + old_buffer; ++cur)
+  {
+    if (cur < nstart || cur >= nstart + old_buffer)
+      *cur = nullptr;
+  }
+  begin_ = iterator(*nstart + begin_off, nstart);
+  end_ = iterator(*(nstart + old_buffer - 1) + end_off, nstart + old_buffer - 1);
+}
+
 // 重载比较操作符
-template <class T>
-bool operator==(const deque<T>& lhs, const deque<T>& rhs)
+template <class T, class Alloc, size_t BufSize>
+bool operator==(const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs)
 {
   return lhs.size() == rhs.size() && 
     mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template <class T>
-bool operator<(const deque<T>& lhs, const deque<T>& rhs)
+template <class T, class Alloc, size_t BufSize>
+bool operator<(const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs)
 {
   return mystl::lexicographical_compare(
     lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
-template <class T>
-bool operator!=(const deque<T>& lhs, const deque<T>& rhs)
+template <class T, class Alloc, size_t BufSize>
+bool operator!=(const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class T>
-bool operator>(const deque<T>& lhs, const deque<T>& rhs)
+template <class T, class Alloc, size_t BufSize>
+bool operator>(const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class T>
-bool operator<=(const deque<T>& lhs, const deque<T>& rhs)
+template <class T, class Alloc, size_t BufSize>
+bool operator<=(const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class T>
-bool operator>=(const deque<T>& lhs, const deque<T>& rhs)
+template <class T, class Alloc, size_t BufSize>
+bool operator>=(const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs)
 {
   return !(lhs < rhs);
 }
 
 // 重载 mystl 的 swap
-template <class T>
-void swap(deque<T>& lhs, deque<T>& rhs)
+template <class T, class Alloc, size_t BufSize>
+void swap(deque<T, Alloc, BufSize>& lhs, deque<T, Alloc, BufSize>& rhs)
 {
   lhs.swap(rhs);
 }
 
+// deque 的迭代器与 map 都指向堆上的空间，分配器可以平凡搬移时 deque 也可以
+template <class T, class Alloc, size_t BufSize>
+struct is_trivially_relocatable<deque<T, Alloc, BufSize>> : mystl::is_trivially_relocatable<Alloc> {};
+
+// 每一个缓冲区都按 Align bytes 对齐、补齐到 Align 整数倍的 deque
+template <class T, size_t Align = ESimdAlign>
+using aligned_deque = deque<T, aligned_allocator<T, Align>>;
+
 } // namespace mystl
 #endif // !MYTINYSTL_DEQUE_H_
 
@@ -0,0 +1,707 @@
+#ifndef MYTINYSTL_DYNAMIC_BITSET_H_
+#define MYTINYSTL_DYNAMIC_BITSET_H_
+
+// 这个头文件包含一个模板类 dynamic_bitset
+// dynamic_bitset : 大小可变的位集合，代替 mystl 中被放弃的 vector<bool>
+
+// notes:
+//
+// 每一位只占 1 bit，按 64 位的字(word)保存在 mystl::vector<uint64_t> 中，
+// 最后一个字中超出 size() 的位总是为 0，这样 count、find、比较都可以按整字处理。
+// 参考 SGI STL 的 stl_bvector.h（_Bit_reference）与 bitset（_M_do_find_first / _M_do_find_next）。
+//
+// count、find_first / find_next、以及批量的 &=、|=、^=、-= 由 bit_kernel 实现，
+// 有逐字的实现与 AVX2 的实现：GCC / Clang 在 x86-64 上用 target 属性单独编译 AVX2 的版本，
+// 运行时检查 CPU 是否支持 AVX2 再决定使用哪一个，不需要额外的编译选项。
+// 定义 MYSTL_NO_AVX2 后只使用逐字的实现
+
+#include <cstdint>
+
+#include "vector.h"
+#include "exceptdef.h"
+
+#if !defined(MYSTL_NO_AVX2) && (defined(__GNUC__) || defined(__clang__)) && \
+    defined(__x86_64__)
+#define MYSTL_BITSET_AVX2 1
+#include <immintrin.h>
+#else
+#define MYSTL_BITSET_AVX2 0
+#endif
+
+namespace mystl
+{
+
+// 每个字的位数
+enum { EBitsPerWord = 64 };
+
+/*****************************************************************************************/
+// bit_kernel
+// 对连续的 n 个字做统计、查找与批量运算，所有函数都是静态的
+// xxx_word 为逐字的实现，xxx_avx2 为 AVX2 的实现（CPU 不支持时不能调用），xxx 按 CPU 选择其一
+/*****************************************************************************************/
+
+class bit_kernel
+{
+public:
+  typedef uint64_t word_type;
+
+  // CPU 是否支持 AVX2，只检查一次
+  static bool has_avx2() noexcept;
+
+  // 1 的个数
+  static size_t count(const word_type* p, size_t n) noexcept;
+  static size_t count_word(const word_type* p, size_t n) noexcept;
+
+  // 从第 from 个字开始第一个不为 0 的字，找不到时返回 n
+  static size_t find_nonzero(const word_type* p, size_t n, size_t from) noexcept;
+  static size_t find_nonzero_word(const word_type* p, size_t n, size_t from) noexcept;
+
+  // dst[i] op= src[i]，andnot 为 dst[i] &= ~src[i]
+  static void and_words(word_type* dst, const word_type* src, size_t n) noexcept;
+  static void or_words(word_type* dst, const word_type* src, size_t n) noexcept;
+  static void xor_words(word_type* dst, const word_type* src, size_t n) noexcept;
+  static void andnot_words(word_type* dst, const word_type* src, size_t n) noexcept;
+  static void and_words_word(word_type* dst, const word_type* src, size_t n) noexcept;
+  static void or_words_word(word_type* dst, const word_type* src, size_t n) noexcept;
+  static void xor_words_word(word_type* dst, const word_type* src, size_t n) noexcept;
+  static void andnot_words_word(word_type* dst, const word_type* src, size_t n) noexcept;
+
+#if MYSTL_BITSET_AVX2
+  static size_t count_avx2(const word_type* p, size_t n) noexcept;
+  static size_t find_nonzero_avx2(const word_type* p, size_t n, size_t from) noexcept;
+  static void and_words_avx2(word_type* dst, const word_type* src, size_t n) noexcept;
+  static void or_words_avx2(word_type* dst, const word_type* src, size_t n) noexcept;
+  static void xor_words_avx2(word_type* dst, const word_type* src, size_t n) noexcept;
+  static void andnot_words_avx2(word_type* dst, const word_type* src, size_t n) noexcept;
+#endif // MYSTL_BITSET_AVX2
+
+  // 一个字中 1 的个数与最低位的 1 的位置（w 不能为 0）
+  static size_t popcount(word_type w) noexcept;
+  static size_t lowest_bit(word_type w) noexcept;
+};
+
+inline bool bit_kernel::has_avx2() noexcept
+{
+#if MYSTL_BITSET_AVX2
+  static const bool avx2 = __builtin_cpu_supports("avx2") != 0;
+  return avx2;
+#else
+  return false;
+#endif
+}
+
+inline size_t bit_kernel::popcount(word_type w) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<size_t>(__builtin_popcountll(w));
+#else
+  w = w - ((w >> 1) & 0x5555555555555555ULL);
+  w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+  w = (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return static_cast<size_t>((w * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+inline size_t bit_kernel::lowest_bit(word_type w) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<size_t>(__builtin_ctzll(w));
+#else
+  size_t n = 0;
+  while ((w & 1) == 0)
+  {
+    w >>= 1;
+    ++n;
+  }
+  return n;
+#endif
+}
+
+inline size_t bit_kernel::count_word(const word_type* p, size_t n) noexcept
+{
+  size_t r = 0;
+  for (size_t i = 0; i < n; ++i)
+    r += popcount(p[i]);
+  return r;
+}
+
+inline size_t bit_kernel::find_nonzero_word(const word_type* p, size_t n, size_t from) noexcept
+{
+  for (size_t i = from; i < n; ++i)
+  {
+    if (p[i] != 0)
+      return i;
+  }
+  return n;
+}
+
+inline void bit_kernel::and_words_word(word_type* dst, const word_type* src, size_t n) noexcept
+{
+  for (size_t i = 0; i < n; ++i)
+    dst[i] &= src[i];
+}
+
+inline void bit_kernel::or_words_word(word_type* dst, const word_type* src, size_t n) noexcept
+{
+  for (size_t i = 0; i < n; ++i)
+    dst[i] |= src[i];
+}
+
+inline void bit_kernel::xor_words_word(word_type* dst, const word_type* src, size_t n) noexcept
+{
+  for (size_t i = 0; i < n; ++i)
+    dst[i] ^= src[i];
+}
+
+inline void bit_kernel::andnot_words_word(word_type* dst, const word_type* src, size_t n) noexcept
+{
+  for (size_t i = 0; i < n; ++i)
+    dst[i] &= ~src[i];
+}
+
+#if MYSTL_BITSET_AVX2
+
+// 每次处理 4 个字：按半字节查表得到每个字节的 1 的个数，再用 sad 把字节累加到 64 位
+__attribute__((target("avx2,popcnt")))
+inline size_t bit_kernel::count_avx2(const word_type* p, size_t n) noexcept
+{
+  const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                          0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_mask = _mm256_set1_epi8(0x0f);
+  __m256i acc = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+    const __m256i lo = _mm256_and_si256(v, low_mask);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    const __m256i c = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                      _mm256_shuffle_epi8(lookup, hi));
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(c, _mm256_setzero_si256()));
+  }
+  size_t r = static_cast<size_t>(_mm256_extract_epi64(acc, 0)) +
+    static_cast<size_t>(_mm256_extract_epi64(acc, 1)) +
+    static_cast<size_t>(_mm256_extract_epi64(acc, 2)) +
+    static_cast<size_t>(_mm256_extract_epi64(acc, 3));
+  for (; i < n; ++i)
+    r += popcount(p[i]);
+  return r;
+}
+
+// 每次检查 4 个字是否全为 0，不全为 0 时再逐字查找
+__attribute__((target("avx2")))
+inline size_t bit_kernel::find_nonzero_avx2(const word_type* p, size_t n, size_t from) noexcept
+{
+  size_t i = from;
+  for (; i + 4 <= n; i += 4)
+  {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+    if (!_mm256_testz_si256(v, v))
+      break;
+  }
+  return find_nonzero_word(p, n, i);
+}
+
+#define MYSTL_BITSET_AVX2_BINARY(NAME, EXPR)                                        \
+__attribute__((target("avx2")))                                                     \
+inline void bit_kernel::NAME##_avx2(word_type* dst, const word_type* src, size_t n) noexcept \
+{                                                                                   \
+  size_t i = 0;                                                                     \
+  for (; i + 4 <= n; i += 4)                                                        \
+  {                                                                                 \
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));\
+    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));\
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), EXPR);                 \
+  }                                                                                 \
+  NAME##_word(dst + i, src + i, n - i);                                             \
+}
+
+MYSTL_BITSET_AVX2_BINARY(and_words, _mm256_and_si256(a, b))
+MYSTL_BITSET_AVX2_BINARY(or_words, _mm256_or_si256(a, b))
+MYSTL_BITSET_AVX2_BINARY(xor_words, _mm256_xor_si256(a, b))
+MYSTL_BITSET_AVX2_BINARY(andnot_words, _mm256_andnot_si256(b, a))
+
+#undef MYSTL_BITSET_AVX2_BINARY
+
+inline size_t bit_kernel::count(const word_type* p, size_t n) noexcept
+{
+  return has_avx2() ? count_avx2(p, n) : count_word(p, n);
+}
+
+inline size_t bit_kernel::find_nonzero(const word_type* p, size_t n, size_t from) noexcept
+{
+  return has_avx2() ? find_nonzero_avx2(p, n, from) : find_nonzero_word(p, n, from);
+}
+
+inline void bit_kernel::and_words(word_type* dst, const word_type* src, size_t n) noexcept
+{
+  if (has_avx2())
+    and_words_avx2(dst, src, n);
+  else
+    and_words_word(dst, src, n);
+}
+
+inline void bit_kernel::or_words(word_type* dst, const word_type* src, size_t n) noexcept
+{
+  if (has_avx2())
+    or_words_avx2(dst, src, n);
+  else
+    or_words_word(dst, src, n);
+}
+
+inline void bit_kernel::xor_words(word_type* dst, const word_type* src, size_t n) noexcept
+{
+  if (has_avx2())
+    xor_words_avx2(dst, src, n);
+  else
+    xor_words_word(dst, src, n);
+}
+
+inline void bit_kernel::andnot_words(word_type* dst, const word_type* src, size_t n) noexcept
+{
+  if (has_avx2())
+    andnot_words_avx2(dst, src, n);
+  else
+    andnot_words_word(dst, src, n);
+}
+
+#else // !MYSTL_BITSET_AVX2
+
+inline size_t bit_kernel::count(const word_type* p, size_t n) noexcept
+{ return count_word(p, n); }
+
+inline size_t bit_kernel::find_nonzero(const word_type* p, size_t n, size_t from) noexcept
+{ return find_nonzero_word(p, n, from); }
+
+inline void bit_kernel::and_words(word_type* dst, const word_type* src, size_t n) noexcept
+{ and_words_word(dst, src, n); }
+
+inline void bit_kernel::or_words(word_type* dst, const word_type* src, size_t n) noexcept
+{ or_words_word(dst, src, n); }
+
+inline void bit_kernel::xor_words(word_type* dst, const word_type* src, size_t n) noexcept
+{ xor_words_word(dst, src, n); }
+
+inline void bit_kernel::andnot_words(word_type* dst, const word_type* src, size_t n) noexcept
+{ andnot_words_word(dst, src, n); }
+
+#endif // MYSTL_BITSET_AVX2
+
+/*****************************************************************************************/
+
+// 类: bit_reference
+// 代表 dynamic_bitset 中的一位，参考 SGI STL 的 _Bit_reference
+class bit_reference
+{
+public:
+  typedef uint64_t word_type;
+
+private:
+  word_type* p_;
+  word_type  mask_;
+
+public:
+  bit_reference(word_type* p, word_type mask) noexcept
+    :p_(p), mask_(mask)
+  {
+  }
+
+  operator bool() const noexcept { return (*p_ & mask_) != 0; }
+  bool operator~() const noexcept { return (*p_ & mask_) == 0; }
+
+  bit_reference& operator=(bool x) noexcept
+  {
+    if (x)
+      *p_ |= mask_;
+    else
+      *p_ &= ~mask_;
+    return *this;
+  }
+
+  bit_reference& operator=(const bit_reference& x) noexcept
+  { return *this = bool(x); }
+
+  bit_reference& flip() noexcept
+  {
+    *p_ ^= mask_;
+    return *this;
+  }
+};
+
+// 模板类: dynamic_bitset
+// 模板参数 Alloc 代表字的分配器类型
+template <class Alloc = mystl::allocator<uint64_t>>
+class dynamic_bitset
+{
+public:
+  // dynamic_bitset 的嵌套型别定义
+  typedef Alloc                                    allocator_type;
+  typedef uint64_t                                 word_type;
+  typedef size_t                                   size_type;
+  typedef bit_reference                            reference;
+  typedef bool                                     const_reference;
+
+  static_assert(std::is_same<typename mystl::allocator_traits<Alloc>::value_type,
+                word_type>::value, "dynamic_bitset requires an allocator of uint64_t");
+
+  // 查找失败时的返回值
+  static const size_type npos = static_cast<size_type>(-1);
+
+  allocator_type get_allocator() const { return words_.get_allocator(); }
+
+private:
+  mystl::vector<word_type, Alloc> words_;  // 保存所有的位，words_.size() 为 size() 需要的字数
+  size_type                       nbits_;  // 位数
+
+public:
+  // 构造、复制、移动、析构函数
+  dynamic_bitset() noexcept
+    :nbits_(0)
+  {
+  }
+
+  explicit dynamic_bitset(const allocator_type& alloc) noexcept
+    :words_(alloc), nbits_(0)
+  {
+  }
+
+  explicit dynamic_bitset(size_type n, bool value = false,
+                          const allocator_type& alloc = allocator_type())
+    :words_(word_count(n), value ? ~word_type(0) : word_type(0), alloc), nbits_(n)
+  {
+    clear_tail();
+  }
+
+  dynamic_bitset(const dynamic_bitset& rhs) = default;
+  dynamic_bitset& operator=(const dynamic_bitset& rhs) = default;
+
+  dynamic_bitset(dynamic_bitset&& rhs) noexcept
+    :words_(mystl::move(rhs.words_)), nbits_(rhs.nbits_)
+  {
+    rhs.nbits_ = 0;
+  }
+
+  dynamic_bitset& operator=(dynamic_bitset&& rhs)
+  {
+    if (this != &rhs)
+    {
+      words_ = mystl::move(rhs.words_);
+      nbits_ = rhs.nbits_;
+      rhs.words_.clear();
+      rhs.nbits_ = 0;
+    }
+    return *this;
+  }
+
+public:
+  // 容量相关操作
+  bool      empty()     const noexcept { return nbits_ == 0; }
+  size_type size()      const noexcept { return nbits_; }
+  size_type num_words() const noexcept { return words_.size(); }
+  size_type capacity()  const noexcept { return words_.capacity() * EBitsPerWord; }
+  void      reserve(size_type n)       { words_.reserve(word_count(n)); }
+  void      shrink_to_fit()            { words_.shrink_to_fit(); }
+
+  // 按字访问
+  word_type*       data()       noexcept { return words_.data(); }
+  const word_type* data() const noexcept { return words_.data(); }
+
+  // 访问元素相关操作
+  reference operator[](size_type pos) noexcept
+  {
+    MYSTL_DEBUG(pos < size());
+    return reference(word_of(pos), mask_of(pos));
+  }
+  bool      operator[](size_type pos) const noexcept
+  {
+    MYSTL_DEBUG(pos < size());
+    return (*word_of(pos) & mask_of(pos)) != 0;
+  }
+  bool      test(size_type pos) const
+  {
+    THROW_OUT_OF_RANGE_IF(!(pos < size()), "dynamic_bitset::test() subscript out of range");
+    return (*this)[pos];
+  }
+
+  // 修改容器相关操作
+  dynamic_bitset& set() noexcept;
+  dynamic_bitset& set(size_type pos, bool value = true);
+  dynamic_bitset& reset() noexcept;
+  dynamic_bitset& reset(size_type pos);
+  dynamic_bitset& flip() noexcept;
+  dynamic_bitset& flip(size_type pos);
+
+  void resize(size_type n, bool value = false);
+  void push_back(bool value);
+  void pop_back();
+  void clear() noexcept
+  {
+    words_.clear();
+    nbits_ = 0;
+  }
+
+  void swap(dynamic_bitset& rhs) noexcept
+  {
+    words_.swap(rhs.words_);
+    mystl::swap(nbits_, rhs.nbits_);
+  }
+
+  // 统计与查找
+
+  size_type count() const noexcept
+  { return bit_kernel::count(words_.data(), words_.size()); }
+
+  bool any()  const noexcept
+  { return bit_kernel::find_nonzero(words_.data(), words_.size(), 0) != words_.size(); }
+  bool none() const noexcept { return !any(); }
+  bool all()  const noexcept { return count() == nbits_; }
+
+  // 第一个为 1 的位置，没有时返回 npos
+  size_type find_first() const noexcept;
+  // pos 之后第一个为 1 的位置，没有时返回 npos
+  size_type find_next(size_type pos) const noexcept;
+
+  // 位运算，两个 dynamic_bitset 的大小必须相同
+
+  dynamic_bitset& operator&=(const dynamic_bitset& rhs) noexcept;
+  dynamic_bitset& operator|=(const dynamic_bitset& rhs) noexcept;
+  dynamic_bitset& operator^=(const dynamic_bitset& rhs) noexcept;
+  // 去掉 rhs 中为 1 的位
+  dynamic_bitset& operator-=(const dynamic_bitset& rhs) noexcept;
+
+  dynamic_bitset  operator~() const
+  {
+    dynamic_bitset tmp(*this);
+    tmp.flip();
+    return tmp;
+  }
+
+private:
+  // helper functions
+
+  static size_type word_count(size_type n) noexcept
+  { return (n + EBitsPerWord - 1) / EBitsPerWord; }
+
+  word_type* word_of(size_type pos) noexcept
+  { return words_.data() + pos / EBitsPerWord; }
+  const word_type* word_of(size_type pos) const noexcept
+  { return words_.data() + pos / EBitsPerWord; }
+
+  static word_type mask_of(size_type pos) noexcept
+  { return word_type(1) << (pos % EBitsPerWord); }
+
+  // 把最后一个字中超出 size() 的位清零
+  void clear_tail() noexcept;
+};
+
+template <class Alloc>
+const typename dynamic_bitset<Alloc>::size_type dynamic_bitset<Alloc>::npos;
+
+/*****************************************************************************************/
+
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::set() noexcept
+{
+  mystl::fill(words_.begin(), words_.end(), ~word_type(0));
+  clear_tail();
+  return *this;
+}
+
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::set(size_type pos, bool value)
+{
+  THROW_OUT_OF_RANGE_IF(!(pos < size()), "dynamic_bitset::set() subscript out of range");
+  (*this)[pos] = value;
+  return *this;
+}
+
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::reset() noexcept
+{
+  mystl::fill(words_.begin(), words_.end(), word_type(0));
+  return *this;
+}
+
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::reset(size_type pos)
+{
+  THROW_OUT_OF_RANGE_IF(!(pos < size()), "dynamic_bitset::reset() subscript out of range");
+  *word_of(pos) &= ~mask_of(pos);
+  return *this;
+}
+
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::flip() noexcept
+{
+  for (auto it = words_.begin(); it != words_.end(); ++it)
+    *it = ~*it;
+  clear_tail();
+  return *this;
+}
+
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::flip(size_type pos)
+{
+  THROW_OUT_OF_RANGE_IF(!(pos < size()), "dynamic_bitset::flip() subscript out of range");
+  *word_of(pos) ^= mask_of(pos);
+  return *this;
+}
+
+// 改变位数，新增的位为 value
+template <class Alloc>
+void dynamic_bitset<Alloc>::resize(size_type n, bool value)
+{
+  const size_type old_bits = nbits_;
+  words_.resize(word_count(n), value ? ~word_type(0) : word_type(0));
+  nbits_ = n;
+  if (value && n > old_bits && old_bits % EBitsPerWord != 0)
+  { // 原来最后一个字中空着的位
+    words_[old_bits / EBitsPerWord] |= ~word_type(0) << (old_bits % EBitsPerWord);
+  }
+  clear_tail();
+}
+
+template <class Alloc>
+void dynamic_bitset<Alloc>::push_back(bool value)
+{
+  if (nbits_ % EBitsPerWord == 0)
+    words_.push_back(word_type(0));
+  ++nbits_;
+  if (value)
+    *word_of(nbits_ - 1) |= mask_of(nbits_ - 1);
+}
+
+template <class Alloc>
+void dynamic_bitset<Alloc>::pop_back()
+{
+  MYSTL_DEBUG(!empty());
+  --nbits_;
+  if (nbits_ % EBitsPerWord == 0)
+    words_.pop_back();
+  else
+    *word_of(nbits_) &= ~mask_of(nbits_);
+}
+
+template <class Alloc>
+typename dynamic_bitset<Alloc>::size_type
+dynamic_bitset<Alloc>::find_first() const noexcept
+{
+  const size_type n = words_.size();
+  const size_type i = bit_kernel::find_nonzero(words_.data(), n, 0);
+  return i == n ? npos : i * EBitsPerWord + bit_kernel::lowest_bit(words_[i]);
+}
+
+// 先检查 pos 所在字中更高的位，再按字查找
+template <class Alloc>
+typename dynamic_bitset<Alloc>::size_type
+dynamic_bitset<Alloc>::find_next(size_type pos) const noexcept
+{
+  if (pos == npos || ++pos >= nbits_)
+    return npos;
+  const size_type n = words_.size();
+  const size_type w = pos / EBitsPerWord;
+  const word_type rest = words_[w] & (~word_type(0) << (pos % EBitsPerWord));
+  if (rest != 0)
+    return w * EBitsPerWord + bit_kernel::lowest_bit(rest);
+  const size_type i = bit_kernel::find_nonzero(words_.data(), n, w + 1);
+  return i == n ? npos : i * EBitsPerWord + bit_kernel::lowest_bit(words_[i]);
+}
+
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::operator&=(const dynamic_bitset& rhs) noexcept
+{
+  MYSTL_DEBUG(size() == rhs.size());
+  bit_kernel::and_words(words_.data(), rhs.words_.data(), words_.size());
+  return *this;
+}
+
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::operator|=(const dynamic_bitset& rhs) noexcept
+{
+  MYSTL_DEBUG(size() == rhs.size());
+  bit_kernel::or_words(words_.data(), rhs.words_.data(), words_.size());
+  return *this;
+}
+
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::operator^=(const dynamic_bitset& rhs) noexcept
+{
+  MYSTL_DEBUG(size() == rhs.size());
+  bit_kernel::xor_words(words_.data(), rhs.words_.data(), words_.size());
+  return *this;
+}
+
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::operator-=(const dynamic_bitset& rhs) noexcept
+{
+  MYSTL_DEBUG(size() == rhs.size());
+  bit_kernel::andnot_words(words_.data(), rhs.words_.data(), words_.size());
+  return *this;
+}
+
+template <class Alloc>
+void dynamic_bitset<Alloc>::clear_tail() noexcept
+{
+  if (nbits_ % EBitsPerWord != 0)
+    words_.back() &= ~(~word_type(0) << (nbits_ % EBitsPerWord));
+}
+
+/*****************************************************************************************/
+// 重载位运算与比较操作符
+
+template <class Alloc>
+dynamic_bitset<Alloc> operator&(const dynamic_bitset<Alloc>& lhs, const dynamic_bitset<Alloc>& rhs)
+{
+  dynamic_bitset<Alloc> tmp(lhs);
+  tmp &= rhs;
+  return tmp;
+}
+
+template <class Alloc>
+dynamic_bitset<Alloc> operator|(const dynamic_bitset<Alloc>& lhs, const dynamic_bitset<Alloc>& rhs)
+{
+  dynamic_bitset<Alloc> tmp(lhs);
+  tmp |= rhs;
+  return tmp;
+}
+
+template <class Alloc>
+dynamic_bitset<Alloc> operator^(const dynamic_bitset<Alloc>& lhs, const dynamic_bitset<Alloc>& rhs)
+{
+  dynamic_bitset<Alloc> tmp(lhs);
+  tmp ^= rhs;
+  return tmp;
+}
+
+template <class Alloc>
+dynamic_bitset<Alloc> operator-(const dynamic_bitset<Alloc>& lhs, const dynamic_bitset<Alloc>& rhs)
+{
+  dynamic_bitset<Alloc> tmp(lhs);
+  tmp -= rhs;
+  return tmp;
+}
+
+// 多余的位总是为 0，可以按字比较
+template <class Alloc>
+bool operator==(const dynamic_bitset<Alloc>& lhs, const dynamic_bitset<Alloc>& rhs)
+{
+  return lhs.size() == rhs.size() &&
+    mystl::equal(lhs.data(), lhs.data() + lhs.num_words(), rhs.data());
+}
+
+template <class Alloc>
+bool operator!=(const dynamic_bitset<Alloc>& lhs, const dynamic_bitset<Alloc>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+// 重载 mystl 的 swap
+template <class Alloc>
+void swap(dynamic_bitset<Alloc>& lhs, dynamic_bitset<Alloc>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_DYNAMIC_BITSET_H_
+
@@ -0,0 +1,951 @@
+#ifndef MYTINYSTL_FLAT_HASHTABLE_H_
+#define MYTINYSTL_FLAT_HASHTABLE_H_
+
+// 这个头文件包含一个模板类 flat_hashtable
+// flat_hashtable : 开放寻址的哈希表，flat_hash_map 与 flat_hash_set 的底层实现
+
+// notes:
+//
+// 参照 Swiss table (abseil 的 raw_hash_set) 的设计：元素直接存放在一个槽数组中，不再为每个元素
+// 分配节点；另有一个与槽一一对应的控制字节数组，每个槽的状态用 1 byte 表示：
+//   EFlatEmpty 为空，EFlatDeleted 为已删除，[0, 127] 表示槽中有元素，值为该元素哈希值的低 7 位 (H2)。
+// 哈希值的其余部分 (H1) 决定探测的起点。探测时一次读入 16 个控制字节，用 SSE2 同时与 H2 比较，
+// 只有控制字节相同的槽才需要比较键值；同一组中出现空槽就可以断定查找失败。
+// 组与组之间按 16, 32, 48 ... 的步长做二次探测。
+//
+// 容量为 2^k - 1，控制字节数组的末尾是一个哨兵 EFlatSentinel 与前 15 个控制字节的副本，
+// 从任何一个槽开始读 16 个控制字节都不会越界，也不需要处理环绕；迭代器遇到哨兵即停止。
+// 空表的控制字节指向一个静态的空组，不分配内存。
+//
+// 负载因子上限为 7/8。删除元素时，若它附近的组从来没有满过(不会有探测序列越过这个槽)，
+// 直接把它置为空槽，否则置为已删除，之后的插入可以复用它。
+//
+// 与 unordered_map / unordered_set 的不同：
+//   * 插入时可能 rehash，使所有的迭代器、指针与引用失效；删除只使被删除元素的迭代器失效
+//   * rehash 时元素需要移动，而不是改变节点的链接
+//   * 没有 bucket 接口，bucket_count() 为槽的个数，max_load_factor 固定为 0.875
+//   * 不支持重复的键值
+//
+// mystl::hash 对整数是恒等映射，低 7 位与高位都不够随机，因此先用 hash_mix (见 functional.h) 打散。
+// 定义 MYSTL_NO_SSE2 后不使用 SSE2，逐个字节比较
+
+#include <initializer_list>
+
+#include <cstdint>
+
+#include "hashtable.h"
+#include "memory.h"
+#include "util.h"
+#include "exceptdef.h"
+
+#if !defined(MYSTL_NO_SSE2) && (defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MYSTL_FLAT_SSE2 1
+#include <emmintrin.h>
+#else
+#define MYSTL_FLAT_SSE2 0
+#endif
+
+namespace mystl
+{
+
+// 控制字节
+typedef signed char flat_ctrl_t;
+
+// 控制字节的特殊值，有元素的槽的控制字节在 [0, 127] 之间
+enum : signed char { EFlatEmpty = -128, EFlatDeleted = -2, EFlatSentinel = -1 };
+
+// 一组控制字节的个数，以及控制字节数组末尾复制的字节数
+enum { EFlatGroupWidth = 16, EFlatClonedBytes = EFlatGroupWidth - 1 };
+
+// 分配内存后的最小容量
+enum { EFlatMinCapacity = 15 };
+
+// 最低位的 1 的位置，x 不能为 0
+inline size_t flat_trailing_zeros(uint32_t x) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<size_t>(__builtin_ctz(x));
+#else
+  size_t n = 0;
+  while ((x & 1) == 0)
+  {
+    x >>= 1;
+    ++n;
+  }
+  return n;
+#endif
+}
+
+// 16 位的掩码中，最高位之上连续的 0 的个数，x 为 0 时返回 16
+inline size_t flat_leading_zeros16(uint32_t x) noexcept
+{
+  size_t n = 0;
+  for (uint32_t bit = 1u << (EFlatGroupWidth - 1); bit != 0 && (x & bit) == 0; bit >>= 1)
+    ++n;
+  return n;
+}
+
+/*****************************************************************************************/
+// flat_group
+// 一组 16 个控制字节，match 系列函数返回一个位掩码，第 i 位对应组中的第 i 个槽
+/*****************************************************************************************/
+
+struct flat_group
+{
+#if MYSTL_FLAT_SSE2
+  __m128i ctrl;
+
+  explicit flat_group(const flat_ctrl_t* p) noexcept
+    :ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))
+  {
+  }
+
+  // 控制字节等于 h 的槽
+  uint32_t match(flat_ctrl_t h) const noexcept
+  {
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h), ctrl)));
+  }
+
+  // 空槽或已删除的槽，即控制字节小于 EFlatSentinel 的槽
+  uint32_t match_empty_or_deleted() const noexcept
+  {
+    return static_cast<uint32_t>(_mm_movemask_epi8(
+      _mm_cmpgt_epi8(_mm_set1_epi8(EFlatSentinel), ctrl)));
+  }
+#else
+  const flat_ctrl_t* ctrl;
+
+  explicit flat_group(const flat_ctrl_t* p) noexcept
+    :ctrl(p)
+  {
+  }
+
+  uint32_t match(flat_ctrl_t h) const noexcept
+  {
+    uint32_t r = 0;
+    for (int i = 0; i < EFlatGroupWidth; ++i)
+      r |= static_cast<uint32_t>(ctrl[i] == h) << i;
+    return r;
+  }
+
+  uint32_t match_empty_or_deleted() const noexcept
+  {
+    uint32_t r = 0;
+    for (int i = 0; i < EFlatGroupWidth; ++i)
+      r |= static_cast<uint32_t>(ctrl[i] < EFlatSentinel) << i;
+    return r;
+  }
+#endif // MYSTL_FLAT_SSE2
+
+  uint32_t match_empty() const noexcept
+  { return match(EFlatEmpty); }
+
+  // 组首连续的空槽与已删除的槽的个数
+  size_t count_leading_empty_or_deleted() const noexcept
+  { return flat_trailing_zeros(~match_empty_or_deleted()); }
+};
+
+/*****************************************************************************************/
+// flat_hashtable 的迭代器设计
+// 保存控制字节与槽的指针，++ 时按组跳过空槽与已删除的槽，遇到哨兵时即为 end()
+/*****************************************************************************************/
+
+template <class T, class Ref, class Ptr>
+struct flat_ht_iterator : public iterator<forward_iterator_tag, T>
+{
+  typedef flat_ht_iterator<T, T&, T*>             iterator;
+  typedef flat_ht_iterator<T, const T&, const T*> const_iterator;
+  typedef flat_ht_iterator                        self;
+
+  typedef T            value_type;
+  typedef Ptr          pointer;
+  typedef Ref          reference;
+  typedef size_t       size_type;
+  typedef ptrdiff_t    difference_type;
+
+  const flat_ctrl_t* ctrl;  // 所指槽的控制字节
+  T*                 slot;  // 所指的槽
+
+  flat_ht_iterator() noexcept
+    :ctrl(nullptr), slot(nullptr)
+  {
+  }
+  flat_ht_iterator(const flat_ctrl_t* c, T* s) noexcept
+    :ctrl(c), slot(s)
+  {
+  }
+  flat_ht_iterator(const iterator& rhs) noexcept
+    :ctrl(rhs.ctrl), slot(rhs.slot)
+  {
+  }
+
+  reference operator*()  const { return *slot; }
+  pointer   operator->() const { return slot; }
+
+  self& operator++()
+  {
+    MYSTL_DEBUG(*ctrl >= 0);
+    ++ctrl;
+    ++slot;
+    skip_empty_or_deleted();
+    return *this;
+  }
+  self operator++(int)
+  {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  // 移动到下一个有元素的槽或哨兵
+  void skip_empty_or_deleted() noexcept
+  {
+    while (*ctrl < EFlatSentinel)
+    {
+      const size_t shift = flat_group(ctrl).count_leading_empty_or_deleted();
+      ctrl += shift;
+      slot += shift;
+    }
+  }
+
+  bool operator==(const self& rhs) const { return ctrl == rhs.ctrl; }
+  bool operator!=(const self& rhs) const { return ctrl != rhs.ctrl; }
+};
+
+// 模板类 flat_hashtable
+// 参数一代表数据类型，参数二代表哈希函数，参数三代表键值相等的比较函数，参数四代表分配器类型
+template <class T, class Hash, class KeyEqual, class Alloc = mystl::allocator<T>>
+class flat_hashtable
+{
+public:
+  // flat_hashtable 的型别定义
+  typedef ht_value_traits<T>                          value_traits;
+  typedef typename value_traits::key_type             key_type;
+  typedef typename value_traits::mapped_type          mapped_type;
+  typedef typename value_traits::value_type           value_type;
+  typedef Hash                                        hasher;
+  typedef KeyEqual                                    key_equal;
+
+  typedef Alloc                                       allocator_type;
+  typedef mystl::allocator_traits<Alloc>              alloc_traits;
+  typedef typename alloc_traits::template
+    rebind_alloc<flat_ctrl_t>                         ctrl_allocator;
+  typedef mystl::allocator_traits<ctrl_allocator>     ctrl_alloc_traits;
+
+  typedef typename alloc_traits::pointer              pointer;
+  typedef typename alloc_traits::const_pointer        const_pointer;
+  typedef value_type&                                 reference;
+  typedef const value_type&                           const_reference;
+  typedef typename alloc_traits::size_type            size_type;
+  typedef typename alloc_traits::difference_type      difference_type;
+
+  typedef flat_ht_iterator<T, T&, T*>                 iterator;
+  typedef flat_ht_iterator<T, const T&, const T*>     const_iterator;
+
+  allocator_type get_allocator() const { return alloc_; }
+
+private:
+  flat_ctrl_t*   ctrl_;         // 控制字节，共 capacity_ + EFlatGroupWidth 个
+  pointer        slots_;        // 槽，共 capacity_ 个
+  size_type      capacity_;     // 槽的个数，为 0 或 2^k - 1
+  size_type      size_;         // 元素个数
+  size_type      growth_left_;  // 不需要 rehash 还能占用的空槽个数
+  hasher         hash_;
+  key_equal      equal_;
+  allocator_type alloc_;
+
+public:
+  // 构造、复制、移动、析构函数
+  explicit flat_hashtable(size_type bucket_count,
+                          const Hash& hash = Hash(),
+                          const KeyEqual& equal = KeyEqual(),
+                          const allocator_type& alloc = allocator_type())
+    :hash_(hash), equal_(equal), alloc_(alloc)
+  {
+    reset_members();
+    if (bucket_count != 0)
+      reserve(bucket_count);
+  }
+
+  flat_hashtable(const flat_hashtable& rhs)
+    :flat_hashtable(rhs, alloc_traits::select_on_container_copy_construction(rhs.alloc_))
+  {
+  }
+  flat_hashtable(const flat_hashtable& rhs, const allocator_type& alloc)
+    :hash_(rhs.hash_), equal_(rhs.equal_), alloc_(alloc)
+  {
+    reset_members();
+    try
+    {
+      copy_from(rhs);
+    }
+    catch (...)
+    {
+      release();
+      throw;
+    }
+  }
+  flat_hashtable(flat_hashtable&& rhs) noexcept
+    :ctrl_(rhs.ctrl_), slots_(rhs.slots_), capacity_(rhs.capacity_),
+    size_(rhs.size_), growth_left_(rhs.growth_left_),
+    hash_(rhs.hash_), equal_(rhs.equal_), alloc_(mystl::move(rhs.alloc_))
+  {
+    rhs.reset_members();
+  }
+
+  flat_hashtable& operator=(const flat_hashtable& rhs);
+  flat_hashtable& operator=(flat_hashtable&& rhs) noexcept(
+    alloc_traits::propagate_on_container_move_assignment::value ||
+    alloc_traits::is_always_equal::value);
+
+  ~flat_hashtable() { release(); }
+
+  // 迭代器相关操作
+  iterator       begin()        noexcept
+  {
+    iterator it(ctrl_, slots_);
+    it.skip_empty_or_deleted();
+    return it;
+  }
+  const_iterator begin()  const noexcept
+  { return const_cast<flat_hashtable*>(this)->begin(); }
+  iterator       end()          noexcept
+  { return iterator_at(capacity_); }
+  const_iterator end()    const noexcept
+  { return const_cast<flat_hashtable*>(this)->end(); }
+
+  const_iterator cbegin() const noexcept
+  { return begin(); }
+  const_iterator cend()   const noexcept
+  { return end(); }
+
+  // 容量相关操作
+  bool      empty()    const noexcept { return size_ == 0; }
+  size_type size()     const noexcept { return size_; }
+  size_type max_size() const noexcept
+  { return static_cast<size_type>(-1) / (sizeof(value_type) + 1) / 2; }
+
+  // 修改容器相关操作
+
+  // emplace_unique / try_emplace_unique
+  // emplace_unique 先构造出元素才能得到键值，键值已存在时这个元素被丢弃；
+  // try_emplace_unique 先用 key 查找，不存在时才用 key 与 args 构造元素
+
+  template <class ...Args>
+  pair<iterator, bool> emplace_unique(Args&& ...args);
+
+  template <class K, class ...Args>
+  pair<iterator, bool> try_emplace_unique(K&& key, Args&& ...args);
+
+  // insert
+
+  pair<iterator, bool> insert_unique(const value_type& value);
+  pair<iterator, bool> insert_unique(value_type&& value);
+
+  template <class InputIter>
+  void insert_unique(InputIter first, InputIter last)
+  { copy_insert_unique(first, last, iterator_category(first)); }
+
+  // erase / clear
+
+  void      erase(const_iterator position);
+  void      erase(const_iterator first, const_iterator last);
+  size_type erase_unique(const key_type& key);
+
+  void      clear() noexcept;
+
+  void      swap(flat_hashtable& rhs) noexcept;
+
+  // 查找相关操作
+
+  size_type      count(const key_type& key) const
+  { return find(key) != end() ? 1 : 0; }
+
+  iterator       find(const key_type& key)
+  {
+    size_type i;
+    return find_index(key, hash_key(key), i) ? iterator_at(i) : end();
+  }
+  const_iterator find(const key_type& key) const
+  { return const_cast<flat_hashtable*>(this)->find(key); }
+
+  pair<iterator, iterator> equal_range_unique(const key_type& key)
+  {
+    iterator it = find(key);
+    iterator last = it;
+    if (it != end())
+      ++last;
+    return mystl::make_pair(it, last);
+  }
+  pair<const_iterator, const_iterator> equal_range_unique(const key_type& key) const
+  {
+    auto r = const_cast<flat_hashtable*>(this)->equal_range_unique(key);
+    return mystl::make_pair(const_iterator(r.first), const_iterator(r.second));
+  }
+
+  // hash policy
+
+  size_type bucket_count()     const noexcept { return capacity_; }
+  size_type max_bucket_count() const noexcept { return max_size(); }
+
+  float load_factor() const noexcept
+  { return capacity_ != 0 ? (float)size_ / capacity_ : 0.0f; }
+
+  float max_load_factor() const noexcept
+  { return 0.875f; }
+  void  max_load_factor(float ml)
+  { // 负载因子固定，只检查参数
+    THROW_OUT_OF_RANGE_IF(ml != ml || ml < 0, "invalid hash load factor");
+  }
+
+  void rehash(size_type count);
+  void reserve(size_type count);
+
+  hasher    hash_fcn() const { return hash_; }
+  key_equal key_eq()   const { return equal_; }
+
+  bool equal_to_unique(const flat_hashtable& other) const;
+
+private:
+  // 静态的空组，空表的 ctrl_ 指向它
+  static flat_ctrl_t* empty_group() noexcept
+  {
+    static flat_ctrl_t group[EFlatGroupWidth] = {
+      EFlatSentinel, EFlatEmpty, EFlatEmpty, EFlatEmpty, EFlatEmpty, EFlatEmpty,
+      EFlatEmpty, EFlatEmpty, EFlatEmpty, EFlatEmpty, EFlatEmpty, EFlatEmpty,
+      EFlatEmpty, EFlatEmpty, EFlatEmpty, EFlatEmpty };
+    return group;
+  }
+
+  // 容量与可以占用的槽数
+  static size_type normalize_capacity(size_type n) noexcept
+  {
+    size_type c = EFlatMinCapacity;
+    while (c < n)
+      c = c * 2 + 1;
+    return c;
+  }
+  static size_type capacity_to_growth(size_type c) noexcept
+  { return c - c / 8; }
+  static size_type growth_to_capacity(size_type n) noexcept
+  { return normalize_capacity(n + (n == 0 ? 0 : (n - 1) / 7)); }
+
+  // 哈希值
+  size_t hash_key(const key_type& key) const
+  { return hash_mix(static_cast<size_t>(hash_(key))); }
+  static size_t      h1(size_t h) noexcept { return h >> 7; }
+  static flat_ctrl_t h2(size_t h) noexcept { return static_cast<flat_ctrl_t>(h & 0x7f); }
+
+  iterator iterator_at(size_type i) noexcept
+  { return iterator(ctrl_ + i, slots_ + i); }
+
+  // 查找、插入的位置
+  bool      find_index(const key_type& key, size_t hash, size_type& index) const;
+  static size_type find_first_non_full(const flat_ctrl_t* ctrl, size_type capacity, size_t hash) noexcept;
+  static void      set_ctrl(flat_ctrl_t* ctrl, size_type capacity, size_type i, flat_ctrl_t h) noexcept;
+  size_type prepare_insert(size_t hash);
+  void      commit_insert(size_type i, size_t hash) noexcept;
+  void      erase_at(size_type i) noexcept;
+
+  // 空间
+  void      reset_members() noexcept;
+  void      release() noexcept;
+  void      destroy_slots() noexcept;
+  void      resize(size_type new_capacity);
+  void      rehash_and_grow();
+  void      copy_from(const flat_hashtable& rhs);
+
+  template <class InputIter>
+  void      copy_insert_unique(InputIter first, InputIter last, mystl::input_iterator_tag);
+  template <class ForwardIter>
+  void      copy_insert_unique(ForwardIter first, ForwardIter last, mystl::forward_iterator_tag);
+};
+
+/*****************************************************************************************/
+
+// 复制赋值运算符
+template <class T, class Hash, class KeyEqual, class Alloc>
+flat_hashtable<T, Hash, KeyEqual, Alloc>&
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+operator=(const flat_hashtable& rhs)
+{
+  if (this != &rhs)
+  {
+    if (mystl::alloc_copy_needs_reset(alloc_, rhs.alloc_))
+      release();  // 原有的空间必须用旧的分配器释放
+    else
+      clear();
+    mystl::alloc_on_copy_assign(alloc_, rhs.alloc_);
+    hash_ = rhs.hash_;
+    equal_ = rhs.equal_;
+    copy_from(rhs);
+  }
+  return *this;
+}
+
+// 移动赋值运算符，能接管 rhs 的空间时直接接管，否则逐个移动元素
+template <class T, class Hash, class KeyEqual, class Alloc>
+flat_hashtable<T, Hash, KeyEqual, Alloc>&
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+operator=(flat_hashtable&& rhs) noexcept(
+  alloc_traits::propagate_on_container_move_assignment::value ||
+  alloc_traits::is_always_equal::value)
+{
+  if (this == &rhs)
+    return *this;
+  hash_ = rhs.hash_;
+  equal_ = rhs.equal_;
+  if (mystl::alloc_move_can_steal(alloc_, rhs.alloc_))
+  {
+    release();
+    mystl::alloc_on_move_assign(alloc_, rhs.alloc_);
+    ctrl_ = rhs.ctrl_;
+    slots_ = rhs.slots_;
+    capacity_ = rhs.capacity_;
+    size_ = rhs.size_;
+    growth_left_ = rhs.growth_left_;
+    rhs.reset_members();
+  }
+  else
+  {
+    clear();
+    reserve(rhs.size_);
+    for (auto it = rhs.begin(); it != rhs.end(); ++it)
+      insert_unique(mystl::move(*it));
+    rhs.clear();
+  }
+  return *this;
+}
+
+// 就地构造元素，键值不允许重复
+// 强异常安全保证
+template <class T, class Hash, class KeyEqual, class Alloc>
+template <class ...Args>
+pair<typename flat_hashtable<T, Hash, KeyEqual, Alloc>::iterator, bool>
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+emplace_unique(Args&& ...args)
+{
+  value_type tmp(mystl::forward<Args>(args)...);
+  return insert_unique(mystl::move(tmp));
+}
+
+// 键值不存在时用 key 与 mapped_type(args...) 构造元素，只用于 flat_hash_map
+// 强异常安全保证
+template <class T, class Hash, class KeyEqual, class Alloc>
+template <class K, class ...Args>
+pair<typename flat_hashtable<T, Hash, KeyEqual, Alloc>::iterator, bool>
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+try_emplace_unique(K&& key, Args&& ...args)
+{
+  const size_t hash = hash_key(key);
+  size_type i;
+  if (find_index(key, hash, i))
+    return mystl::make_pair(iterator_at(i), false);
+  i = prepare_insert(hash);
+  alloc_traits::construct(alloc_, slots_ + i, mystl::forward<K>(key),
+                          mapped_type(mystl::forward<Args>(args)...));
+  commit_insert(i, hash);
+  return mystl::make_pair(iterator_at(i), true);
+}
+
+// 插入元素，键值不允许重复
+// 强异常安全保证
+template <class T, class Hash, class KeyEqual, class Alloc>
+pair<typename flat_hashtable<T, Hash, KeyEqual, Alloc>::iterator, bool>
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+insert_unique(const value_type& value)
+{
+  const key_type& key = value_traits::get_key(value);
+  const size_t hash = hash_key(key);
+  size_type i;
+  if (find_index(key, hash, i))
+    return mystl::make_pair(iterator_at(i), false);
+  i = prepare_insert(hash);
+  alloc_traits::construct(alloc_, slots_ + i, value);
+  commit_insert(i, hash);
+  return mystl::make_pair(iterator_at(i), true);
+}
+
+template <class T, class Hash, class KeyEqual, class Alloc>
+pair<typename flat_hashtable<T, Hash, KeyEqual, Alloc>::iterator, bool>
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+insert_unique(value_type&& value)
+{
+  const key_type& key = value_traits::get_key(value);
+  const size_t hash = hash_key(key);
+  size_type i;
+  if (find_index(key, hash, i))
+    return mystl::make_pair(iterator_at(i), false);
+  i = prepare_insert(hash);
+  alloc_traits::construct(alloc_, slots_ + i, mystl::move(value));
+  commit_insert(i, hash);
+  return mystl::make_pair(iterator_at(i), true);
+}
+
+// 删除迭代器所指的元素，其它元素不移动
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+erase(const_iterator position)
+{
+  MYSTL_DEBUG(position != end() && *position.ctrl >= 0);
+  erase_at(static_cast<size_type>(position.ctrl - ctrl_));
+}
+
+// 删除 [first, last) 内的元素
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+erase(const_iterator first, const_iterator last)
+{
+  while (first != last)
+  {
+    const size_type i = static_cast<size_type>(first.ctrl - ctrl_);
+    ++first;  // 删除不会移动元素，先前进再删除即可
+    erase_at(i);
+  }
+}
+
+// 删除键值为 key 的元素
+template <class T, class Hash, class KeyEqual, class Alloc>
+typename flat_hashtable<T, Hash, KeyEqual, Alloc>::size_type
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+erase_unique(const key_type& key)
+{
+  size_type i;
+  if (!find_index(key, hash_key(key), i))
+    return 0;
+  erase_at(i);
+  return 1;
+}
+
+// 清空元素，保留空间
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+clear() noexcept
+{
+  if (capacity_ == 0)
+    return;
+  destroy_slots();
+  for (size_type i = 0; i < capacity_ + EFlatGroupWidth; ++i)
+    ctrl_[i] = EFlatEmpty;
+  ctrl_[capacity_] = EFlatSentinel;
+  size_ = 0;
+  growth_left_ = capacity_to_growth(capacity_);
+}
+
+// 交换两个 flat_hashtable
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+swap(flat_hashtable& rhs) noexcept
+{
+  if (this != &rhs)
+  {
+    mystl::swap(ctrl_, rhs.ctrl_);
+    mystl::swap(slots_, rhs.slots_);
+    mystl::swap(capacity_, rhs.capacity_);
+    mystl::swap(size_, rhs.size_);
+    mystl::swap(growth_left_, rhs.growth_left_);
+    mystl::swap(hash_, rhs.hash_);
+    mystl::swap(equal_, rhs.equal_);
+    mystl::alloc_on_swap(alloc_, rhs.alloc_);
+  }
+}
+
+// 重新分配空间，使槽数至少为 count 且能容纳现有的元素
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+rehash(size_type count)
+{
+  if (count == 0 && size_ == 0)
+  {
+    release();
+    return;
+  }
+  const size_type n = mystl::max(normalize_capacity(count), growth_to_capacity(size_));
+  if (n != capacity_)
+    resize(n);
+}
+
+// 预留空间，使插入 count 个元素时不需要 rehash
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+reserve(size_type count)
+{
+  THROW_LENGTH_ERROR_IF(count > max_size(), "flat_hashtable's size too big");
+  if (count > size_ + growth_left_)
+    resize(growth_to_capacity(count));
+}
+
+// 两个表的元素相同
+template <class T, class Hash, class KeyEqual, class Alloc>
+bool flat_hashtable<T, Hash, KeyEqual, Alloc>::
+equal_to_unique(const flat_hashtable& other) const
+{
+  if (size_ != other.size_)
+    return false;
+  for (auto it = begin(), last = end(); it != last; ++it)
+  {
+    auto p = other.find(value_traits::get_key(*it));
+    if (p == other.end() || !(value_traits::get_value(*p) == value_traits::get_value(*it)))
+      return false;
+  }
+  return true;
+}
+
+/*****************************************************************************************/
+// helper function
+
+// 查找键值为 key 的元素，找到时由 index 返回其位置
+template <class T, class Hash, class KeyEqual, class Alloc>
+bool flat_hashtable<T, Hash, KeyEqual, Alloc>::
+find_index(const key_type& key, size_t hash, size_type& index) const
+{
+  const flat_ctrl_t h = h2(hash);
+  size_type offset = h1(hash) & capacity_;
+  size_type step = 0;
+  for (;;)
+  {
+    const flat_group g(ctrl_ + offset);
+    for (uint32_t bits = g.match(h); bits != 0; bits &= bits - 1)
+    {
+      const size_type i = (offset + flat_trailing_zeros(bits)) & capacity_;
+      if (equal_(value_traits::get_key(slots_[i]), key))
+      {
+        index = i;
+        return true;
+      }
+    }
+    if (g.match_empty() != 0)
+      return false;
+    step += EFlatGroupWidth;
+    offset = (offset + step) & capacity_;
+  }
+}
+
+// 沿 hash 的探测序列找到第一个空槽或已删除的槽
+template <class T, class Hash, class KeyEqual, class Alloc>
+typename flat_hashtable<T, Hash, KeyEqual, Alloc>::size_type
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+find_first_non_full(const flat_ctrl_t* ctrl, size_type capacity, size_t hash) noexcept
+{
+  size_type offset = h1(hash) & capacity;
+  size_type step = 0;
+  for (;;)
+  {
+    const uint32_t bits = flat_group(ctrl + offset).match_empty_or_deleted();
+    if (bits != 0)
+      return (offset + flat_trailing_zeros(bits)) & capacity;
+    step += EFlatGroupWidth;
+    offset = (offset + step) & capacity;
+  }
+}
+
+// 设置第 i 个控制字节，前 EFlatClonedBytes 个控制字节同时写入末尾的副本
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+set_ctrl(flat_ctrl_t* ctrl, size_type capacity, size_type i, flat_ctrl_t h) noexcept
+{
+  ctrl[i] = h;
+  ctrl[((i - EFlatClonedBytes) & capacity) + (EFlatClonedBytes & capacity)] = h;
+}
+
+// 找到插入的位置，没有可以占用的空槽时先 rehash
+template <class T, class Hash, class KeyEqual, class Alloc>
+typename flat_hashtable<T, Hash, KeyEqual, Alloc>::size_type
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+prepare_insert(size_t hash)
+{
+  size_type i = find_first_non_full(ctrl_, capacity_, hash);
+  if (growth_left_ == 0 && ctrl_[i] != EFlatDeleted)
+  {
+    rehash_and_grow();
+    i = find_first_non_full(ctrl_, capacity_, hash);
+  }
+  return i;
+}
+
+// 元素已在第 i 个槽构造完成，登记它
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+commit_insert(size_type i, size_t hash) noexcept
+{
+  if (ctrl_[i] == EFlatEmpty)
+    --growth_left_;
+  set_ctrl(ctrl_, capacity_, i, h2(hash));
+  ++size_;
+}
+
+// 删除第 i 个槽中的元素
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+erase_at(size_type i) noexcept
+{
+  alloc_traits::destroy(alloc_, slots_ + i);
+  --size_;
+  // 包含 i 的每一个 16 个槽的窗口中都有空槽时，不会有探测序列越过 i，可以直接置空
+  const size_type before = (i - EFlatGroupWidth) & capacity_;
+  const uint32_t empty_after = flat_group(ctrl_ + i).match_empty();
+  const uint32_t empty_before = flat_group(ctrl_ + before).match_empty();
+  const bool was_never_full = empty_after != 0 && empty_before != 0 &&
+    flat_trailing_zeros(empty_after) + flat_leading_zeros16(empty_before) <
+    static_cast<size_t>(EFlatGroupWidth);
+  set_ctrl(ctrl_, capacity_, i, was_never_full ? EFlatEmpty : EFlatDeleted);
+  if (was_never_full)
+    ++growth_left_;
+}
+
+// 成员恢复为空表的状态，不释放空间
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+reset_members() noexcept
+{
+  ctrl_ = empty_group();
+  slots_ = nullptr;
+  capacity_ = 0;
+  size_ = 0;
+  growth_left_ = 0;
+}
+
+// 销毁所有元素并释放空间
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+release() noexcept
+{
+  if (capacity_ == 0)
+    return;
+  destroy_slots();
+  ctrl_allocator ctrl_alloc(alloc_);
+  ctrl_alloc_traits::deallocate(ctrl_alloc, ctrl_, capacity_ + EFlatGroupWidth);
+  alloc_traits::deallocate(alloc_, slots_, capacity_);
+  reset_members();
+}
+
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+destroy_slots() noexcept
+{
+  if (std::is_trivially_destructible<value_type>::value)
+    return;
+  for (size_type i = 0; i < capacity_; ++i)
+  {
+    if (ctrl_[i] >= 0)
+      alloc_traits::destroy(alloc_, slots_ + i);
+  }
+}
+
+// 分配 new_capacity 个槽，把元素移动过去，移动构造可能抛出异常时改为复制
+// 强异常安全保证：抛出异常时新的空间被释放，原有的元素保持不变
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+resize(size_type new_capacity)
+{
+  THROW_LENGTH_ERROR_IF(new_capacity > max_size(), "flat_hashtable's size too big");
+  ctrl_allocator ctrl_alloc(alloc_);
+  flat_ctrl_t* new_ctrl = ctrl_alloc_traits::allocate(ctrl_alloc, new_capacity + EFlatGroupWidth);
+  pointer new_slots = nullptr;
+  try
+  {
+    new_slots = alloc_traits::allocate(alloc_, new_capacity);
+  }
+  catch (...)
+  {
+    ctrl_alloc_traits::deallocate(ctrl_alloc, new_ctrl, new_capacity + EFlatGroupWidth);
+    throw;
+  }
+  for (size_type i = 0; i < new_capacity + EFlatGroupWidth; ++i)
+    new_ctrl[i] = EFlatEmpty;
+  new_ctrl[new_capacity] = EFlatSentinel;
+
+  try
+  {
+    for (size_type i = 0; i < capacity_; ++i)
+    {
+      if (ctrl_[i] < 0)
+        continue;
+      const size_t hash = hash_key(value_traits::get_key(slots_[i]));
+      const size_type j = find_first_non_full(new_ctrl, new_capacity, hash);
+      alloc_traits::construct(alloc_, new_slots + j, mystl::move_if_noexcept(slots_[i]));
+      set_ctrl(new_ctrl, new_capacity, j, h2(hash));
+    }
+  }
+  catch (...)
+  {
+    for (size_type j = 0; j < new_capacity; ++j)
+    {
+      if (new_ctrl[j] >= 0)
+        alloc_traits::destroy(alloc_, new_slots + j);
+    }
+    alloc_traits::deallocate(alloc_, new_slots, new_capacity);
+    ctrl_alloc_traits::deallocate(ctrl_alloc, new_ctrl, new_capacity + EFlatGroupWidth);
+    throw;
+  }
+
+  const size_type n = size_;
+  release();
+  ctrl_ = new_ctrl;
+  slots_ = new_slots;
+  capacity_ = new_capacity;
+  size_ = n;
+  growth_left_ = capacity_to_growth(new_capacity) - n;
+}
+
+// 没有可以占用的空槽：已删除的槽较多时按原容量重建，否则容量加倍
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+rehash_and_grow()
+{
+  if (capacity_ == 0)
+    resize(EFlatMinCapacity);
+  else if (size_ * 32 <= capacity_ * 25)
+    resize(capacity_);
+  else
+    resize(capacity_ * 2 + 1);
+}
+
+// 复制 rhs 的元素，rhs 中的键值互不相同，不需要查找
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+copy_from(const flat_hashtable& rhs)
+{
+  reserve(rhs.size_);
+  for (size_type i = 0; i < rhs.capacity_; ++i)
+  {
+    if (rhs.ctrl_[i] < 0)
+      continue;
+    const size_t hash = hash_key(value_traits::get_key(rhs.slots_[i]));
+    const size_type j = find_first_non_full(ctrl_, capacity_, hash);
+    alloc_traits::construct(alloc_, slots_ + j, rhs.slots_[i]);
+    commit_insert(j, hash);
+  }
+}
+
+template <class T, class Hash, class KeyEqual, class Alloc>
+template <class InputIter>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+copy_insert_unique(InputIter first, InputIter last, mystl::input_iterator_tag)
+{
+  for (; first != last; ++first)
+    insert_unique(*first);
+}
+
+template <class T, class Hash, class KeyEqual, class Alloc>
+template <class ForwardIter>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+copy_insert_unique(ForwardIter first, ForwardIter last, mystl::forward_iterator_tag)
+{
+  reserve(size_ + static_cast<size_type>(mystl::distance(first, last)));
+  for (; first != last; ++first)
+    insert_unique(*first);
+}
+
+// 重载 mystl 的 swap
+template <class T, class Hash, class KeyEqual, class Alloc>
+void swap(flat_hashtable<T, Hash, KeyEqual, Alloc>& lhs,
+          flat_hashtable<T, Hash, KeyEqual, Alloc>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_FLAT_HASHTABLE_H_
+
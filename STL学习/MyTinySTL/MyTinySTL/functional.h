@@ -4,6 +4,8 @@
 // 这个头文件包含了 mystl 的函数对象与哈希函数
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 
 namespace mystl
 {
@@ -194,13 +196,43 @@ struct hash<T*>
   { return reinterpret_cast<size_t>(p); }
 };
 
-// 对于整型类型，只是返回原值
+// 打散整数的各位 (MurmurHash3 的 fmix，乘法与移位异或交替)
+// 输入的每一位都会影响输出的每一位，低位与高位都可以直接用作桶的下标
+inline size_t hash_mix(size_t h) noexcept
+{
+#if (_MSC_VER && _WIN64) || ((__GNUC__ || __clang__) &&__SIZEOF_POINTER__ == 8)
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+#else
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+#endif
+  return h;
+}
+
+// 对于整型类型，缺省只是返回原值，配合以质数为桶个数的 hashtable 已经足够
+// 定义 MYSTL_HASH_MIX 后返回 hash_mix 打散的值，也可以对单个容器使用 mix_hash
+#ifdef MYSTL_HASH_MIX
+#define MYSTL_TRIVIAL_HASH_FCN(Type)         \
+template <> struct hash<Type>                \
+{                                            \
+  size_t operator()(Type val) const noexcept \
+  { return hash_mix(static_cast<size_t>(val)); } \
+};
+#else
 #define MYSTL_TRIVIAL_HASH_FCN(Type)         \
 template <> struct hash<Type>                \
 {                                            \
   size_t operator()(Type val) const noexcept \
   { return static_cast<size_t>(val); }       \
 };
+#endif
 
 MYSTL_TRIVIAL_HASH_FCN(bool)
 
@@ -234,7 +266,7 @@ MYSTL_TRIVIAL_HASH_FCN(unsigned long long)
 
 #undef MYSTL_TRIVIAL_HASH_FCN
 
-// 对于浮点数，逐位哈希
+// 对于浮点数，逐位哈希 (FNV-1a)
 inline size_t bitwise_hash(const unsigned char* first, size_t count)
 {
 #if (_MSC_VER && _WIN64) || ((__GNUC__ || __clang__) &&__SIZEOF_POINTER__ == 8)
@@ -253,6 +285,124 @@ inline size_t bitwise_hash(const unsigned char* first, size_t count)
   return result;
 }
 
+// 字节串的哈希，仿照 wyhash：每次读入 8 个字节，用 64 位乘法的 128 位结果的高低两半相异或来混合
+// 短于 16 字节的键值只做两次乘法，长键值每轮并行处理 48 个字节，比逐字节的 bitwise_hash 快得多
+
+// 读入未对齐的 8 / 4 个字节，以及 1~3 个字节
+inline uint64_t hash_read8(const unsigned char* p) noexcept
+{
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t hash_read4(const unsigned char* p) noexcept
+{
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t hash_read_small(const unsigned char* p, size_t k) noexcept
+{
+  return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+// 64 位乘法，128 位的结果由 lo / hi 返回
+inline void hash_mum(uint64_t& lo, uint64_t& hi) noexcept
+{
+#if defined(__SIZEOF_INT128__)
+  const __uint128_t r = static_cast<__uint128_t>(lo) * hi;
+  lo = static_cast<uint64_t>(r);
+  hi = static_cast<uint64_t>(r >> 64);
+#else
+  const uint64_t ha = hi >> 32, hb = lo >> 32;
+  const uint64_t la = static_cast<uint32_t>(hi), lb = static_cast<uint32_t>(lo);
+  const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  const uint64_t t = rl + (rm0 << 32);
+  uint64_t c = t < rl;
+  const uint64_t l = t + (rm1 << 32);
+  c += l < t;
+  lo = l;
+  hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+inline uint64_t hash_mum_mix(uint64_t a, uint64_t b) noexcept
+{
+  hash_mum(a, b);
+  return a ^ b;
+}
+
+inline size_t hash_bytes(const void* key, size_t len, uint64_t seed = 0) noexcept
+{
+  static const uint64_t s0 = 0xa0761d6478bd642full;
+  static const uint64_t s1 = 0xe7037ed1a0b428dbull;
+  static const uint64_t s2 = 0x8ebc6af09c88c6e3ull;
+  static const uint64_t s3 = 0x589965cc75374cc3ull;
+  const unsigned char* p = static_cast<const unsigned char*>(key);
+  seed ^= hash_mum_mix(seed ^ s0, s1);
+  uint64_t a, b;
+  if (len <= 16)
+  {
+    if (len >= 4)
+    {
+      // 4~16 个字节：读入首尾各两个可能重叠的 4 字节
+      const size_t m = (len >> 3) << 2;
+      a = (hash_read4(p) << 32) | hash_read4(p + m);
+      b = (hash_read4(p + len - 4) << 32) | hash_read4(p + len - 4 - m);
+    }
+    else if (len > 0)
+    {
+      a = hash_read_small(p, len);
+      b = 0;
+    }
+    else
+    {
+      a = b = 0;
+    }
+  }
+  else
+  {
+    size_t i = len;
+    if (i > 48)
+    {
+      // 三条互不依赖的乘法链，可以同时执行
+      uint64_t see1 = seed, see2 = seed;
+      do
+      {
+        seed = hash_mum_mix(hash_read8(p) ^ s1, hash_read8(p + 8) ^ seed);
+        see1 = hash_mum_mix(hash_read8(p + 16) ^ s2, hash_read8(p + 24) ^ see1);
+        see2 = hash_mum_mix(hash_read8(p + 32) ^ s3, hash_read8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16)
+    {
+      seed = hash_mum_mix(hash_read8(p) ^ s1, hash_read8(p + 8) ^ seed);
+      p += 16;
+      i -= 16;
+    }
+    // 最后 16 个字节，可能与已处理的部分重叠
+    a = hash_read8(p + i - 16);
+    b = hash_read8(p + i - 8);
+  }
+  a ^= s1;
+  b ^= seed;
+  hash_mum(a, b);
+  return static_cast<size_t>(hash_mum_mix(a ^ s0 ^ len, b ^ s1));
+}
+
+// 在哈希函数的结果上再用 hash_mix 打散，用于要求低位足够随机的容器，如以 2 的幂为桶个数的表
+template <class Key, class Hash = mystl::hash<Key>>
+struct mix_hash : public Hash
+{
+  size_t operator()(const Key& key) const
+  { return hash_mix(static_cast<size_t>(Hash::operator()(key))); }
+};
+
 template <>
 struct hash<float>
 {
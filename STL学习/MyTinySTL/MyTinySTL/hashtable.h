@@ -9,6 +9,7 @@
 #include "algo.h"
 #include "functional.h"
 #include "memory.h"
+#include "node_slab.h"
 #include "vector.h"
 #include "util.h"
 #include "exceptdef.h"
@@ -16,9 +17,21 @@
 namespace mystl
 {
 
-// hashtable 的节点定义
-template <class T>
-struct hashtable_node
+// 节点中缓存的哈希值，Cache 为 false 时是空基类，不占用空间
+template <bool Cache>
+struct ht_node_hash
+{
+  size_t hash_code;  // 键值的完整哈希值，还没有映射到 bucket
+};
+
+template <>
+struct ht_node_hash<false>
+{
+};
+
+// hashtable 的节点定义，Cache 为 true 时节点中缓存键值的哈希值
+template <class T, bool Cache = false>
+struct hashtable_node :public ht_node_hash<Cache>
 {
   hashtable_node* next;   // 指向下一个节点
   T               value;  // 储存实值
@@ -26,13 +39,30 @@ struct hashtable_node
   hashtable_node() = default;
   hashtable_node(const T& n) :next(nullptr), value(n) {}
 
-  hashtable_node(const hashtable_node& node) :next(node.next), value(node.value) {}
-  hashtable_node(hashtable_node&& node) :next(node.next), value(mystl::move(node.value))
+  hashtable_node(const hashtable_node& node)
+    :ht_node_hash<Cache>(node), next(node.next), value(node.value) {}
+  hashtable_node(hashtable_node&& node)
+    :ht_node_hash<Cache>(node), next(node.next), value(mystl::move(node.value))
   {
     node.next = nullptr;
   }
 };
 
+// ht_cache_hash : 是否在节点中缓存哈希值
+// 缓存之后，迭代器跨 bucket 前进、rehash 与复制都不再调用哈希函数，查找时先比较哈希值再比较键值，
+// 代价是每个节点多一个 size_t。mystl::hash 对整数、浮点数与指针几乎没有开销，缺省不缓存，
+// 其它哈希函数（如字符串）缺省缓存，可以为自己的哈希函数特化这个模板
+template <class Hash>
+struct ht_cache_hash :public std::true_type {};
+
+template <class Key>
+struct ht_cache_hash<mystl::hash<Key>>
+  :public std::integral_constant<bool, !std::is_arithmetic<Key>::value &&
+                                       !std::is_pointer<Key>::value> {};
+
+template <class Key, class Hash>
+struct ht_cache_hash<mystl::mix_hash<Key, Hash>> :public ht_cache_hash<Hash> {};
+
 // value traits
 template <class T, bool>
 struct ht_value_traits_imp
@@ -101,31 +131,34 @@ struct ht_value_traits
 
 // forward declaration
 
-template <class T, class HashFun, class KeyEqual>
+struct ht_prime_policy;
+
+template <class T, class HashFun, class KeyEqual, class Alloc = mystl::allocator<T>,
+          class Policy = mystl::ht_prime_policy>
 class hashtable;
 
-template <class T, class HashFun, class KeyEqual>
+template <class T, class HashFun, class KeyEqual, class Alloc, class Policy>
 struct ht_iterator;
 
-template <class T, class HashFun, class KeyEqual>
+template <class T, class HashFun, class KeyEqual, class Alloc, class Policy>
 struct ht_const_iterator;
 
-template <class T>
+template <class T, bool Cache>
 struct ht_local_iterator;
 
-template <class T>
+template <class T, bool Cache>
 struct ht_const_local_iterator;
 
 // ht_iterator
 
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
 struct ht_iterator_base :public mystl::iterator<mystl::forward_iterator_tag, T>
 {
-  typedef mystl::hashtable<T, Hash, KeyEqual>         hashtable;
-  typedef ht_iterator_base<T, Hash, KeyEqual>         base;
-  typedef mystl::ht_iterator<T, Hash, KeyEqual>       iterator;
-  typedef mystl::ht_const_iterator<T, Hash, KeyEqual> const_iterator;
-  typedef hashtable_node<T>*                          node_ptr;
+  typedef mystl::hashtable<T, Hash, KeyEqual, Alloc, Policy>         hashtable;
+  typedef ht_iterator_base<T, Hash, KeyEqual, Alloc, Policy>         base;
+  typedef mystl::ht_iterator<T, Hash, KeyEqual, Alloc, Policy>       iterator;
+  typedef mystl::ht_const_iterator<T, Hash, KeyEqual, Alloc, Policy> const_iterator;
+  typedef hashtable_node<T, ht_cache_hash<Hash>::value>* node_ptr;
   typedef hashtable*                                  contain_ptr;
   typedef const node_ptr                              const_node_ptr;
   typedef const contain_ptr                           const_contain_ptr;
@@ -142,10 +175,10 @@ struct ht_iterator_base :public mystl::iterator<mystl::forward_iterator_tag, T>
   bool operator!=(const base& rhs) const { return node != rhs.node; }
 };
 
-template <class T, class Hash, class KeyEqual>
-struct ht_iterator :public ht_iterator_base<T, Hash, KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+struct ht_iterator :public ht_iterator_base<T, Hash, KeyEqual, Alloc, Policy>
 {
-  typedef ht_iterator_base<T, Hash, KeyEqual> base;
+  typedef ht_iterator_base<T, Hash, KeyEqual, Alloc, Policy> base;
   typedef typename base::hashtable            hashtable;
   typedef typename base::iterator             iterator;
   typedef typename base::const_iterator       const_iterator;
@@ -206,9 +239,7 @@ struct ht_iterator :public ht_iterator_base<T, Hash, KeyEqual>
     node = node->next;
     if (node == nullptr)
     { // 如果下一个位置为空，跳到下一个 bucket 的起始处
-      auto index = ht->hash(value_traits::get_key(old->value));
-      while (!node && ++index < ht->bucket_size_)
-        node = ht->buckets_[index];
+      node = ht->next_bucket_node(old);
     }
     return *this;
   }
@@ -220,10 +251,10 @@ struct ht_iterator :public ht_iterator_base<T, Hash, KeyEqual>
   }
 };
 
-template <class T, class Hash, class KeyEqual>
-struct ht_const_iterator :public ht_iterator_base<T, Hash, KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+struct ht_const_iterator :public ht_iterator_base<T, Hash, KeyEqual, Alloc, Policy>
 {
-  typedef ht_iterator_base<T, Hash, KeyEqual> base;
+  typedef ht_iterator_base<T, Hash, KeyEqual, Alloc, Policy> base;
   typedef typename base::hashtable            hashtable;
   typedef typename base::iterator             iterator;
   typedef typename base::const_iterator       const_iterator;
@@ -284,11 +315,7 @@ struct ht_const_iterator :public ht_iterator_base<T, Hash, KeyEqual>
     node = node->next;
     if (node == nullptr)
     { // 如果下一个位置为空，跳到下一个 bucket 的起始处
-      auto index = ht->hash(value_traits::get_key(old->value));
-      while (!node && ++index < ht->bucket_size_)
-      {
-        node = ht->buckets_[index];
-      }
+      node = ht->next_bucket_node(old);
     }
     return *this;
   }
@@ -301,7 +328,7 @@ struct ht_const_iterator :public ht_iterator_base<T, Hash, KeyEqual>
 };
 
 // local iterator
-template <class T>
+template <class T, bool Cache>
 struct ht_local_iterator :public mystl::iterator<mystl::forward_iterator_tag, T>
 {
   typedef T                          value_type;
@@ -309,11 +336,11 @@ struct ht_local_iterator :public mystl::iterator<mystl::forward_iterator_tag, T>
   typedef value_type&                reference;
   typedef size_t                     size_type;
   typedef ptrdiff_t                  difference_type;
-  typedef hashtable_node<T>*         node_ptr;
+  typedef hashtable_node<T, Cache>*  node_ptr;
 
-  typedef ht_local_iterator<T>       self;
-  typedef ht_local_iterator<T>       local_iterator;
-  typedef ht_const_local_iterator<T> const_local_iterator;
+  typedef ht_local_iterator<T, Cache>       self;
+  typedef ht_local_iterator<T, Cache>       local_iterator;
+  typedef ht_const_local_iterator<T, Cache> const_local_iterator;
   node_ptr node;
 
   ht_local_iterator(node_ptr n)
@@ -350,7 +377,7 @@ struct ht_local_iterator :public mystl::iterator<mystl::forward_iterator_tag, T>
   bool operator!=(const self& other) const { return node != other.node; }
 };
 
-template <class T>
+template <class T, bool Cache>
 struct ht_const_local_iterator :public mystl::iterator<mystl::forward_iterator_tag, T>
 {
   typedef T                          value_type;
@@ -358,11 +385,11 @@ struct ht_const_local_iterator :public mystl::iterator<mystl::forward_iterator_t
   typedef const value_type&          reference;
   typedef size_t                     size_type;
   typedef ptrdiff_t                  difference_type;
-  typedef const hashtable_node<T>*   node_ptr;
+  typedef const hashtable_node<T, Cache>* node_ptr;
 
-  typedef ht_const_local_iterator<T> self;
-  typedef ht_local_iterator<T>       local_iterator;
-  typedef ht_const_local_iterator<T> const_local_iterator;
+  typedef ht_const_local_iterator<T, Cache> self;
+  typedef ht_local_iterator<T, Cache>       local_iterator;
+  typedef ht_const_local_iterator<T, Cache> const_local_iterator;
 
   node_ptr node;
 
@@ -467,14 +494,112 @@ inline size_t ht_next_prime(size_t n)
   return pos == last ? *(last - 1) : *pos;
 }
 
+/*****************************************************************************************/
+// bucket 下标策略
+// 作为 hashtable 的第五个模板参数，决定 bucket 的个数如何增长，以及哈希值如何映射为 bucket 的下标
+//   next_size(n) : 不小于 n 的 bucket 个数
+//   max_size()   : bucket 个数的上限
+//   reset(n)     : bucket 个数变为 n 时调用，预先算好 index 需要的常量
+//   index(h, n)  : 哈希值 h 在 n 个 bucket 中的下标
+/*****************************************************************************************/
+
+// 质数个 bucket，取模得到下标，对哈希值的质量要求最低
+struct ht_prime_policy
+{
+  static size_t next_size(size_t n) noexcept { return ht_next_prime(n); }
+  static size_t max_size()          noexcept { return ht_prime_list[PRIME_NUM - 1]; }
+
+  void   reset(size_t /*n*/)             noexcept {}
+  size_t index(size_t h, size_t n) const noexcept { return h % n; }
+};
+
+// 质数个 bucket，用 Lemire 的 fastmod 代替除法：
+// reset 时算出 m = floor((2^64 - 1) / n) + 1，之后 a mod n 等于 (m * a 的低 64 位) * n 的高 64 位，
+// 对 32 位的 a 与 n 总是成立。哈希值先折叠为 32 位，bucket 个数不小于 2^32
+// 或编译器不支持 128 位整数时退回取模
+struct ht_fastmod_policy
+{
+  uint64_t m = 0;
+
+  static size_t next_size(size_t n) noexcept { return ht_next_prime(n); }
+  static size_t max_size()          noexcept { return ht_prime_list[PRIME_NUM - 1]; }
+
+  void reset(size_t n) noexcept
+  {
+#if defined(__SIZEOF_INT128__)
+    m = (n > 1 && static_cast<uint64_t>(n) <= 0xffffffffull)
+      ? 0xffffffffffffffffull / n + 1 : 0;
+#else
+    (void)n;
+#endif
+  }
+
+  size_t index(size_t h, size_t n) const noexcept
+  {
+#if defined(__SIZEOF_INT128__)
+    if (m != 0)
+    {
+      const uint32_t a = static_cast<uint32_t>(h ^ (static_cast<uint64_t>(h) >> 32));
+      return static_cast<size_t>((static_cast<__uint128_t>(m * a) * n) >> 64);
+    }
+#endif
+    return h % n;
+  }
+};
+
+// 2 的幂个 bucket，下标取 h 乘以 2^w / 黄金分割比 之后的高 log2(n) 位 (Fibonacci hashing)
+// 只需要一次乘法与一次移位；乘积的高位混合了 h 的所有位，恒等映射的整数哈希也能散开
+struct ht_pow2_policy
+{
+  unsigned shift = sizeof(size_t) * 8 - 1;
+
+  static size_t next_size(size_t n) noexcept
+  {
+    size_t s = 128;
+    while (s < n && s < max_size())
+      s <<= 1;
+    return s;
+  }
+  static size_t max_size() noexcept
+  { return static_cast<size_t>(1) << (sizeof(size_t) * 8 - 1); }
+
+  void reset(size_t n) noexcept
+  {
+    unsigned k = 1;
+    while ((static_cast<size_t>(1) << k) < n)
+      ++k;
+    shift = static_cast<unsigned>(sizeof(size_t) * 8) - k;
+  }
+
+  size_t index(size_t h, size_t /*n*/) const noexcept
+  {
+#ifdef SYSTEM_64
+    return (h * 11400714819323198485ull) >> shift;
+#else
+    return (h * 2654435769u) >> shift;
+#endif
+  }
+};
+
+// 增量 rehash 时每次插入至少迁移的旧 bucket 个数
+// 实际的个数按剩余的旧 bucket 与再次超过负载上限前还能插入的元素个数计算，
+// 新数组只比旧数组大约 1.7 倍（ht_prime_policy）或负载上限较低时也能在下一次扩容前迁移完
+static constexpr size_t ht_rehash_step = 4;
+
 // 模板类 hashtable
-// 参数一代表数据类型，参数二代表哈希函数，参数三代表键值相等的比较函数
-template <class T, class Hash, class KeyEqual>
+// 参数一代表数据类型，参数二代表哈希函数，参数三代表键值相等的比较函数，参数四代表分配器类型，
+// 参数五代表 bucket 下标策略，缺省使用 ht_prime_policy
+//
+// 开启增量 rehash 后，插入使元素个数超过负载上限时只分配新的 bucket 数组，旧数组中的节点
+// 在之后的每次插入中迁移一部分 bucket，把一次搬运所有节点的停顿分摊到多次插入中。
+// 迁移期间键值在旧数组中的 bucket 还没有迁移时就在旧数组中，否则在新数组中；
+// 迭代器先遍历新数组，再遍历旧数组中还没有迁移的部分。删除与查找不做迁移
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
 class hashtable
 {  
 
-  friend struct mystl::ht_iterator<T, Hash, KeyEqual>;
-  friend struct mystl::ht_const_iterator<T, Hash, KeyEqual>;
+  friend struct mystl::ht_iterator<T, Hash, KeyEqual, Alloc, Policy>;
+  friend struct mystl::ht_const_iterator<T, Hash, KeyEqual, Alloc, Policy>;
 
 public:
   // hashtable 的型别定义
@@ -485,36 +610,55 @@ public:
   typedef Hash                                        hasher;
   typedef KeyEqual                                    key_equal;
 
-  typedef hashtable_node<T>                           node_type;
+  // 是否在节点中缓存哈希值，见 ht_cache_hash
+  static constexpr bool cache_hash = ht_cache_hash<Hash>::value;
+
+  typedef hashtable_node<T, cache_hash>               node_type;
   typedef node_type*                                  node_ptr;
-  typedef mystl::vector<node_ptr>                     bucket_type;
 
-  typedef mystl::allocator<T>                         allocator_type;
-  typedef mystl::allocator<T>                         data_allocator;
-  typedef mystl::allocator<node_type>                 node_allocator;
+  typedef Alloc                                       allocator_type;
+  typedef mystl::allocator_traits<Alloc>              alloc_traits;
+  typedef typename alloc_traits::template 
+    rebind_alloc<node_type>                           node_allocator;
+  typedef typename alloc_traits::template 
+    rebind_alloc<node_ptr>                            bucket_allocator;
+  typedef mystl::allocator_traits<node_allocator>     node_alloc_traits;
+
+  typedef mystl::vector<node_ptr, bucket_allocator>   bucket_type;
 
-  typedef typename allocator_type::pointer            pointer;
-  typedef typename allocator_type::const_pointer      const_pointer;
-  typedef typename allocator_type::reference          reference;
-  typedef typename allocator_type::const_reference    const_reference;
-  typedef typename allocator_type::size_type          size_type;
-  typedef typename allocator_type::difference_type    difference_type;
+  typedef typename alloc_traits::pointer              pointer;
+  typedef typename alloc_traits::const_pointer        const_pointer;
+  typedef value_type&                                 reference;
+  typedef const value_type&                           const_reference;
+  typedef typename alloc_traits::size_type            size_type;
+  typedef typename alloc_traits::difference_type      difference_type;
 
-  typedef mystl::ht_iterator<T, Hash, KeyEqual>       iterator;
-  typedef mystl::ht_const_iterator<T, Hash, KeyEqual> const_iterator;
-  typedef mystl::ht_local_iterator<T>                 local_iterator;
-  typedef mystl::ht_const_local_iterator<T>           const_local_iterator;
+  typedef mystl::ht_iterator<T, Hash, KeyEqual, Alloc, Policy>       iterator;
+  typedef mystl::ht_const_iterator<T, Hash, KeyEqual, Alloc, Policy> const_iterator;
+  typedef mystl::ht_local_iterator<T, cache_hash>       local_iterator;
+  typedef mystl::ht_const_local_iterator<T, cache_hash> const_local_iterator;
 
-  allocator_type get_allocator() const { return allocator_type(); }
+  allocator_type get_allocator() const { return allocator_type(node_alloc_); }
 
 private:
-  // 用以下六个参数来表现 hashtable
-  bucket_type buckets_;
-  size_type   bucket_size_;
-  size_type   size_;
-  float       mlf_;
-  hasher      hash_;
-  key_equal   equal_;
+  // 用以下七个参数来表现 hashtable，另外保存节点的分配器
+  bucket_type    buckets_;
+  size_type      bucket_size_;
+  Policy         policy_;       // 由 bucket 个数算出的下标计算常量
+  size_type      size_;
+  float          mlf_;
+  hasher         hash_;
+  key_equal      equal_;
+  node_allocator node_alloc_;
+  mystl::node_slab<node_type, node_allocator> slab_;  // 节点从这里成批分配
+
+  // 增量 rehash 的状态，old_size_ 为 0 表示没有正在进行的迁移，
+  // 否则旧数组中 [migrate_, old_size_) 的 bucket 还没有迁移到 buckets_
+  bucket_type    old_buckets_;
+  Policy         old_policy_;
+  size_type      old_size_;
+  size_type      migrate_;
+  bool           incremental_;  // 是否使用增量 rehash
 
 private:
   bool is_equal(const key_type& key1, const key_type& key2)
@@ -527,37 +671,133 @@ private:
     return equal_(key1, key2);
   }
 
-  const_iterator M_cit(node_ptr node) const noexcept
+  typedef std::integral_constant<bool, cache_hash> cache_tag;
+
+  size_t key_hash(const key_type& key) const
   {
-    return const_iterator(node, const_cast<hashtable*>(this));
+    return static_cast<size_t>(hash_(key));
   }
 
-  iterator M_begin() noexcept
+  // 节点的哈希值，缓存时直接读取，否则重新计算
+  size_t node_hash(const node_type* p, std::true_type) const
+  {
+    return p->hash_code;
+  }
+  size_t node_hash(const node_type* p, std::false_type) const
+  {
+    return key_hash(value_traits::get_key(p->value));
+  }
+  size_t node_hash(const node_type* p) const
+  {
+    return node_hash(p, cache_tag());
+  }
+
+  void set_node_hash(node_ptr p, size_t h, std::true_type) { p->hash_code = h; }
+  void set_node_hash(node_ptr,   size_t,   std::false_type) {}
+  void set_node_hash(node_ptr p, size_t h) { set_node_hash(p, h, cache_tag()); }
+
+  void copy_node_hash(node_ptr to, const node_type* from, std::true_type) { to->hash_code = from->hash_code; }
+  void copy_node_hash(node_ptr,    const node_type*,      std::false_type) {}
+
+  // 节点的键值是否等于 key，h 为 key 的哈希值，缓存时哈希值不同就不必比较键值
+  bool node_equal(const node_type* p, size_t h, const key_type& key, std::true_type) const
+  {
+    return p->hash_code == h && is_equal(value_traits::get_key(p->value), key);
+  }
+  bool node_equal(const node_type* p, size_t, const key_type& key, std::false_type) const
+  {
+    return is_equal(value_traits::get_key(p->value), key);
+  }
+  bool node_equal(const node_type* p, size_t h, const key_type& key) const
+  {
+    return node_equal(p, h, key, cache_tag());
+  }
+
+  // 节点所在的 bucket
+  size_type node_bucket(const node_type* p) const
+  {
+    return policy_.index(node_hash(p), bucket_size_);
+  }
+
+  // 哈希值为 h 的键值所在链表的头指针，迁移未完成时可能在旧数组中
+  node_ptr& bucket_head(size_t h)
   {
-    for (size_type n = 0; n < bucket_size_; ++n)
+    if (old_size_ != 0)
     {
-      if (buckets_[n])  // 找到第一个有节点的位置就返回
-        return iterator(buckets_[n], this);
+      const auto n = old_policy_.index(h, old_size_);
+      if (n >= migrate_)
+        return old_buckets_[n];
     }
-    return iterator(nullptr, this);
+    return buckets_[policy_.index(h, bucket_size_)];
+  }
+  node_ptr bucket_head(size_t h) const
+  {
+    return const_cast<hashtable*>(this)->bucket_head(h);
   }
 
-  const_iterator M_begin() const noexcept
+  // 从 buckets_ 的第 n 个 bucket 开始（in_old 为 true 时从旧数组的第 n 个开始）找第一个节点，
+  // buckets_ 之后接着旧数组中还没有迁移的部分
+  node_ptr first_node(size_type n, bool in_old) const
+  {
+    if (!in_old)
+    {
+      for (; n < bucket_size_; ++n)
+      {
+        if (buckets_[n])
+          return buckets_[n];
+      }
+      n = migrate_;
+    }
+    for (; n < old_size_; ++n)
+    {
+      if (old_buckets_[n])
+        return old_buckets_[n];
+    }
+    return nullptr;
+  }
+
+  // 哈希值为 h 的键值所在 bucket 之后的第一个节点
+  node_ptr bucket_after(size_t h) const
   {
-    for (size_type n = 0; n < bucket_size_; ++n)
+    if (old_size_ != 0)
     {
-      if (buckets_[n])  // 找到第一个有节点的位置就返回
-        return M_cit(buckets_[n]);
+      const auto n = old_policy_.index(h, old_size_);
+      if (n >= migrate_)
+        return first_node(n + 1, true);
     }
-    return M_cit(nullptr);
+    return first_node(policy_.index(h, bucket_size_) + 1, false);
+  }
+
+  // 节点 p 所在 bucket 之后的第一个节点，迭代器跨 bucket 时使用
+  node_ptr next_bucket_node(const node_type* p) const
+  {
+    return bucket_after(node_hash(p));
+  }
+
+  const_iterator M_cit(node_ptr node) const noexcept
+  {
+    return const_iterator(node, const_cast<hashtable*>(this));
+  }
+
+  iterator M_begin() noexcept
+  {
+    return iterator(first_node(0, false), this);
+  }
+
+  const_iterator M_begin() const noexcept
+  {
+    return M_cit(first_node(0, false));
   }
 
 public:
   // 构造、复制、移动、析构函数
   explicit hashtable(size_type bucket_count,
                      const Hash& hash = Hash(),
-                     const KeyEqual& equal = KeyEqual())
-    :size_(0), mlf_(1.0f), hash_(hash), equal_(equal)
+                     const KeyEqual& equal = KeyEqual(),
+                     const allocator_type& alloc = allocator_type())
+    :buckets_(bucket_allocator(alloc)), size_(0), mlf_(1.0f),
+    hash_(hash), equal_(equal), node_alloc_(alloc),
+    old_buckets_(bucket_allocator(alloc)), old_size_(0), migrate_(0), incremental_(false)
   {
     init(bucket_count);
   }
@@ -567,32 +807,53 @@ public:
     hashtable(Iter first, Iter last,
               size_type bucket_count,
               const Hash& hash = Hash(),
-              const KeyEqual& equal = KeyEqual())
-    :size_(mystl::distance(first, last)), mlf_(1.0f), hash_(hash), equal_(equal)
+              const KeyEqual& equal = KeyEqual(),
+              const allocator_type& alloc = allocator_type())
+    :buckets_(bucket_allocator(alloc)), size_(mystl::distance(first, last)), mlf_(1.0f),
+    hash_(hash), equal_(equal), node_alloc_(alloc),
+    old_buckets_(bucket_allocator(alloc)), old_size_(0), migrate_(0), incremental_(false)
   {
     init(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))));
   }
 
   hashtable(const hashtable& rhs)
-    :hash_(rhs.hash_), equal_(rhs.equal_)
+    :hashtable(rhs, allocator_type(
+      node_alloc_traits::select_on_container_copy_construction(rhs.node_alloc_)))
+  {
+  }
+  hashtable(const hashtable& rhs, const allocator_type& alloc)
+    :buckets_(bucket_allocator(alloc)), hash_(rhs.hash_), equal_(rhs.equal_), node_alloc_(alloc),
+    old_buckets_(bucket_allocator(alloc)), old_size_(0), migrate_(0), incremental_(false)
   {
     copy_init(rhs);
   }
   hashtable(hashtable&& rhs) noexcept
     : bucket_size_(rhs.bucket_size_), 
+    policy_(rhs.policy_),
     size_(rhs.size_),
     mlf_(rhs.mlf_),
     hash_(rhs.hash_),
-    equal_(rhs.equal_)
+    equal_(rhs.equal_),
+    node_alloc_(mystl::move(rhs.node_alloc_)),
+    slab_(mystl::move(rhs.slab_)),
+    old_policy_(rhs.old_policy_),
+    old_size_(rhs.old_size_),
+    migrate_(rhs.migrate_),
+    incremental_(rhs.incremental_)
   {
     buckets_ = mystl::move(rhs.buckets_);
+    old_buckets_ = mystl::move(rhs.old_buckets_);
     rhs.bucket_size_ = 0;
     rhs.size_ = 0;
     rhs.mlf_ = 0.0f;
+    rhs.old_size_ = 0;
+    rhs.migrate_ = 0;
   }
 
   hashtable& operator=(const hashtable& rhs);
-  hashtable& operator=(hashtable&& rhs) noexcept;
+  hashtable& operator=(hashtable&& rhs) noexcept(
+    node_alloc_traits::propagate_on_container_move_assignment::value ||
+    node_alloc_traits::is_always_equal::value);
 
   ~hashtable() { clear(); }
 
@@ -706,40 +967,40 @@ public:
 
   local_iterator       begin(size_type n)        noexcept
   { 
-    MYSTL_DEBUG(n < size_);
+    MYSTL_DEBUG(n < bucket_size_);
     return buckets_[n];
   }
   const_local_iterator begin(size_type n)  const noexcept
   { 
-    MYSTL_DEBUG(n < size_);
+    MYSTL_DEBUG(n < bucket_size_);
     return buckets_[n];
   }
   const_local_iterator cbegin(size_type n) const noexcept
   { 
-    MYSTL_DEBUG(n < size_);
+    MYSTL_DEBUG(n < bucket_size_);
     return buckets_[n];
   }
 
   local_iterator       end(size_type n)          noexcept
   { 
-    MYSTL_DEBUG(n < size_);
+    MYSTL_DEBUG(n < bucket_size_);
     return nullptr; 
   }
   const_local_iterator end(size_type n)    const noexcept
   { 
-    MYSTL_DEBUG(n < size_);
+    MYSTL_DEBUG(n < bucket_size_);
     return nullptr; 
   }
   const_local_iterator cend(size_type n)   const noexcept
   {
-    MYSTL_DEBUG(n < size_);
+    MYSTL_DEBUG(n < bucket_size_);
     return nullptr; 
   }
 
   size_type bucket_count()                 const noexcept
   { return bucket_size_; }
   size_type max_bucket_count()             const noexcept
-  { return ht_prime_list[PRIME_NUM - 1]; }
+  { return Policy::max_size(); }
 
   size_type bucket_size(size_type n)       const noexcept;
   size_type bucket(const key_type& key)    const
@@ -763,9 +1024,26 @@ public:
   void reserve(size_type count)
   { rehash(static_cast<size_type>((float)count / max_load_factor() + 0.5f)); }
 
+  // 增量 rehash，关闭时立即完成尚未完成的迁移
+  // [note]: 迁移期间 bucket 接口只反映新数组中的节点，需要时先调用 finish_rehash
+  void incremental_rehash(bool on)
+  {
+    if (!on)
+      finish_rehash();
+    incremental_ = on;
+  }
+  bool incremental_rehash() const noexcept { return incremental_; }
+
+  bool rehashing() const noexcept { return old_size_ != 0; }
+  void finish_rehash()            { rehash_step(old_size_); }
+
   hasher    hash_fcn() const { return hash_; }
   key_equal key_eq()   const { return equal_; }
 
+  // 两个表的元素是否相同
+  bool equal_to_multi(const hashtable& other) const;
+  bool equal_to_unique(const hashtable& other) const;
+
 private:
   // hashtable 成员函数
 
@@ -780,9 +1058,11 @@ private:
 
   // hash
   size_type next_size(size_type n) const;
-  size_type hash(const key_type& key, size_type n) const;
   size_type hash(const key_type& key) const;
   void      rehash_if_need(size_type n);
+  void      start_rehash(size_type count);
+  void      rehash_step(size_type n);
+  void      release_old_buckets();
 
   // insert
   template <class InputIter>
@@ -799,55 +1079,88 @@ private:
   iterator             insert_node_multi(node_ptr np);
 
   // bucket operator
+  void link_node(node_ptr& head, node_ptr np, size_t h);
   void replace_bucket(size_type bucket_count);
   void erase_bucket(size_type n, node_ptr first, node_ptr last);
   void erase_bucket(size_type n, node_ptr last);
 
-  // comparision
-  bool equal_to_multi(const hashtable& other);
-  bool equal_to_unique(const hashtable& other);
 };
 
 /*****************************************************************************************/
 
 // 复制赋值运算符
-template <class T, class Hash, class KeyEqual>
-hashtable<T, Hash, KeyEqual>&
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+hashtable<T, Hash, KeyEqual, Alloc, Policy>&
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 operator=(const hashtable& rhs)
 {
   if (this != &rhs)
   {
-    hashtable tmp(rhs);
-    swap(tmp);
+    clear();
+    mystl::alloc_on_copy_assign(node_alloc_, rhs.node_alloc_);
+    buckets_ = rhs.buckets_;  // bucket 的分配器按相同的规则传递，其内容会在 copy_init 中重置
+    hash_ = rhs.hash_;
+    equal_ = rhs.equal_;
+    copy_init(rhs);
   }
   return *this;
 }
 
 // 移动赋值运算符
-template <class T, class Hash, class KeyEqual>
-hashtable<T, Hash, KeyEqual>&
-hashtable<T, Hash, KeyEqual>::
-operator=(hashtable&& rhs) noexcept
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+hashtable<T, Hash, KeyEqual, Alloc, Policy>&
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
+operator=(hashtable&& rhs) noexcept(
+  node_alloc_traits::propagate_on_container_move_assignment::value ||
+  node_alloc_traits::is_always_equal::value)
 {
-  hashtable tmp(mystl::move(rhs));
-  swap(tmp);
+  if (this == &rhs)
+    return *this;
+  clear();
+  hash_ = rhs.hash_;
+  equal_ = rhs.equal_;
+  mlf_ = rhs.mlf_;
+  incremental_ = rhs.incremental_;
+  if (mystl::alloc_move_can_steal(node_alloc_, rhs.node_alloc_))
+  {
+    mystl::alloc_on_move_assign(node_alloc_, rhs.node_alloc_);
+    buckets_ = mystl::move(rhs.buckets_);
+    bucket_size_ = rhs.bucket_size_;
+    policy_ = rhs.policy_;
+    size_ = rhs.size_;
+    slab_.swap(rhs.slab_);  // clear 之后自己的 slab 为空
+    old_buckets_ = mystl::move(rhs.old_buckets_);
+    old_policy_ = rhs.old_policy_;
+    old_size_ = rhs.old_size_;
+    migrate_ = rhs.migrate_;
+    rhs.bucket_size_ = 0;
+    rhs.size_ = 0;
+    rhs.mlf_ = 0.0f;
+    rhs.old_size_ = 0;
+    rhs.migrate_ = 0;
+  }
+  else
+  { // 分配器不相等且不传递，只能逐个移动元素
+    rehash_if_need(rhs.size_);
+    for (auto it = rhs.begin(); it != rhs.end(); ++it)
+      insert_node_multi(create_node(mystl::move(*it)));
+    rhs.clear();
+  }
   return *this;
 }
 
 // 就地构造元素，键值允许重复
 // 强异常安全保证
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
 template <class ...Args>
-typename hashtable<T, Hash, KeyEqual>::iterator
-hashtable<T, Hash, KeyEqual>::
+typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::iterator
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 emplace_multi(Args&& ...args)
 {
   auto np = create_node(mystl::forward<Args>(args)...);
   try
   {
-    if ((float)(size_ + 1) > (float)bucket_size_ * max_load_factor())
-      rehash(size_ + 1);
+    rehash_if_need(1);
   }
   catch (...)
   {
@@ -859,17 +1172,16 @@ emplace_multi(Args&& ...args)
 
 // 就地构造元素，键值允许重复
 // 强异常安全保证
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
 template <class ...Args>
-pair<typename hashtable<T, Hash, KeyEqual>::iterator, bool> 
-hashtable<T, Hash, KeyEqual>::
+pair<typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::iterator, bool> 
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 emplace_unique(Args&& ...args)
 {
   auto np = create_node(mystl::forward<Args>(args)...);
   try
   {
-    if ((float)(size_ + 1) > (float)bucket_size_ * max_load_factor())
-      rehash(size_ + 1);
+    rehash_if_need(1);
   }
   catch (...)
   {
@@ -880,38 +1192,42 @@ emplace_unique(Args&& ...args)
 }
 
 // 在不需要重建表格的情况下插入新节点，键值不允许重复
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::iterator, bool>
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+pair<typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::iterator, bool>
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 insert_unique_noresize(const value_type& value)
 {
-  const auto n = hash(value_traits::get_key(value));
-  auto first = buckets_[n];
+  const auto& key = value_traits::get_key(value);
+  const auto h = key_hash(key);
+  auto& first = bucket_head(h);
   for (auto cur = first; cur; cur = cur->next)
   {
-    if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(value)))
+    if (node_equal(cur, h, key))
       return mystl::make_pair(iterator(cur, this), false);
   }
   // 让新节点成为链表的第一个节点
   auto tmp = create_node(value);  
+  set_node_hash(tmp, h);
   tmp->next = first;
-  buckets_[n] = tmp;
+  first = tmp;
   ++size_;
   return mystl::make_pair(iterator(tmp, this), true);
 }
 
 // 在不需要重建表格的情况下插入新节点，键值允许重复
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::iterator
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::iterator
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 insert_multi_noresize(const value_type& value)
 {
-  const auto n = hash(value_traits::get_key(value));
-  auto first = buckets_[n];
+  const auto& key = value_traits::get_key(value);
+  const auto h = key_hash(key);
+  auto& first = bucket_head(h);
   auto tmp = create_node(value);
+  set_node_hash(tmp, h);
   for (auto cur = first; cur; cur = cur->next)
   {
-    if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(value)))
+    if (node_equal(cur, h, key))
     { // 如果链表中存在相同键值的节点就马上插入，然后返回
       tmp->next = cur->next;
       cur->next = tmp;
@@ -921,24 +1237,24 @@ insert_multi_noresize(const value_type& value)
   }
   // 否则插入在链表头部
   tmp->next = first;
-  buckets_[n] = tmp;
+  first = tmp;
   ++size_;
   return iterator(tmp, this);
 }
 
 // 删除迭代器所指的节点
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 erase(const_iterator position)
 {
   auto p = position.node;
   if (p)
   {
-    const auto n = hash(value_traits::get_key(p->value));
-    auto cur = buckets_[n];
+    auto& head = bucket_head(node_hash(p));
+    auto cur = head;
     if (cur == p)
     { // p 位于链表头部
-      buckets_[n] = cur->next;
+      head = cur->next;
       destroy_node(cur);
       --size_;
     }
@@ -965,17 +1281,28 @@ erase(const_iterator position)
 }
 
 // 删除[first, last)内的节点
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 erase(const_iterator first, const_iterator last)
 {
   if (first.node == last.node)
     return;
+  if (old_size_ != 0)
+  { // 迁移未完成时节点分布在两个数组中，逐个删除
+    while (first != last)
+    {
+      auto next = first;
+      ++next;
+      erase(first);
+      first = next;
+    }
+    return;
+  }
   auto first_bucket = first.node 
-    ? hash(value_traits::get_key(first.node->value)) 
+    ? node_bucket(first.node) 
     : bucket_size_;
   auto last_bucket = last.node 
-    ? hash(value_traits::get_key(last.node->value))
+    ? node_bucket(last.node)
     : bucket_size_;
   if (first_bucket == last_bucket)
   { // 如果在 bucket 在同一个位置
@@ -997,32 +1324,34 @@ erase(const_iterator first, const_iterator last)
 }
 
 // 删除键值为 key 的节点
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 erase_multi(const key_type& key)
 {
   auto p = equal_range_multi(key);
   if (p.first.node != nullptr)
   {
+    const size_type n = mystl::distance(p.first, p.second);  // 删除之后迭代器失效，先计数
     erase(p.first, p.second);
-    return mystl::distance(p.first, p.second);
+    return n;
   }
   return 0;
 }
 
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 erase_unique(const key_type& key)
 {
-  const auto n = hash(key);
-  auto first = buckets_[n];
+  const auto h = key_hash(key);
+  auto& head = bucket_head(h);
+  auto first = head;
   if (first)
   {
-    if (is_equal(value_traits::get_key(first->value), key))
+    if (node_equal(first, h, key))
     {
-      buckets_[n] = first->next;
+      head = first->next;
       destroy_node(first);
       --size_;
       return 1;
@@ -1032,7 +1361,7 @@ erase_unique(const key_type& key)
       auto next = first->next;
       while (next)
       {
-        if (is_equal(value_traits::get_key(next->value), key))
+        if (node_equal(next, h, key))
         {
           first->next = next->next;
           destroy_node(next);
@@ -1048,8 +1377,8 @@ erase_unique(const key_type& key)
 }
 
 // 清空 hashtable
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 clear()
 {
   if (size_ != 0)
@@ -1065,14 +1394,26 @@ clear()
       }
       buckets_[i] = nullptr;
     }
+    for (size_type i = migrate_; i < old_size_; ++i)
+    {
+      node_ptr cur = old_buckets_[i];
+      while (cur != nullptr)
+      {
+        node_ptr next = cur->next;
+        destroy_node(cur);
+        cur = next;
+      }
+    }
     size_ = 0;
   }
+  release_old_buckets();
+  slab_.release(node_alloc_);
 }
 
 // 在某个 bucket 节点的个数
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 bucket_size(size_type n) const noexcept
 {
   size_type result = 0;
@@ -1084,11 +1425,12 @@ bucket_size(size_type n) const noexcept
 }
 
 // 重新对元素进行一遍哈希，插入到新的位置
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 rehash(size_type count)
 {
-  auto n = ht_next_prime(count);
+  finish_rehash();  // 显式 rehash 时先完成尚未完成的迁移
+  auto n = next_size(count);
   if (n > bucket_size_)
   {
     replace_bucket(n);
@@ -1104,160 +1446,152 @@ rehash(size_type count)
 }
 
 // 查找键值为 key 的节点，返回其迭代器
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::iterator
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::iterator
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 find(const key_type& key)
 {
-  const auto n = hash(key);
-  node_ptr first = buckets_[n];
-  for (; first && !is_equal(value_traits::get_key(first->value), key); first = first->next) {}
+  const auto h = key_hash(key);
+  node_ptr first = bucket_head(h);
+  for (; first && !node_equal(first, h, key); first = first->next) {}
   return iterator(first, this);
 }
 
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::const_iterator
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::const_iterator
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 find(const key_type& key) const
 {
-  const auto n = hash(key);
-  node_ptr first = buckets_[n];
-  for (; first && !is_equal(value_traits::get_key(first->value), key); first = first->next) {}
+  const auto h = key_hash(key);
+  node_ptr first = bucket_head(h);
+  for (; first && !node_equal(first, h, key); first = first->next) {}
   return M_cit(first);
 }
 
 // 查找键值为 key 出现的次数
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 count(const key_type& key) const
 {
-  const auto n = hash(key);
+  const auto h = key_hash(key);
   size_type result = 0;
-  for (node_ptr cur = buckets_[n]; cur; cur = cur->next)
+  for (node_ptr cur = bucket_head(h); cur; cur = cur->next)
   {
-    if (is_equal(value_traits::get_key(cur->value), key))
+    if (node_equal(cur, h, key))
       ++result;
   }
   return result;
 }
 
 // 查找与键值 key 相等的区间，返回一个 pair，指向相等区间的首尾
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::iterator,
-  typename hashtable<T, Hash, KeyEqual>::iterator>
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+pair<typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::iterator,
+  typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::iterator>
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 equal_range_multi(const key_type& key)
 {
-  const auto n = hash(key);
-  for (node_ptr first = buckets_[n]; first; first = first->next)
+  const auto h = key_hash(key);
+  for (node_ptr first = bucket_head(h); first; first = first->next)
   {
-    if (is_equal(value_traits::get_key(first->value), key))
+    if (node_equal(first, h, key))
     { // 如果出现相等的键值
       for (node_ptr second = first->next; second; second = second->next)
       {
-        if (!is_equal(value_traits::get_key(second->value), key))
+        if (!node_equal(second, h, key))
           return mystl::make_pair(iterator(first, this), iterator(second, this));
       }
-      for (auto m = n + 1; m < bucket_size_; ++m)
-      { // 整个链表都相等，查找下一个链表出现的位置
-        if (buckets_[m])
-          return mystl::make_pair(iterator(first, this), iterator(buckets_[m], this));
-      }
-      return mystl::make_pair(iterator(first, this), end());
+      // 整个链表都相等，下一个链表的起始处就是区间的尾部
+      return mystl::make_pair(iterator(first, this), iterator(bucket_after(h), this));
     }
   }
   return mystl::make_pair(end(), end());
 }
 
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::const_iterator,
-  typename hashtable<T, Hash, KeyEqual>::const_iterator>
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+pair<typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::const_iterator,
+  typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::const_iterator>
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 equal_range_multi(const key_type& key) const
 {
-  const auto n = hash(key);
-  for (node_ptr first = buckets_[n]; first; first = first->next)
+  const auto h = key_hash(key);
+  for (node_ptr first = bucket_head(h); first; first = first->next)
   {
-    if (is_equal(value_traits::get_key(first->value), key))
+    if (node_equal(first, h, key))
     {
       for (node_ptr second = first->next; second; second = second->next)
       {
-        if (!is_equal(value_traits::get_key(second->value), key))
+        if (!node_equal(second, h, key))
           return mystl::make_pair(M_cit(first), M_cit(second));
       }
-      for (auto m = n + 1; m < bucket_size_; ++m)
-      { // 整个链表都相等，查找下一个链表出现的位置
-        if (buckets_[m])
-          return mystl::make_pair(M_cit(first), M_cit(buckets_[m]));
-      }
-      return mystl::make_pair(M_cit(first), cend());
+      // 整个链表都相等，下一个链表的起始处就是区间的尾部
+      return mystl::make_pair(M_cit(first), M_cit(bucket_after(h)));
     }
   }
   return mystl::make_pair(cend(), cend());
 }
 
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::iterator,
-  typename hashtable<T, Hash, KeyEqual>::iterator>
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+pair<typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::iterator,
+  typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::iterator>
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 equal_range_unique(const key_type& key)
 {
-  const auto n = hash(key);
-  for (node_ptr first = buckets_[n]; first; first = first->next)
+  const auto h = key_hash(key);
+  for (node_ptr first = bucket_head(h); first; first = first->next)
   {
-    if (is_equal(value_traits::get_key(first->value), key))
+    if (node_equal(first, h, key))
     {
       if (first->next)
         return mystl::make_pair(iterator(first, this), iterator(first->next, this));
-      for (auto m = n + 1; m < bucket_size_; ++m)
-      { // 整个链表都相等，查找下一个链表出现的位置
-        if (buckets_[m])
-          return mystl::make_pair(iterator(first, this), iterator(buckets_[m], this));
-      }
-      return mystl::make_pair(iterator(first, this), end());
+      // 整个链表都相等，下一个链表的起始处就是区间的尾部
+      return mystl::make_pair(iterator(first, this), iterator(bucket_after(h), this));
     }
   }
   return mystl::make_pair(end(), end());
 }
 
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::const_iterator,
-  typename hashtable<T, Hash, KeyEqual>::const_iterator>
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+pair<typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::const_iterator,
+  typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::const_iterator>
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 equal_range_unique(const key_type& key) const
 {
-  const auto n = hash(key);
-  for (node_ptr first = buckets_[n]; first; first = first->next)
+  const auto h = key_hash(key);
+  for (node_ptr first = bucket_head(h); first; first = first->next)
   {
-    if (is_equal(value_traits::get_key(first->value), key))
+    if (node_equal(first, h, key))
     {
       if (first->next)
         return mystl::make_pair(M_cit(first), M_cit(first->next));
-      for (auto m = n + 1; m < bucket_size_; ++m)
-      { // 整个链表都相等，查找下一个链表出现的位置
-        if (buckets_[m])
-          return mystl::make_pair(M_cit(first), M_cit(buckets_[m]));
-      }
-      return mystl::make_pair(M_cit(first), cend());
+      // 整个链表都相等，下一个链表的起始处就是区间的尾部
+      return mystl::make_pair(M_cit(first), M_cit(bucket_after(h)));
     }
   }
   return mystl::make_pair(cend(), cend());
 }
 
 // 交换 hashtable
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 swap(hashtable& rhs) noexcept
 {
   if (this != &rhs)
   {
     buckets_.swap(rhs.buckets_);
     mystl::swap(bucket_size_, rhs.bucket_size_);
+    mystl::swap(policy_, rhs.policy_);
     mystl::swap(size_, rhs.size_);
     mystl::swap(mlf_, rhs.mlf_);
     mystl::swap(hash_, rhs.hash_);
     mystl::swap(equal_, rhs.equal_);
+    mystl::alloc_on_swap(node_alloc_, rhs.node_alloc_);
+    slab_.swap(rhs.slab_);
+    old_buckets_.swap(rhs.old_buckets_);
+    mystl::swap(old_policy_, rhs.old_policy_);
+    mystl::swap(old_size_, rhs.old_size_);
+    mystl::swap(migrate_, rhs.migrate_);
+    mystl::swap(incremental_, rhs.incremental_);
   }
 }
 
@@ -1265,8 +1599,8 @@ swap(hashtable& rhs) noexcept
 // helper function
 
 // init 函数
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 init(size_type n)
 {
   const auto bucket_nums = next_size(n);
@@ -1282,13 +1616,32 @@ init(size_type n)
     throw;
   }
   bucket_size_ = buckets_.size();
+  policy_.reset(bucket_size_);
 }
 
 // copy_init 函数
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 copy_init(const hashtable& ht)
 {
+  incremental_ = ht.incremental_;
+  if (ht.old_size_ != 0)
+  { // ht 的迁移还没有完成，逐个复制节点，复制出的表不再处于迁移中
+    init(ht.bucket_size_);
+    mlf_ = ht.mlf_;
+    size_ = 0;
+    try
+    {
+      for (auto it = ht.begin(); it != ht.end(); ++it)
+        insert_node_multi(create_node(*it));
+    }
+    catch (...)
+    {
+      clear();
+      throw;
+    }
+    return;
+  }
   bucket_size_ = 0;
   buckets_.reserve(ht.bucket_size_);
   buckets_.assign(ht.bucket_size_, nullptr);
@@ -1300,16 +1653,19 @@ copy_init(const hashtable& ht)
       if (cur)
       { // 如果某 bucket 存在链表
         auto copy = create_node(cur->value);
+        copy_node_hash(copy, cur, cache_tag());
         buckets_[i] = copy;
         for (auto next = cur->next; next; cur = next, next = cur->next)
         {  //复制链表
           copy->next = create_node(next->value);
           copy = copy->next;
+          copy_node_hash(copy, next, cache_tag());
         }
         copy->next = nullptr;
       }
     }
     bucket_size_ = ht.bucket_size_;
+    policy_ = ht.policy_;
     mlf_ = ht.mlf_;
     size_ = ht.size_;
   }
@@ -1320,74 +1676,137 @@ copy_init(const hashtable& ht)
 }
 
 // create_node 函数
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
 template <class ...Args>
-typename hashtable<T, Hash, KeyEqual>::node_ptr
-hashtable<T, Hash, KeyEqual>::
+typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::node_ptr
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 create_node(Args&& ...args)
 {
-  node_ptr tmp = node_allocator::allocate(1);
+  node_ptr tmp = slab_.allocate(node_alloc_);
   try
   {
-    data_allocator::construct(mystl::address_of(tmp->value), mystl::forward<Args>(args)...);
+    node_alloc_traits::construct(node_alloc_, mystl::address_of(tmp->value),
+                                 mystl::forward<Args>(args)...);
     tmp->next = nullptr;
   }
   catch (...)
   {
-    node_allocator::deallocate(tmp);
+    slab_.deallocate(tmp);
     throw;
   }
   return tmp;
 }
 
 // destroy_node 函数
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 destroy_node(node_ptr node)
 {
-  data_allocator::destroy(mystl::address_of(node->value));
-  node_allocator::deallocate(node);
+  node_alloc_traits::destroy(node_alloc_, mystl::address_of(node->value));
+  slab_.deallocate(node);
   node = nullptr;
 }
 
 // next_size 函数
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::next_size(size_type n) const
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::next_size(size_type n) const
 {
-  return ht_next_prime(n);
+  return Policy::next_size(n);
 }
 
 // hash 函数
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
-hash(const key_type& key, size_type n) const
-{
-  return hash_(key) % n;
-}
-
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 hash(const key_type& key) const
 {
-  return hash_(key) % bucket_size_;
+  return policy_.index(key_hash(key), bucket_size_);
 }
 
 // rehash_if_need 函数
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 rehash_if_need(size_type n)
 {
+  if (old_size_ != 0)
+  { // 每次插入迁移一部分旧 bucket，保证在元素个数再次超过负载上限的那次插入之前迁移完
+    const auto limit = static_cast<size_type>((float)bucket_size_ * max_load_factor());
+    const auto room = limit > size_ ? limit - size_ : 1;
+    const auto rest = old_size_ - migrate_;
+    rehash_step(mystl::max(ht_rehash_step, (rest + room - 1) / room));
+  }
   if (static_cast<float>(size_ + n) > (float)bucket_size_ * max_load_factor())
-    rehash(size_ + n);
+  {
+    if (incremental_ && n == 1)
+      start_rehash(size_ + n);
+    else
+      rehash(size_ + n);
+  }
+}
+
+// start_rehash 函数
+// 开始增量 rehash：只分配新的 bucket 数组，旧数组中的节点留到之后的插入中迁移
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
+start_rehash(size_type count)
+{
+  const auto n = next_size(count);
+  if (n <= bucket_size_)
+    return;
+  finish_rehash();  // 上一次迁移还没有完成，先一次做完
+  bucket_type bucket(n, bucket_allocator(node_alloc_));
+  old_buckets_.swap(buckets_);
+  buckets_.swap(bucket);
+  old_policy_ = policy_;
+  old_size_ = bucket_size_;
+  migrate_ = 0;
+  bucket_size_ = n;
+  policy_.reset(n);
+}
+
+// rehash_step 函数
+// 把旧数组中最多 n 个 bucket 的节点迁移到 buckets_，全部迁移完就释放旧数组
+// 每个节点先从旧链表中摘下再链接到新链表，中途抛出异常时表仍然完整
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
+rehash_step(size_type n)
+{
+  if (old_size_ == 0)
+    return;
+  const auto last = old_size_ - migrate_ > n ? migrate_ + n : old_size_;
+  for (; migrate_ < last; ++migrate_)
+  {
+    auto& head = old_buckets_[migrate_];
+    while (head)
+    {
+      const auto h = node_hash(head);
+      auto np = head;
+      head = np->next;
+      link_node(buckets_[policy_.index(h, bucket_size_)], np, h);
+    }
+  }
+  if (migrate_ == old_size_)
+    release_old_buckets();
+}
+
+// release_old_buckets 函数
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
+release_old_buckets()
+{
+  if (old_size_ != 0)
+  {
+    bucket_type(bucket_allocator(node_alloc_)).swap(old_buckets_);
+    old_size_ = 0;
+    migrate_ = 0;
+  }
 }
 
 // copy_insert
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
 template <class InputIter>
-void hashtable<T, Hash, KeyEqual>::
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 copy_insert_multi(InputIter first, InputIter last, mystl::input_iterator_tag)
 {
   rehash_if_need(mystl::distance(first, last));
@@ -1395,9 +1814,9 @@ copy_insert_multi(InputIter first, InputIter last, mystl::input_iterator_tag)
     insert_multi_noresize(*first);
 }
 
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
 template <class ForwardIter>
-void hashtable<T, Hash, KeyEqual>::
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 copy_insert_multi(ForwardIter first, ForwardIter last, mystl::forward_iterator_tag)
 {
   size_type n = mystl::distance(first, last);
@@ -1406,9 +1825,9 @@ copy_insert_multi(ForwardIter first, ForwardIter last, mystl::forward_iterator_t
     insert_multi_noresize(*first);
 }
 
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
 template <class InputIter>
-void hashtable<T, Hash, KeyEqual>::
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 copy_insert_unique(InputIter first, InputIter last, mystl::input_iterator_tag)
 {
   rehash_if_need(mystl::distance(first, last));
@@ -1416,9 +1835,9 @@ copy_insert_unique(InputIter first, InputIter last, mystl::input_iterator_tag)
     insert_unique_noresize(*first);
 }
 
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
 template <class ForwardIter>
-void hashtable<T, Hash, KeyEqual>::
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 copy_insert_unique(ForwardIter first, ForwardIter last, mystl::forward_iterator_tag)
 {
   size_type n = mystl::distance(first, last);
@@ -1428,22 +1847,25 @@ copy_insert_unique(ForwardIter first, ForwardIter last, mystl::forward_iterator_
 }
 
 // insert_node 函数
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::iterator
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::iterator
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 insert_node_multi(node_ptr np)
 {
-  const auto n = hash(value_traits::get_key(np->value));
-  auto cur = buckets_[n];
+  const auto& key = value_traits::get_key(np->value);
+  const auto h = key_hash(key);
+  set_node_hash(np, h);
+  auto& head = bucket_head(h);
+  auto cur = head;
   if (cur == nullptr)
   {
-    buckets_[n] = np;
+    head = np;
     ++size_;
     return iterator(np, this);
   }
   for (; cur; cur = cur->next)
   {
-    if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(np->value)))
+    if (node_equal(cur, h, key))
     {
       np->next = cur->next;
       cur->next = np;
@@ -1451,81 +1873,92 @@ insert_node_multi(node_ptr np)
       return iterator(np, this);
     }
   }
-  np->next = buckets_[n];
-  buckets_[n] = np;
+  np->next = head;
+  head = np;
   ++size_;
   return iterator(np, this);
 }
 
 // insert_node_unique 函数
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::iterator, bool>
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+pair<typename hashtable<T, Hash, KeyEqual, Alloc, Policy>::iterator, bool>
+hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 insert_node_unique(node_ptr np)
 {
-  const auto n = hash(value_traits::get_key(np->value));
-  auto cur = buckets_[n];
+  const auto& key = value_traits::get_key(np->value);
+  const auto h = key_hash(key);
+  set_node_hash(np, h);
+  auto& head = bucket_head(h);
+  auto cur = head;
   if (cur == nullptr)
   {
-    buckets_[n] = np;
+    head = np;
     ++size_;
     return mystl::make_pair(iterator(np, this), true);
   }
   for (; cur; cur = cur->next)
   {
-    if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(np->value)))
-    {
+    if (node_equal(cur, h, key))
+    { // 键值已存在，新节点不会被插入，需要释放
+      destroy_node(np);
       return mystl::make_pair(iterator(cur, this), false);
     }
   }
-  np->next = buckets_[n];
-  buckets_[n] = np;
+  np->next = head;
+  head = np;
   ++size_;
   return mystl::make_pair(iterator(np, this), true);
 }
 
+// link_node 函数
+// 把哈希值为 h 的节点 np 链接到以 head 开头的链表中，键值相同的节点保持相邻
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
+link_node(node_ptr& head, node_ptr np, size_t h)
+{
+  for (auto cur = head; cur; cur = cur->next)
+  {
+    if (node_equal(cur, h, value_traits::get_key(np->value)))
+    {
+      np->next = cur->next;
+      cur->next = np;
+      return;
+    }
+  }
+  np->next = head;
+  head = np;
+}
+
 // replace_bucket 函数
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 replace_bucket(size_type bucket_count)
 {
-  bucket_type bucket(bucket_count);
+  bucket_type bucket(bucket_count, bucket_allocator(node_alloc_));
+  Policy policy;
+  policy.reset(bucket_count);
   if (size_ != 0)
-  {
+  { // 直接把原有节点链接到新的 bucket 中，不再复制节点
     for (size_type i = 0; i < bucket_size_; ++i)
     {
-      for (auto first = buckets_[i]; first; first = first->next)
+      for (auto first = buckets_[i]; first; )
       {
-        auto tmp = create_node(first->value);
-        const auto n = hash(value_traits::get_key(first->value), bucket_count);
-        auto f = bucket[n];
-        bool is_inserted = false;
-        for (auto cur = f; cur; cur = cur->next)
-        {
-          if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(first->value)))
-          {
-            tmp->next = cur->next;
-            cur->next = tmp;
-            is_inserted = true;
-            break;
-          }
-        }
-        if (!is_inserted)
-        {
-          tmp->next = f;
-          bucket[n] = tmp;
-        }
+        auto next = first->next;
+        const auto h = node_hash(first);
+        link_node(bucket[policy.index(h, bucket_count)], first, h);
+        first = next;
       }
     }
   }
   buckets_.swap(bucket);
   bucket_size_ = buckets_.size();
+  policy_ = policy;
 }
 
 // erase_bucket 函数
 // 在第 n 个 bucket 内，删除 [first, last) 的节点
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 erase_bucket(size_type n, node_ptr first, node_ptr last)
 {
   auto cur = buckets_[n];
@@ -1549,8 +1982,8 @@ erase_bucket(size_type n, node_ptr first, node_ptr last)
 
 // erase_bucket 函数
 // 在第 n 个 bucket 内，删除 [buckets_[n], last) 的节点
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void hashtable<T, Hash, KeyEqual, Alloc, Policy>::
 erase_bucket(size_type n, node_ptr last)
 {
   auto cur = buckets_[n];
@@ -1565,8 +1998,8 @@ erase_bucket(size_type n, node_ptr last)
 }
 
 // equal_to 函数
-template <class T, class Hash, class KeyEqual>
-bool hashtable<T, Hash, KeyEqual>::equal_to_multi(const hashtable& other)
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+bool hashtable<T, Hash, KeyEqual, Alloc, Policy>::equal_to_multi(const hashtable& other) const
 {
   if (size_ != other.size_)
     return false;
@@ -1574,16 +2007,16 @@ bool hashtable<T, Hash, KeyEqual>::equal_to_multi(const hashtable& other)
   {
     auto p1 = equal_range_multi(value_traits::get_key(*f));
     auto p2 = other.equal_range_multi(value_traits::get_key(*f));
-    if (mystl::distance(p1.first, p1.last) != mystl::distance(p2.first, p2.last) ||
-        !mystl::is_permutation(p1.first, p2.last, p2.first, p2.last))
+    if (mystl::distance(p1.first, p1.second) != mystl::distance(p2.first, p2.second) ||
+        !mystl::is_permutation(p1.first, p1.second, p2.first, p2.second))
       return false;
-    f = p1.last;
+    f = p1.second;
   }
   return true;
 }
 
-template <class T, class Hash, class KeyEqual>
-bool hashtable<T, Hash, KeyEqual>::equal_to_unique(const hashtable& other)
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+bool hashtable<T, Hash, KeyEqual, Alloc, Policy>::equal_to_unique(const hashtable& other) const
 {
   if (size_ != other.size_)
     return false;
@@ -1597,9 +2030,9 @@ bool hashtable<T, Hash, KeyEqual>::equal_to_unique(const hashtable& other)
 }
 
 // 重载 mystl 的 swap
-template <class T, class Hash, class KeyEqual>
-void swap(hashtable<T, Hash, KeyEqual>& lhs,
-          hashtable<T, Hash, KeyEqual>& rhs) noexcept
+template <class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void swap(hashtable<T, Hash, KeyEqual, Alloc, Policy>& lhs,
+          hashtable<T, Hash, KeyEqual, Alloc, Policy>& rhs) noexcept
 {
   lhs.swap(rhs);
 }
@@ -29,7 +29,9 @@ void push_heap_aux(RandomIter first, Distance holeIndex, Distance topIndex, T va
 template <class RandomIter, class Distance>
 void push_heap_d(RandomIter first, RandomIter last, Distance*)
 {
-  mystl::push_heap_aux(first, (last - first) - 1, static_cast<Distance>(0), *(last - 1));
+  typedef typename iterator_traits<RandomIter>::value_type value_type;
+  mystl::push_heap_aux(first, (last - first) - 1, static_cast<Distance>(0),
+                       value_type(*(last - 1)));
 }
 
 template <class RandomIter>
@@ -56,8 +58,9 @@ void push_heap_aux(RandomIter first, Distance holeIndex, Distance topIndex, T va
 template <class RandomIter, class Compared, class Distance>
 void push_heap_d(RandomIter first, RandomIter last, Distance*, Compared comp)
 {
+  typedef typename iterator_traits<RandomIter>::value_type value_type;
   mystl::push_heap_aux(first, (last - first) - 1, static_cast<Distance>(0),
-                       *(last - 1), comp);
+                       value_type(*(last - 1)), comp);
 }
 
 template <class RandomIter, class Compared>
@@ -69,6 +72,7 @@ void push_heap(RandomIter first, RandomIter last, Compared comp)
 /*****************************************************************************************/
 // pop_heap
 // 该函数接受两个迭代器，表示 heap 容器的首尾，将 heap 的根节点取出放到容器尾部，调整 heap
+// 调用者传入的 value 必须是 value_type 的副本，迭代器的 reference 为代理对象时也不会被覆盖
 /*****************************************************************************************/
 template <class RandomIter, class T, class Distance>
 void adjust_heap(RandomIter first, Distance holeIndex, Distance len, T value)
@@ -105,7 +109,9 @@ void pop_heap_aux(RandomIter first, RandomIter last, RandomIter result, T value,
 template <class RandomIter>
 void pop_heap(RandomIter first, RandomIter last)
 {
-  mystl::pop_heap_aux(first, last - 1, last - 1, *(last - 1), distance_type(first));
+  typedef typename iterator_traits<RandomIter>::value_type value_type;
+  mystl::pop_heap_aux(first, last - 1, last - 1, value_type(*(last - 1)),
+                      distance_type(first));
 }
 
 // 重载版本使用函数对象 comp 代替比较操作
@@ -143,7 +149,8 @@ void pop_heap_aux(RandomIter first, RandomIter last, RandomIter result,
 template <class RandomIter, class Compared>
 void pop_heap(RandomIter first, RandomIter last, Compared comp)
 {
-  mystl::pop_heap_aux(first, last - 1, last - 1, *(last - 1),
+  typedef typename iterator_traits<RandomIter>::value_type value_type;
+  mystl::pop_heap_aux(first, last - 1, last - 1, value_type(*(last - 1)),
                       distance_type(first), comp);
 }
 
@@ -178,6 +185,7 @@ void sort_heap(RandomIter first, RandomIter last, Compared comp)
 template <class RandomIter, class Distance>
 void make_heap_aux(RandomIter first, RandomIter last, Distance*)
 {
+  typedef typename iterator_traits<RandomIter>::value_type value_type;
   if (last - first < 2)
     return;
   auto len = last - first;
@@ -185,7 +193,7 @@ void make_heap_aux(RandomIter first, RandomIter last, Distance*)
   while (true)
   {
     // 重排以 holeIndex 为首的子树
-    mystl::adjust_heap(first, holeIndex, len, *(first + holeIndex));
+    mystl::adjust_heap(first, holeIndex, len, value_type(*(first + holeIndex)));
     if (holeIndex == 0)
       return;
     holeIndex--;
@@ -202,6 +210,7 @@ void make_heap(RandomIter first, RandomIter last)
 template <class RandomIter, class Distance, class Compared>
 void make_heap_aux(RandomIter first, RandomIter last, Distance*, Compared comp)
 {
+  typedef typename iterator_traits<RandomIter>::value_type value_type;
   if (last - first < 2)
     return;
   auto len = last - first;
@@ -209,7 +218,7 @@ void make_heap_aux(RandomIter first, RandomIter last, Distance*, Compared comp)
   while (true)
   {
     // 重排以 holeIndex 为首的子树
-    mystl::adjust_heap(first, holeIndex, len, *(first + holeIndex), comp);
+    mystl::adjust_heap(first, holeIndex, len, value_type(*(first + holeIndex)), comp);
     if (holeIndex == 0)
       return;
     holeIndex--;
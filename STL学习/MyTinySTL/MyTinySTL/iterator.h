@@ -129,6 +129,22 @@ struct is_iterator :
 {
 };
 
+// 分段迭代器：由若干段连续存储拼接而成的序列的迭代器，如 deque_iterator。
+// 特化 segmented_iterator_traits 的迭代器需要提供：
+//   segment_iterator / local_iterator : 段的迭代器，以及段内的迭代器(通常是指针)
+//   segment(it) / local(it)           : it 所在的段以及段内的位置
+//   begin(seg) / end(seg)             : 段的头尾
+//   compose(seg, p)                   : 由段和段内位置得到迭代器，p 为段尾时转到下一段的头部
+// algobase.h、algo.h、numeric.h 中的部分算法据此逐段处理，每一段上直接使用指针
+template <class Iterator>
+struct segmented_iterator_traits
+{
+  typedef std::false_type is_segmented;
+};
+
+template <class Iterator>
+struct is_segmented_iterator : public segmented_iterator_traits<Iterator>::is_segmented {};
+
 // 萃取某个迭代器的 category
 template <class Iterator>
 typename iterator_traits<Iterator>::iterator_category
@@ -0,0 +1,240 @@
+#ifndef MYTINYSTL_LARGE_ALLOC_H_
+#define MYTINYSTL_LARGE_ALLOC_H_
+
+// 这个头文件包含一个类 large_alloc，为大块内存提供单独的分配路径
+//
+// Linux 下直接向内核申请匿名映射(mmap)，按 2M 对齐并用 madvise(MADV_HUGEPAGE) 请求透明大页，
+// 扫描上千万个元素的 vector 时可以大幅减少 TLB miss；
+// 还可以用 set_numa_node 指定 NUMA 节点，之后申请的内存通过 mbind 优先放在该节点上，
+// 缺省不绑定，由首次访问(first-touch)的线程所在节点决定。其它平台退回 std::malloc。
+//
+// 在包含 allocator.h 之前定义 MYSTL_USE_LARGE_ALLOC，可以令 mystl::allocator<T> 与 alloc 中
+// 不小于 MYSTL_LARGE_ALLOC_THRESHOLD（缺省 2M）的请求改用这条路径，这个宏必须对程序中所有的编译单元一致地定义
+//
+// reallocate 与 try_expand 用 mremap 调整映射：能原地扩展时不移动，否则由内核重新映射页表，
+// 都不需要复制数据，vector 与 basic_string 扩容时借此避免 O(n) 的复制
+
+#include <new>
+#include <atomic>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define MYSTL_LARGE_ALLOC_MMAP 1
+#else
+#define MYSTL_LARGE_ALLOC_MMAP 0
+#endif
+
+#ifndef MYSTL_LARGE_ALLOC_THRESHOLD
+#define MYSTL_LARGE_ALLOC_THRESHOLD (2 * 1024 * 1024)
+#endif
+
+namespace mystl
+{
+
+// 大页的大小与普通页的大小
+enum { EHugePageBytes = 2 * 1024 * 1024, EPageBytes = 4096 };
+
+// 大块内存的空间配置类
+// 所有函数都是静态的，分配与释放时必须传入相同的大小
+class large_alloc
+{
+public:
+  static void* allocate(size_t n);
+  static void  deallocate(void* p, size_t n) noexcept;
+
+  // 把 p 指向的大小为 old_n 的空间调整为 new_n，内容保持不变，可能移动到新的地址
+  static void* reallocate(void* p, size_t old_n, size_t new_n);
+  // 只尝试原地扩展，成功时返回 true，失败时原空间不变
+  static bool  try_expand(void* p, size_t old_n, size_t new_n) noexcept;
+
+  // 大于等于这个值的请求才交给 large_alloc
+  static constexpr size_t threshold() noexcept
+  { return static_cast<size_t>(MYSTL_LARGE_ALLOC_THRESHOLD); }
+  static constexpr bool   is_large(size_t n) noexcept
+  { return n >= threshold(); }
+
+  // 之后申请的内存优先放在 node 节点上，node < 0 表示不绑定
+  static void set_numa_node(int node) noexcept { M_node().store(node); }
+  static int  numa_node() noexcept             { return M_node().load(); }
+
+  // 是否请求透明大页，缺省开启
+  static void set_huge_page(bool on) noexcept  { M_huge().store(on); }
+  static bool huge_page() noexcept             { return M_huge().load(); }
+
+  // 映射 n bytes 实际占用的大小：开启大页时上调到 2M 的倍数，否则上调到页大小的倍数
+  static size_t map_size(size_t n) noexcept;
+
+private:
+  static std::atomic<int>&  M_node() noexcept;
+  static std::atomic<bool>& M_huge() noexcept;
+
+  static void* M_map(size_t size);
+  static void  M_advise(void* p, size_t size) noexcept;
+  static void  M_bind(void* p, size_t size, int node) noexcept;
+};
+
+inline std::atomic<int>& large_alloc::M_node() noexcept
+{
+  static std::atomic<int> node(-1);
+  return node;
+}
+
+inline std::atomic<bool>& large_alloc::M_huge() noexcept
+{
+  static std::atomic<bool> huge(true);
+  return huge;
+}
+
+inline size_t large_alloc::map_size(size_t n) noexcept
+{
+  // 映射大小只由 n 决定，这样 set_huge_page 前后申请的内存都能正确释放
+  const size_t align = n >= static_cast<size_t>(EHugePageBytes)
+    ? static_cast<size_t>(EHugePageBytes) : static_cast<size_t>(EPageBytes);
+  return (n + align - 1) & ~(align - 1);
+}
+
+// 分配大小为 n 的空间，失败时抛出 std::bad_alloc
+inline void* large_alloc::allocate(size_t n)
+{
+#if MYSTL_LARGE_ALLOC_MMAP
+  const size_t size = map_size(n);
+  void* p = M_map(size);
+  M_advise(p, size);
+  return p;
+#else
+  void* p = std::malloc(n);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+#endif
+}
+
+// 释放 p 指向的大小为 n 的空间
+inline void large_alloc::deallocate(void* p, size_t n) noexcept
+{
+  if (p == nullptr)
+    return;
+#if MYSTL_LARGE_ALLOC_MMAP
+  ::munmap(p, map_size(n));
+#else
+  (void)n;
+  std::free(p);
+#endif
+}
+
+// 调整空间大小，失败时抛出 std::bad_alloc，原空间不变
+inline void* large_alloc::reallocate(void* p, size_t old_n, size_t new_n)
+{
+  if (p == nullptr)
+    return allocate(new_n);
+#if MYSTL_LARGE_ALLOC_MMAP
+  const size_t old_size = map_size(old_n);
+  const size_t new_size = map_size(new_n);
+  if (old_size == new_size)
+    return p;
+  // 扩展后的映射不再保证 2M 对齐，内核仍会把其中对齐的部分合并为大页
+  void* r = ::mremap(p, old_size, new_size, MREMAP_MAYMOVE);
+  if (r == MAP_FAILED)
+    throw std::bad_alloc();
+  if (new_size > old_size)
+    M_advise(r, new_size);
+  return r;
+#else
+  (void)old_n;
+  void* r = std::realloc(p, new_n);
+  if (r == nullptr)
+    throw std::bad_alloc();
+  return r;
+#endif
+}
+
+inline bool large_alloc::try_expand(void* p, size_t old_n, size_t new_n) noexcept
+{
+  if (p == nullptr)
+    return false;
+#if MYSTL_LARGE_ALLOC_MMAP
+  const size_t old_size = map_size(old_n);
+  const size_t new_size = map_size(new_n);
+  if (new_size <= old_size)
+    return new_size == old_size;
+  // 不带 MREMAP_MAYMOVE，后面的地址空间被占用时失败
+  if (::mremap(p, old_size, new_size, 0) == MAP_FAILED)
+    return false;
+  M_advise(p, new_size);
+  return true;
+#else
+  (void)old_n;
+  (void)new_n;
+  return false;
+#endif
+}
+
+#if MYSTL_LARGE_ALLOC_MMAP
+
+// 对 2M 以上的映射请求透明大页，并按设置绑定 NUMA 节点
+inline void large_alloc::M_advise(void* p, size_t size) noexcept
+{
+  if (huge_page() && size >= static_cast<size_t>(EHugePageBytes))
+    ::madvise(p, size, MADV_HUGEPAGE);
+  const int node = numa_node();
+  if (node >= 0)
+    M_bind(p, size, node);
+}
+
+// 映射 size bytes，size 是 2M 的倍数时，多映射一些再把首尾裁掉，使起始地址按 2M 对齐
+inline void* large_alloc::M_map(size_t size)
+{
+  const int prot = PROT_READ | PROT_WRITE;
+  const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  if (size % static_cast<size_t>(EHugePageBytes) != 0)
+  {
+    void* p = ::mmap(nullptr, size, prot, flags, -1, 0);
+    if (p == MAP_FAILED)
+      throw std::bad_alloc();
+    return p;
+  }
+  const size_t total = size + static_cast<size_t>(EHugePageBytes);
+  char* raw = static_cast<char*>(::mmap(nullptr, total, prot, flags, -1, 0));
+  if (raw == MAP_FAILED)
+    throw std::bad_alloc();
+  const uintptr_t mask = static_cast<uintptr_t>(EHugePageBytes) - 1;
+  char* p = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(raw) + mask) & ~mask);
+  const size_t head = static_cast<size_t>(p - raw);
+  if (head > 0)
+    ::munmap(raw, head);
+  const size_t tail = total - head - size;
+  if (tail > 0)
+    ::munmap(p + size, tail);
+  return p;
+}
+
+// 以 MPOL_PREFERRED 策略把 [p, p + size) 绑定到 node 节点，节点内存不足时内核仍可以使用其它节点
+// 直接使用系统调用，不依赖 libnuma；失败时忽略，退回 first-touch
+inline void large_alloc::M_bind(void* p, size_t size, int node) noexcept
+{
+#ifdef SYS_mbind
+  const int mpol_preferred = 1;
+  const size_t bits = sizeof(unsigned long) * 8;
+  unsigned long mask[4] = { 0, 0, 0, 0 };
+  if (static_cast<size_t>(node) >= bits * 4)
+    return;
+  mask[node / bits] = 1UL << (node % bits);
+  ::syscall(SYS_mbind, p, size, mpol_preferred, mask, bits * 4 + 1, 0);
+#else
+  (void)p;
+  (void)size;
+  (void)node;
+#endif
+}
+
+#endif // MYSTL_LARGE_ALLOC_MMAP
+
+} // namespace mystl
+#endif // !MYTINYSTL_LARGE_ALLOC_H_
+
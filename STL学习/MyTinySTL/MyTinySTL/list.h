@@ -205,24 +205,28 @@ struct list_const_iterator : public iterator<bidirectional_iterator_tag, T>
 };
 
 // 模板类: list
-// 模板参数 T 代表数据类型
-template <class T>
+// 模板参数 T 代表数据类型，Alloc 代表分配器类型
+template <class T, class Alloc = mystl::allocator<T>>
 class list
 {
 public:
   // list 的嵌套型别定义
-  typedef mystl::allocator<T>                      allocator_type;
-  typedef mystl::allocator<T>                      data_allocator;
-  typedef mystl::allocator<list_node_base<T>>      base_allocator;
-  typedef mystl::allocator<list_node<T>>           node_allocator;
-
-  typedef typename allocator_type::value_type      value_type;
-  typedef typename allocator_type::pointer         pointer;
-  typedef typename allocator_type::const_pointer   const_pointer;
-  typedef typename allocator_type::reference       reference;
-  typedef typename allocator_type::const_reference const_reference;
-  typedef typename allocator_type::size_type       size_type;
-  typedef typename allocator_type::difference_type difference_type;
+  typedef Alloc                                    allocator_type;
+  typedef mystl::allocator_traits<Alloc>           alloc_traits;
+  typedef typename alloc_traits::template 
+    rebind_alloc<list_node_base<T>>                base_allocator;
+  typedef typename alloc_traits::template 
+    rebind_alloc<list_node<T>>                     node_allocator;
+  typedef mystl::allocator_traits<base_allocator>  base_alloc_traits;
+  typedef mystl::allocator_traits<node_allocator>  node_alloc_traits;
+
+  typedef typename alloc_traits::value_type        value_type;
+  typedef typename alloc_traits::pointer           pointer;
+  typedef typename alloc_traits::const_pointer     const_pointer;
+  typedef value_type&                              reference;
+  typedef const value_type&                        const_reference;
+  typedef typename alloc_traits::size_type         size_type;
+  typedef typename alloc_traits::difference_type   difference_type;
 
   typedef list_iterator<T>                         iterator;
   typedef list_const_iterator<T>                   const_iterator;
@@ -232,60 +236,63 @@ public:
   typedef typename node_traits<T>::base_ptr        base_ptr;
   typedef typename node_traits<T>::node_ptr        node_ptr;
 
-  allocator_type get_allocator() { return node_allocator(); }
+  allocator_type get_allocator() const { return allocator_type(node_alloc_); }
 
 private:
-  base_ptr  node_;  // 指向末尾节点
-  size_type size_;  // 大小
+  base_ptr       node_;        // 指向末尾节点
+  size_type      size_;        // 大小
+  node_allocator node_alloc_;  // 节点分配器
 
 public:
   // 构造、复制、移动、析构函数
   list() 
   { fill_init(0, value_type()); }
 
-  explicit list(size_type n) 
+  explicit list(const allocator_type& alloc)
+    :node_alloc_(alloc)
+  { fill_init(0, value_type()); }
+
+  explicit list(size_type n, const allocator_type& alloc = allocator_type())
+    :node_alloc_(alloc)
   { fill_init(n, value_type()); }
 
-  list(size_type n, const T& value)
+  list(size_type n, const T& value, const allocator_type& alloc = allocator_type())
+    :node_alloc_(alloc)
   { fill_init(n, value); }
 
   template <class Iter, typename std::enable_if<
     mystl::is_input_iterator<Iter>::value, int>::type = 0>
-  list(Iter first, Iter last)
+  list(Iter first, Iter last, const allocator_type& alloc = allocator_type())
+    :node_alloc_(alloc)
   { copy_init(first, last); }
 
-  list(std::initializer_list<T> ilist)
+  list(std::initializer_list<T> ilist, const allocator_type& alloc = allocator_type())
+    :node_alloc_(alloc)
   { copy_init(ilist.begin(), ilist.end()); }
 
   list(const list& rhs)
+    :node_alloc_(node_alloc_traits::select_on_container_copy_construction(rhs.node_alloc_))
+  { copy_init(rhs.cbegin(), rhs.cend()); }
+
+  list(const list& rhs, const allocator_type& alloc)
+    :node_alloc_(alloc)
   { copy_init(rhs.cbegin(), rhs.cend()); }
 
   list(list&& rhs) noexcept
-    :node_(rhs.node_), size_(rhs.size_)
+    :node_(rhs.node_), size_(rhs.size_), node_alloc_(mystl::move(rhs.node_alloc_))
   {
     rhs.node_ = nullptr;
     rhs.size_ = 0;
   }
 
-  list& operator=(const list& rhs)
-  {
-    if (this != &rhs)
-    {
-      assign(rhs.begin(), rhs.end());
-    }
-    return *this;
-  }
-
-  list& operator=(list&& rhs) noexcept
-  {
-    clear();
-    splice(end(), rhs);
-    return *this;
-  }
+  list& operator=(const list& rhs);
+  list& operator=(list&& rhs) noexcept(
+    node_alloc_traits::propagate_on_container_move_assignment::value ||
+    node_alloc_traits::is_always_equal::value);
 
   list& operator=(std::initializer_list<T> ilist)
   {
-    list tmp(ilist.begin(), ilist.end());
+    list tmp(ilist.begin(), ilist.end(), get_allocator());
     swap(tmp);
     return *this;
   }
@@ -295,8 +302,7 @@ public:
     if (node_)
     {
       clear();
-      base_allocator::deallocate(node_);
-      node_ = nullptr;
+      destroy_header();
       size_ = 0;
     }
   }
@@ -507,6 +513,7 @@ public:
   {
     mystl::swap(node_, rhs.node_);
     mystl::swap(size_, rhs.size_);
+    mystl::alloc_on_swap(node_alloc_, rhs.node_alloc_);
   }
 
   // list 相关操作
@@ -546,6 +553,10 @@ private:
   node_ptr create_node(Args&& ...agrs);
   void     destroy_node(node_ptr p);
 
+  // create / destroy header
+  void     create_header();
+  void     destroy_header();
+
   // initialize
   void      fill_init(size_type n, const value_type& value);
   template <class Iter>
@@ -576,10 +587,63 @@ private:
 
 /*****************************************************************************************/
 
+// 复制赋值操作符
+template <class T, class Alloc>
+list<T, Alloc>& list<T, Alloc>::operator=(const list& rhs)
+{
+  if (this != &rhs)
+  {
+    if (mystl::alloc_copy_needs_reset(node_alloc_, rhs.node_alloc_))
+    { // 原有节点必须由原来的分配器释放
+      clear();
+      destroy_header();
+      mystl::alloc_on_copy_assign(node_alloc_, rhs.node_alloc_);
+      create_header();
+    }
+    else
+    {
+      mystl::alloc_on_copy_assign(node_alloc_, rhs.node_alloc_);
+    }
+    assign(rhs.begin(), rhs.end());
+  }
+  return *this;
+}
+
+// 移动赋值操作符
+template <class T, class Alloc>
+list<T, Alloc>& list<T, Alloc>::operator=(list&& rhs) noexcept(
+  node_alloc_traits::propagate_on_container_move_assignment::value ||
+  node_alloc_traits::is_always_equal::value)
+{
+  if (this == &rhs)
+    return *this;
+  clear();
+  if (mystl::alloc_move_can_steal(node_alloc_, rhs.node_alloc_))
+  {
+    if (!(node_alloc_ == rhs.node_alloc_))
+    { // 哨兵节点也改由新的分配器管理
+      destroy_header();
+      mystl::alloc_on_move_assign(node_alloc_, rhs.node_alloc_);
+      create_header();
+    }
+    else
+    {
+      mystl::alloc_on_move_assign(node_alloc_, rhs.node_alloc_);
+    }
+    splice(end(), rhs);
+  }
+  else
+  { // 分配器不相等且不传递，只能逐个移动元素
+    for (auto it = rhs.begin(); it != rhs.end(); ++it)
+      emplace_back(mystl::move(*it));
+  }
+  return *this;
+}
+
 // 删除 pos 处的元素
-template <class T>
-typename list<T>::iterator 
-list<T>::erase(const_iterator pos)
+template <class T, class Alloc>
+typename list<T, Alloc>::iterator 
+list<T, Alloc>::erase(const_iterator pos)
 {
   MYSTL_DEBUG(pos != cend());
   auto n = pos.node_;
@@ -591,9 +655,9 @@ list<T>::erase(const_iterator pos)
 }
 
 // 删除 [first, last) 内的元素
-template <class T>
-typename list<T>::iterator 
-list<T>::erase(const_iterator first, const_iterator last)
+template <class T, class Alloc>
+typename list<T, Alloc>::iterator 
+list<T, Alloc>::erase(const_iterator first, const_iterator last)
 {
   if (first != last)
   {
@@ -610,8 +674,8 @@ list<T>::erase(const_iterator first, const_iterator last)
 }
 
 // 清空 list
-template <class T>
-void list<T>::clear()
+template <class T, class Alloc>
+void list<T, Alloc>::clear()
 {
   if (size_ != 0)
   {
@@ -626,8 +690,8 @@ void list<T>::clear()
 }
 
 // 重置容器大小
-template <class T>
-void list<T>::resize(size_type new_size, const value_type& value)
+template <class T, class Alloc>
+void list<T, Alloc>::resize(size_type new_size, const value_type& value)
 {
   auto i = begin();
   size_type len = 0;
@@ -647,10 +711,10 @@ void list<T>::resize(size_type new_size, const value_type& value)
 }
 
 // 将 list x 接合于 pos 之前
-template <class T>
-void list<T>::splice(const_iterator pos, list& x)
+template <class T, class Alloc>
+void list<T, Alloc>::splice(const_iterator pos, list& x)
 {
-  MYSTL_DEBUG(this != &x);
+  MYSTL_DEBUG(this != &x && node_alloc_ == x.node_alloc_);
   if (!x.empty())
   {
     THROW_LENGTH_ERROR_IF(size_ > max_size() - x.size_, "list<T>'s size too big");
@@ -667,9 +731,10 @@ void list<T>::splice(const_iterator pos, list& x)
 }
 
 // 将 it 所指的节点接合于 pos 之前
-template <class T>
-void list<T>::splice(const_iterator pos, list& x, const_iterator it)
+template <class T, class Alloc>
+void list<T, Alloc>::splice(const_iterator pos, list& x, const_iterator it)
 {
+  MYSTL_DEBUG(node_alloc_ == x.node_alloc_);
   if (pos.node_ != it.node_ && pos.node_ != it.node_->next)
   {
     THROW_LENGTH_ERROR_IF(size_ > max_size() - 1, "list<T>'s size too big");
@@ -685,9 +750,10 @@ void list<T>::splice(const_iterator pos, list& x, const_iterator it)
 }
 
 // 将 list x 的 [first, last) 内的节点接合于 pos 之前
-template <class T>
-void list<T>::splice(const_iterator pos, list& x, const_iterator first, const_iterator last)
+template <class T, class Alloc>
+void list<T, Alloc>::splice(const_iterator pos, list& x, const_iterator first, const_iterator last)
 {
+  MYSTL_DEBUG(node_alloc_ == x.node_alloc_);
   if (first != last && this != &x)
   {
     size_type n = mystl::distance(first, last);
@@ -704,9 +770,9 @@ void list<T>::splice(const_iterator pos, list& x, const_iterator first, const_it
 }
 
 // 将另一元操作 pred 为 true 的所有元素移除
-template <class T>
+template <class T, class Alloc>
 template <class UnaryPredicate>
-void list<T>::remove_if(UnaryPredicate pred)
+void list<T, Alloc>::remove_if(UnaryPredicate pred)
 {
   auto f = begin();
   auto l = end();
@@ -721,9 +787,9 @@ void list<T>::remove_if(UnaryPredicate pred)
 }
 
 // 移除 list 中满足 pred 为 true 重复元素
-template <class T>
+template <class T, class Alloc>
 template <class BinaryPredicate>
-void list<T>::unique(BinaryPredicate pred)
+void list<T, Alloc>::unique(BinaryPredicate pred)
 {
   auto i = begin();
   auto e = end();
@@ -745,10 +811,11 @@ void list<T>::unique(BinaryPredicate pred)
 }
 
 // 与另一个 list 合并，按照 comp 为 true 的顺序
-template <class T>
+template <class T, class Alloc>
 template <class Compare>
-void list<T>::merge(list& x, Compare comp)
+void list<T, Alloc>::merge(list& x, Compare comp)
 {
+  MYSTL_DEBUG(node_alloc_ == x.node_alloc_);
   if (this != &x)
   {
     THROW_LENGTH_ERROR_IF(size_ > max_size() - x.size_, "list<T>'s size too big");
@@ -796,8 +863,8 @@ void list<T>::merge(list& x, Compare comp)
 }
 
 // 将 list 反转
-template <class T>
-void list<T>::reverse()
+template <class T, class Alloc>
+void list<T, Alloc>::reverse()
 {
   if (size_ <= 1)
   {
@@ -817,40 +884,58 @@ void list<T>::reverse()
 // helper function
 
 // 创建结点
-template <class T>
+template <class T, class Alloc>
 template <class ...Args>
-typename list<T>::node_ptr 
-list<T>::create_node(Args&& ...args)
+typename list<T, Alloc>::node_ptr 
+list<T, Alloc>::create_node(Args&& ...args)
 {
-  node_ptr p = node_allocator::allocate(1);
+  node_ptr p = node_alloc_traits::allocate(node_alloc_, 1);
   try
   {
-    data_allocator::construct(mystl::address_of(p->value), mystl::forward<Args>(args)...);
+    node_alloc_traits::construct(node_alloc_, mystl::address_of(p->value),
+                                 mystl::forward<Args>(args)...);
     p->prev = nullptr;
     p->next = nullptr;
   }
   catch (...)
   {
-    node_allocator::deallocate(p);
+    node_alloc_traits::deallocate(node_alloc_, p, 1);
     throw;
   }
   return p;
 }
 
 // 销毁结点
-template <class T>
-void list<T>::destroy_node(node_ptr p)
+template <class T, class Alloc>
+void list<T, Alloc>::destroy_node(node_ptr p)
 {
-  data_allocator::destroy(mystl::address_of(p->value));
-  node_allocator::deallocate(p);
+  node_alloc_traits::destroy(node_alloc_, mystl::address_of(p->value));
+  node_alloc_traits::deallocate(node_alloc_, p, 1);
 }
 
-// 用 n 个元素初始化容器
-template <class T>
-void list<T>::fill_init(size_type n, const value_type& value)
+// 创建哨兵节点，哨兵节点不存放元素
+template <class T, class Alloc>
+void list<T, Alloc>::create_header()
 {
-  node_ = base_allocator::allocate(1);
+  base_allocator base_alloc(node_alloc_);
+  node_ = base_alloc_traits::allocate(base_alloc, 1);
   node_->unlink();
+}
+
+// 销毁哨兵节点
+template <class T, class Alloc>
+void list<T, Alloc>::destroy_header()
+{
+  base_allocator base_alloc(node_alloc_);
+  base_alloc_traits::deallocate(base_alloc, node_, 1);
+  node_ = nullptr;
+}
+
+// 用 n 个元素初始化容器
+template <class T, class Alloc>
+void list<T, Alloc>::fill_init(size_type n, const value_type& value)
+{
+  create_header();
   size_ = n;
   try
   {
@@ -863,19 +948,17 @@ void list<T>::fill_init(size_type n, const value_type& value)
   catch (...)
   {
     clear();
-    base_allocator::deallocate(node_);
-    node_ = nullptr;
+    destroy_header();
     throw;
   }
 }
 
 // 以 [first, last) 初始化容器
-template <class T>
+template <class T, class Alloc>
 template <class Iter>
-void list<T>::copy_init(Iter first, Iter last)
+void list<T, Alloc>::copy_init(Iter first, Iter last)
 {
-  node_ = base_allocator::allocate(1);
-  node_->unlink();
+  create_header();
   size_type n = mystl::distance(first, last);
   size_ = n;
   try
@@ -889,16 +972,15 @@ void list<T>::copy_init(Iter first, Iter last)
   catch (...)
   {
     clear();
-    base_allocator::deallocate(node_);
-    node_ = nullptr;
+    destroy_header();
     throw;
   }
 }
 
 // 在 pos 处连接一个节点
-template <class T>
-typename list<T>::iterator 
-list<T>::link_iter_node(const_iterator pos, base_ptr link_node)
+template <class T, class Alloc>
+typename list<T, Alloc>::iterator 
+list<T, Alloc>::link_iter_node(const_iterator pos, base_ptr link_node)
 {
   if (pos == node_->next)
   {
@@ -916,8 +998,8 @@ list<T>::link_iter_node(const_iterator pos, base_ptr link_node)
 }
 
 // 在 pos 处连接 [first, last] 的结点
-template <class T>
-void list<T>::link_nodes(base_ptr pos, base_ptr first, base_ptr last)
+template <class T, class Alloc>
+void list<T, Alloc>::link_nodes(base_ptr pos, base_ptr first, base_ptr last)
 {
   pos->prev->next = first;
   first->prev = pos->prev;
@@ -926,8 +1008,8 @@ void list<T>::link_nodes(base_ptr pos, base_ptr first, base_ptr last)
 }
 
 // 在头部连接 [first, last] 结点
-template <class T>
-void list<T>::link_nodes_at_front(base_ptr first, base_ptr last)
+template <class T, class Alloc>
+void list<T, Alloc>::link_nodes_at_front(base_ptr first, base_ptr last)
 {
   first->prev = node_;
   last->next = node_->next;
@@ -936,8 +1018,8 @@ void list<T>::link_nodes_at_front(base_ptr first, base_ptr last)
 }
 
 // 在尾部连接 [first, last] 结点
-template <class T>
-void list<T>::link_nodes_at_back(base_ptr first, base_ptr last)
+template <class T, class Alloc>
+void list<T, Alloc>::link_nodes_at_back(base_ptr first, base_ptr last)
 {
   last->next = node_;
   first->prev = node_->prev;
@@ -946,16 +1028,16 @@ void list<T>::link_nodes_at_back(base_ptr first, base_ptr last)
 }
 
 // 容器与 [first, last] 结点断开连接
-template <class T>
-void list<T>::unlink_nodes(base_ptr first, base_ptr last)
+template <class T, class Alloc>
+void list<T, Alloc>::unlink_nodes(base_ptr first, base_ptr last)
 {
   first->prev->next = last->next;
   last->next->prev = first->prev;
 }
 
 // 用 n 个元素为容器赋值
-template <class T>
-void list<T>::fill_assign(size_type n, const value_type& value)
+template <class T, class Alloc>
+void list<T, Alloc>::fill_assign(size_type n, const value_type& value)
 {
   auto i = begin();
   auto e = end();
@@ -974,9 +1056,9 @@ void list<T>::fill_assign(size_type n, const value_type& value)
 }
 
 // 复制[f2, l2)为容器赋值
-template <class T>
+template <class T, class Alloc>
 template <class Iter>
-void list<T>::copy_assign(Iter f2, Iter l2)
+void list<T, Alloc>::copy_assign(Iter f2, Iter l2)
 {
   auto f1 = begin();
   auto l1 = end();
@@ -995,9 +1077,9 @@ void list<T>::copy_assign(Iter f2, Iter l2)
 }
 
 // 在 pos 处插入 n 个元素
-template <class T>
-typename list<T>::iterator 
-list<T>::fill_insert(const_iterator pos, size_type n, const value_type& value)
+template <class T, class Alloc>
+typename list<T, Alloc>::iterator 
+list<T, Alloc>::fill_insert(const_iterator pos, size_type n, const value_type& value)
 {
   iterator r(pos.node_);
   if (n != 0)
@@ -1037,10 +1119,10 @@ list<T>::fill_insert(const_iterator pos, size_type n, const value_type& value)
 }
 
 // 在 pos 处插入 [first, last) 的元素
-template <class T>
+template <class T, class Alloc>
 template <class Iter>
-typename list<T>::iterator 
-list<T>::copy_insert(const_iterator pos, size_type n, Iter first)
+typename list<T, Alloc>::iterator 
+list<T, Alloc>::copy_insert(const_iterator pos, size_type n, Iter first)
 {
   iterator r(pos.node_);
   if (n != 0)
@@ -1079,10 +1161,10 @@ list<T>::copy_insert(const_iterator pos, size_type n, Iter first)
 }
 
 // 对 list 进行归并排序，返回一个迭代器指向区间最小元素的位置
-template <class T>
+template <class T, class Alloc>
 template <class Compared>
-typename list<T>::iterator 
-list<T>::list_sort(iterator f1, iterator l2, size_type n, Compared comp)
+typename list<T, Alloc>::iterator 
+list<T, Alloc>::list_sort(iterator f1, iterator l2, size_type n, Compared comp)
 {
   if (n < 2)
     return f1;
@@ -1156,8 +1238,8 @@ list<T>::list_sort(iterator f1, iterator l2, size_type n, Compared comp)
 }
 
 // 重载比较操作符
-template <class T>
-bool operator==(const list<T>& lhs, const list<T>& rhs)
+template <class T, class Alloc>
+bool operator==(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs)
 {
   auto f1 = lhs.cbegin();
   auto f2 = rhs.cbegin();
@@ -1168,39 +1250,39 @@ bool operator==(const list<T>& lhs, const list<T>& rhs)
   return f1 == l1 && f2 == l2;
 }
 
-template <class T>
-bool operator<(const list<T>& lhs, const list<T>& rhs)
+template <class T, class Alloc>
+bool operator<(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs)
 {
   return mystl::lexicographical_compare(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend());
 }
 
-template <class T>
-bool operator!=(const list<T>& lhs, const list<T>& rhs)
+template <class T, class Alloc>
+bool operator!=(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class T>
-bool operator>(const list<T>& lhs, const list<T>& rhs)
+template <class T, class Alloc>
+bool operator>(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class T>
-bool operator<=(const list<T>& lhs, const list<T>& rhs)
+template <class T, class Alloc>
+bool operator<=(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class T>
-bool operator>=(const list<T>& lhs, const list<T>& rhs)
+template <class T, class Alloc>
+bool operator>=(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs)
 {
   return !(lhs < rhs);
 }
 
 // 重载 mystl 的 swap
-template <class T>
-void swap(list<T>& lhs, list<T>& rhs) noexcept
+template <class T, class Alloc>
+void swap(list<T, Alloc>& lhs, list<T, Alloc>& rhs) noexcept
 {
   lhs.swap(rhs);
 }
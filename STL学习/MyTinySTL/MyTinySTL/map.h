@@ -20,7 +20,9 @@ namespace mystl
 
 // 模板类 map，键值不允许重复
 // 参数一代表键值类型，参数二代表实值类型，参数三代表键值的比较方式，缺省使用 mystl::less
-template <class Key, class T, class Compare = mystl::less<Key>>
+// 参数四代表分配器类型
+template <class Key, class T, class Compare = mystl::less<Key>,
+          class Alloc = mystl::allocator<mystl::pair<const Key, T>>>
 class map
 {
 public:
@@ -33,7 +35,7 @@ public:
   // 定义一个 functor，用来进行元素比较
   class value_compare : public binary_function <value_type, value_type, bool>
   {
-    friend class map<Key, T, Compare>;
+    friend class map<Key, T, Compare, Alloc>;
   private:
     Compare comp;
     value_compare(Compare c) : comp(c) {}
@@ -46,7 +48,7 @@ public:
 
 private:
   // 以 mystl::rb_tree 作为底层机制
-  typedef mystl::rb_tree<value_type, key_compare>  base_type;
+  typedef mystl::rb_tree<value_type, key_compare, Alloc>  base_type;
   base_type tree_;
 
 public:
@@ -69,13 +71,23 @@ public:
 
   map() = default;
 
+  explicit map(const key_compare& comp, const allocator_type& alloc = allocator_type())
+    :tree_(comp, alloc)
+  {
+  }
+
+  explicit map(const allocator_type& alloc)
+    :tree_(alloc)
+  {
+  }
+
   template <class InputIterator>
-  map(InputIterator first, InputIterator last)
-    :tree_()
+  map(InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+    :tree_(alloc)
   { tree_.insert_unique(first, last); }
 
-  map(std::initializer_list<value_type> ilist) 
-    :tree_()
+  map(std::initializer_list<value_type> ilist, const allocator_type& alloc = allocator_type())
+    :tree_(alloc)
   { tree_.insert_unique(ilist.begin(), ilist.end()); }
 
   map(const map& rhs) 
@@ -256,45 +268,45 @@ public:
 };
 
 // 重载比较操作符
-template <class Key, class T, class Compare>
-bool operator==(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Alloc>
+bool operator==(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator<(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Alloc>
+bool operator<(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs)
 {
   return lhs < rhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator!=(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Alloc>
+bool operator!=(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class Key, class T, class Compare>
-bool operator>(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Alloc>
+bool operator>(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator<=(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Alloc>
+bool operator<=(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class Key, class T, class Compare>
-bool operator>=(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Alloc>
+bool operator>=(const map<Key, T, Compare, Alloc>& lhs, const map<Key, T, Compare, Alloc>& rhs)
 {
   return !(lhs < rhs);
 }
 
 // 重载 mystl 的 swap
-template <class Key, class T, class Compare>
-void swap(map<Key, T, Compare>& lhs, map<Key, T, Compare>& rhs) noexcept
+template <class Key, class T, class Compare, class Alloc>
+void swap(map<Key, T, Compare, Alloc>& lhs, map<Key, T, Compare, Alloc>& rhs) noexcept
 {
   lhs.swap(rhs);
 }
@@ -303,7 +315,9 @@ void swap(map<Key, T, Compare>& lhs, map<Key, T, Compare>& rhs) noexcept
 
 // 模板类 multimap，键值允许重复
 // 参数一代表键值类型，参数二代表实值类型，参数三代表键值的比较方式，缺省使用 mystl::less
-template <class Key, class T, class Compare = mystl::less<Key>>
+// 参数四代表分配器类型
+template <class Key, class T, class Compare = mystl::less<Key>,
+          class Alloc = mystl::allocator<mystl::pair<const Key, T>>>
 class multimap
 {
 public:
@@ -316,7 +330,7 @@ public:
   // 定义一个 functor，用来进行元素比较
   class value_compare : public binary_function <value_type, value_type, bool>
   {
-    friend class multimap<Key, T, Compare>;
+    friend class multimap<Key, T, Compare, Alloc>;
   private:
     Compare comp;
     value_compare(Compare c) : comp(c) {}
@@ -329,7 +343,7 @@ public:
 
 private:
   // 用 mystl::rb_tree 作为底层机制
-  typedef mystl::rb_tree<value_type, key_compare>  base_type;
+  typedef mystl::rb_tree<value_type, key_compare, Alloc>  base_type;
   base_type tree_;
 
 public:
@@ -352,12 +366,22 @@ public:
 
   multimap() = default;
 
+  explicit multimap(const key_compare& comp, const allocator_type& alloc = allocator_type())
+    :tree_(comp, alloc)
+  {
+  }
+
+  explicit multimap(const allocator_type& alloc)
+    :tree_(alloc)
+  {
+  }
+
   template <class InputIterator>
-  multimap(InputIterator first, InputIterator last) 
-    :tree_() 
+  multimap(InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+    :tree_(alloc)
   { tree_.insert_multi(first, last); }
-  multimap(std::initializer_list<value_type> ilist) 
-    :tree_() 
+  multimap(std::initializer_list<value_type> ilist, const allocator_type& alloc = allocator_type())
+    :tree_(alloc)
   { tree_.insert_multi(ilist.begin(), ilist.end()); }
 
   multimap(const multimap& rhs)
@@ -501,45 +525,45 @@ public:
 };
 
 // 重载比较操作符
-template <class Key, class T, class Compare>
-bool operator==(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Alloc>
+bool operator==(const multimap<Key, T, Compare, Alloc>& lhs, const multimap<Key, T, Compare, Alloc>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator<(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Alloc>
+bool operator<(const multimap<Key, T, Compare, Alloc>& lhs, const multimap<Key, T, Compare, Alloc>& rhs)
 {
   return lhs < rhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator!=(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Alloc>
+bool operator!=(const multimap<Key, T, Compare, Alloc>& lhs, const multimap<Key, T, Compare, Alloc>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class Key, class T, class Compare>
-bool operator>(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Alloc>
+bool operator>(const multimap<Key, T, Compare, Alloc>& lhs, const multimap<Key, T, Compare, Alloc>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator<=(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Alloc>
+bool operator<=(const multimap<Key, T, Compare, Alloc>& lhs, const multimap<Key, T, Compare, Alloc>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class Key, class T, class Compare>
-bool operator>=(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Alloc>
+bool operator>=(const multimap<Key, T, Compare, Alloc>& lhs, const multimap<Key, T, Compare, Alloc>& rhs)
 {
   return !(lhs < rhs);
 }
 
 // 重载 mystl 的 swap
-template <class Key, class T, class Compare>
-void swap(multimap<Key, T, Compare>& lhs, multimap<Key, T, Compare>& rhs) noexcept
+template <class Key, class T, class Compare, class Alloc>
+void swap(multimap<Key, T, Compare, Alloc>& lhs, multimap<Key, T, Compare, Alloc>& rhs) noexcept
 {
   lhs.swap(rhs);
 }
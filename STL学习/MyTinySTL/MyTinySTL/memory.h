@@ -7,9 +7,11 @@
 #include <cstddef>
 #include <cstdlib>
 #include <climits>
+#include <memory>
 
 #include "algobase.h"
 #include "allocator.h"
+#include "aligned_allocator.h"
 #include "construct.h"
 #include "uninitialized.h"
 
@@ -23,6 +25,13 @@ constexpr Tp* address_of(Tp& value) noexcept
   return &value;
 }
 
+// std::unique_ptr 与 std::shared_ptr 只保存指针，可以平凡搬移
+template <class T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+
+template <class T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
 // 获取 / 释放 临时缓冲区
 
 template <class T>
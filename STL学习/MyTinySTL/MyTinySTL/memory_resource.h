@@ -0,0 +1,684 @@
+#ifndef MYTINYSTL_MEMORY_RESOURCE_H_
+#define MYTINYSTL_MEMORY_RESOURCE_H_
+
+// 这个头文件包含 mystl::pmr 命名空间中的多态内存资源，仿照 C++17 的 <memory_resource>
+//
+// memory_resource                : 内存资源的抽象基类
+// monotonic_buffer_resource      : 只增不减的 arena，释放操作为空，release() 或析构时一次性归还全部内存
+// unsynchronized_pool_resource   : 按大小分级的内存池，不加锁，只能在单个线程中使用
+// polymorphic_allocator          : 从 memory_resource 取得内存的分配器，可直接作为容器的 Alloc 参数
+//
+// 另外定义了 pmr::vector、pmr::map、pmr::string 等别名，使用前仍需包含对应容器的头文件
+
+#include <new>
+#include <atomic>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "algobase.h"
+#include "allocator.h"
+#include "functional.h"
+
+namespace mystl
+{
+namespace pmr
+{
+
+// 默认的对齐大小
+enum { EMaxAlign = alignof(std::max_align_t) };
+
+// 类: memory_resource
+// 内存资源的抽象基类，派生类需要实现 do_allocate / do_deallocate / do_is_equal
+class memory_resource
+{
+public:
+  virtual ~memory_resource() {}
+
+  void* allocate(size_t bytes, size_t alignment = EMaxAlign)
+  { return do_allocate(bytes, alignment); }
+  void  deallocate(void* p, size_t bytes, size_t alignment = EMaxAlign)
+  { do_deallocate(p, bytes, alignment); }
+
+  bool  is_equal(const memory_resource& other) const noexcept
+  { return do_is_equal(other); }
+
+private:
+  virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+  virtual void  do_deallocate(void* p, size_t bytes, size_t alignment) = 0;
+  virtual bool  do_is_equal(const memory_resource& other) const noexcept = 0;
+};
+
+inline bool operator==(const memory_resource& lhs, const memory_resource& rhs) noexcept
+{
+  return &lhs == &rhs || lhs.is_equal(rhs);
+}
+
+inline bool operator!=(const memory_resource& lhs, const memory_resource& rhs) noexcept
+{
+  return !(lhs == rhs);
+}
+
+/*****************************************************************************************/
+// 全局的内存资源
+
+// 把 p 向上调整到 alignment 的倍数，alignment 必须是 2 的幂
+inline char* align_up(char* p, size_t alignment) noexcept
+{
+  const auto v = reinterpret_cast<uintptr_t>(p);
+  return reinterpret_cast<char*>((v + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+}
+
+// 类: new_delete_resource_impl
+// 使用 ::operator new / ::operator delete，对齐要求超过 EMaxAlign 时多申请一些空间再调整
+class new_delete_resource_impl : public memory_resource
+{
+private:
+  void* do_allocate(size_t bytes, size_t alignment) override
+  {
+    if (alignment <= EMaxAlign)
+      return ::operator new(bytes);
+    // 在返回的地址之前保存原始指针
+    char* raw = static_cast<char*>(::operator new(bytes + alignment + sizeof(void*)));
+    char* p = align_up(raw + sizeof(void*), alignment);
+    reinterpret_cast<void**>(p)[-1] = raw;
+    return p;
+  }
+  void do_deallocate(void* p, size_t, size_t alignment) override
+  {
+    if (alignment <= EMaxAlign)
+      ::operator delete(p);
+    else
+      ::operator delete(static_cast<void**>(p)[-1]);
+  }
+  bool do_is_equal(const memory_resource& other) const noexcept override
+  { return this == &other; }
+};
+
+// 类: null_resource_impl
+// 任何分配请求都抛出 std::bad_alloc，可用作 arena 的上游，确保不会越过给定的缓冲区
+class null_resource_impl : public memory_resource
+{
+private:
+  void* do_allocate(size_t, size_t) override
+  { throw std::bad_alloc(); }
+  void  do_deallocate(void*, size_t, size_t) override {}
+  bool  do_is_equal(const memory_resource& other) const noexcept override
+  { return this == &other; }
+};
+
+inline memory_resource* new_delete_resource() noexcept
+{
+  static new_delete_resource_impl r;
+  return &r;
+}
+
+inline memory_resource* null_memory_resource() noexcept
+{
+  static null_resource_impl r;
+  return &r;
+}
+
+inline std::atomic<memory_resource*>& default_resource_holder() noexcept
+{
+  static std::atomic<memory_resource*> r(new_delete_resource());
+  return r;
+}
+
+// 设置默认的内存资源，传入 nullptr 时恢复为 new_delete_resource()，返回原来的资源
+inline memory_resource* set_default_resource(memory_resource* r) noexcept
+{
+  if (r == nullptr)
+    r = new_delete_resource();
+  return default_resource_holder().exchange(r);
+}
+
+inline memory_resource* get_default_resource() noexcept
+{
+  return default_resource_holder().load();
+}
+
+/*****************************************************************************************/
+
+// 类: monotonic_buffer_resource
+// 从当前缓冲区中依次切出内存，缓冲区用完后向上游申请一块更大的缓冲区（每次扩大一倍）
+// deallocate 不做任何事，所有内存在 release() 或析构时一次性归还上游
+class monotonic_buffer_resource : public memory_resource
+{
+private:
+  // 每块从上游申请的缓冲区头部都有一个 chunk_header，用于 release 时归还
+  struct chunk_header
+  {
+    chunk_header* next;
+    size_t        size;
+    size_t        alignment;
+  };
+
+  enum { EInitSize = 1024 };
+
+  memory_resource* upstream_;     // 上游内存资源
+  void*            init_buffer_;  // 构造时给定的缓冲区
+  size_t           init_size_;    // 构造时给定的缓冲区大小
+  char*            cur_;          // 当前缓冲区中可用空间的起始位置
+  size_t           left_;         // 当前缓冲区中剩余的空间
+  size_t           next_size_;    // 下一次向上游申请的大小
+  chunk_header*    chunks_;       // 向上游申请的缓冲区链表
+
+public:
+  monotonic_buffer_resource()
+    :monotonic_buffer_resource(get_default_resource())
+  {
+  }
+  explicit monotonic_buffer_resource(memory_resource* upstream)
+    :upstream_(upstream), init_buffer_(nullptr), init_size_(0),
+     cur_(nullptr), left_(0), next_size_(EInitSize), chunks_(nullptr)
+  {
+  }
+  explicit monotonic_buffer_resource(size_t initial_size,
+                                     memory_resource* upstream = get_default_resource())
+    :upstream_(upstream), init_buffer_(nullptr), init_size_(0),
+     cur_(nullptr), left_(0), next_size_(initial_size < 64 ? 64 : initial_size), chunks_(nullptr)
+  {
+  }
+  monotonic_buffer_resource(void* buffer, size_t buffer_size,
+                            memory_resource* upstream = get_default_resource())
+    :upstream_(upstream), init_buffer_(buffer), init_size_(buffer_size),
+     cur_(static_cast<char*>(buffer)), left_(buffer_size),
+     next_size_(mystl::max(buffer_size * 2, static_cast<size_t>(EInitSize))), chunks_(nullptr)
+  {
+  }
+
+  monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
+  monotonic_buffer_resource& operator=(const monotonic_buffer_resource&) = delete;
+
+  ~monotonic_buffer_resource() override
+  { release(); }
+
+  // 把向上游申请的内存全部归还，之后重新从构造时给定的缓冲区开始分配
+  void release() noexcept
+  {
+    while (chunks_ != nullptr)
+    {
+      auto next = chunks_->next;
+      upstream_->deallocate(chunks_, chunks_->size, chunks_->alignment);
+      chunks_ = next;
+    }
+    cur_ = static_cast<char*>(init_buffer_);
+    left_ = init_size_;
+  }
+
+  memory_resource* upstream_resource() const noexcept
+  { return upstream_; }
+
+private:
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void  do_deallocate(void*, size_t, size_t) override {}
+  bool  do_is_equal(const memory_resource& other) const noexcept override
+  { return this == &other; }
+
+  void  new_chunk(size_t bytes, size_t alignment);
+};
+
+// 从当前缓冲区中切出 bytes 大小、按 alignment 对齐的内存
+inline void* monotonic_buffer_resource::do_allocate(size_t bytes, size_t alignment)
+{
+  if (bytes == 0)
+    bytes = 1;
+  char* p = align_up(cur_, alignment);
+  size_t pad = static_cast<size_t>(p - cur_);
+  if (cur_ == nullptr || pad + bytes > left_)
+  {
+    new_chunk(bytes, alignment);
+    p = align_up(cur_, alignment);
+    pad = static_cast<size_t>(p - cur_);
+  }
+  cur_ = p + bytes;
+  left_ -= pad + bytes;
+  return p;
+}
+
+// 向上游申请一块新的缓冲区，大小至少能容纳本次请求
+inline void monotonic_buffer_resource::new_chunk(size_t bytes, size_t alignment)
+{
+  const size_t chunk_align = mystl::max(alignment, static_cast<size_t>(EMaxAlign));
+  size_t need = sizeof(chunk_header) + bytes + chunk_align;
+  size_t size = next_size_;
+  if (size < need)
+    size = need;
+  auto chunk = static_cast<chunk_header*>(upstream_->allocate(size, chunk_align));
+  chunk->next = chunks_;
+  chunk->size = size;
+  chunk->alignment = chunk_align;
+  chunks_ = chunk;
+  cur_ = reinterpret_cast<char*>(chunk) + sizeof(chunk_header);
+  left_ = size - sizeof(chunk_header);
+  next_size_ = size * 2;
+}
+
+/*****************************************************************************************/
+
+// 结构体: pool_options
+// 为 0 的选项使用缺省值
+struct pool_options
+{
+  size_t max_blocks_per_chunk;         // 每次向上游申请时，一个 chunk 中区块的最大数量
+  size_t largest_required_pool_block;  // 由池管理的最大区块，更大的请求直接交给上游
+
+  pool_options() noexcept
+    :max_blocks_per_chunk(0), largest_required_pool_block(0)
+  {
+  }
+};
+
+// 类: unsynchronized_pool_resource
+// 把 <= largest_required_pool_block 的请求按 2 的幂分级，每级维护一个自由链表，
+// 自由链表为空时向上游申请一个 chunk，chunk 中的区块数量从 8 开始逐次翻倍，直到 max_blocks_per_chunk
+// 更大的请求直接交给上游，并记录下来以便 release 时归还
+// 不加锁，只能在单个线程中使用
+class unsynchronized_pool_resource : public memory_resource
+{
+private:
+  struct free_block
+  {
+    free_block* next;
+  };
+
+  struct chunk_header
+  {
+    chunk_header* next;
+    size_t        size;
+    size_t        alignment;
+  };
+
+  // 直接交给上游的大区块，头部放在区块之前
+  struct large_header
+  {
+    large_header* prev;
+    large_header* next;
+    size_t        size;       // 向上游申请的总大小
+    size_t        alignment;  // 向上游申请时使用的对齐
+    size_t        offset;     // 区块相对原始地址的偏移
+  };
+
+  struct pool
+  {
+    free_block*   free_list;        // 自由链表
+    chunk_header* chunks;           // 向上游申请的 chunk 链表
+    size_t        next_blocks;      // 下一个 chunk 中的区块数量
+  };
+
+  enum
+  {
+    EMinBlockShift = 3,        // 最小的区块为 8 bytes
+    EMaxPools = 20,            // 最大的区块不超过 4M
+    EDefaultLargest = 4096,
+    EDefaultMaxBlocks = 1024,
+    EFirstBlocks = 8
+  };
+
+  memory_resource* upstream_;
+  pool_options     options_;
+  size_t           npools_;
+  pool             pools_[EMaxPools];
+  large_header*    large_;
+
+public:
+  unsynchronized_pool_resource()
+    :unsynchronized_pool_resource(pool_options(), get_default_resource())
+  {
+  }
+  explicit unsynchronized_pool_resource(memory_resource* upstream)
+    :unsynchronized_pool_resource(pool_options(), upstream)
+  {
+  }
+  explicit unsynchronized_pool_resource(const pool_options& opts,
+                                        memory_resource* upstream = get_default_resource());
+
+  unsynchronized_pool_resource(const unsynchronized_pool_resource&) = delete;
+  unsynchronized_pool_resource& operator=(const unsynchronized_pool_resource&) = delete;
+
+  ~unsynchronized_pool_resource() override
+  { release(); }
+
+  void release() noexcept;
+
+  memory_resource* upstream_resource() const noexcept
+  { return upstream_; }
+  pool_options     options() const noexcept
+  { return options_; }
+
+private:
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void  do_deallocate(void* p, size_t bytes, size_t alignment) override;
+  bool  do_is_equal(const memory_resource& other) const noexcept override
+  { return this == &other; }
+
+  size_t pool_index(size_t bytes, size_t alignment) const noexcept;
+  size_t block_size(size_t index) const noexcept
+  { return static_cast<size_t>(1) << (index + EMinBlockShift); }
+  void   refill(size_t index);
+};
+
+inline unsynchronized_pool_resource::
+unsynchronized_pool_resource(const pool_options& opts, memory_resource* upstream)
+  :upstream_(upstream), options_(opts), npools_(0), large_(nullptr)
+{
+  if (options_.max_blocks_per_chunk == 0)
+    options_.max_blocks_per_chunk = EDefaultMaxBlocks;
+  if (options_.max_blocks_per_chunk < EFirstBlocks)
+    options_.max_blocks_per_chunk = EFirstBlocks;
+  if (options_.largest_required_pool_block == 0)
+    options_.largest_required_pool_block = EDefaultLargest;
+  // 调整为池中实际最大的区块
+  while (npools_ < EMaxPools && block_size(npools_) < options_.largest_required_pool_block)
+    ++npools_;
+  if (npools_ < EMaxPools)
+    ++npools_;
+  options_.largest_required_pool_block = block_size(npools_ - 1);
+  for (size_t i = 0; i < EMaxPools; ++i)
+  {
+    pools_[i].free_list = nullptr;
+    pools_[i].chunks = nullptr;
+    pools_[i].next_blocks = EFirstBlocks;
+  }
+}
+
+// 归还所有 chunk 与大区块，池恢复到刚构造时的状态
+inline void unsynchronized_pool_resource::release() noexcept
+{
+  for (size_t i = 0; i < npools_; ++i)
+  {
+    auto& pl = pools_[i];
+    while (pl.chunks != nullptr)
+    {
+      auto next = pl.chunks->next;
+      upstream_->deallocate(reinterpret_cast<char*>(pl.chunks) + sizeof(chunk_header) - pl.chunks->size,
+                            pl.chunks->size, pl.chunks->alignment);
+      pl.chunks = next;
+    }
+    pl.free_list = nullptr;
+    pl.next_blocks = EFirstBlocks;
+  }
+  while (large_ != nullptr)
+  {
+    auto next = large_->next;
+    upstream_->deallocate(reinterpret_cast<char*>(large_) + sizeof(large_header) - large_->offset,
+                          large_->size, large_->alignment);
+    large_ = next;
+  }
+}
+
+// 找到能容纳 bytes 且满足对齐的最小区块，返回 npools_ 表示交给上游
+inline size_t unsynchronized_pool_resource::
+pool_index(size_t bytes, size_t alignment) const noexcept
+{
+  const size_t need = bytes > alignment ? bytes : alignment;
+  if (need > options_.largest_required_pool_block)
+    return npools_;
+  size_t i = 0;
+  while (block_size(i) < need)
+    ++i;
+  return i;
+}
+
+// 为第 index 级申请一个新的 chunk，并把其中的区块串到自由链表上
+// chunk 按区块大小对齐，因此每个区块都按自身大小对齐；chunk_header 放在 chunk 末尾
+inline void unsynchronized_pool_resource::refill(size_t index)
+{
+  auto& pl = pools_[index];
+  const size_t bs = block_size(index);
+  const size_t nblock = pl.next_blocks;
+  const size_t size = bs * nblock + sizeof(chunk_header);
+  const size_t align = mystl::max(bs, static_cast<size_t>(EMaxAlign));
+  char* p = static_cast<char*>(upstream_->allocate(size, align));
+  auto chunk = reinterpret_cast<chunk_header*>(p + bs * nblock);
+  chunk->next = pl.chunks;
+  chunk->size = size;
+  chunk->alignment = align;
+  pl.chunks = chunk;
+  for (size_t i = nblock; i > 0; --i)
+  {
+    auto b = reinterpret_cast<free_block*>(p + bs * (i - 1));
+    b->next = pl.free_list;
+    pl.free_list = b;
+  }
+  if (pl.next_blocks * 2 <= options_.max_blocks_per_chunk)
+    pl.next_blocks *= 2;
+  else
+    pl.next_blocks = options_.max_blocks_per_chunk;
+}
+
+inline void* unsynchronized_pool_resource::do_allocate(size_t bytes, size_t alignment)
+{
+  const size_t index = pool_index(bytes, alignment);
+  if (index < npools_)
+  {
+    auto& pl = pools_[index];
+    if (pl.free_list == nullptr)
+      refill(index);
+    auto b = pl.free_list;
+    pl.free_list = b->next;
+    return b;
+  }
+  // 大区块：在区块之前留出 large_header 的位置
+  const size_t align = mystl::max(alignment, static_cast<size_t>(EMaxAlign));
+  const size_t offset = (sizeof(large_header) + align - 1) & ~(align - 1);
+  const size_t size = offset + bytes;
+  char* raw = static_cast<char*>(upstream_->allocate(size, align));
+  auto h = reinterpret_cast<large_header*>(raw + offset - sizeof(large_header));
+  h->prev = nullptr;
+  h->next = large_;
+  h->size = size;
+  h->alignment = align;
+  h->offset = offset;
+  if (large_ != nullptr)
+    large_->prev = h;
+  large_ = h;
+  return raw + offset;
+}
+
+inline void unsynchronized_pool_resource::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+  if (p == nullptr)
+    return;
+  const size_t index = pool_index(bytes, alignment);
+  if (index < npools_)
+  {
+    auto b = static_cast<free_block*>(p);
+    b->next = pools_[index].free_list;
+    pools_[index].free_list = b;
+    return;
+  }
+  auto h = reinterpret_cast<large_header*>(static_cast<char*>(p) - sizeof(large_header));
+  if (h->prev != nullptr)
+    h->prev->next = h->next;
+  else
+    large_ = h->next;
+  if (h->next != nullptr)
+    h->next->prev = h->prev;
+  upstream_->deallocate(static_cast<char*>(p) - h->offset, h->size, h->alignment);
+}
+
+/*****************************************************************************************/
+
+// 模板类: polymorphic_allocator
+// 持有一个 memory_resource 指针，所有分配请求都转交给它
+// 与标准库一致，容器复制时不传递资源（复制得到的容器使用默认资源），赋值与交换时也不传递
+template <class T>
+class polymorphic_allocator
+{
+public:
+  typedef T         value_type;
+  typedef T*        pointer;
+  typedef const T*  const_pointer;
+  typedef size_t    size_type;
+  typedef ptrdiff_t difference_type;
+
+private:
+  memory_resource* resource_;
+
+public:
+  polymorphic_allocator() noexcept
+    :resource_(get_default_resource())
+  {
+  }
+  polymorphic_allocator(memory_resource* r) noexcept
+    :resource_(r)
+  {
+    MYSTL_DEBUG(r != nullptr);
+  }
+  polymorphic_allocator(const polymorphic_allocator& rhs) = default;
+  template <class U>
+  polymorphic_allocator(const polymorphic_allocator<U>& rhs) noexcept
+    :resource_(rhs.resource())
+  {
+  }
+
+  polymorphic_allocator& operator=(const polymorphic_allocator&) = delete;
+
+  T*   allocate(size_type n)
+  {
+    THROW_LENGTH_ERROR_IF(n > static_cast<size_type>(-1) / sizeof(T),
+                          "polymorphic_allocator<T>::allocate(n) size too big");
+    return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* p, size_type n)
+  {
+    resource_->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  // 若元素本身是使用 polymorphic_allocator 的容器（例如 pmr::map 中的 pmr::string），
+  // 并且可以用 (args..., alloc) 构造，则把当前资源传递给它
+  template <class U, class... Args>
+  void construct(U* p, Args&& ...args)
+  {
+    construct_aux(uses_resource<U, Args...>(), p, mystl::forward<Args>(args)...);
+  }
+
+  template <class U>
+  void destroy(U* p)
+  {
+    p->~U();
+  }
+
+  polymorphic_allocator select_on_container_copy_construction() const
+  {
+    return polymorphic_allocator();
+  }
+
+  memory_resource* resource() const noexcept
+  { return resource_; }
+
+private:
+  template <class U, class = void>
+  struct has_pmr_allocator : std::false_type {};
+
+  template <class U>
+  struct has_pmr_allocator<U, typename mystl::alloc_void<typename U::allocator_type>::type>
+    : std::is_convertible<polymorphic_allocator, typename U::allocator_type> {};
+
+  template <class U, class... Args>
+  struct uses_resource
+    : std::integral_constant<bool, has_pmr_allocator<U>::value &&
+      std::is_constructible<U, Args..., const polymorphic_allocator&>::value> {};
+
+  template <class U, class... Args>
+  void construct_aux(std::true_type, U* p, Args&& ...args)
+  {
+    ::new ((void*)p) U(mystl::forward<Args>(args)..., *this);
+  }
+
+  template <class U, class... Args>
+  void construct_aux(std::false_type, U* p, Args&& ...args)
+  {
+    ::new ((void*)p) U(mystl::forward<Args>(args)...);
+  }
+};
+
+template <class T, class U>
+bool operator==(const polymorphic_allocator<T>& lhs, const polymorphic_allocator<U>& rhs) noexcept
+{
+  return *lhs.resource() == *rhs.resource();
+}
+
+template <class T, class U>
+bool operator!=(const polymorphic_allocator<T>& lhs, const polymorphic_allocator<U>& rhs) noexcept
+{
+  return !(lhs == rhs);
+}
+
+} // namespace pmr
+
+// polymorphic_allocator 只保存一个指针
+template <class T>
+struct is_trivially_relocatable<pmr::polymorphic_allocator<T>> : std::true_type {};
+
+/*****************************************************************************************/
+// 容器的前置声明，缺省模板参数在各自的头文件中给出
+
+template <class T, class Alloc, class Growth> class vector;
+template <class T, class Alloc> class list;
+template <class T, class Alloc, size_t BufSize> class deque;
+template <class Key, class T, class Compare, class Alloc> class map;
+template <class Key, class T, class Compare, class Alloc> class multimap;
+template <class Key, class Compare, class Alloc> class set;
+template <class Key, class Compare, class Alloc> class multiset;
+template <class Key, class T, class Hash, class KeyEqual, class Alloc, class Policy> class unordered_map;
+template <class Key, class T, class Hash, class KeyEqual, class Alloc, class Policy> class unordered_multimap;
+template <class Key, class Hash, class KeyEqual, class Alloc, class Policy> class unordered_set;
+template <class Key, class Hash, class KeyEqual, class Alloc, class Policy> class unordered_multiset;
+template <class CharType> struct char_traits;
+template <class CharType, class CharTraits, class Alloc> class basic_string;
+
+namespace pmr
+{
+
+// 使用 polymorphic_allocator 的容器别名
+
+template <class T>
+using vector = mystl::vector<T, polymorphic_allocator<T>>;
+
+template <class T>
+using list = mystl::list<T, polymorphic_allocator<T>>;
+
+template <class T>
+using deque = mystl::deque<T, polymorphic_allocator<T>>;
+
+template <class Key, class T, class Compare = mystl::less<Key>>
+using map = mystl::map<Key, T, Compare, polymorphic_allocator<mystl::pair<const Key, T>>>;
+
+template <class Key, class T, class Compare = mystl::less<Key>>
+using multimap = mystl::multimap<Key, T, Compare, polymorphic_allocator<mystl::pair<const Key, T>>>;
+
+template <class Key, class Compare = mystl::less<Key>>
+using set = mystl::set<Key, Compare, polymorphic_allocator<Key>>;
+
+template <class Key, class Compare = mystl::less<Key>>
+using multiset = mystl::multiset<Key, Compare, polymorphic_allocator<Key>>;
+
+template <class Key, class T, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+using unordered_map = mystl::unordered_map<Key, T, Hash, KeyEqual,
+                                           polymorphic_allocator<mystl::pair<const Key, T>>>;
+
+template <class Key, class T, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+using unordered_multimap = mystl::unordered_multimap<Key, T, Hash, KeyEqual,
+                                                     polymorphic_allocator<mystl::pair<const Key, T>>>;
+
+template <class Key, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+using unordered_set = mystl::unordered_set<Key, Hash, KeyEqual, polymorphic_allocator<Key>>;
+
+template <class Key, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+using unordered_multiset = mystl::unordered_multiset<Key, Hash, KeyEqual, polymorphic_allocator<Key>>;
+
+template <class CharType, class CharTraits = mystl::char_traits<CharType>>
+using basic_string = mystl::basic_string<CharType, CharTraits, polymorphic_allocator<CharType>>;
+
+using string    = pmr::basic_string<char>;
+using wstring   = pmr::basic_string<wchar_t>;
+using u16string = pmr::basic_string<char16_t>;
+using u32string = pmr::basic_string<char32_t>;
+
+} // namespace pmr
+} // namespace mystl
+#endif // !MYTINYSTL_MEMORY_RESOURCE_H_
+
@@ -0,0 +1,176 @@
+#ifndef MYTINYSTL_NODE_SLAB_H_
+#define MYTINYSTL_NODE_SLAB_H_
+
+// 这个头文件包含一个模板类 node_slab，为 rb_tree 与 hashtable 成批分配节点
+//
+// 每个容器持有一个 node_slab，节点不再逐个向分配器申请，而是从连续的区块(chunk)中依次切出：
+// 区块的大小从 EFirstChunkNodes 个节点开始倍增，最多 EMaxChunkNodes 个节点，
+// 释放的节点挂在侵入式的自由链表上，供之后的插入复用；区块只在容器 clear 或析构时整体归还分配器。
+// 连续插入的节点在内存中相邻，遍历 map / unordered_map 时缓存命中率更高，插入时也不必每次调用分配器。
+//
+// node_slab 不保存分配器，所有需要分配器的操作都由容器传入自己的节点分配器
+
+#include <new>
+
+#include <cstddef>
+
+#include "allocator.h"
+#include "exceptdef.h"
+
+namespace mystl
+{
+
+// 区块的节点数
+enum { EFirstChunkNodes = 4, EMaxChunkNodes = 64 };
+
+// 模板类：node_slab
+// 参数一代表节点类型，参数二代表节点的分配器类型
+template <class Node, class Alloc>
+class node_slab
+{
+public:
+  typedef Alloc                            allocator_type;
+  typedef mystl::allocator_traits<Alloc>   alloc_traits;
+  typedef size_t                           size_type;
+
+private:
+  // 区块的第一个节点的位置用来记录区块，空闲节点的位置用来串成自由链表
+  struct chunk_header
+  {
+    chunk_header* next;
+    size_type     n;
+  };
+  struct free_slot
+  {
+    free_slot* next;
+  };
+
+  static_assert(sizeof(Node) >= sizeof(chunk_header) &&
+                alignof(Node) >= alignof(chunk_header),
+                "node_slab requires nodes that can hold two words");
+
+  free_slot*    free_;    // 自由链表
+  chunk_header* chunks_;  // 所有区块，最新的在前
+  Node*         cur_;     // 最新区块中尚未切出的部分
+  Node*         end_;
+  size_type     next_;    // 下一个区块的节点数
+
+public:
+  node_slab() noexcept
+    :free_(nullptr), chunks_(nullptr), cur_(nullptr), end_(nullptr),
+    next_(EFirstChunkNodes)
+  {
+  }
+
+  node_slab(node_slab&& rhs) noexcept
+    :free_(rhs.free_), chunks_(rhs.chunks_), cur_(rhs.cur_), end_(rhs.end_),
+    next_(rhs.next_)
+  {
+    rhs.reset();
+  }
+
+  node_slab(const node_slab&) = delete;
+  node_slab& operator=(const node_slab&) = delete;
+
+  // 区块必须由容器用 release 归还
+  ~node_slab() { MYSTL_DEBUG(chunks_ == nullptr); }
+
+  // 取得一个节点的空间，不构造节点
+  Node* allocate(allocator_type& a);
+
+  // 归还一个节点的空间，节点必须已经析构
+  void  deallocate(Node* p) noexcept;
+
+  // 把所有区块归还分配器，所有节点必须已经析构
+  void  release(allocator_type& a) noexcept;
+
+  void  swap(node_slab& rhs) noexcept;
+
+  // 当前持有的区块数
+  size_type chunk_count() const noexcept;
+
+private:
+  void  M_new_chunk(allocator_type& a);
+  void  reset() noexcept;
+};
+
+/*****************************************************************************************/
+
+template <class Node, class Alloc>
+Node* node_slab<Node, Alloc>::allocate(allocator_type& a)
+{
+  if (free_ != nullptr)
+  {
+    free_slot* s = free_;
+    free_ = s->next;
+    return reinterpret_cast<Node*>(s);
+  }
+  if (cur_ == end_)
+    M_new_chunk(a);
+  return cur_++;
+}
+
+template <class Node, class Alloc>
+void node_slab<Node, Alloc>::deallocate(Node* p) noexcept
+{
+  free_ = ::new (static_cast<void*>(p)) free_slot{ free_ };
+}
+
+template <class Node, class Alloc>
+void node_slab<Node, Alloc>::release(allocator_type& a) noexcept
+{
+  while (chunks_ != nullptr)
+  {
+    chunk_header* h = chunks_;
+    chunks_ = h->next;
+    alloc_traits::deallocate(a, reinterpret_cast<Node*>(h), h->n);
+  }
+  reset();
+}
+
+template <class Node, class Alloc>
+void node_slab<Node, Alloc>::swap(node_slab& rhs) noexcept
+{
+  mystl::swap(free_, rhs.free_);
+  mystl::swap(chunks_, rhs.chunks_);
+  mystl::swap(cur_, rhs.cur_);
+  mystl::swap(end_, rhs.end_);
+  mystl::swap(next_, rhs.next_);
+}
+
+template <class Node, class Alloc>
+typename node_slab<Node, Alloc>::size_type
+node_slab<Node, Alloc>::chunk_count() const noexcept
+{
+  size_type n = 0;
+  for (chunk_header* h = chunks_; h != nullptr; h = h->next)
+    ++n;
+  return n;
+}
+
+// 申请新的区块，第一个节点的位置记录区块，其余的依次切出
+template <class Node, class Alloc>
+void node_slab<Node, Alloc>::M_new_chunk(allocator_type& a)
+{
+  const size_type n = next_;
+  Node* p = alloc_traits::allocate(a, n);
+  chunks_ = ::new (static_cast<void*>(p)) chunk_header{ chunks_, n };
+  cur_ = p + 1;
+  end_ = p + n;
+  if (next_ < static_cast<size_type>(EMaxChunkNodes))
+    next_ <<= 1;
+}
+
+template <class Node, class Alloc>
+void node_slab<Node, Alloc>::reset() noexcept
+{
+  free_ = nullptr;
+  chunks_ = nullptr;
+  cur_ = nullptr;
+  end_ = nullptr;
+  next_ = EFirstChunkNodes;
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_NODE_SLAB_H_
+
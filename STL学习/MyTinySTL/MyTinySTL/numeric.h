@@ -13,9 +13,8 @@ namespace mystl
 // 版本1：以初值 init 对每个元素进行累加
 // 版本2：以初值 init 对每个元素进行二元操作
 /*****************************************************************************************/
-// 版本1
 template <class InputIter, class T>
-T accumulate(InputIter first, InputIter last, T init)
+T accumulate_plus_dispatch(InputIter first, InputIter last, T init, std::false_type)
 {
   for (; first != last; ++first)
   {
@@ -24,9 +23,9 @@ T accumulate(InputIter first, InputIter last, T init)
   return init;
 }
 
-// 版本2
 template <class InputIter, class T, class BinaryOp>
-T accumulate(InputIter first, InputIter last, T init, BinaryOp binary_op)
+T accumulate_dispatch(InputIter first, InputIter last, T init, BinaryOp binary_op,
+                      std::false_type)
 {
   for (; first != last; ++first)
   {
@@ -35,6 +34,58 @@ T accumulate(InputIter first, InputIter last, T init, BinaryOp binary_op)
   return init;
 }
 
+// 分段迭代器逐段累加，每一段上使用指针
+template <class SegIter, class T>
+T accumulate_plus_dispatch(SegIter first, SegIter last, T init, std::true_type)
+{
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto sfirst = traits::segment(first);
+  const auto slast = traits::segment(last);
+  if (sfirst == slast)
+    return accumulate_plus_dispatch(traits::local(first), traits::local(last), init,
+                                    std::false_type());
+  init = accumulate_plus_dispatch(traits::local(first), traits::end(sfirst), init,
+                                  std::false_type());
+  for (++sfirst; sfirst != slast; ++sfirst)
+    init = accumulate_plus_dispatch(traits::begin(sfirst), traits::end(sfirst), init,
+                                    std::false_type());
+  return accumulate_plus_dispatch(traits::begin(slast), traits::local(last), init,
+                                  std::false_type());
+}
+
+template <class SegIter, class T, class BinaryOp>
+T accumulate_dispatch(SegIter first, SegIter last, T init, BinaryOp binary_op,
+                      std::true_type)
+{
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto sfirst = traits::segment(first);
+  const auto slast = traits::segment(last);
+  if (sfirst == slast)
+    return accumulate_dispatch(traits::local(first), traits::local(last), init, binary_op,
+                               std::false_type());
+  init = accumulate_dispatch(traits::local(first), traits::end(sfirst), init, binary_op,
+                             std::false_type());
+  for (++sfirst; sfirst != slast; ++sfirst)
+    init = accumulate_dispatch(traits::begin(sfirst), traits::end(sfirst), init, binary_op,
+                               std::false_type());
+  return accumulate_dispatch(traits::begin(slast), traits::local(last), init, binary_op,
+                             std::false_type());
+}
+
+// 版本1
+template <class InputIter, class T>
+T accumulate(InputIter first, InputIter last, T init)
+{
+  return accumulate_plus_dispatch(first, last, init, is_segmented_iterator<InputIter>());
+}
+
+// 版本2
+template <class InputIter, class T, class BinaryOp>
+T accumulate(InputIter first, InputIter last, T init, BinaryOp binary_op)
+{
+  return accumulate_dispatch(first, last, init, binary_op, is_segmented_iterator<InputIter>());
+}
+
 /*****************************************************************************************/
 // adjacent_difference
 // 版本1：计算相邻元素的差值，结果保存到以 result 为起始的区间上
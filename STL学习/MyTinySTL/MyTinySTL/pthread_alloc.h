@@ -0,0 +1,97 @@
+#ifndef MYTINYSTL_PTHREAD_ALLOC_H_
+#define MYTINYSTL_PTHREAD_ALLOC_H_
+
+// 这个头文件包含模板类 pthread_allocator，仿照 SGI STL 的 pthread_alloc
+//
+// SGI 的 pthread_alloc 为每个线程维护私有的自由链表，mystl::alloc 也是这样的线程缓存内存池：
+// 小区块的分配与释放只操作本线程的自由链表，过长的链表与定期回收时多余的区块成批归还全局仓库。
+// pthread_allocator 总是使用这个内存池，与 MYSTL_USE_POOL_ALLOC 是否定义无关，
+// 因此生产者与消费者分属不同线程的容器不会在 malloc 上串行
+
+#include "alloc.h"
+#include "util.h"
+#include "construct.h"
+
+namespace mystl
+{
+
+// SGI 中 pthread_alloc 是底层的空间配置类，这里就是 alloc
+typedef alloc pthread_alloc;
+
+// 模板类：pthread_allocator
+// 模板参数代表数据类型，对齐要求超过 8 bytes 的类型仍交给 ::operator new
+template <class T>
+class pthread_allocator
+{
+public:
+  typedef T            value_type;
+  typedef T*           pointer;
+  typedef const T*     const_pointer;
+  typedef T&           reference;
+  typedef const T&     const_reference;
+  typedef size_t       size_type;
+  typedef ptrdiff_t    difference_type;
+
+  template <class U>
+  struct rebind
+  {
+    typedef pthread_allocator<U> other;
+  };
+
+public:
+  pthread_allocator() noexcept {}
+  pthread_allocator(const pthread_allocator&) noexcept {}
+  template <class U>
+  pthread_allocator(const pthread_allocator<U>&) noexcept {}
+
+  T*   allocate(size_type n);
+  void deallocate(T* ptr, size_type n);
+
+  template <class... Args>
+  void construct(T* ptr, Args&& ...args)
+  { mystl::construct(ptr, mystl::forward<Args>(args)...); }
+
+  void destroy(T* ptr)
+  { mystl::destroy(ptr); }
+};
+
+template <class T>
+T* pthread_allocator<T>::allocate(size_type n)
+{
+  if (n == 0)
+    return nullptr;
+  if (alignof(T) <= static_cast<size_type>(EAlign128))
+    return static_cast<T*>(pthread_alloc::allocate(n * sizeof(T)));
+  return static_cast<T*>(::operator new(n * sizeof(T)));
+}
+
+template <class T>
+void pthread_allocator<T>::deallocate(T* ptr, size_type n)
+{
+  if (ptr == nullptr)
+    return;
+  if (alignof(T) <= static_cast<size_type>(EAlign128))
+    pthread_alloc::deallocate(ptr, n * sizeof(T));
+  else
+    ::operator delete(ptr);
+}
+
+// 所有线程共用同一个仓库，任意两个实例都相等，在一个线程分配的区块可以在另一个线程释放
+template <class T, class U>
+bool operator==(const pthread_allocator<T>&, const pthread_allocator<U>&) noexcept
+{
+  return true;
+}
+
+template <class T, class U>
+bool operator!=(const pthread_allocator<T>&, const pthread_allocator<U>&) noexcept
+{
+  return false;
+}
+
+template <class T>
+struct is_trivially_relocatable<pthread_allocator<T>> : std::true_type {};
+
+} // namespace mystl
+#endif // !MYTINYSTL_PTHREAD_ALLOC_H_
+
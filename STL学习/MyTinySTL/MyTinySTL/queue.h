@@ -15,6 +15,7 @@ namespace mystl
 
 // 模板类 queue
 // 参数一代表数据类型，参数二代表底层容器类型，缺省使用 mystl::deque 作为底层容器
+// 线程间传递数据时可以使用 ring_buffer.h 中的 spsc_ring / mpmc_ring 作为底层容器
 template <class T, class Container = mystl::deque<T>>
 class queue
 {
@@ -116,6 +117,17 @@ public:
   void pop()                         
   { c_.pop_front(); }
 
+  // 批量放入、取出，要求底层容器提供 push_back_n / pop_front_n，如 mystl::deque
+  template <class IIter, typename std::enable_if<
+    mystl::is_input_iterator<IIter>::value, int>::type = 0>
+  void push_range(IIter first, IIter last)
+  { c_.push_back_n(first, last); }
+
+  // 把队头的 n 个元素移动到 out，n 不能大于 size()，返回 out 的结束位置
+  template <class OIter>
+  OIter pop_range(OIter out, size_type n)
+  { return c_.pop_front_n(out, n); }
+
   void clear()         
   { 
     while (!empty())
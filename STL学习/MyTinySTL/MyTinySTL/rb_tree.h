@@ -11,6 +11,7 @@
 #include "functional.h"
 #include "iterator.h"
 #include "memory.h"
+#include "node_slab.h"
 #include "type_traits.h"
 #include "exceptdef.h"
 
@@ -707,8 +708,8 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
 }
 
 // 模板类 rb_tree
-// 参数一代表数据类型，参数二代表键值比较类型
-template <class T, class Compare>
+// 参数一代表数据类型，参数二代表键值比较类型，参数三代表分配器类型
+template <class T, class Compare, class Alloc = mystl::allocator<T>>
 class rb_tree
 {
 public:
@@ -726,31 +727,37 @@ public:
   typedef typename tree_traits::value_type         value_type;
   typedef Compare                                  key_compare;
 
-  typedef mystl::allocator<T>                      allocator_type;
-  typedef mystl::allocator<T>                      data_allocator;
-  typedef mystl::allocator<base_type>              base_allocator;
-  typedef mystl::allocator<node_type>              node_allocator;
-
-  typedef typename allocator_type::pointer         pointer;
-  typedef typename allocator_type::const_pointer   const_pointer;
-  typedef typename allocator_type::reference       reference;
-  typedef typename allocator_type::const_reference const_reference;
-  typedef typename allocator_type::size_type       size_type;
-  typedef typename allocator_type::difference_type difference_type;
+  typedef Alloc                                    allocator_type;
+  typedef mystl::allocator_traits<Alloc>           alloc_traits;
+  typedef typename alloc_traits::template 
+    rebind_alloc<base_type>                        base_allocator;
+  typedef typename alloc_traits::template 
+    rebind_alloc<node_type>                        node_allocator;
+  typedef mystl::allocator_traits<base_allocator>  base_alloc_traits;
+  typedef mystl::allocator_traits<node_allocator>  node_alloc_traits;
+
+  typedef typename alloc_traits::pointer           pointer;
+  typedef typename alloc_traits::const_pointer     const_pointer;
+  typedef value_type&                              reference;
+  typedef const value_type&                        const_reference;
+  typedef typename alloc_traits::size_type         size_type;
+  typedef typename alloc_traits::difference_type   difference_type;
 
   typedef rb_tree_iterator<T>                      iterator;
   typedef rb_tree_const_iterator<T>                const_iterator;
   typedef mystl::reverse_iterator<iterator>        reverse_iterator;
   typedef mystl::reverse_iterator<const_iterator>  const_reverse_iterator;
 
-  allocator_type get_allocator() const { return node_allocator(); }
+  allocator_type get_allocator() const { return allocator_type(node_alloc_); }
   key_compare    key_comp()      const { return key_comp_; }
 
 private:
-  // 用以下三个数据表现 rb tree
-  base_ptr    header_;      // 特殊节点，与根节点互为对方的父节点
-  size_type   node_count_;  // 节点数
-  key_compare key_comp_;    // 节点键值比较的准则
+  // 用以下三个数据表现 rb tree，另外保存节点的分配器
+  base_ptr       header_;      // 特殊节点，与根节点互为对方的父节点
+  size_type      node_count_;  // 节点数
+  key_compare    key_comp_;    // 节点键值比较的准则
+  node_allocator node_alloc_;  // 节点分配器
+  mystl::node_slab<node_type, node_allocator> slab_;  // 节点从这里成批分配
 
 private:
   // 以下三个函数用于取得根节点，最小节点和最大节点
@@ -762,13 +769,25 @@ public:
   // 构造、复制、析构函数
   rb_tree() { rb_tree_init(); }
 
+  explicit rb_tree(const allocator_type& alloc)
+    :node_alloc_(alloc)
+  { rb_tree_init(); }
+
+  explicit rb_tree(const key_compare& comp, const allocator_type& alloc = allocator_type())
+    :key_comp_(comp), node_alloc_(alloc)
+  { rb_tree_init(); }
+
   rb_tree(const rb_tree& rhs);
   rb_tree(rb_tree&& rhs) noexcept;
 
   rb_tree& operator=(const rb_tree& rhs);
   rb_tree& operator=(rb_tree&& rhs);
 
-  ~rb_tree() { clear(); }
+  ~rb_tree()
+  {
+    clear();
+    destroy_header();
+  }
 
 public:
   // 迭代器相关操作
@@ -942,6 +961,7 @@ private:
 
   // init / reset
   void     rb_tree_init();
+  void     destroy_header();
   void     reset();
 
   // get insert pos
@@ -966,9 +986,10 @@ private:
 /*****************************************************************************************/
 
 // 复制构造函数
-template <class T, class Compare>
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+rb_tree<T, Compare, Alloc>::
 rb_tree(const rb_tree& rhs)
+  :node_alloc_(node_alloc_traits::select_on_container_copy_construction(rhs.node_alloc_))
 {
   rb_tree_init();
   if (rhs.node_count_ != 0)
@@ -982,25 +1003,37 @@ rb_tree(const rb_tree& rhs)
 }
 
 // 移动构造函数
-template <class T, class Compare>
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+rb_tree<T, Compare, Alloc>::
 rb_tree(rb_tree&& rhs) noexcept
   :header_(mystl::move(rhs.header_)),
   node_count_(rhs.node_count_),
-  key_comp_(rhs.key_comp_)
+  key_comp_(rhs.key_comp_),
+  node_alloc_(mystl::move(rhs.node_alloc_)),
+  slab_(mystl::move(rhs.slab_))
 {
   rhs.reset();
 }
 
 // 复制赋值操作符
-template <class T, class Compare>
-rb_tree<T, Compare>& 
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+rb_tree<T, Compare, Alloc>& 
+rb_tree<T, Compare, Alloc>::
 operator=(const rb_tree& rhs)
 {
   if (this != &rhs)
   {
     clear();
+    if (mystl::alloc_copy_needs_reset(node_alloc_, rhs.node_alloc_))
+    { // header 必须由原来的分配器释放
+      destroy_header();
+      mystl::alloc_on_copy_assign(node_alloc_, rhs.node_alloc_);
+      rb_tree_init();
+    }
+    else
+    {
+      mystl::alloc_on_copy_assign(node_alloc_, rhs.node_alloc_);
+    }
 
     if (rhs.node_count_ != 0)
     {
@@ -1016,24 +1049,39 @@ operator=(const rb_tree& rhs)
 }
 
 // 移动赋值操作符
-template <class T, class Compare>
-rb_tree<T, Compare>&
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+rb_tree<T, Compare, Alloc>&
+rb_tree<T, Compare, Alloc>::
 operator=(rb_tree&& rhs)
 {
+  if (this == &rhs)
+    return *this;
   clear();
-  header_ = mystl::move(rhs.header_);
-  node_count_ = rhs.node_count_;
-  key_comp_ = rhs.key_comp_;
-  rhs.reset();
+  if (mystl::alloc_move_can_steal(node_alloc_, rhs.node_alloc_))
+  {
+    destroy_header();
+    mystl::alloc_on_move_assign(node_alloc_, rhs.node_alloc_);
+    header_ = mystl::move(rhs.header_);
+    node_count_ = rhs.node_count_;
+    key_comp_ = rhs.key_comp_;
+    slab_.swap(rhs.slab_);  // clear 之后自己的 slab 为空
+    rhs.reset();
+  }
+  else
+  { // 分配器不相等且不传递，只能逐个移动元素，元素已经有序，每次都插入到尾部
+    key_comp_ = rhs.key_comp_;
+    for (auto it = rhs.begin(); it != rhs.end(); ++it)
+      emplace_multi_use_hint(end(), mystl::move(*it));
+    rhs.clear();
+  }
   return *this;
 }
 
 // 就地插入元素，键值允许重复
-template <class T, class Compare>
+template <class T, class Compare, class Alloc>
 template <class ...Args>
-typename rb_tree<T, Compare>::iterator 
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, Alloc>::iterator 
+rb_tree<T, Compare, Alloc>::
 emplace_multi(Args&& ...args)
 {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
@@ -1043,10 +1091,10 @@ emplace_multi(Args&& ...args)
 }
 
 // 就地插入元素，键值不允许重复
-template <class T, class Compare>
+template <class T, class Compare, class Alloc>
 template <class ...Args>
-mystl::pair<typename rb_tree<T, Compare>::iterator, bool> 
-rb_tree<T, Compare>::
+mystl::pair<typename rb_tree<T, Compare, Alloc>::iterator, bool> 
+rb_tree<T, Compare, Alloc>::
 emplace_unique(Args&& ...args)
 {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
@@ -1061,10 +1109,10 @@ emplace_unique(Args&& ...args)
 }
 
 // 就地插入元素，键值允许重复，当 hint 位置与插入位置接近时，插入操作的时间复杂度可以降低
-template <class T, class Compare>
+template <class T, class Compare, class Alloc>
 template <class ...Args>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 emplace_multi_use_hint(iterator hint, Args&& ...args)
 {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
@@ -1102,10 +1150,10 @@ emplace_multi_use_hint(iterator hint, Args&& ...args)
 }
 
 // 就地插入元素，键值不允许重复，当 hint 位置与插入位置接近时，插入操作的时间复杂度可以降低
-template<class T, class Compare>
+template <class T, class Compare, class Alloc>
 template<class ...Args>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 emplace_unique_use_hint(iterator hint, Args&& ...args)
 {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
@@ -1153,9 +1201,9 @@ emplace_unique_use_hint(iterator hint, Args&& ...args)
 }
 
 // 插入元素，节点键值允许重复
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 insert_multi(const value_type& value)
 {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
@@ -1164,9 +1212,9 @@ insert_multi(const value_type& value)
 }
 
 // 插入新值，节点键值不允许重复，返回一个 pair，若插入成功，pair 的第二参数为 true，否则为 false
-template <class T, class Compare>
-mystl::pair<typename rb_tree<T, Compare>::iterator, bool>
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+mystl::pair<typename rb_tree<T, Compare, Alloc>::iterator, bool>
+rb_tree<T, Compare, Alloc>::
 insert_unique(const value_type& value)
 {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
@@ -1179,9 +1227,9 @@ insert_unique(const value_type& value)
 }
 
 // 删除 hint 位置的节点
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 erase(iterator hint)
 {
   auto node = hint.node->get_node_ptr();
@@ -1195,9 +1243,9 @@ erase(iterator hint)
 }
 
 // 删除键值等于 key 的元素，返回删除的个数
-template <class T, class Compare>
-typename rb_tree<T, Compare>::size_type
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::size_type
+rb_tree<T, Compare, Alloc>::
 erase_multi(const key_type& key)
 {
   auto p = equal_range_multi(key);
@@ -1207,9 +1255,9 @@ erase_multi(const key_type& key)
 }
 
 // 删除键值等于 key 的元素，返回删除的个数
-template <class T, class Compare>
-typename rb_tree<T, Compare>::size_type
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::size_type
+rb_tree<T, Compare, Alloc>::
 erase_unique(const key_type& key)
 {
   auto it = find(key);
@@ -1222,8 +1270,8 @@ erase_unique(const key_type& key)
 }
 
 // 删除[first, last)区间内的元素
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+void rb_tree<T, Compare, Alloc>::
 erase(iterator first, iterator last)
 {
   if (first == begin() && last == end())
@@ -1237,9 +1285,9 @@ erase(iterator first, iterator last)
   }
 }
 
-// 清空 rb tree
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+// 清空 rb tree，节点所在的区块一并归还分配器
+template <class T, class Compare, class Alloc>
+void rb_tree<T, Compare, Alloc>::
 clear()
 {
   if (node_count_ != 0)
@@ -1250,12 +1298,13 @@ clear()
     rightmost() = header_;
     node_count_ = 0;
   }
+  slab_.release(node_alloc_);
 }
 
 // 查找键值为 k 的节点，返回指向它的迭代器
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 find(const key_type& key)
 {
   auto y = header_;  // 最后一个不小于 key 的节点
@@ -1275,9 +1324,9 @@ find(const key_type& key)
   return (j == end() || key_comp_(key, value_traits::get_key(*j))) ? end() : j;
 }
 
-template <class T, class Compare>
-typename rb_tree<T, Compare>::const_iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::const_iterator
+rb_tree<T, Compare, Alloc>::
 find(const key_type& key) const
 {
   auto y = header_;  // 最后一个不小于 key 的节点
@@ -1298,9 +1347,9 @@ find(const key_type& key) const
 }
 
 // 键值不小于 key 的第一个位置
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 lower_bound(const key_type& key)
 {
   auto y = header_;
@@ -1319,9 +1368,9 @@ lower_bound(const key_type& key)
   return iterator(y);
 }
 
-template <class T, class Compare>
-typename rb_tree<T, Compare>::const_iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::const_iterator
+rb_tree<T, Compare, Alloc>::
 lower_bound(const key_type& key) const
 {
   auto y = header_;
@@ -1341,9 +1390,9 @@ lower_bound(const key_type& key) const
 }
 
 // 键值不小于 key 的最后一个位置
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 upper_bound(const key_type& key)
 {
   auto y = header_;
@@ -1362,9 +1411,9 @@ upper_bound(const key_type& key)
   return iterator(y);
 }
 
-template <class T, class Compare>
-typename rb_tree<T, Compare>::const_iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::const_iterator
+rb_tree<T, Compare, Alloc>::
 upper_bound(const key_type& key) const
 {
   auto y = header_;
@@ -1384,8 +1433,8 @@ upper_bound(const key_type& key) const
 }
 
 // 交换 rb tree
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+void rb_tree<T, Compare, Alloc>::
 swap(rb_tree& rhs) noexcept
 {
   if (this != &rhs)
@@ -1393,6 +1442,8 @@ swap(rb_tree& rhs) noexcept
     mystl::swap(header_, rhs.header_);
     mystl::swap(node_count_, rhs.node_count_);
     mystl::swap(key_comp_, rhs.key_comp_);
+    mystl::alloc_on_swap(node_alloc_, rhs.node_alloc_);
+    slab_.swap(rhs.slab_);
   }
 }
 
@@ -1400,32 +1451,33 @@ swap(rb_tree& rhs) noexcept
 // helper function
 
 // 创建一个结点
-template <class T, class Compare>
+template <class T, class Compare, class Alloc>
 template <class ...Args>
-typename rb_tree<T, Compare>::node_ptr
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, Alloc>::node_ptr
+rb_tree<T, Compare, Alloc>::
 create_node(Args&&... args)
 {
-  auto tmp = node_allocator::allocate(1);
+  auto tmp = slab_.allocate(node_alloc_);
   try
   {
-    data_allocator::construct(mystl::address_of(tmp->value), mystl::forward<Args>(args)...);
+    node_alloc_traits::construct(node_alloc_, mystl::address_of(tmp->value),
+                                 mystl::forward<Args>(args)...);
     tmp->left = nullptr;
     tmp->right = nullptr;
     tmp->parent = nullptr;
   }
   catch (...)
   {
-    node_allocator::deallocate(tmp);
+    slab_.deallocate(tmp);
     throw;
   }
   return tmp;
 }
 
 // 复制一个结点
-template <class T, class Compare>
-typename rb_tree<T, Compare>::node_ptr
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::node_ptr
+rb_tree<T, Compare, Alloc>::
 clone_node(base_ptr x)
 {
   node_ptr tmp = create_node(x->get_node_ptr()->value);
@@ -1436,20 +1488,21 @@ clone_node(base_ptr x)
 }
 
 // 销毁一个结点
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+void rb_tree<T, Compare, Alloc>::
 destroy_node(node_ptr p)
 {
-  data_allocator::destroy(&p->value);
-  node_allocator::deallocate(p);
+  node_alloc_traits::destroy(node_alloc_, &p->value);
+  slab_.deallocate(p);
 }
 
 // 初始化容器
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+void rb_tree<T, Compare, Alloc>::
 rb_tree_init()
 {
-  header_ = base_allocator::allocate(1);
+  base_allocator base_alloc(node_alloc_);
+  header_ = base_alloc_traits::allocate(base_alloc, 1);
   header_->color = rb_tree_red;  // header_ 节点颜色为红，与 root 区分
   root() = nullptr;
   leftmost() = header_;
@@ -1457,18 +1510,30 @@ rb_tree_init()
   node_count_ = 0;
 }
 
+// 释放 header 节点，被移动过的容器没有 header
+template <class T, class Compare, class Alloc>
+void rb_tree<T, Compare, Alloc>::destroy_header()
+{
+  if (header_ != nullptr)
+  {
+    base_allocator base_alloc(node_alloc_);
+    base_alloc_traits::deallocate(base_alloc, header_, 1);
+    header_ = nullptr;
+  }
+}
+
 // reset 函数
-template <class T, class Compare>
-void rb_tree<T, Compare>::reset()
+template <class T, class Compare, class Alloc>
+void rb_tree<T, Compare, Alloc>::reset()
 {
   header_ = nullptr;
   node_count_ = 0;
 }
 
 // get_insert_multi_pos 函数
-template <class T, class Compare>
-mystl::pair<typename rb_tree<T, Compare>::base_ptr, bool>
-rb_tree<T, Compare>::get_insert_multi_pos(const key_type& key)
+template <class T, class Compare, class Alloc>
+mystl::pair<typename rb_tree<T, Compare, Alloc>::base_ptr, bool>
+rb_tree<T, Compare, Alloc>::get_insert_multi_pos(const key_type& key)
 {
   auto x = root();
   auto y = header_;
@@ -1483,9 +1548,9 @@ rb_tree<T, Compare>::get_insert_multi_pos(const key_type& key)
 }
 
 // get_insert_unique_pos 函数
-template <class T, class Compare>
-mystl::pair<mystl::pair<typename rb_tree<T, Compare>::base_ptr, bool>, bool>
-rb_tree<T, Compare>::get_insert_unique_pos(const key_type& key)
+template <class T, class Compare, class Alloc>
+mystl::pair<mystl::pair<typename rb_tree<T, Compare, Alloc>::base_ptr, bool>, bool>
+rb_tree<T, Compare, Alloc>::get_insert_unique_pos(const key_type& key)
 { // 返回一个 pair，第一个值为一个 pair，包含插入点的父节点和一个 bool 表示是否在左边插入，
   // 第二个值为一个 bool，表示是否插入成功
   auto x = root();
@@ -1519,9 +1584,9 @@ rb_tree<T, Compare>::get_insert_unique_pos(const key_type& key)
 
 // insert_value_at 函数
 // x 为插入点的父节点， value 为要插入的值，add_to_left 表示是否在左边插入
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 insert_value_at(base_ptr x, const value_type& value, bool add_to_left)
 {
   node_ptr node = create_node(value);
@@ -1552,9 +1617,9 @@ insert_value_at(base_ptr x, const value_type& value, bool add_to_left)
 
 // 在 x 节点处插入新的节点
 // x 为插入点的父节点， node 为要插入的节点，add_to_left 表示是否在左边插入
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator
+rb_tree<T, Compare, Alloc>::
 insert_node_at(base_ptr x, node_ptr node, bool add_to_left)
 {
   node->parent = x;
@@ -1583,9 +1648,9 @@ insert_node_at(base_ptr x, node_ptr node, bool add_to_left)
 }
 
 // 插入元素，键值允许重复，使用 hint
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator 
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator 
+rb_tree<T, Compare, Alloc>::
 insert_multi_use_hint(iterator hint, key_type key, node_ptr node)
 {
   // 在 hint 附近寻找可插入的位置
@@ -1610,9 +1675,9 @@ insert_multi_use_hint(iterator hint, key_type key, node_ptr node)
 }
 
 // 插入元素，键值不允许重复，使用 hint
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator 
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::iterator 
+rb_tree<T, Compare, Alloc>::
 insert_unique_use_hint(iterator hint, key_type key, node_ptr node)
 {
   // 在 hint 附近寻找可插入的位置
@@ -1643,9 +1708,9 @@ insert_unique_use_hint(iterator hint, key_type key, node_ptr node)
 
 // copy_from 函数
 // 递归复制一颗树，节点从 x 开始，p 为 x 的父节点
-template <class T, class Compare>
-typename rb_tree<T, Compare>::base_ptr
-rb_tree<T, Compare>::copy_from(base_ptr x, base_ptr p)
+template <class T, class Compare, class Alloc>
+typename rb_tree<T, Compare, Alloc>::base_ptr
+rb_tree<T, Compare, Alloc>::copy_from(base_ptr x, base_ptr p)
 {
   auto top = clone_node(x);
   top->parent = p;
@@ -1676,8 +1741,8 @@ rb_tree<T, Compare>::copy_from(base_ptr x, base_ptr p)
 
 // erase_since 函数
 // 从 x 节点开始删除该节点及其子树
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc>
+void rb_tree<T, Compare, Alloc>::
 erase_since(base_ptr x)
 {
   while (x != nullptr)
@@ -1690,45 +1755,45 @@ erase_since(base_ptr x)
 }
 
 // 重载比较操作符
-template <class T, class Compare>
-bool operator==(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs)
+template <class T, class Compare, class Alloc>
+bool operator==(const rb_tree<T, Compare, Alloc>& lhs, const rb_tree<T, Compare, Alloc>& rhs)
 {
   return lhs.size() == rhs.size() && mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template <class T, class Compare>
-bool operator<(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs)
+template <class T, class Compare, class Alloc>
+bool operator<(const rb_tree<T, Compare, Alloc>& lhs, const rb_tree<T, Compare, Alloc>& rhs)
 {
   return mystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
-template <class T, class Compare>
-bool operator!=(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs)
+template <class T, class Compare, class Alloc>
+bool operator!=(const rb_tree<T, Compare, Alloc>& lhs, const rb_tree<T, Compare, Alloc>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class T, class Compare>
-bool operator>(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs)
+template <class T, class Compare, class Alloc>
+bool operator>(const rb_tree<T, Compare, Alloc>& lhs, const rb_tree<T, Compare, Alloc>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class T, class Compare>
-bool operator<=(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs)
+template <class T, class Compare, class Alloc>
+bool operator<=(const rb_tree<T, Compare, Alloc>& lhs, const rb_tree<T, Compare, Alloc>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class T, class Compare>
-bool operator>=(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs)
+template <class T, class Compare, class Alloc>
+bool operator>=(const rb_tree<T, Compare, Alloc>& lhs, const rb_tree<T, Compare, Alloc>& rhs)
 {
   return !(lhs < rhs);
 }
 
 // 重载 mystl 的 swap
-template <class T, class Compare>
-void swap(rb_tree<T, Compare>& lhs, rb_tree<T, Compare>& rhs) noexcept
+template <class T, class Compare, class Alloc>
+void swap(rb_tree<T, Compare, Alloc>& lhs, rb_tree<T, Compare, Alloc>& rhs) noexcept
 {
   lhs.swap(rhs);
 }
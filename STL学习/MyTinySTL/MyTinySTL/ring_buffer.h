@@ -0,0 +1,444 @@
+#ifndef MYTINYSTL_RING_BUFFER_H_
+#define MYTINYSTL_RING_BUFFER_H_
+
+// 这个头文件包含两个模板类 spsc_ring 和 mpmc_ring
+// spsc_ring : 单生产者、单消费者的无锁环形队列
+// mpmc_ring : 多生产者、多消费者的无锁环形队列
+
+// notes:
+//
+// 两者的容量在构造时确定，上调到 2 的幂，下标是一直递增的计数器，取模只需要一次按位与；
+// 之后不再申请内存，满了时 try_push 返回 false，push_back / emplace_back 自旋等待。
+// 生产者与消费者写的计数器之间用 ECacheLineBytes 的填充隔开，避免伪共享。
+//
+// 两者都提供 queue 所需的接口，可以作为 mystl::queue 的底层容器：
+//   mystl::queue<int, mystl::spsc_ring<int>> q;
+// 此时 queue(n) 的 n 是环的容量。
+// spsc_ring : push / back 只能在生产者线程调用，front / pop 只能在消费者线程调用；
+// mpmc_ring : front 与 pop 是两步操作，有多个消费者时应直接使用 try_pop / pop(value)。
+//
+// mpmc_ring 的实现参照 Dmitry Vyukov 的 bounded MPMC queue：每个位置带一个序号，
+// 生产者和消费者分别用 CAS 抢占 tail 与 head，再通过序号交接这个位置上的元素。
+// 位置一旦被抢占就必须完成交接，因此要求元素的移动构造与移动赋值不抛出异常
+
+#include <atomic>
+#include <thread>
+
+#include "memory.h"
+#include "util.h"
+#include "exceptdef.h"
+
+namespace mystl
+{
+
+// cache line 的大小，用于隔开生产者与消费者各自修改的数据
+enum { ECacheLineBytes = 64 };
+
+// 缺省容量
+enum { ERingDefaultCapacity = 1024 };
+
+// 自旋等待，多次失败后让出时间片
+inline void ring_pause(unsigned& spins) noexcept
+{
+  if (++spins < 64)
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+  }
+  else
+  {
+    std::this_thread::yield();
+  }
+}
+
+// 容量上调到 2 的幂，至少为 2
+inline size_t ring_capacity(size_t n)
+{
+  THROW_LENGTH_ERROR_IF(n > (static_cast<size_t>(1) << (sizeof(size_t) * 8 - 2)),
+                        "ring capacity too big");
+  size_t cap = 2;
+  while (cap < n)
+    cap <<= 1;
+  return cap;
+}
+
+/*****************************************************************************************/
+// spsc_ring
+// 生产者只写 tail_，消费者只写 head_；双方各自缓存一份对方的计数器，
+// 只有在缓存的值显示队列满(空)时才重新读取，减少 cache line 在两个核之间的来回
+/*****************************************************************************************/
+template <class T, class Alloc = mystl::allocator<T>>
+class spsc_ring
+{
+public:
+  typedef Alloc                                    allocator_type;
+  typedef mystl::allocator_traits<Alloc>           alloc_traits;
+  typedef typename alloc_traits::value_type        value_type;
+  typedef typename alloc_traits::pointer           pointer;
+  typedef value_type&                              reference;
+  typedef const value_type&                        const_reference;
+  typedef typename alloc_traits::size_type         size_type;
+
+private:
+  // 构造后只读的部分
+  pointer                buf_;
+  size_type              mask_;
+  allocator_type         alloc_;
+  char                   pad0_[ECacheLineBytes];
+  // 生产者的部分
+  std::atomic<size_type> tail_;
+  size_type              head_cache_;
+  char                   pad1_[ECacheLineBytes];
+  // 消费者的部分
+  std::atomic<size_type> head_;
+  size_type              tail_cache_;
+  char                   pad2_[ECacheLineBytes];
+
+public:
+  explicit spsc_ring(size_type capacity = ERingDefaultCapacity,
+                     const allocator_type& alloc = allocator_type())
+    :buf_(nullptr), mask_(ring_capacity(capacity) - 1), alloc_(alloc),
+    tail_(0), head_cache_(0), head_(0), tail_cache_(0)
+  {
+    buf_ = alloc_traits::allocate(alloc_, mask_ + 1);
+  }
+
+  spsc_ring(const spsc_ring&) = delete;
+  spsc_ring& operator=(const spsc_ring&) = delete;
+
+  ~spsc_ring()
+  {
+    clear();
+    alloc_traits::deallocate(alloc_, buf_, mask_ + 1);
+  }
+
+public:
+  // 容量相关操作，在另一方同时修改时 size 只是一个近似值
+  size_type capacity() const noexcept { return mask_ + 1; }
+  size_type size()     const noexcept
+  {
+    const size_type h = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - h;
+  }
+  bool      empty()    const noexcept { return size() == 0; }
+  bool      full()     const noexcept { return size() == capacity(); }
+
+  // 生产者：满时返回 false
+  template <class ...Args>
+  bool try_emplace(Args&& ...args)
+  {
+    const size_type t = tail_.load(std::memory_order_relaxed);
+    if (t - head_cache_ == capacity())
+    {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (t - head_cache_ == capacity())
+        return false;
+    }
+    alloc_traits::construct(alloc_, buf_ + (t & mask_), mystl::forward<Args>(args)...);
+    tail_.store(t + 1, std::memory_order_release);
+    return true;
+  }
+  bool try_push(const value_type& value) { return try_emplace(value); }
+  bool try_push(value_type&& value)      { return try_emplace(mystl::move(value)); }
+
+  // 生产者：满时自旋等待
+  template <class ...Args>
+  void emplace_back(Args&& ...args)
+  {
+    unsigned spins = 0;
+    while (!try_emplace(mystl::forward<Args>(args)...))
+      ring_pause(spins);
+  }
+  void push_back(const value_type& value) { emplace_back(value); }
+  void push_back(value_type&& value)      { emplace_back(mystl::move(value)); }
+
+  // 生产者：最后放入的元素
+  reference       back()
+  {
+    MYSTL_DEBUG(!empty());
+    return buf_[(tail_.load(std::memory_order_relaxed) - 1) & mask_];
+  }
+  const_reference back() const
+  {
+    MYSTL_DEBUG(!empty());
+    return buf_[(tail_.load(std::memory_order_relaxed) - 1) & mask_];
+  }
+
+  // 消费者：空时返回 false
+  bool try_pop(value_type& value)
+  {
+    const size_type h = head_.load(std::memory_order_relaxed);
+    if (h == tail_cache_)
+    {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (h == tail_cache_)
+        return false;
+    }
+    pointer p = buf_ + (h & mask_);
+    value = mystl::move(*p);
+    alloc_traits::destroy(alloc_, p);
+    head_.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 消费者：空时自旋等待
+  void pop(value_type& value)
+  {
+    unsigned spins = 0;
+    while (!try_pop(value))
+      ring_pause(spins);
+  }
+
+  // 消费者：最早放入的元素，调用前需确认队列不为空
+  reference       front()
+  {
+    MYSTL_DEBUG(!empty());
+    return buf_[head_.load(std::memory_order_relaxed) & mask_];
+  }
+  const_reference front() const
+  {
+    MYSTL_DEBUG(!empty());
+    return buf_[head_.load(std::memory_order_relaxed) & mask_];
+  }
+
+  void pop_front()
+  {
+    MYSTL_DEBUG(!empty());
+    const size_type h = head_.load(std::memory_order_relaxed);
+    alloc_traits::destroy(alloc_, buf_ + (h & mask_));
+    head_.store(h + 1, std::memory_order_release);
+  }
+
+  // 消费者：弹出所有元素
+  void clear() noexcept
+  {
+    size_type h = head_.load(std::memory_order_relaxed);
+    const size_type t = tail_.load(std::memory_order_acquire);
+    for (; h != t; ++h)
+      alloc_traits::destroy(alloc_, buf_ + (h & mask_));
+    head_.store(h, std::memory_order_release);
+  }
+};
+
+/*****************************************************************************************/
+// mpmc_ring
+// 位置 i 的序号为 seq：seq == pos 时可以写入第 pos 个元素，seq == pos + 1 时可以读出，
+// 读出后 seq 置为 pos + capacity，留给下一轮的生产者
+/*****************************************************************************************/
+template <class T, class Alloc = mystl::allocator<T>>
+class mpmc_ring
+{
+  static_assert(std::is_nothrow_move_constructible<T>::value &&
+                std::is_nothrow_move_assignable<T>::value,
+                "mpmc_ring requires nothrow move construction and assignment");
+
+public:
+  typedef Alloc                                    allocator_type;
+  typedef mystl::allocator_traits<Alloc>           alloc_traits;
+  typedef typename alloc_traits::value_type        value_type;
+  typedef value_type&                              reference;
+  typedef const value_type&                        const_reference;
+  typedef typename alloc_traits::size_type         size_type;
+  typedef typename alloc_traits::difference_type   difference_type;
+
+private:
+  struct cell
+  {
+    std::atomic<size_type> seq;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+    T* ptr() noexcept { return reinterpret_cast<T*>(&storage); }
+  };
+
+  typedef typename alloc_traits::template rebind_alloc<cell> cell_allocator;
+  typedef mystl::allocator_traits<cell_allocator>            cell_alloc_traits;
+
+  // 构造后只读的部分
+  cell*                  cells_;
+  size_type              mask_;
+  allocator_type         alloc_;
+  char                   pad0_[ECacheLineBytes];
+  // 生产者竞争的部分
+  std::atomic<size_type> tail_;
+  char                   pad1_[ECacheLineBytes];
+  // 消费者竞争的部分
+  std::atomic<size_type> head_;
+  char                   pad2_[ECacheLineBytes];
+
+public:
+  explicit mpmc_ring(size_type capacity = ERingDefaultCapacity,
+                     const allocator_type& alloc = allocator_type())
+    :cells_(nullptr), mask_(ring_capacity(capacity) - 1), alloc_(alloc), tail_(0), head_(0)
+  {
+    cell_allocator cell_alloc(alloc_);
+    cells_ = cell_alloc_traits::allocate(cell_alloc, mask_ + 1);
+    for (size_type i = 0; i <= mask_; ++i)
+      ::new (static_cast<void*>(&cells_[i].seq)) std::atomic<size_type>(i);
+  }
+
+  mpmc_ring(const mpmc_ring&) = delete;
+  mpmc_ring& operator=(const mpmc_ring&) = delete;
+
+  ~mpmc_ring()
+  {
+    clear();
+    cell_allocator cell_alloc(alloc_);
+    cell_alloc_traits::deallocate(cell_alloc, cells_, mask_ + 1);
+  }
+
+public:
+  // 容量相关操作，在其他线程同时修改时 size 只是一个近似值
+  size_type capacity() const noexcept { return mask_ + 1; }
+  size_type size()     const noexcept
+  {
+    const size_type h = head_.load(std::memory_order_acquire);
+    const size_type t = tail_.load(std::memory_order_acquire);
+    return t > h ? t - h : 0;
+  }
+  bool      empty()    const noexcept { return size() == 0; }
+  bool      full()     const noexcept { return size() >= capacity(); }
+
+  // 生产者：满时返回 false。先在本线程构造好元素，抢占位置之后只做不抛出异常的移动
+  template <class ...Args>
+  bool try_emplace(Args&& ...args)
+  {
+    value_type value(mystl::forward<Args>(args)...);
+    return try_push(mystl::move(value));
+  }
+  bool try_push(const value_type& value)
+  {
+    value_type tmp(value);
+    return try_push(mystl::move(tmp));
+  }
+  bool try_push(value_type&& value) noexcept
+  {
+    cell* c = claim_tail();
+    if (c == nullptr)
+      return false;
+    ::new (static_cast<void*>(c->ptr())) value_type(mystl::move(value));
+    c->seq.store(c->seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 生产者：满时自旋等待
+  template <class ...Args>
+  void emplace_back(Args&& ...args)
+  {
+    value_type value(mystl::forward<Args>(args)...);
+    unsigned spins = 0;
+    while (!try_push(mystl::move(value)))
+      ring_pause(spins);
+  }
+  void push_back(const value_type& value) { emplace_back(value); }
+  void push_back(value_type&& value)      { emplace_back(mystl::move(value)); }
+
+  // 消费者：空时返回 false
+  bool try_pop(value_type& value) noexcept
+  {
+    cell* c = claim_head();
+    if (c == nullptr)
+      return false;
+    value = mystl::move(*c->ptr());
+    release_head(c);
+    return true;
+  }
+
+  // 消费者：空时自旋等待
+  void pop(value_type& value) noexcept
+  {
+    unsigned spins = 0;
+    while (!try_pop(value))
+      ring_pause(spins);
+  }
+
+  // 消费者：等待队首的元素就绪并返回它；有多个消费者时它可能先被别的线程取走
+  reference front() noexcept
+  {
+    const size_type pos = head_.load(std::memory_order_acquire);
+    cell* c = cells_ + (pos & mask_);
+    unsigned spins = 0;
+    while (c->seq.load(std::memory_order_acquire) != pos + 1)
+      ring_pause(spins);
+    return *c->ptr();
+  }
+
+  void pop_front() noexcept
+  {
+    unsigned spins = 0;
+    cell* c;
+    while ((c = claim_head()) == nullptr)
+      ring_pause(spins);
+    release_head(c);
+  }
+
+  // 消费者：弹出所有元素
+  void clear() noexcept
+  {
+    cell* c;
+    while ((c = claim_head()) != nullptr)
+      release_head(c);
+  }
+
+private:
+  // 抢占一个可以写入的位置，满时返回 nullptr
+  cell* claim_tail() noexcept
+  {
+    size_type pos = tail_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      cell* c = cells_ + (pos & mask_);
+      const size_type seq = c->seq.load(std::memory_order_acquire);
+      const difference_type diff = static_cast<difference_type>(seq - pos);
+      if (diff == 0)
+      {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          return c;
+      }
+      else if (diff < 0)
+      {
+        return nullptr;
+      }
+      else
+      {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // 抢占一个可以读出的位置，空时返回 nullptr
+  cell* claim_head() noexcept
+  {
+    size_type pos = head_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      cell* c = cells_ + (pos & mask_);
+      const size_type seq = c->seq.load(std::memory_order_acquire);
+      const difference_type diff = static_cast<difference_type>(seq - (pos + 1));
+      if (diff == 0)
+      {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          return c;
+      }
+      else if (diff < 0)
+      {
+        return nullptr;
+      }
+      else
+      {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // 析构读出位置上的元素，把位置留给下一轮的生产者
+  void release_head(cell* c) noexcept
+  {
+    mystl::destroy(c->ptr());
+    c->seq.store(c->seq.load(std::memory_order_relaxed) + mask_, std::memory_order_release);
+  }
+};
+
+} // namespace mystl
+#endif // !MYTINYSTL_RING_BUFFER_H_
+
@@ -0,0 +1,812 @@
+#ifndef MYTINYSTL_SEGMENTED_VECTOR_H_
+#define MYTINYSTL_SEGMENTED_VECTOR_H_
+
+// 这个头文件包含一个模板类 segmented_vector
+// segmented_vector : 分段存储的向量，扩容时不搬移元素，元素的地址在其被删除之前保持不变
+
+// notes:
+//
+// 元素存放在一组大小为 2 的幂的分段中，第 k 段可以容纳 B * 2^k 个元素，B = 2^first_bits，
+// 因此前 k 段一共容纳 B * (2^k - 1) 个元素。下标 n 所在的分段与段内偏移可以直接算出：
+//   j = n + B，h = floor(log2(j))，段号 k = h - first_bits，段内偏移为 j - 2^h，
+// 只需要一次 count-leading-zeros，不必像 deque_iterator 那样逐个节点查找。
+//
+// 扩容时只分配下一个分段，已有的元素不会被复制或搬移，指向它们的指针、引用与迭代器一直有效
+// (end() 除外)；分段的数目是 O(log n)，分配的次数与 vector 相同，均摊 O(1)。
+// 分段表的长度固定，第一次分配时创建，之后不再改变，所以迭代器可以直接保存分段表。
+//
+// 只支持在尾部插入和删除；对一列数据做热循环时可以用 segment_data / segment_size 逐段遍历
+
+#include <initializer_list>
+
+#include "iterator.h"
+#include "memory.h"
+#include "util.h"
+#include "exceptdef.h"
+
+namespace mystl
+{
+
+// 取 n 的最高位的位置，n 必须大于 0
+inline size_t segmented_log2(size_t n) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<size_t>(63 - __builtin_clzll(static_cast<unsigned long long>(n)));
+#else
+  size_t k = 0;
+  while (n >>= 1)
+    ++k;
+  return k;
+#endif
+}
+
+// 第一个分段的元素个数为 2^value，至少占 256 bytes，至少 4 个元素
+constexpr size_t segmented_bits_for(size_t elem_bytes, size_t bits)
+{
+  return bits >= 8 || (static_cast<size_t>(1) << bits) * elem_bytes >= 256
+    ? bits : segmented_bits_for(elem_bytes, bits + 1);
+}
+
+template <class T>
+struct segmented_first_bits
+{
+  static constexpr size_t value = segmented_bits_for(sizeof(T), 2);
+};
+
+// segmented_vector 的迭代器设计
+// 保存分段表与下标，段内移动只改变指针，跨段或随机移动时由下标重新计算位置
+template <class T, class Ref, class Ptr>
+struct segmented_vector_iterator : public iterator<random_access_iterator_tag, T>
+{
+  typedef segmented_vector_iterator<T, T&, T*>             iterator;
+  typedef segmented_vector_iterator<T, const T&, const T*> const_iterator;
+  typedef segmented_vector_iterator                        self;
+
+  typedef T            value_type;
+  typedef Ptr          pointer;
+  typedef Ref          reference;
+  typedef size_t       size_type;
+  typedef ptrdiff_t    difference_type;
+  typedef T* const*    map_pointer;
+
+  static constexpr size_type first_bits = segmented_first_bits<T>::value;
+  static constexpr size_type first_size = static_cast<size_type>(1) << first_bits;
+
+  pointer     cur;    // 指向当前元素
+  pointer     first;  // 指向所在分段的头部
+  pointer     last;   // 指向所在分段的尾部
+  map_pointer segs;   // 分段表
+  size_type   idx;    // 当前元素的下标
+
+  segmented_vector_iterator() noexcept
+    :cur(nullptr), first(nullptr), last(nullptr), segs(nullptr), idx(0) {}
+
+  segmented_vector_iterator(map_pointer s, size_type n) noexcept
+    :segs(s), idx(n)
+  { seek(); }
+
+  segmented_vector_iterator(const iterator& rhs) noexcept
+    :cur(rhs.cur), first(rhs.first), last(rhs.last), segs(rhs.segs), idx(rhs.idx) {}
+
+  self& operator=(const iterator& rhs) noexcept
+  {
+    cur = rhs.cur;
+    first = rhs.first;
+    last = rhs.last;
+    segs = rhs.segs;
+    idx = rhs.idx;
+    return *this;
+  }
+
+  // 根据 idx 重新计算 cur、first、last，所在分段尚未分配时全部置空
+  void seek() noexcept
+  {
+    const size_type j = idx + first_size;
+    const size_type h = segmented_log2(j);
+    const pointer seg = segs == nullptr ? nullptr : segs[h - first_bits];
+    if (seg == nullptr)
+    {
+      cur = first = last = nullptr;
+      return;
+    }
+    first = seg;
+    last = seg + (static_cast<size_type>(1) << h);
+    cur = seg + (j - (static_cast<size_type>(1) << h));
+  }
+
+  reference operator*()  const { return *cur; }
+  pointer   operator->() const { return cur; }
+
+  self& operator++()
+  {
+    ++idx;
+    if (++cur == last)
+      seek();
+    return *this;
+  }
+  self operator++(int)
+  {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  self& operator--()
+  {
+    --idx;
+    if (cur == first)
+      seek();
+    else
+      --cur;
+    return *this;
+  }
+  self operator--(int)
+  {
+    self tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  self& operator+=(difference_type n)
+  {
+    const difference_type offset = n + (cur - first);
+    idx += n;
+    if (cur != nullptr && offset >= 0 && offset < last - first)
+      cur = first + offset;  // 仍在同一个分段中
+    else
+      seek();
+    return *this;
+  }
+  self operator+(difference_type n) const
+  {
+    self tmp = *this;
+    return tmp += n;
+  }
+  self& operator-=(difference_type n)
+  {
+    return *this += -n;
+  }
+  self operator-(difference_type n) const
+  {
+    self tmp = *this;
+    return tmp -= n;
+  }
+
+  difference_type operator-(const self& x) const
+  {
+    return static_cast<difference_type>(idx) - static_cast<difference_type>(x.idx);
+  }
+
+  reference operator[](difference_type n) const { return *(*this + n); }
+
+  // 重载比较操作符
+  bool operator==(const self& rhs) const { return idx == rhs.idx; }
+  bool operator< (const self& rhs) const { return idx < rhs.idx; }
+  bool operator!=(const self& rhs) const { return !(*this == rhs); }
+  bool operator> (const self& rhs) const { return rhs < *this; }
+  bool operator<=(const self& rhs) const { return !(rhs < *this); }
+  bool operator>=(const self& rhs) const { return !(*this < rhs); }
+};
+
+template <class T, class Ref, class Ptr>
+constexpr typename segmented_vector_iterator<T, Ref, Ptr>::size_type
+segmented_vector_iterator<T, Ref, Ptr>::first_bits;
+
+template <class T, class Ref, class Ptr>
+constexpr typename segmented_vector_iterator<T, Ref, Ptr>::size_type
+segmented_vector_iterator<T, Ref, Ptr>::first_size;
+
+// 模板类 segmented_vector
+// 模板参数 T 代表数据类型，Alloc 代表分配器类型
+template <class T, class Alloc = mystl::allocator<T>>
+class segmented_vector
+{
+public:
+  // segmented_vector 的型别定义
+  typedef Alloc                                    allocator_type;
+  typedef mystl::allocator_traits<Alloc>           alloc_traits;
+  typedef typename alloc_traits::template
+    rebind_alloc<T*>                               map_allocator;
+  typedef mystl::allocator_traits<map_allocator>   map_alloc_traits;
+
+  typedef typename alloc_traits::value_type        value_type;
+  typedef typename alloc_traits::pointer           pointer;
+  typedef typename alloc_traits::const_pointer     const_pointer;
+  typedef value_type&                              reference;
+  typedef const value_type&                        const_reference;
+  typedef typename alloc_traits::size_type         size_type;
+  typedef typename alloc_traits::difference_type   difference_type;
+  typedef pointer*                                 map_pointer;
+
+  typedef segmented_vector_iterator<T, T&, T*>              iterator;
+  typedef segmented_vector_iterator<T, const T&, const T*>  const_iterator;
+  typedef mystl::reverse_iterator<iterator>                 reverse_iterator;
+  typedef mystl::reverse_iterator<const_iterator>           const_reverse_iterator;
+
+  allocator_type get_allocator() const { return alloc_; }
+
+  static constexpr size_type first_bits = segmented_first_bits<T>::value;
+  static constexpr size_type first_size = static_cast<size_type>(1) << first_bits;
+  // 分段表的长度，足以容纳 max_size() 个元素
+  static constexpr size_type max_segments = sizeof(size_type) * 8 - first_bits - 1;
+
+private:
+  // 用以下数据来表现一个 segmented_vector
+  map_pointer    segs_;      // 分段表，长度为 max_segments，第一次分配时创建
+  size_type      nsegs_;     // 已分配的分段数
+  size_type      size_;      // 元素个数
+  pointer        tail_;      // 下一个元素的位置，所在分段未分配时为空
+  pointer        tail_end_;  // tail_ 所在分段的尾部
+  allocator_type alloc_;     // 分段的分配器，分段表使用由它 rebind 得到的分配器
+
+public:
+  // 构造、复制、移动、析构函数
+  segmented_vector() noexcept
+    :segs_(nullptr), nsegs_(0), size_(0), tail_(nullptr), tail_end_(nullptr)
+  {
+  }
+
+  explicit segmented_vector(const allocator_type& alloc) noexcept
+    :segs_(nullptr), nsegs_(0), size_(0), tail_(nullptr), tail_end_(nullptr), alloc_(alloc)
+  {
+  }
+
+  explicit segmented_vector(size_type n, const allocator_type& alloc = allocator_type())
+    :segs_(nullptr), nsegs_(0), size_(0), tail_(nullptr), tail_end_(nullptr), alloc_(alloc)
+  {
+    init_guard([&] { resize(n); });
+  }
+
+  segmented_vector(size_type n, const value_type& value,
+                   const allocator_type& alloc = allocator_type())
+    :segs_(nullptr), nsegs_(0), size_(0), tail_(nullptr), tail_end_(nullptr), alloc_(alloc)
+  {
+    init_guard([&] { resize(n, value); });
+  }
+
+  template <class Iter, typename std::enable_if<
+    mystl::is_input_iterator<Iter>::value, int>::type = 0>
+  segmented_vector(Iter first, Iter last, const allocator_type& alloc = allocator_type())
+    :segs_(nullptr), nsegs_(0), size_(0), tail_(nullptr), tail_end_(nullptr), alloc_(alloc)
+  {
+    init_guard([&] {
+      for (; first != last; ++first)
+        emplace_back(*first);
+    });
+  }
+
+  segmented_vector(std::initializer_list<value_type> ilist,
+                   const allocator_type& alloc = allocator_type())
+    :segs_(nullptr), nsegs_(0), size_(0), tail_(nullptr), tail_end_(nullptr), alloc_(alloc)
+  {
+    init_guard([&] { copy_from(ilist.begin(), ilist.size()); });
+  }
+
+  segmented_vector(const segmented_vector& rhs)
+    :segs_(nullptr), nsegs_(0), size_(0), tail_(nullptr), tail_end_(nullptr),
+    alloc_(alloc_traits::select_on_container_copy_construction(rhs.alloc_))
+  {
+    init_guard([&] { copy_from(rhs); });
+  }
+
+  segmented_vector(segmented_vector&& rhs) noexcept
+    :segs_(rhs.segs_), nsegs_(rhs.nsegs_), size_(rhs.size_),
+    tail_(rhs.tail_), tail_end_(rhs.tail_end_), alloc_(mystl::move(rhs.alloc_))
+  {
+    rhs.reset_members();
+  }
+
+  segmented_vector& operator=(const segmented_vector& rhs);
+  segmented_vector& operator=(segmented_vector&& rhs);
+
+  segmented_vector& operator=(std::initializer_list<value_type> ilist)
+  {
+    clear();
+    copy_from(ilist.begin(), ilist.size());
+    return *this;
+  }
+
+  ~segmented_vector()
+  { release(); }
+
+public:
+  // 迭代器相关操作
+  iterator               begin()         noexcept
+  { return iterator(segs_, 0); }
+  const_iterator         begin()   const noexcept
+  { return const_iterator(segs_, 0); }
+  iterator               end()           noexcept
+  { return iterator(segs_, size_); }
+  const_iterator         end()     const noexcept
+  { return const_iterator(segs_, size_); }
+
+  reverse_iterator       rbegin()        noexcept
+  { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin()  const noexcept
+  { return const_reverse_iterator(end()); }
+  reverse_iterator       rend()          noexcept
+  { return reverse_iterator(begin()); }
+  const_reverse_iterator rend()    const noexcept
+  { return const_reverse_iterator(begin()); }
+
+  const_iterator         cbegin()  const noexcept
+  { return begin(); }
+  const_iterator         cend()    const noexcept
+  { return end(); }
+
+  // 容量相关操作
+  bool      empty()    const noexcept { return size_ == 0; }
+  size_type size()     const noexcept { return size_; }
+  size_type max_size() const noexcept { return segment_start(max_segments); }
+  size_type capacity() const noexcept { return segment_start(nsegs_); }
+  void      reserve(size_type n);
+  void      shrink_to_fit();
+
+  // 访问元素相关操作
+  reference       operator[](size_type n)
+  {
+    MYSTL_DEBUG(n < size_);
+    return *locate(n);
+  }
+  const_reference operator[](size_type n) const
+  {
+    MYSTL_DEBUG(n < size_);
+    return *locate(n);
+  }
+  reference       at(size_type n)
+  {
+    THROW_OUT_OF_RANGE_IF(!(n < size_), "segmented_vector<T>::at() subscript out of range");
+    return (*this)[n];
+  }
+  const_reference at(size_type n) const
+  {
+    THROW_OUT_OF_RANGE_IF(!(n < size_), "segmented_vector<T>::at() subscript out of range");
+    return (*this)[n];
+  }
+
+  reference       front()
+  {
+    MYSTL_DEBUG(!empty());
+    return *segs_[0];
+  }
+  const_reference front() const
+  {
+    MYSTL_DEBUG(!empty());
+    return *segs_[0];
+  }
+  reference       back()
+  {
+    MYSTL_DEBUG(!empty());
+    return *locate(size_ - 1);
+  }
+  const_reference back() const
+  {
+    MYSTL_DEBUG(!empty());
+    return *locate(size_ - 1);
+  }
+
+  // 分段相关操作
+  // 第 k 段可以容纳的元素个数，以及第 k 段第一个元素的下标
+  static size_type segment_capacity(size_type k) noexcept
+  { return static_cast<size_type>(1) << (k + first_bits); }
+  static size_type segment_start(size_type k) noexcept
+  { return segment_capacity(k) - first_size; }
+  // 下标 n 所在的分段
+  static size_type segment_of(size_type n) noexcept
+  { return segmented_log2(n + first_size) - first_bits; }
+
+  // 含有元素的分段数，以及第 k 段的首地址与元素个数
+  size_type       segment_count() const noexcept
+  { return size_ == 0 ? 0 : segment_of(size_ - 1) + 1; }
+  pointer         segment_data(size_type k) noexcept
+  {
+    MYSTL_DEBUG(k < nsegs_);
+    return segs_[k];
+  }
+  const_pointer   segment_data(size_type k) const noexcept
+  {
+    MYSTL_DEBUG(k < nsegs_);
+    return segs_[k];
+  }
+  size_type       segment_size(size_type k) const noexcept
+  {
+    const size_type start = segment_start(k);
+    return size_ <= start ? 0 : mystl::min(segment_capacity(k), size_ - start);
+  }
+
+  // 修改容器相关操作
+
+  // emplace_back / push_back
+  template <class ...Args>
+  void emplace_back(Args&& ...args)
+  {
+    if (tail_ == tail_end_)
+      grow_tail();
+    alloc_traits::construct(alloc_, tail_, mystl::forward<Args>(args)...);
+    ++tail_;
+    ++size_;
+  }
+
+  void push_back(const value_type& value)
+  { emplace_back(value); }
+  void push_back(value_type&& value)
+  { emplace_back(mystl::move(value)); }
+
+  void pop_back();
+
+  void clear() noexcept
+  { destroy_from(0); }
+
+  void resize(size_type new_size) { return resize(new_size, value_type()); }
+  void resize(size_type new_size, const value_type& value);
+
+  void swap(segmented_vector& rhs) noexcept;
+
+private:
+  // helper functions
+
+  // 下标 n 处元素的地址，所在分段必须已经分配
+  pointer locate(size_type n) const noexcept
+  {
+    const size_type j = n + first_size;
+    const size_type h = segmented_log2(j);
+    return segs_[h - first_bits] + (j - (static_cast<size_type>(1) << h));
+  }
+
+  // 构造函数中途抛出异常时释放已经分配的空间
+  template <class F>
+  void init_guard(F f)
+  {
+    try
+    {
+      f();
+    }
+    catch (...)
+    {
+      release();
+      throw;
+    }
+  }
+
+  void reset_members() noexcept
+  {
+    segs_ = nullptr;
+    nsegs_ = 0;
+    size_ = 0;
+    tail_ = nullptr;
+    tail_end_ = nullptr;
+  }
+
+  void add_segment();
+  void grow_tail();
+  void reset_tail() noexcept;
+  void destroy_from(size_type n) noexcept;
+  void release() noexcept;
+
+  template <class Iter>
+  void copy_from(Iter first, size_type n);
+  void copy_from(const segmented_vector& rhs);
+  void move_from(segmented_vector& rhs);
+};
+
+template <class T, class Alloc>
+constexpr typename segmented_vector<T, Alloc>::size_type segmented_vector<T, Alloc>::first_bits;
+
+template <class T, class Alloc>
+constexpr typename segmented_vector<T, Alloc>::size_type segmented_vector<T, Alloc>::first_size;
+
+template <class T, class Alloc>
+constexpr typename segmented_vector<T, Alloc>::size_type segmented_vector<T, Alloc>::max_segments;
+
+/*****************************************************************************************/
+
+// 复制赋值操作符
+template <class T, class Alloc>
+segmented_vector<T, Alloc>&
+segmented_vector<T, Alloc>::operator=(const segmented_vector& rhs)
+{
+  if (this != &rhs)
+  {
+    if (mystl::alloc_copy_needs_reset(alloc_, rhs.alloc_))
+      release();  // 原有的分段必须用旧的分配器释放
+    else
+      clear();
+    mystl::alloc_on_copy_assign(alloc_, rhs.alloc_);
+    copy_from(rhs);
+  }
+  return *this;
+}
+
+// 移动赋值操作符，能接管 rhs 的空间时直接接管，否则逐个移动元素
+template <class T, class Alloc>
+segmented_vector<T, Alloc>&
+segmented_vector<T, Alloc>::operator=(segmented_vector&& rhs)
+{
+  if (this == &rhs)
+    return *this;
+  if (mystl::alloc_move_can_steal(alloc_, rhs.alloc_))
+  {
+    release();
+    mystl::alloc_on_move_assign(alloc_, rhs.alloc_);
+    segs_ = rhs.segs_;
+    nsegs_ = rhs.nsegs_;
+    size_ = rhs.size_;
+    tail_ = rhs.tail_;
+    tail_end_ = rhs.tail_end_;
+    rhs.reset_members();
+  }
+  else
+  {
+    clear();
+    move_from(rhs);
+    rhs.clear();
+  }
+  return *this;
+}
+
+// 预留空间，只分配新的分段，已有的元素不动
+template <class T, class Alloc>
+void segmented_vector<T, Alloc>::reserve(size_type n)
+{
+  THROW_LENGTH_ERROR_IF(n > max_size(), "segmented_vector<T>'s size too big");
+  while (capacity() < n)
+    add_segment();
+  reset_tail();
+}
+
+// 释放没有元素的分段
+template <class T, class Alloc>
+void segmented_vector<T, Alloc>::shrink_to_fit()
+{
+  while (nsegs_ > 0 && segment_start(nsegs_ - 1) >= size_)
+  {
+    --nsegs_;
+    alloc_traits::deallocate(alloc_, segs_[nsegs_], segment_capacity(nsegs_));
+    segs_[nsegs_] = nullptr;
+  }
+  if (nsegs_ == 0)
+    release();
+  else
+    reset_tail();
+}
+
+// 删除尾部元素，分段保留给之后的插入使用
+template <class T, class Alloc>
+void segmented_vector<T, Alloc>::pop_back()
+{
+  MYSTL_DEBUG(!empty());
+  --size_;
+  alloc_traits::destroy(alloc_, locate(size_));
+  reset_tail();
+}
+
+// 重置容器大小
+template <class T, class Alloc>
+void segmented_vector<T, Alloc>::resize(size_type new_size, const value_type& value)
+{
+  if (new_size < size_)
+  {
+    destroy_from(new_size);
+    return;
+  }
+  reserve(new_size);
+  // 元素不会被搬移，value 即使是容器中的元素也一直有效
+  while (size_ < new_size)
+    emplace_back(value);
+}
+
+// 交换两个 segmented_vector
+template <class T, class Alloc>
+void segmented_vector<T, Alloc>::swap(segmented_vector& rhs) noexcept
+{
+  if (this != &rhs)
+  {
+    mystl::swap(segs_, rhs.segs_);
+    mystl::swap(nsegs_, rhs.nsegs_);
+    mystl::swap(size_, rhs.size_);
+    mystl::swap(tail_, rhs.tail_);
+    mystl::swap(tail_end_, rhs.tail_end_);
+    mystl::alloc_on_swap(alloc_, rhs.alloc_);
+  }
+}
+
+/*****************************************************************************************/
+// helper function
+
+// 分配下一个分段，第一次分配时创建分段表
+template <class T, class Alloc>
+void segmented_vector<T, Alloc>::add_segment()
+{
+  THROW_LENGTH_ERROR_IF(nsegs_ == max_segments, "segmented_vector<T>'s size too big");
+  if (segs_ == nullptr)
+  {
+    map_allocator map_alloc(alloc_);
+    segs_ = map_alloc_traits::allocate(map_alloc, max_segments);
+    for (size_type k = 0; k < max_segments; ++k)
+      segs_[k] = nullptr;
+  }
+  segs_[nsegs_] = alloc_traits::allocate(alloc_, segment_capacity(nsegs_));
+  ++nsegs_;
+}
+
+// tail_ 到达分段尾部时，转到下一个分段，必要时先分配
+template <class T, class Alloc>
+void segmented_vector<T, Alloc>::grow_tail()
+{
+  if (size_ == capacity())
+    add_segment();
+  reset_tail();
+}
+
+// 根据 size_ 重新计算 tail_ 与 tail_end_
+template <class T, class Alloc>
+void segmented_vector<T, Alloc>::reset_tail() noexcept
+{
+  if (size_ < capacity())
+  {
+    const size_type k = segment_of(size_);
+    tail_ = segs_[k] + (size_ - segment_start(k));
+    tail_end_ = segs_[k] + segment_capacity(k);
+  }
+  else
+  {
+    tail_ = tail_end_ = nullptr;
+  }
+}
+
+// 析构 [n, size_) 上的元素，分段保留
+template <class T, class Alloc>
+void segmented_vector<T, Alloc>::destroy_from(size_type n) noexcept
+{
+  if (n >= size_)
+    return;
+  for (size_type k = segment_of(n); k < nsegs_ && segment_start(k) < size_; ++k)
+  {
+    const size_type start = segment_start(k);
+    const size_type b = n > start ? n - start : 0;
+    const size_type e = mystl::min(segment_capacity(k), size_ - start);
+    alloc_traits::destroy(alloc_, segs_[k] + b, segs_[k] + e);
+  }
+  size_ = n;
+  reset_tail();
+}
+
+// 析构所有元素并释放全部空间
+template <class T, class Alloc>
+void segmented_vector<T, Alloc>::release() noexcept
+{
+  if (segs_ == nullptr)
+    return;
+  destroy_from(0);
+  for (size_type k = 0; k < nsegs_; ++k)
+    alloc_traits::deallocate(alloc_, segs_[k], segment_capacity(k));
+  map_allocator map_alloc(alloc_);
+  map_alloc_traits::deallocate(map_alloc, segs_, max_segments);
+  reset_members();
+}
+
+// 在空的容器中复制 [first, first + n)，逐段整体复制
+template <class T, class Alloc>
+template <class Iter>
+void segmented_vector<T, Alloc>::copy_from(Iter first, size_type n)
+{
+  MYSTL_DEBUG(size_ == 0);
+  reserve(n);
+  try
+  {
+    for (size_type k = 0; size_ < n; ++k)
+    {
+      const size_type count = mystl::min(segment_capacity(k), n - size_);
+      mystl::uninitialized_copy(first, first + count, segs_[k]);
+      first += count;
+      size_ += count;
+    }
+  }
+  catch (...)
+  { // 已经复制的分段保留下来，尾部要与 size_ 一致
+    reset_tail();
+    throw;
+  }
+  reset_tail();
+}
+
+// 两个容器的分段划分相同，第 k 段对应复制到第 k 段
+template <class T, class Alloc>
+void segmented_vector<T, Alloc>::copy_from(const segmented_vector& rhs)
+{
+  MYSTL_DEBUG(size_ == 0);
+  reserve(rhs.size_);
+  try
+  {
+    for (size_type k = 0; size_ < rhs.size_; ++k)
+    {
+      const size_type count = rhs.segment_size(k);
+      mystl::uninitialized_copy(rhs.segs_[k], rhs.segs_[k] + count, segs_[k]);
+      size_ += count;
+    }
+  }
+  catch (...)
+  {
+    reset_tail();
+    throw;
+  }
+  reset_tail();
+}
+
+template <class T, class Alloc>
+void segmented_vector<T, Alloc>::move_from(segmented_vector& rhs)
+{
+  MYSTL_DEBUG(size_ == 0);
+  reserve(rhs.size_);
+  try
+  {
+    for (size_type k = 0; size_ < rhs.size_; ++k)
+    {
+      const size_type count = rhs.segment_size(k);
+      mystl::uninitialized_move(rhs.segs_[k], rhs.segs_[k] + count, segs_[k]);
+      size_ += count;
+    }
+  }
+  catch (...)
+  {
+    reset_tail();
+    throw;
+  }
+  reset_tail();
+}
+
+/*****************************************************************************************/
+// 重载比较操作符
+
+template <class T, class Alloc>
+bool operator==(const segmented_vector<T, Alloc>& lhs, const segmented_vector<T, Alloc>& rhs)
+{
+  return lhs.size() == rhs.size() &&
+    mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class T, class Alloc>
+bool operator<(const segmented_vector<T, Alloc>& lhs, const segmented_vector<T, Alloc>& rhs)
+{
+  return mystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class T, class Alloc>
+bool operator!=(const segmented_vector<T, Alloc>& lhs, const segmented_vector<T, Alloc>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+template <class T, class Alloc>
+bool operator>(const segmented_vector<T, Alloc>& lhs, const segmented_vector<T, Alloc>& rhs)
+{
+  return rhs < lhs;
+}
+
+template <class T, class Alloc>
+bool operator<=(const segmented_vector<T, Alloc>& lhs, const segmented_vector<T, Alloc>& rhs)
+{
+  return !(rhs < lhs);
+}
+
+template <class T, class Alloc>
+bool operator>=(const segmented_vector<T, Alloc>& lhs, const segmented_vector<T, Alloc>& rhs)
+{
+  return !(lhs < rhs);
+}
+
+// 重载 mystl 的 swap
+template <class T, class Alloc>
+void swap(segmented_vector<T, Alloc>& lhs, segmented_vector<T, Alloc>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+// segmented_vector 只保存指向堆上空间的指针，分配器可以平凡搬移时它也可以
+template <class T, class Alloc>
+struct is_trivially_relocatable<segmented_vector<T, Alloc>>
+  : mystl::is_trivially_relocatable<Alloc> {};
+
+} // namespace mystl
+#endif // !MYTINYSTL_SEGMENTED_VECTOR_H_
+
@@ -0,0 +1,439 @@
+#ifndef MYTINYSTL_SMALL_VECTOR_H_
+#define MYTINYSTL_SMALL_VECTOR_H_
+
+// 这个头文件包含一个模板类 small_vector
+// small_vector : 带有内联缓冲区的向量，不超过 N 个元素时不分配堆空间
+
+// notes:
+//
+// small_vector<T, N> 以 vector<T, small_buffer_allocator<T, N, Alloc>> 为私有基类，
+// 插入、扩容、搬移全部复用 vector 的实现：
+// 缓冲区放在分配器中，分配器对象是 vector 的成员，因此缓冲区就在 small_vector 对象内部。
+// 第一次分配的 N 个位置取自缓冲区，超出后由 vector 的扩容函数向上游分配器申请堆空间，
+// 元素可以平凡搬移时同样走 reallocate 的路径；shrink_to_fit 时元素不超过 N 个会搬回缓冲区。
+//
+// 与 vector 不同，移动与交换不能总是交换指针：
+// 元素在缓冲区中时只能逐个搬移，只有元素在堆上时才直接接管空间
+
+#include <initializer_list>
+#include <type_traits>
+
+#include <cstring>
+
+#include "vector.h"
+
+namespace mystl
+{
+
+// 模板类: small_buffer_allocator
+// 自带 N 个元素的缓冲区，缓冲区空闲且请求不超过 N 个元素时从缓冲区分配，否则交给上游分配器
+// 缓冲区不能被其它分配器对象释放，所以复制时只复制上游分配器，且两个不同的对象总是不相等
+// 只供 small_vector 使用
+template <class T, size_t N, class Alloc>
+class small_buffer_allocator
+{
+public:
+  typedef mystl::allocator_traits<Alloc> upstream_traits;
+
+  typedef T            value_type;
+  typedef T*           pointer;
+  typedef const T*     const_pointer;
+  typedef T&           reference;
+  typedef const T&     const_reference;
+  typedef size_t       size_type;
+  typedef ptrdiff_t    difference_type;
+
+  typedef std::false_type propagate_on_container_copy_assignment;
+  typedef std::false_type propagate_on_container_move_assignment;
+  typedef std::false_type propagate_on_container_swap;
+  typedef std::false_type is_always_equal;
+
+private:
+  typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type buf_;  // 内联缓冲区
+  bool  used_;      // 缓冲区是否已分配出去
+  Alloc upstream_;  // 上游分配器
+
+public:
+  small_buffer_allocator() noexcept
+    :used_(false), upstream_()
+  {
+  }
+
+  explicit small_buffer_allocator(const Alloc& upstream) noexcept
+    :used_(false), upstream_(upstream)
+  {
+  }
+
+  small_buffer_allocator(const small_buffer_allocator& rhs) noexcept
+    :used_(false), upstream_(rhs.upstream_)
+  {
+  }
+
+  small_buffer_allocator& operator=(const small_buffer_allocator& rhs) noexcept
+  {
+    upstream_ = rhs.upstream_;
+    return *this;
+  }
+
+  T*   allocate(size_type n);
+  void deallocate(T* ptr, size_type n);
+
+  // 从缓冲区搬到堆上时按字节复制，只用于可以平凡搬移的元素
+  T*   reallocate(T* ptr, size_type old_n, size_type new_n);
+  bool try_expand(T* ptr, size_type old_n, size_type new_n) noexcept;
+
+  T*       buffer()       noexcept { return reinterpret_cast<T*>(&buf_); }
+  const T* buffer() const noexcept { return reinterpret_cast<const T*>(&buf_); }
+
+  // ptr 是否指向缓冲区
+  bool owns(const T* ptr) const noexcept { return ptr == buffer(); }
+
+  const Alloc& upstream() const noexcept { return upstream_; }
+};
+
+template <class T, size_t N, class Alloc>
+T* small_buffer_allocator<T, N, Alloc>::allocate(size_type n)
+{
+  if (!used_ && n <= N)
+  {
+    used_ = true;
+    return buffer();
+  }
+  return upstream_traits::allocate(upstream_, n);
+}
+
+template <class T, size_t N, class Alloc>
+void small_buffer_allocator<T, N, Alloc>::deallocate(T* ptr, size_type n)
+{
+  if (owns(ptr))
+    used_ = false;
+  else
+    upstream_traits::deallocate(upstream_, ptr, n);
+}
+
+template <class T, size_t N, class Alloc>
+T* small_buffer_allocator<T, N, Alloc>::
+reallocate(T* ptr, size_type old_n, size_type new_n)
+{
+  if (!owns(ptr))
+    return upstream_traits::reallocate(upstream_, ptr, old_n, new_n);
+  if (new_n <= N)
+    return ptr;
+  T* r = upstream_traits::allocate(upstream_, new_n);
+  std::memcpy(static_cast<void*>(r), static_cast<const void*>(ptr), old_n * sizeof(T));
+  used_ = false;
+  return r;
+}
+
+template <class T, size_t N, class Alloc>
+bool small_buffer_allocator<T, N, Alloc>::
+try_expand(T* ptr, size_type old_n, size_type new_n) noexcept
+{
+  if (owns(ptr))
+    return new_n <= N;
+  return upstream_traits::try_expand(upstream_, ptr, old_n, new_n);
+}
+
+template <class T, size_t N, class Alloc>
+bool operator==(const small_buffer_allocator<T, N, Alloc>& lhs,
+                const small_buffer_allocator<T, N, Alloc>& rhs) noexcept
+{
+  return &lhs == &rhs;
+}
+
+template <class T, size_t N, class Alloc>
+bool operator!=(const small_buffer_allocator<T, N, Alloc>& lhs,
+                const small_buffer_allocator<T, N, Alloc>& rhs) noexcept
+{
+  return !(lhs == rhs);
+}
+
+// vector 第一次分配时正好取走整个缓冲区
+template <class T, size_t N, class Alloc>
+struct vector_init_capacity<small_buffer_allocator<T, N, Alloc>>
+  : mystl::m_integral_constant<size_t, N> {};
+
+/*****************************************************************************************/
+
+// 模板类: small_vector
+// 模板参数 T 代表类型，N 代表内联缓冲区的元素个数，Alloc 代表缓冲区不够时使用的分配器
+template <class T, size_t N, class Alloc = mystl::allocator<T>>
+class small_vector : private mystl::vector<T, small_buffer_allocator<T, N, Alloc>>
+{
+  static_assert(N > 0, "small_vector requires a non-empty inline buffer");
+
+  typedef small_buffer_allocator<T, N, Alloc>   buffer_allocator;
+  typedef mystl::vector<T, buffer_allocator>    base;
+  typedef mystl::allocator_traits<Alloc>        upstream_traits;
+
+public:
+  // small_vector 的嵌套型别定义
+  typedef Alloc                                 allocator_type;
+
+  typedef typename base::value_type             value_type;
+  typedef typename base::pointer                pointer;
+  typedef typename base::const_pointer          const_pointer;
+  typedef typename base::reference              reference;
+  typedef typename base::const_reference        const_reference;
+  typedef typename base::size_type              size_type;
+  typedef typename base::difference_type        difference_type;
+
+  typedef typename base::iterator               iterator;
+  typedef typename base::const_iterator         const_iterator;
+  typedef typename base::reverse_iterator       reverse_iterator;
+  typedef typename base::const_reverse_iterator const_reverse_iterator;
+
+  allocator_type get_allocator() const { return this->alloc_.upstream(); }
+
+public:
+  // 构造、复制、移动、析构函数
+  small_vector() noexcept
+    :base()
+  {
+  }
+
+  explicit small_vector(const allocator_type& alloc) noexcept
+    :base(buffer_allocator(alloc))
+  {
+  }
+
+  explicit small_vector(size_type n, const allocator_type& alloc = allocator_type())
+    :base(n, buffer_allocator(alloc))
+  {
+  }
+
+  small_vector(size_type n, const value_type& value,
+               const allocator_type& alloc = allocator_type())
+    :base(n, value, buffer_allocator(alloc))
+  {
+  }
+
+  template <class Iter, typename std::enable_if<
+    mystl::is_input_iterator<Iter>::value, int>::type = 0>
+  small_vector(Iter first, Iter last, const allocator_type& alloc = allocator_type())
+    :base(first, last, buffer_allocator(alloc))
+  {
+  }
+
+  small_vector(std::initializer_list<value_type> ilist,
+               const allocator_type& alloc = allocator_type())
+    :base(ilist, buffer_allocator(alloc))
+  {
+  }
+
+  small_vector(const small_vector& rhs)
+    :base(rhs)
+  {
+  }
+
+  // 上游分配器不总是相等时，rhs 在堆上也可能要重新分配空间，不能保证不抛出异常
+  small_vector(small_vector&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value &&
+                                            upstream_traits::is_always_equal::value)
+    :base(rhs.alloc_)
+  {
+    take(rhs);
+  }
+
+  small_vector& operator=(const small_vector& rhs)
+  {
+    base::operator=(rhs);
+    return *this;
+  }
+
+  small_vector& operator=(small_vector&& rhs)
+  {
+    if (this != &rhs)
+      take(rhs);
+    return *this;
+  }
+
+  small_vector& operator=(std::initializer_list<value_type> ilist)
+  {
+    this->assign(ilist);
+    return *this;
+  }
+
+public:
+  // 与 vector 相同的接口
+  using base::begin;
+  using base::end;
+  using base::rbegin;
+  using base::rend;
+  using base::cbegin;
+  using base::cend;
+  using base::crbegin;
+  using base::crend;
+
+  using base::empty;
+  using base::size;
+  using base::max_size;
+  using base::capacity;
+  using base::reserve;
+
+  using base::operator[];
+  using base::at;
+  using base::front;
+  using base::back;
+  using base::data;
+
+  using base::assign;
+  using base::emplace;
+  using base::emplace_back;
+  using base::push_back;
+  using base::pop_back;
+  using base::insert;
+  using base::append_range;
+  using base::resize_uninitialized;
+  using base::erase;
+  using base::clear;
+  using base::resize;
+  using base::reverse;
+
+  // 元素是否在内联缓冲区中
+  bool is_small() const noexcept { return this->alloc_.owns(this->begin_); }
+
+  // 元素在缓冲区中时不做任何事，在堆上且不超过 N 个时搬回缓冲区
+  void shrink_to_fit();
+
+  void swap(small_vector& rhs);
+
+private:
+  // helper functions
+
+  // 移动 rhs 的元素，之后 rhs 为空
+  void take(small_vector& rhs);
+
+  // 空间已被接管后，重新使用缓冲区
+  void reset_small() noexcept;
+};
+
+/*****************************************************************************************/
+
+// 放弃多余的容量
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::shrink_to_fit()
+{
+  if (is_small())
+    return;
+  const size_type len = size();
+  if (len > N)
+  {
+    base::shrink_to_fit();
+    return;
+  }
+  // 直接搬回缓冲区，使容量仍为 N
+  iterator buf = this->alloc_.allocate(N);
+  try
+  {
+    mystl::uninitialized_relocate(this->begin_, this->end_, buf);
+  }
+  catch (...)
+  {
+    this->alloc_.deallocate(buf, N);
+    throw;
+  }
+  this->alloc_.deallocate(this->begin_, this->cap_ - this->begin_);
+  this->begin_ = buf;
+  this->end_ = buf + len;
+  this->cap_ = buf + N;
+}
+
+// rhs 在堆上且上游分配器相等时接管空间，否则逐个搬移到自己的空间
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::
+take(small_vector& rhs)
+{
+  if (!rhs.is_small() && (upstream_traits::is_always_equal::value ||
+                          this->alloc_.upstream() == rhs.alloc_.upstream()))
+  {
+    this->adopt(rhs);
+    rhs.reset_small();
+  }
+  else
+  { // rhs 在缓冲区中时不超过 N 个元素，自己的容量不小于 N，不需要扩容
+    this->clear();
+    this->reserve(rhs.size());
+    this->end_ = mystl::uninitialized_relocate(rhs.begin_, rhs.end_, this->begin_);
+    rhs.end_ = rhs.begin_;
+  }
+}
+
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::reset_small() noexcept
+{
+  this->begin_ = this->alloc_.allocate(N);  // 缓冲区此时空闲，一定取得缓冲区
+  this->end_ = this->begin_;
+  this->cap_ = this->begin_ + N;
+}
+
+// 都在堆上时交换指针，否则通过一个临时对象逐个搬移
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::
+swap(small_vector& rhs)
+{
+  if (this == &rhs)
+    return;
+  if (!is_small() && !rhs.is_small())
+  {
+    mystl::swap(this->begin_, rhs.begin_);
+    mystl::swap(this->end_, rhs.end_);
+    mystl::swap(this->cap_, rhs.cap_);
+  }
+  else
+  {
+    small_vector tmp(mystl::move(rhs));
+    rhs = mystl::move(*this);
+    *this = mystl::move(tmp);
+  }
+}
+
+/*****************************************************************************************/
+// 重载比较操作符
+
+template <class T, size_t N, class Alloc>
+bool operator==(const small_vector<T, N, Alloc>& lhs, const small_vector<T, N, Alloc>& rhs)
+{
+  return lhs.size() == rhs.size() &&
+    mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class T, size_t N, class Alloc>
+bool operator<(const small_vector<T, N, Alloc>& lhs, const small_vector<T, N, Alloc>& rhs)
+{
+  return mystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class T, size_t N, class Alloc>
+bool operator!=(const small_vector<T, N, Alloc>& lhs, const small_vector<T, N, Alloc>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+template <class T, size_t N, class Alloc>
+bool operator>(const small_vector<T, N, Alloc>& lhs, const small_vector<T, N, Alloc>& rhs)
+{
+  return rhs < lhs;
+}
+
+template <class T, size_t N, class Alloc>
+bool operator<=(const small_vector<T, N, Alloc>& lhs, const small_vector<T, N, Alloc>& rhs)
+{
+  return !(rhs < lhs);
+}
+
+template <class T, size_t N, class Alloc>
+bool operator>=(const small_vector<T, N, Alloc>& lhs, const small_vector<T, N, Alloc>& rhs)
+{
+  return !(lhs < rhs);
+}
+
+// 重载 mystl 的 swap
+template <class T, size_t N, class Alloc>
+void swap(small_vector<T, N, Alloc>& lhs, small_vector<T, N, Alloc>& rhs)
+{
+  lhs.swap(rhs);
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_SMALL_VECTOR_H_
+
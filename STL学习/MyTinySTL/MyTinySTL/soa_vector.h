@@ -0,0 +1,481 @@
+#ifndef MYTINYSTL_SOA_VECTOR_H_
+#define MYTINYSTL_SOA_VECTOR_H_
+
+// 这个头文件包含一个模板类 soa_vector
+// soa_vector : 按列存储的向量(structure of arrays)，每个字段各自存放在一段连续空间中
+
+// notes:
+//
+// soa_vector<Ts...> 的每一列是一个 mystl::vector<Ti>，所有列的长度始终相同。
+// 按行访问时得到代理对象：reference 为 std::tuple<Ts&...>，value_type 为 std::tuple<Ts...>，
+// 行迭代器是随机访问迭代器，可以直接交给 mystl::sort、find_if、transform 等算法。
+// 只用到一两个字段的热循环应当通过 data<I>() / column<I>() 直接遍历该列，
+// 这样只有用到的字段进入缓存，并且编译器可以对连续的数组做向量化。
+//
+// 插入一行时逐列追加，某一列抛出异常时把已经追加的列截回原来的长度，保证各列等长
+
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
+
+#include "vector.h"
+#include "exceptdef.h"
+
+namespace mystl
+{
+
+// 编译期的下标序列，用于对每一列展开同一个操作
+template <size_t... I>
+struct soa_index_sequence {};
+
+template <size_t N, size_t... I>
+struct soa_make_index_sequence : soa_make_index_sequence<N - 1, N - 1, I...> {};
+
+template <size_t... I>
+struct soa_make_index_sequence<0, I...>
+{
+  typedef soa_index_sequence<I...> type;
+};
+
+// 对参数包中的每一项依次求值 expr
+#define MYSTL_SOA_EXPAND(expr) do {                   \
+  int expand_[] = { 0, ((void)(expr), 0)... };         \
+  (void)expand_;                                       \
+} while(0)
+
+template <class... Ts>
+class soa_vector;
+
+// 按第 I 个字段比较两行，行可以是 value_type 或 reference，用于 sort 等算法
+template <size_t I>
+struct soa_field_less
+{
+  template <class Row1, class Row2>
+  bool operator()(const Row1& lhs, const Row2& rhs) const
+  {
+    return std::get<I>(lhs) < std::get<I>(rhs);
+  }
+};
+
+/*****************************************************************************************/
+// soa_iterator
+// 行迭代器，保存容器指针与行号，解引用时得到由各列元素的引用组成的 tuple
+/*****************************************************************************************/
+template <bool Const, class... Ts>
+struct soa_iterator : public mystl::iterator<mystl::random_access_iterator_tag,
+  std::tuple<Ts...>, ptrdiff_t, void,
+  typename std::conditional<Const, std::tuple<const Ts&...>, std::tuple<Ts&...>>::type>
+{
+  typedef typename std::conditional<Const, std::tuple<const Ts&...>,
+    std::tuple<Ts&...>>::type                           reference;
+  typedef ptrdiff_t                                     difference_type;
+  typedef typename std::conditional<Const, const soa_vector<Ts...>,
+    soa_vector<Ts...>>::type                            owner_type;
+  typedef soa_iterator<Const, Ts...>                    self;
+
+  owner_type*     owner;  // 所属的容器
+  difference_type pos;    // 行号
+
+  soa_iterator() noexcept : owner(nullptr), pos(0) {}
+  soa_iterator(owner_type* o, difference_type n) noexcept : owner(o), pos(n) {}
+  // Const 为 false 时即为复制构造函数，为 true 时允许由非 const 迭代器转换
+  soa_iterator(const soa_iterator<false, Ts...>& rhs) noexcept
+    :owner(rhs.owner), pos(rhs.pos) {}
+  soa_iterator& operator=(const soa_iterator& rhs) = default;
+
+  reference operator*() const
+  {
+    return deref(typename soa_make_index_sequence<sizeof...(Ts)>::type());
+  }
+  reference operator[](difference_type n) const { return *(*this + n); }
+
+  self& operator++() { ++pos; return *this; }
+  self operator++(int) { self tmp = *this; ++pos; return tmp; }
+  self& operator--() { --pos; return *this; }
+  self operator--(int) { self tmp = *this; --pos; return tmp; }
+
+  self& operator+=(difference_type n) { pos += n; return *this; }
+  self& operator-=(difference_type n) { pos -= n; return *this; }
+  self operator+(difference_type n) const { return self(owner, pos + n); }
+  self operator-(difference_type n) const { return self(owner, pos - n); }
+  difference_type operator-(const self& rhs) const { return pos - rhs.pos; }
+
+  bool operator==(const self& rhs) const { return pos == rhs.pos; }
+  bool operator!=(const self& rhs) const { return pos != rhs.pos; }
+  bool operator<(const self& rhs) const  { return pos < rhs.pos; }
+  bool operator>(const self& rhs) const  { return rhs < *this; }
+  bool operator<=(const self& rhs) const { return !(rhs < *this); }
+  bool operator>=(const self& rhs) const { return !(*this < rhs); }
+
+private:
+  template <size_t... I>
+  reference deref(soa_index_sequence<I...>) const
+  {
+    return reference(owner->template data<I>()[pos]...);
+  }
+};
+
+template <bool Const, class... Ts>
+soa_iterator<Const, Ts...> operator+(ptrdiff_t n, const soa_iterator<Const, Ts...>& it)
+{
+  return it + n;
+}
+
+/*****************************************************************************************/
+// soa_vector
+/*****************************************************************************************/
+template <class... Ts>
+class soa_vector
+{
+  static_assert(sizeof...(Ts) > 0, "soa_vector needs at least one field");
+
+public:
+  // soa_vector 的嵌套型别定义
+  typedef std::tuple<Ts...>                        value_type;
+  typedef std::tuple<Ts&...>                       reference;
+  typedef std::tuple<const Ts&...>                 const_reference;
+  typedef size_t                                   size_type;
+  typedef ptrdiff_t                                difference_type;
+
+  typedef soa_iterator<false, Ts...>               iterator;
+  typedef soa_iterator<true, Ts...>                const_iterator;
+  typedef mystl::reverse_iterator<iterator>        reverse_iterator;
+  typedef mystl::reverse_iterator<const_iterator>  const_reverse_iterator;
+
+  // 第 I 个字段的类型
+  template <size_t I>
+  using field_type = typename std::tuple_element<I, value_type>::type;
+
+private:
+  typedef typename soa_make_index_sequence<sizeof...(Ts)>::type indices;
+
+  std::tuple<mystl::vector<Ts>...> cols_;  // 每个字段一列
+
+public:
+  // 构造、复制、移动、析构函数
+  soa_vector() = default;
+
+  explicit soa_vector(size_type n)
+  { resize(n); }
+
+  soa_vector(size_type n, const value_type& value)
+  { resize(n, value); }
+
+  soa_vector(std::initializer_list<value_type> ilist)
+  {
+    reserve(ilist.size());
+    for (auto& row : ilist)
+      push_back(row);
+  }
+
+  soa_vector(const soa_vector& rhs) = default;
+
+  soa_vector(soa_vector&& rhs) noexcept
+    :cols_(mystl::move(rhs.cols_))
+  {
+  }
+
+  soa_vector& operator=(const soa_vector& rhs) = default;
+
+  soa_vector& operator=(soa_vector&& rhs) noexcept
+  {
+    cols_ = mystl::move(rhs.cols_);
+    return *this;
+  }
+
+  soa_vector& operator=(std::initializer_list<value_type> ilist)
+  {
+    soa_vector tmp(ilist);
+    swap(tmp);
+    return *this;
+  }
+
+  ~soa_vector() = default;
+
+public:
+  // 列相关操作
+  template <size_t I>
+  const mystl::vector<field_type<I>>& column() const noexcept
+  { return std::get<I>(cols_); }
+
+  template <size_t I>
+  field_type<I>*       data() noexcept       { return std::get<I>(cols_).data(); }
+  template <size_t I>
+  const field_type<I>* data() const noexcept { return std::get<I>(cols_).data(); }
+
+  // 迭代器相关操作
+  iterator               begin()         noexcept { return iterator(this, 0); }
+  const_iterator         begin()   const noexcept { return const_iterator(this, 0); }
+  iterator               end()           noexcept
+  { return iterator(this, static_cast<difference_type>(size())); }
+  const_iterator         end()     const noexcept
+  { return const_iterator(this, static_cast<difference_type>(size())); }
+
+  reverse_iterator       rbegin()        noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin()  const noexcept { return const_reverse_iterator(end()); }
+  reverse_iterator       rend()          noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend()    const noexcept { return const_reverse_iterator(begin()); }
+
+  const_iterator         cbegin()  const noexcept { return begin(); }
+  const_iterator         cend()    const noexcept { return end(); }
+
+  // 容量相关操作
+  bool      empty()    const noexcept { return std::get<0>(cols_).empty(); }
+  size_type size()     const noexcept { return std::get<0>(cols_).size(); }
+  size_type capacity() const noexcept { return std::get<0>(cols_).capacity(); }
+  size_type max_size() const noexcept { return max_size_aux(indices()); }
+
+  void      reserve(size_type n)
+  { reserve_aux(n, indices()); }
+  void      shrink_to_fit()
+  { shrink_to_fit_aux(indices()); }
+
+  // 访问元素相关操作
+  reference operator[](size_type n)
+  {
+    MYSTL_DEBUG(n < size());
+    return row(n, indices());
+  }
+  const_reference operator[](size_type n) const
+  {
+    MYSTL_DEBUG(n < size());
+    return row(n, indices());
+  }
+  reference at(size_type n)
+  {
+    THROW_OUT_OF_RANGE_IF(!(n < size()), "soa_vector<Ts...>::at() subscript out of range");
+    return (*this)[n];
+  }
+  const_reference at(size_type n) const
+  {
+    THROW_OUT_OF_RANGE_IF(!(n < size()), "soa_vector<Ts...>::at() subscript out of range");
+    return (*this)[n];
+  }
+
+  reference front()
+  {
+    MYSTL_DEBUG(!empty());
+    return row(0, indices());
+  }
+  const_reference front() const
+  {
+    MYSTL_DEBUG(!empty());
+    return row(0, indices());
+  }
+  reference back()
+  {
+    MYSTL_DEBUG(!empty());
+    return row(size() - 1, indices());
+  }
+  const_reference back() const
+  {
+    MYSTL_DEBUG(!empty());
+    return row(size() - 1, indices());
+  }
+
+  // 修改容器相关操作
+
+  // emplace_back 按字段顺序给出每一列的构造参数
+  template <class... Args>
+  void emplace_back(Args&& ...args)
+  {
+    static_assert(sizeof...(Args) == sizeof...(Ts),
+                  "soa_vector::emplace_back needs one argument per field");
+    append_row(indices(), mystl::forward<Args>(args)...);
+  }
+
+  void push_back(const value_type& value)
+  { push_back_aux(value, indices()); }
+  void push_back(value_type&& value)
+  { push_back_aux(mystl::move(value), indices()); }
+
+  void pop_back()
+  {
+    MYSTL_DEBUG(!empty());
+    pop_back_aux(indices());
+  }
+
+  iterator erase(const_iterator pos)
+  { return erase(pos, pos + 1); }
+  iterator erase(const_iterator first, const_iterator last);
+
+  void clear() noexcept
+  { truncate(0); }
+
+  void resize(size_type new_size);
+  void resize(size_type new_size, const value_type& value);
+
+  void swap(soa_vector& rhs) noexcept
+  { swap_aux(rhs, indices()); }
+
+private:
+  // helper functions
+
+  template <size_t... I>
+  reference row(size_type n, soa_index_sequence<I...>)
+  { return reference(std::get<I>(cols_)[n]...); }
+  template <size_t... I>
+  const_reference row(size_type n, soa_index_sequence<I...>) const
+  { return const_reference(std::get<I>(cols_)[n]...); }
+
+  template <size_t... I>
+  size_type max_size_aux(soa_index_sequence<I...>) const noexcept
+  {
+    size_type n = static_cast<size_type>(-1);
+    MYSTL_SOA_EXPAND(n = mystl::min(n, std::get<I>(cols_).max_size()));
+    return n;
+  }
+
+  template <size_t... I>
+  void reserve_aux(size_type n, soa_index_sequence<I...>)
+  { MYSTL_SOA_EXPAND(std::get<I>(cols_).reserve(n)); }
+
+  template <size_t... I>
+  void shrink_to_fit_aux(soa_index_sequence<I...>)
+  { MYSTL_SOA_EXPAND(std::get<I>(cols_).shrink_to_fit()); }
+
+  template <size_t... I, class... Args>
+  void append_row(soa_index_sequence<I...>, Args&& ...args);
+
+  template <class Row, size_t... I>
+  void push_back_aux(Row&& value, soa_index_sequence<I...>)
+  { append_row(indices(), std::get<I>(mystl::forward<Row>(value))...); }
+
+  template <size_t... I>
+  void pop_back_aux(soa_index_sequence<I...>)
+  { MYSTL_SOA_EXPAND(std::get<I>(cols_).pop_back()); }
+
+  template <size_t... I>
+  void erase_aux(size_type first, size_type last, soa_index_sequence<I...>)
+  {
+    MYSTL_SOA_EXPAND(std::get<I>(cols_).erase(std::get<I>(cols_).begin() + first,
+                                              std::get<I>(cols_).begin() + last));
+  }
+
+  // 把每一列截到 n 行，各列长度可以不同（用于回滚），只析构尾部元素，不会抛出异常
+  template <class Col>
+  static void truncate_column(Col& col, size_type n) noexcept
+  {
+    while (col.size() > n)
+      col.pop_back();
+  }
+
+  template <size_t... I>
+  void truncate_aux(size_type n, soa_index_sequence<I...>) noexcept
+  { MYSTL_SOA_EXPAND(truncate_column(std::get<I>(cols_), n)); }
+
+  void truncate(size_type n) noexcept
+  { truncate_aux(n, indices()); }
+
+  template <size_t... I>
+  void resize_aux(size_type n, soa_index_sequence<I...>)
+  { MYSTL_SOA_EXPAND(std::get<I>(cols_).resize(n)); }
+
+  template <size_t... I>
+  void resize_aux(size_type n, const value_type& value, soa_index_sequence<I...>)
+  { MYSTL_SOA_EXPAND(std::get<I>(cols_).resize(n, std::get<I>(value))); }
+
+  template <size_t... I>
+  void swap_aux(soa_vector& rhs, soa_index_sequence<I...>) noexcept
+  { MYSTL_SOA_EXPAND(std::get<I>(cols_).swap(std::get<I>(rhs.cols_))); }
+};
+
+/*****************************************************************************************/
+
+// 删除 [first, last) 上的行
+template <class... Ts>
+typename soa_vector<Ts...>::iterator
+soa_vector<Ts...>::erase(const_iterator first, const_iterator last)
+{
+  MYSTL_DEBUG(first >= cbegin() && last <= cend() && !(last < first));
+  erase_aux(static_cast<size_type>(first.pos), static_cast<size_type>(last.pos), indices());
+  return iterator(this, first.pos);
+}
+
+// 重置容器大小，新增的行值初始化
+template <class... Ts>
+void soa_vector<Ts...>::resize(size_type new_size)
+{
+  const size_type old_size = size();
+  if (new_size < old_size)
+  {
+    truncate(new_size);
+    return;
+  }
+  try
+  {
+    resize_aux(new_size, indices());
+  }
+  catch (...)
+  {
+    truncate(old_size);
+    throw;
+  }
+}
+
+// 重置容器大小，新增的行为 value 的副本
+template <class... Ts>
+void soa_vector<Ts...>::resize(size_type new_size, const value_type& value)
+{
+  const size_type old_size = size();
+  if (new_size < old_size)
+  {
+    truncate(new_size);
+    return;
+  }
+  try
+  {
+    resize_aux(new_size, value, indices());
+  }
+  catch (...)
+  {
+    truncate(old_size);
+    throw;
+  }
+}
+
+// 在尾部追加一行，每一列用对应的参数构造
+template <class... Ts>
+template <size_t... I, class... Args>
+void soa_vector<Ts...>::append_row(soa_index_sequence<I...>, Args&& ...args)
+{
+  const size_type old_size = size();
+  try
+  {
+    MYSTL_SOA_EXPAND(std::get<I>(cols_).emplace_back(mystl::forward<Args>(args)));
+  }
+  catch (...)
+  {
+    truncate(old_size);
+    throw;
+  }
+}
+
+/*****************************************************************************************/
+// 重载比较操作符
+
+template <class... Ts>
+bool operator==(const soa_vector<Ts...>& lhs, const soa_vector<Ts...>& rhs)
+{
+  return lhs.size() == rhs.size() &&
+    mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class... Ts>
+bool operator!=(const soa_vector<Ts...>& lhs, const soa_vector<Ts...>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+// 重载 mystl 的 swap
+template <class... Ts>
+void swap(soa_vector<Ts...>& lhs, soa_vector<Ts...>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+#undef MYSTL_SOA_EXPAND
+
+} // namespace mystl
+#endif // !MYTINYSTL_SOA_VECTOR_H_
+
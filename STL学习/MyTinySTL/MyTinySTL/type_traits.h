@@ -39,6 +39,24 @@ struct is_pair : mystl::m_false_type {};
 template <class T1, class T2>
 struct is_pair<mystl::pair<T1, T2>> : mystl::m_true_type {};
 
+// is_trivially_relocatable
+// 把对象按字节复制到新地址、并且不再调用原对象的析构函数，等价于移动构造后析构原对象，
+// 这样的类型称为可以平凡搬移的类型，容器扩容时可以用 memcpy 整段搬移元素。
+// 可以逐字节复制的类型都满足；其它类型（例如只持有堆上资源的指针、不保存指向自身的指针的类型）
+// 可以特化这个模板来声明
+
+template <class T>
+struct is_trivially_relocatable
+  : std::integral_constant<bool, std::is_trivially_copyable<T>::value> {};
+
+template <class T>
+struct is_trivially_relocatable<const T> : mystl::is_trivially_relocatable<T> {};
+
+template <class T1, class T2>
+struct is_trivially_relocatable<mystl::pair<T1, T2>>
+  : std::integral_constant<bool, mystl::is_trivially_relocatable<T1>::value &&
+                                 mystl::is_trivially_relocatable<T2>::value> {};
+
 } // namespace mystl
 
 #endif // !MYTINYSTL_TYPE_TRAITS_H_
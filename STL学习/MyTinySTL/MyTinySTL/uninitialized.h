@@ -37,8 +37,9 @@ unchecked_uninit_copy(InputIter first, InputIter last, ForwardIter result, std::
   }
   catch (...)
   {
-    for (; result != cur; --cur)
-      mystl::destroy(&*cur);
+    for (; result != cur; ++result)
+      mystl::destroy(&*result);
+    throw;
   }
   return cur;
 }
@@ -77,8 +78,9 @@ unchecked_uninit_copy_n(InputIter first, Size n, ForwardIter result, std::false_
   }
   catch (...)
   {
-    for (; result != cur; --cur)
-      mystl::destroy(&*cur);
+    for (; result != cur; ++result)
+      mystl::destroy(&*result);
+    throw;
   }
   return cur;
 }
@@ -117,8 +119,9 @@ unchecked_uninit_fill(ForwardIter first, ForwardIter last, const T& value, std::
   }
   catch (...)
   {
-    for (;first != cur; ++first)
+    for (; first != cur; ++first)
       mystl::destroy(&*first);
+    throw;
   }
 }
 
@@ -158,6 +161,7 @@ unchecked_uninit_fill_n(ForwardIter first, Size n, const T& value, std::false_ty
   {
     for (; first != cur; ++first)
       mystl::destroy(&*first);
+    throw;
   }
   return cur;
 }
@@ -197,6 +201,7 @@ unchecked_uninit_move(InputIter first, InputIter last, ForwardIter result, std::
   catch (...)
   {
     mystl::destroy(result, cur);
+    throw;
   }
   return cur;
 }
@@ -251,6 +256,131 @@ ForwardIter uninitialized_move_n(InputIter first, Size n, ForwardIter result)
                                         value_type>{});
 }
 
+/*****************************************************************************************/
+// uninitialized_relocate
+// 把[first, last)上的对象搬移到以 result 为起始处的未初始化空间，返回搬移结束的位置，
+// 搬移完成后原来的对象已经析构，[first, last) 成为未初始化的空间
+// 元素可以平凡搬移且迭代器是指针时，整段 memmove，此时两段空间可以重叠（result 不在 (first, last) 内）；
+// 否则逐个移动构造，全部成功后再析构原来的对象，失败时析构已构造的对象，原来的对象保持不变
+/*****************************************************************************************/
+template <class T>
+T* unchecked_uninit_relocate(T* first, T* last, T* result, std::true_type)
+{
+  const auto n = static_cast<size_t>(last - first);
+  if (n != 0)
+    std::memmove(static_cast<void*>(result), static_cast<const void*>(first), n * sizeof(T));
+  return result + n;
+}
+
+template <class InputIter, class ForwardIter>
+ForwardIter 
+unchecked_uninit_relocate(InputIter first, InputIter last, ForwardIter result, std::true_type)
+{
+  typedef typename iterator_traits<ForwardIter>::value_type value_type;
+  for (; first != last; ++first, ++result)
+  {
+    std::memmove(static_cast<void*>(&*result),
+                 static_cast<const void*>(&*first), sizeof(value_type));
+  }
+  return result;
+}
+
+template <class InputIter, class ForwardIter>
+ForwardIter 
+unchecked_uninit_relocate(InputIter first, InputIter last, ForwardIter result, std::false_type)
+{
+  ForwardIter cur = result;
+  try
+  {
+    for (auto it = first; it != last; ++it, ++cur)
+    {
+      mystl::construct(&*cur, mystl::move(*it));
+    }
+  }
+  catch (...)
+  {
+    mystl::destroy(result, cur);
+    throw;
+  }
+  mystl::destroy(first, last);
+  return cur;
+}
+
+template <class InputIter, class ForwardIter>
+ForwardIter uninitialized_relocate(InputIter first, InputIter last, ForwardIter result)
+{
+  return mystl::unchecked_uninit_relocate(first, last, result,
+                                          mystl::is_trivially_relocatable<
+                                          typename iterator_traits<InputIter>::
+                                          value_type>{});
+}
+
+/*****************************************************************************************/
+// uninitialized_relocate_n
+// 把[first, first + n)上的对象搬移到以 result 为起始处的未初始化空间，返回搬移结束的位置
+/*****************************************************************************************/
+template <class InputIter, class Size, class ForwardIter>
+ForwardIter uninitialized_relocate_n(InputIter first, Size n, ForwardIter result)
+{
+  auto last = first;
+  mystl::advance(last, n);
+  return mystl::uninitialized_relocate(first, last, result);
+}
+
+/*****************************************************************************************/
+// uninitialized_relocate_backward
+// 把[first, last)上的对象搬移到以 result 为结束处的未初始化空间，返回搬移后的起始位置
+// 用于向后挪动一段元素，两段空间可以重叠（result 不在 (first, last) 内）
+/*****************************************************************************************/
+template <class T>
+T* unchecked_uninit_relocate_backward(T* first, T* last, T* result, std::true_type)
+{
+  const auto n = static_cast<size_t>(last - first);
+  if (n != 0)
+    std::memmove(static_cast<void*>(result - n), static_cast<const void*>(first), n * sizeof(T));
+  return result - n;
+}
+
+template <class BidirectionalIter1, class BidirectionalIter2>
+BidirectionalIter2
+unchecked_uninit_relocate_backward(BidirectionalIter1 first, BidirectionalIter1 last,
+                                   BidirectionalIter2 result, std::true_type)
+{
+  typedef typename iterator_traits<BidirectionalIter2>::value_type value_type;
+  while (first != last)
+  {
+    --last;
+    --result;
+    std::memmove(static_cast<void*>(&*result),
+                 static_cast<const void*>(&*last), sizeof(value_type));
+  }
+  return result;
+}
+
+template <class BidirectionalIter1, class BidirectionalIter2>
+BidirectionalIter2
+unchecked_uninit_relocate_backward(BidirectionalIter1 first, BidirectionalIter1 last,
+                                   BidirectionalIter2 result, std::false_type)
+{
+  // 逐个移动时不允许重叠，先全部构造再析构原来的对象
+  auto n = mystl::distance(first, last);
+  auto dest = result;
+  mystl::advance(dest, -n);
+  mystl::unchecked_uninit_relocate(first, last, dest, std::false_type());
+  return dest;
+}
+
+template <class BidirectionalIter1, class BidirectionalIter2>
+BidirectionalIter2
+uninitialized_relocate_backward(BidirectionalIter1 first, BidirectionalIter1 last,
+                                BidirectionalIter2 result)
+{
+  return mystl::unchecked_uninit_relocate_backward(first, last, result,
+                                                   mystl::is_trivially_relocatable<
+                                                   typename iterator_traits<BidirectionalIter1>::
+                                                   value_type>{});
+}
+
 } // namespace mystl
 #endif // !MYTINYSTL_UNINITIALIZED_H_
 
@@ -6,6 +6,9 @@
 
 // notes:
 //
+// 开启 incremental_rehash 后，增长时的 rehash 分摊到之后的多次插入中完成，避免一次插入出现长时间的停顿。
+// 迁移期间插入仍会改变元素的遍历顺序；bucket 接口只反映新的 bucket 数组，需要时先调用 finish_rehash。
+//
 // 异常保证：
 // mystl::unordered_map<Key, T> / mystl::unordered_multimap<Key, T> 满足基本异常保证，对以下等函数做强异常安全保证：
 //   * emplace
@@ -19,13 +22,16 @@ namespace mystl
 
 // 模板类 unordered_map，键值不允许重复
 // 参数一代表键值类型，参数二代表实值类型，参数三代表哈希函数，缺省使用 mystl::hash
-// 参数四代表键值比较方式，缺省使用 mystl::equal_to
-template <class Key, class T, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+// 参数四代表键值比较方式，缺省使用 mystl::equal_to，参数五代表分配器类型
+// 参数六代表 bucket 下标策略，缺省使用 ht_prime_policy，见 hashtable.h
+template <class Key, class T, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>,
+          class Alloc = mystl::allocator<mystl::pair<const Key, T>>,
+          class Policy = mystl::ht_prime_policy>
 class unordered_map
 {
 private:
   // 使用 hashtable 作为底层机制
-  typedef hashtable<mystl::pair<const Key, T>, Hash, KeyEqual> base_type;
+  typedef hashtable<mystl::pair<const Key, T>, Hash, KeyEqual, Alloc, Policy> base_type;
   base_type ht_;
 
 public:
@@ -60,10 +66,16 @@ public:
   {
   }
 
+  explicit unordered_map(const allocator_type& alloc)
+    :ht_(100, Hash(), KeyEqual(), alloc)
+  {
+  }
+
   explicit unordered_map(size_type bucket_count,
                          const Hash& hash = Hash(),
-                         const KeyEqual& equal = KeyEqual())
-    :ht_(bucket_count, hash, equal)
+                         const KeyEqual& equal = KeyEqual(),
+                         const allocator_type& alloc = allocator_type())
+    :ht_(bucket_count, hash, equal, alloc)
   {
   }
 
@@ -71,8 +83,9 @@ public:
   unordered_map(InputIterator first, InputIterator last,
                 const size_type bucket_count = 100,
                 const Hash& hash = Hash(),
-                const KeyEqual& equal = KeyEqual())
-    : ht_(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))), hash, equal)
+                const KeyEqual& equal = KeyEqual(),
+                const allocator_type& alloc = allocator_type())
+    : ht_(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))), hash, equal, alloc)
   {
     for (; first != last; ++first)
       ht_.insert_unique_noresize(*first);
@@ -81,8 +94,9 @@ public:
   unordered_map(std::initializer_list<value_type> ilist,
                 const size_type bucket_count = 100,
                 const Hash& hash = Hash(),
-                const KeyEqual& equal = KeyEqual())
-    :ht_(mystl::max(bucket_count, static_cast<size_type>(ilist.size())), hash, equal)
+                const KeyEqual& equal = KeyEqual(),
+                const allocator_type& alloc = allocator_type())
+    :ht_(mystl::max(bucket_count, static_cast<size_type>(ilist.size())), hash, equal, alloc)
   {
     for (auto first = ilist.begin(), last = ilist.end(); first != last; ++first)
       ht_.insert_unique_noresize(*first);
@@ -264,39 +278,45 @@ public:
   void      rehash(size_type count)                 { ht_.rehash(count); }
   void      reserve(size_type count)                { ht_.reserve(count); }
 
+  // 增量 rehash，见 hashtable.h
+  void      incremental_rehash(bool on)             { ht_.incremental_rehash(on); }
+  bool      incremental_rehash()     const noexcept { return ht_.incremental_rehash(); }
+  bool      rehashing()              const noexcept { return ht_.rehashing(); }
+  void      finish_rehash()                         { ht_.finish_rehash(); }
+
   hasher    hash_fcn()               const          { return ht_.hash_fcn(); }
   key_equal key_eq()                 const          { return ht_.key_eq(); }
 
 public:
   friend bool operator==(const unordered_map& lhs, const unordered_map& rhs)
   {
-    return lhs.ht_.equal_range_unique(rhs.ht_);
+    return lhs.ht_.equal_to_unique(rhs.ht_);
   }
   friend bool operator!=(const unordered_map& lhs, const unordered_map& rhs)
   {
-    return !lhs.ht_.equal_range_unique(rhs.ht_);
+    return !lhs.ht_.equal_to_unique(rhs.ht_);
   }
 };
 
 // 重载比较操作符
-template <class Key, class T, class Hash, class KeyEqual>
-bool operator==(const unordered_map<Key, T, Hash, KeyEqual>& lhs,
-                const unordered_map<Key, T, Hash, KeyEqual>& rhs)
+template <class Key, class T, class Hash, class KeyEqual, class Alloc, class Policy>
+bool operator==(const unordered_map<Key, T, Hash, KeyEqual, Alloc, Policy>& lhs,
+                const unordered_map<Key, T, Hash, KeyEqual, Alloc, Policy>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class T, class Hash, class KeyEqual>
-bool operator!=(const unordered_map<Key, T, Hash, KeyEqual>& lhs,
-                const unordered_map<Key, T, Hash, KeyEqual>& rhs)
+template <class Key, class T, class Hash, class KeyEqual, class Alloc, class Policy>
+bool operator!=(const unordered_map<Key, T, Hash, KeyEqual, Alloc, Policy>& lhs,
+                const unordered_map<Key, T, Hash, KeyEqual, Alloc, Policy>& rhs)
 {
   return lhs != rhs;
 }
 
 // 重载 mystl 的 swap
-template <class Key, class T, class Hash, class KeyEqual>
-void swap(unordered_map<Key, T, Hash, KeyEqual>& lhs,
-          unordered_map<Key, T, Hash, KeyEqual>& rhs)
+template <class Key, class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void swap(unordered_map<Key, T, Hash, KeyEqual, Alloc, Policy>& lhs,
+          unordered_map<Key, T, Hash, KeyEqual, Alloc, Policy>& rhs)
 {
   lhs.swap(rhs);
 }
@@ -305,13 +325,16 @@ void swap(unordered_map<Key, T, Hash, KeyEqual>& lhs,
 
 // 模板类 unordered_multimap，键值允许重复
 // 参数一代表键值类型，参数二代表实值类型，参数三代表哈希函数，缺省使用 mystl::hash
-// 参数四代表键值比较方式，缺省使用 mystl::equal_to
-template <class Key, class T, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+// 参数四代表键值比较方式，缺省使用 mystl::equal_to，参数五代表分配器类型
+// 参数六代表 bucket 下标策略，缺省使用 ht_prime_policy，见 hashtable.h
+template <class Key, class T, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>,
+          class Alloc = mystl::allocator<mystl::pair<const Key, T>>,
+          class Policy = mystl::ht_prime_policy>
 class unordered_multimap
 {
 private:
   // 使用 hashtable 作为底层机制
-  typedef hashtable<pair<const Key, T>, Hash, KeyEqual> base_type;
+  typedef hashtable<mystl::pair<const Key, T>, Hash, KeyEqual, Alloc, Policy> base_type;
   base_type ht_;
 
 public:
@@ -345,10 +368,16 @@ public:
   {
   }
 
+  explicit unordered_multimap(const allocator_type& alloc)
+    :ht_(100, Hash(), KeyEqual(), alloc)
+  {
+  }
+
   explicit unordered_multimap(size_type bucket_count,
                               const Hash& hash = Hash(),
-                              const KeyEqual& equal = KeyEqual())
-    :ht_(bucket_count, hash, equal) 
+                              const KeyEqual& equal = KeyEqual(),
+                              const allocator_type& alloc = allocator_type())
+    :ht_(bucket_count, hash, equal, alloc)
   {
   }
 
@@ -356,8 +385,9 @@ public:
   unordered_multimap(InputIterator first, InputIterator last,
                      const size_type bucket_count = 100,
                      const Hash& hash = Hash(),
-                     const KeyEqual& equal = KeyEqual())
-    :ht_(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))), hash, equal)
+                     const KeyEqual& equal = KeyEqual(),
+                     const allocator_type& alloc = allocator_type())
+    :ht_(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))), hash, equal, alloc)
   {
     for (; first != last; ++first)
       ht_.insert_multi_noresize(*first);
@@ -366,8 +396,9 @@ public:
   unordered_multimap(std::initializer_list<value_type> ilist,
                      const size_type bucket_count = 100,
                      const Hash& hash = Hash(),
-                     const KeyEqual& equal = KeyEqual())
-    :ht_(mystl::max(bucket_count, static_cast<size_type>(ilist.size())), hash, equal)
+                     const KeyEqual& equal = KeyEqual(),
+                     const allocator_type& alloc = allocator_type())
+    :ht_(mystl::max(bucket_count, static_cast<size_type>(ilist.size())), hash, equal, alloc)
   {
     for (auto first = ilist.begin(), last = ilist.end(); first != last; ++first)
       ht_.insert_multi_noresize(*first);
@@ -521,39 +552,45 @@ public:
   void      rehash(size_type count)                 { ht_.rehash(count); }
   void      reserve(size_type count)                { ht_.reserve(count); }
 
+  // 增量 rehash，见 hashtable.h
+  void      incremental_rehash(bool on)             { ht_.incremental_rehash(on); }
+  bool      incremental_rehash()     const noexcept { return ht_.incremental_rehash(); }
+  bool      rehashing()              const noexcept { return ht_.rehashing(); }
+  void      finish_rehash()                         { ht_.finish_rehash(); }
+
   hasher    hash_fcn()               const          { return ht_.hash_fcn(); }
   key_equal key_eq()                 const          { return ht_.key_eq(); }
 
 public:
   friend bool operator==(const unordered_multimap& lhs, const unordered_multimap& rhs)
   {
-    return lhs.ht_.equal_range_multi(rhs.ht_);
+    return lhs.ht_.equal_to_multi(rhs.ht_);
   }
   friend bool operator!=(const unordered_multimap& lhs, const unordered_multimap& rhs)
   {
-    return !lhs.ht_.equal_range_multi(rhs.ht_);
+    return !lhs.ht_.equal_to_multi(rhs.ht_);
   }
 };
 
 // 重载比较操作符
-template <class Key, class T, class Hash, class KeyEqual>
-bool operator==(const unordered_multimap<Key, T, Hash, KeyEqual>& lhs,
-                const unordered_multimap<Key, T, Hash, KeyEqual>& rhs)
+template <class Key, class T, class Hash, class KeyEqual, class Alloc, class Policy>
+bool operator==(const unordered_multimap<Key, T, Hash, KeyEqual, Alloc, Policy>& lhs,
+                const unordered_multimap<Key, T, Hash, KeyEqual, Alloc, Policy>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class T, class Hash, class KeyEqual>
-bool operator!=(const unordered_multimap<Key, T, Hash, KeyEqual>& lhs,
-                const unordered_multimap<Key, T, Hash, KeyEqual>& rhs)
+template <class Key, class T, class Hash, class KeyEqual, class Alloc, class Policy>
+bool operator!=(const unordered_multimap<Key, T, Hash, KeyEqual, Alloc, Policy>& lhs,
+                const unordered_multimap<Key, T, Hash, KeyEqual, Alloc, Policy>& rhs)
 {
   return lhs != rhs;
 }
 
 // 重载 mystl 的 swap
-template <class Key, class T, class Hash, class KeyEqual>
-void swap(unordered_multimap<Key, T, Hash, KeyEqual>& lhs,
-          unordered_multimap<Key, T, Hash, KeyEqual>& rhs)
+template <class Key, class T, class Hash, class KeyEqual, class Alloc, class Policy>
+void swap(unordered_multimap<Key, T, Hash, KeyEqual, Alloc, Policy>& lhs,
+          unordered_multimap<Key, T, Hash, KeyEqual, Alloc, Policy>& rhs)
 {
   lhs.swap(rhs);
 }
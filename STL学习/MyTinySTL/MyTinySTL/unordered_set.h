@@ -6,6 +6,9 @@
 
 // notes:
 //
+// 开启 incremental_rehash 后，增长时的 rehash 分摊到之后的多次插入中完成，避免一次插入出现长时间的停顿。
+// 迁移期间插入仍会改变元素的遍历顺序；bucket 接口只反映新的 bucket 数组，需要时先调用 finish_rehash。
+//
 // 异常保证：
 // mystl::unordered_set<Key> / mystl::unordered_multiset<Key> 满足基本异常保证，对以下等函数做强异常安全保证：
 //   * emplace
@@ -19,13 +22,16 @@ namespace mystl
 
 // 模板类 unordered_set，键值不允许重复
 // 参数一代表键值类型，参数二代表哈希函数，缺省使用 mystl::hash，
-// 参数三代表键值比较方式，缺省使用 mystl::equal_to
-template <class Key, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+// 参数三代表键值比较方式，缺省使用 mystl::equal_to，参数四代表分配器类型，
+// 参数五代表 bucket 下标策略，缺省使用 ht_prime_policy，见 hashtable.h
+template <class Key, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>,
+          class Alloc = mystl::allocator<Key>,
+          class Policy = mystl::ht_prime_policy>
 class unordered_set
 {
 private:
   // 使用 hashtable 作为底层机制
-  typedef hashtable<Key, Hash, KeyEqual> base_type;
+  typedef hashtable<Key, Hash, KeyEqual, Alloc, Policy> base_type;
   base_type ht_;
 
 public:
@@ -58,10 +64,16 @@ public:
   {
   }
 
+  explicit unordered_set(const allocator_type& alloc)
+    :ht_(100, Hash(), KeyEqual(), alloc)
+  {
+  }
+
   explicit unordered_set(size_type bucket_count,
                          const Hash& hash = Hash(),
-                         const KeyEqual& equal = KeyEqual())
-    :ht_(bucket_count, hash, equal)
+                         const KeyEqual& equal = KeyEqual(),
+                         const allocator_type& alloc = allocator_type())
+    :ht_(bucket_count, hash, equal, alloc)
   {
   }
 
@@ -69,8 +81,9 @@ public:
   unordered_set(InputIterator first, InputIterator last,
                 const size_type bucket_count = 100,
                 const Hash& hash = Hash(),
-                const KeyEqual& equal = KeyEqual())
-    : ht_(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))), hash, equal)
+                const KeyEqual& equal = KeyEqual(),
+                const allocator_type& alloc = allocator_type())
+    : ht_(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))), hash, equal, alloc)
   {
     for (; first != last; ++first)
       ht_.insert_unique_noresize(*first);
@@ -79,8 +92,9 @@ public:
   unordered_set(std::initializer_list<value_type> ilist,
                 const size_type bucket_count = 100,
                 const Hash& hash = Hash(),
-                const KeyEqual& equal = KeyEqual())
-    :ht_(mystl::max(bucket_count, static_cast<size_type>(ilist.size())), hash, equal)
+                const KeyEqual& equal = KeyEqual(),
+                const allocator_type& alloc = allocator_type())
+    :ht_(mystl::max(bucket_count, static_cast<size_type>(ilist.size())), hash, equal, alloc)
   {
     for (auto first = ilist.begin(), last = ilist.end(); first != last; ++first)
       ht_.insert_unique_noresize(*first);
@@ -234,6 +248,12 @@ public:
   void      rehash(size_type count)                 { ht_.rehash(count); }
   void      reserve(size_type count)                { ht_.reserve(count); }
 
+  // 增量 rehash，见 hashtable.h
+  void      incremental_rehash(bool on)             { ht_.incremental_rehash(on); }
+  bool      incremental_rehash()     const noexcept { return ht_.incremental_rehash(); }
+  bool      rehashing()              const noexcept { return ht_.rehashing(); }
+  void      finish_rehash()                         { ht_.finish_rehash(); }
+
   hasher    hash_fcn()               const          { return ht_.hash_fcn(); }
   key_equal key_eq()                 const          { return ht_.key_eq(); }
 
@@ -241,33 +261,33 @@ public:
 public:
   friend bool operator==(const unordered_set& lhs, const unordered_set& rhs)
   {
-    return lhs.ht_.equal_range_unique(rhs.ht_);
+    return lhs.ht_.equal_to_unique(rhs.ht_);
   }
   friend bool operator!=(const unordered_set& lhs, const unordered_set& rhs)
   {
-    return !lhs.ht_.equal_range_unique(rhs.ht_);
+    return !lhs.ht_.equal_to_unique(rhs.ht_);
   }
 };
 
 // 重载比较操作符
-template <class Key, class Hash, class KeyEqual, class Alloc>
-bool operator==(const unordered_set<Key, Hash, KeyEqual>& lhs,
-                const unordered_set<Key, Hash, KeyEqual>& rhs)
+template <class Key, class Hash, class KeyEqual, class Alloc, class Policy>
+bool operator==(const unordered_set<Key, Hash, KeyEqual, Alloc, Policy>& lhs,
+                const unordered_set<Key, Hash, KeyEqual, Alloc, Policy>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class Hash, class KeyEqual, class Alloc>
-bool operator!=(const unordered_set<Key, Hash, KeyEqual>& lhs,
-                const unordered_set<Key, Hash, KeyEqual>& rhs)
+template <class Key, class Hash, class KeyEqual, class Alloc, class Policy>
+bool operator!=(const unordered_set<Key, Hash, KeyEqual, Alloc, Policy>& lhs,
+                const unordered_set<Key, Hash, KeyEqual, Alloc, Policy>& rhs)
 {
   return lhs != rhs;
 }
 
 // 重载 mystl 的 swap
-template <class Key, class Hash, class KeyEqual, class Alloc>
-void swap(unordered_set<Key, Hash, KeyEqual>& lhs,
-          unordered_set<Key, Hash, KeyEqual>& rhs)
+template <class Key, class Hash, class KeyEqual, class Alloc, class Policy>
+void swap(unordered_set<Key, Hash, KeyEqual, Alloc, Policy>& lhs,
+          unordered_set<Key, Hash, KeyEqual, Alloc, Policy>& rhs)
 {
   lhs.swap(rhs);
 }
@@ -276,13 +296,16 @@ void swap(unordered_set<Key, Hash, KeyEqual>& lhs,
 
 // 模板类 unordered_multiset，键值允许重复
 // 参数一代表键值类型，参数二代表哈希函数，缺省使用 mystl::hash，
-// 参数三代表键值比较方式，缺省使用 mystl::equal_to
-template <class Key, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+// 参数三代表键值比较方式，缺省使用 mystl::equal_to，参数四代表分配器类型，
+// 参数五代表 bucket 下标策略，缺省使用 ht_prime_policy，见 hashtable.h
+template <class Key, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>,
+          class Alloc = mystl::allocator<Key>,
+          class Policy = mystl::ht_prime_policy>
 class unordered_multiset
 {
 private:
   // 使用 hashtable 作为底层机制
-  typedef hashtable<Key, Hash, KeyEqual> base_type;
+  typedef hashtable<Key, Hash, KeyEqual, Alloc, Policy> base_type;
   base_type ht_;
 
 public:
@@ -315,10 +338,16 @@ public:
   {
   }
 
+  explicit unordered_multiset(const allocator_type& alloc)
+    :ht_(100, Hash(), KeyEqual(), alloc)
+  {
+  }
+
   explicit unordered_multiset(size_type bucket_count,
                               const Hash& hash = Hash(),
-                              const KeyEqual& equal = KeyEqual())
-    :ht_(bucket_count, hash, equal)
+                              const KeyEqual& equal = KeyEqual(),
+                              const allocator_type& alloc = allocator_type())
+    :ht_(bucket_count, hash, equal, alloc)
   {
   }
 
@@ -326,8 +355,9 @@ public:
   unordered_multiset(InputIterator first, InputIterator last,
                      const size_type bucket_count = 100,
                      const Hash& hash = Hash(),
-                     const KeyEqual& equal = KeyEqual())
-    : ht_(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))), hash, equal)
+                     const KeyEqual& equal = KeyEqual(),
+                     const allocator_type& alloc = allocator_type())
+    : ht_(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))), hash, equal, alloc)
   {
     for (; first != last; ++first)
       ht_.insert_multi_noresize(*first);
@@ -336,8 +366,9 @@ public:
   unordered_multiset(std::initializer_list<value_type> ilist,
                      const size_type bucket_count = 100,
                      const Hash& hash = Hash(),
-                     const KeyEqual& equal = KeyEqual())
-    :ht_(mystl::max(bucket_count, static_cast<size_type>(ilist.size())), hash, equal)
+                     const KeyEqual& equal = KeyEqual(),
+                     const allocator_type& alloc = allocator_type())
+    :ht_(mystl::max(bucket_count, static_cast<size_type>(ilist.size())), hash, equal, alloc)
   {
     for (auto first = ilist.begin(), last = ilist.end(); first != last; ++first)
       ht_.insert_multi_noresize(*first);
@@ -492,39 +523,45 @@ public:
   void      rehash(size_type count)                 { ht_.rehash(count); }
   void      reserve(size_type count)                { ht_.reserve(count); }
 
+  // 增量 rehash，见 hashtable.h
+  void      incremental_rehash(bool on)             { ht_.incremental_rehash(on); }
+  bool      incremental_rehash()     const noexcept { return ht_.incremental_rehash(); }
+  bool      rehashing()              const noexcept { return ht_.rehashing(); }
+  void      finish_rehash()                         { ht_.finish_rehash(); }
+
   hasher    hash_fcn()               const          { return ht_.hash_fcn(); }
   key_equal key_eq()                 const          { return ht_.key_eq(); }
 
 public:
   friend bool operator==(const unordered_multiset& lhs, const unordered_multiset& rhs)
   {
-    return lhs.ht_.equal_range_multi(rhs.ht_);
+    return lhs.ht_.equal_to_multi(rhs.ht_);
   }
   friend bool operator!=(const unordered_multiset& lhs, const unordered_multiset& rhs)
   {
-    return !lhs.ht_.equal_range_multi(rhs.ht_);
+    return !lhs.ht_.equal_to_multi(rhs.ht_);
   }
 };
 
 // 重载比较操作符
-template <class Key, class Hash, class KeyEqual, class Alloc>
-bool operator==(const unordered_multiset<Key, Hash, KeyEqual>& lhs,
-                const unordered_multiset<Key, Hash, KeyEqual>& rhs)
+template <class Key, class Hash, class KeyEqual, class Alloc, class Policy>
+bool operator==(const unordered_multiset<Key, Hash, KeyEqual, Alloc, Policy>& lhs,
+                const unordered_multiset<Key, Hash, KeyEqual, Alloc, Policy>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class Hash, class KeyEqual, class Alloc>
-bool operator!=(const unordered_multiset<Key, Hash, KeyEqual>& lhs,
-                const unordered_multiset<Key, Hash, KeyEqual>& rhs)
+template <class Key, class Hash, class KeyEqual, class Alloc, class Policy>
+bool operator!=(const unordered_multiset<Key, Hash, KeyEqual, Alloc, Policy>& lhs,
+                const unordered_multiset<Key, Hash, KeyEqual, Alloc, Policy>& rhs)
 {
   return lhs != rhs;
 }
 
 // 重载 mystl 的 swap
-template <class Key, class Hash, class KeyEqual, class Alloc>
-void swap(unordered_multiset<Key, Hash, KeyEqual>& lhs,
-          unordered_multiset<Key, Hash, KeyEqual>& rhs)
+template <class Key, class Hash, class KeyEqual, class Alloc, class Policy>
+void swap(unordered_multiset<Key, Hash, KeyEqual, Alloc, Policy>& lhs,
+          unordered_multiset<Key, Hash, KeyEqual, Alloc, Policy>& rhs)
 {
   lhs.swap(rhs);
 }
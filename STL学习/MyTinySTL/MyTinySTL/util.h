@@ -18,6 +18,18 @@ typename std::remove_reference<T>::type&& move(T&& arg) noexcept
   return static_cast<typename std::remove_reference<T>::type&&>(arg);
 }
 
+// move_if_noexcept
+// 移动构造可能抛出异常而又可以复制时返回左值引用，让调用者复制，原对象保持不变
+
+template <class T>
+typename std::conditional<
+  !std::is_nothrow_move_constructible<T>::value && std::is_copy_constructible<T>::value,
+  const T&, T&&>::type
+move_if_noexcept(T& arg) noexcept
+{
+  return mystl::move(arg);
+}
+
 // forward
 
 template <class T>
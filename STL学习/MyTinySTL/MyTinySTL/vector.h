@@ -15,7 +15,21 @@
 //   * reserve
 //   * resize
 //   * insert
-
+//
+// 元素可以平凡搬移(mystl::is_trivially_relocatable)时，reserve 与插入引起的扩容改用
+// allocator_traits::reallocate，大块空间可以原地扩展或由 mremap 重新映射，不需要逐个移动元素
+//
+// 第一次分配的容量由 vector_init_capacity<Alloc> 决定，small_vector 借此把初始空间放在对象内部
+//
+// 第三个模板参数是扩容策略，决定空间不足时的新容量：
+//   * vector_growth_1_5x       : 1.5 倍（缺省）
+//   * vector_growth_2x         : 2 倍
+//   * vector_growth_page       : 1.5 倍，达到一页后按页的整数倍
+//   * vector_growth_size_class : 1.5 倍，再上调到分配器实际分配的区块大小（allocator_traits::good_size）
+// 批量写入时可以用 append_range 一次扩容后直接复制，平凡类型还可以用 resize_uninitialized
+// 取得未初始化的空间，由调用者直接写入
+
+#include <functional>
 #include <initializer_list>
 
 #include "iterator.h"
@@ -37,57 +51,159 @@ namespace mystl
 #undef min
 #endif // min
 
+// vector 第一次分配空间时的容量，默认为 16，分配器自带缓冲区时可以特化为缓冲区的大小
+template <class Alloc>
+struct vector_init_capacity : mystl::m_integral_constant<size_t, 16> {};
+
+/*****************************************************************************************/
+// 扩容策略
+// next_capacity(a, old_cap, need, max_cap) 返回不小于 need、不大于 max_cap 的新容量，
+// old_cap 为原来的容量，need 为至少需要的容量，a 为 vector 的分配器
+
+// 容量很小时（shrink_to_fit 之后，或者 small_vector 离开缓冲区时）至少扩到 16，避免连续几次小的扩容
+enum { EVectorMinGrowth = 16 };
+
+// 按页上调时页的大小
+enum { EVectorPageBytes = 4096 };
+
+// 1.5 倍
+struct vector_growth_1_5x
+{
+  template <class Alloc>
+  static size_t next_capacity(const Alloc&, size_t old_cap, size_t need, size_t max_cap) noexcept
+  {
+    if (old_cap > max_cap - old_cap / 2)
+      return need;
+    const size_t n = mystl::max(old_cap + old_cap / 2, need);
+    return mystl::max(n, mystl::min(static_cast<size_t>(EVectorMinGrowth), max_cap));
+  }
+};
+
+// 2 倍
+struct vector_growth_2x
+{
+  template <class Alloc>
+  static size_t next_capacity(const Alloc&, size_t old_cap, size_t need, size_t max_cap) noexcept
+  {
+    if (old_cap > max_cap / 2)
+      return need;
+    const size_t n = mystl::max(old_cap * 2, need);
+    return mystl::max(n, mystl::min(static_cast<size_t>(EVectorMinGrowth), max_cap));
+  }
+};
+
+// 1.5 倍，空间达到一页后上调到页的整数倍，避免大块空间的最后一页只用了一部分
+struct vector_growth_page
+{
+  template <class Alloc>
+  static size_t next_capacity(const Alloc& a, size_t old_cap, size_t need, size_t max_cap) noexcept
+  {
+    const size_t n = vector_growth_1_5x::next_capacity(a, old_cap, need, max_cap);
+    const size_t elem = sizeof(typename Alloc::value_type);
+    const size_t bytes = n * elem;
+    if (bytes < static_cast<size_t>(EVectorPageBytes) ||
+        bytes > static_cast<size_t>(-1) - static_cast<size_t>(EVectorPageBytes))
+      return n;
+    const size_t page = static_cast<size_t>(EVectorPageBytes);
+    return mystl::min(((bytes + page - 1) & ~(page - 1)) / elem, max_cap);
+  }
+};
+
+// 1.5 倍，再上调到分配器实际分配的区块能容纳的元素个数，区块末尾的空间不会浪费
+struct vector_growth_size_class
+{
+  template <class Alloc>
+  static size_t next_capacity(const Alloc& a, size_t old_cap, size_t need, size_t max_cap) noexcept
+  {
+    const size_t n = vector_growth_1_5x::next_capacity(a, old_cap, need, max_cap);
+    return mystl::min(mystl::max(mystl::allocator_traits<Alloc>::good_size(a, n), n), max_cap);
+  }
+};
+
+/*****************************************************************************************/
+
 // 模板类: vector 
-// 模板参数 T 代表类型
-template <class T>
+// 模板参数 T 代表类型，Alloc 代表分配器类型，Growth 代表扩容策略
+template <class T, class Alloc = mystl::allocator<T>, class Growth = mystl::vector_growth_1_5x>
 class vector
 {
-  static_assert(!std::is_same<bool, T>::value, "vector<bool> is abandoned in mystl");
+  static_assert(!std::is_same<bool, T>::value,
+                "vector<bool> is abandoned in mystl, use dynamic_bitset instead");
 public:
   // vector 的嵌套型别定义
-  typedef mystl::allocator<T>                      allocator_type;
-  typedef mystl::allocator<T>                      data_allocator;
+  typedef Alloc                                    allocator_type;
+  typedef mystl::allocator_traits<Alloc>           alloc_traits;
 
-  typedef typename allocator_type::value_type      value_type;
-  typedef typename allocator_type::pointer         pointer;
-  typedef typename allocator_type::const_pointer   const_pointer;
-  typedef typename allocator_type::reference       reference;
-  typedef typename allocator_type::const_reference const_reference;
-  typedef typename allocator_type::size_type       size_type;
-  typedef typename allocator_type::difference_type difference_type;
+  typedef typename alloc_traits::value_type        value_type;
+  typedef typename alloc_traits::pointer           pointer;
+  typedef typename alloc_traits::const_pointer     const_pointer;
+  typedef value_type&                              reference;
+  typedef const value_type&                        const_reference;
+  typedef typename alloc_traits::size_type         size_type;
+  typedef typename alloc_traits::difference_type   difference_type;
 
   typedef value_type*                              iterator;
   typedef const value_type*                        const_iterator;
   typedef mystl::reverse_iterator<iterator>        reverse_iterator;
   typedef mystl::reverse_iterator<const_iterator>  const_reverse_iterator;
 
-  allocator_type get_allocator() { return data_allocator(); }
+  allocator_type get_allocator() const { return alloc_; }
+
+protected:
+  // small_vector 以 vector 为基类，直接管理内联缓冲区以外的空间
+  iterator       begin_;  // 表示目前使用空间的头部
+  iterator       end_;    // 表示目前使用空间的尾部
+  iterator       cap_;    // 表示目前储存空间的尾部
+  allocator_type alloc_;  // 分配器
+
+  // 释放原有的空间，接管 rhs 的空间，rhs 的分配器必须能够释放这块空间
+  void      adopt(vector& rhs) noexcept;
+
+  void      destroy_and_recover(iterator first, iterator last, size_type n);
 
 private:
-  iterator begin_;  // 表示目前使用空间的头部
-  iterator end_;    // 表示目前使用空间的尾部
-  iterator cap_;    // 表示目前储存空间的尾部
+  // 元素能否按字节搬移到新的空间
+  typedef mystl::is_trivially_relocatable<T> bitwise_relocatable;
+
+  // 第一次分配的容量
+  static size_type init_cap() noexcept
+  { return static_cast<size_type>(vector_init_capacity<Alloc>::value); }
 
 public:
   // 构造、复制、移动、析构函数
   vector() noexcept
   { try_init(); }
 
-  explicit vector(size_type n)
+  explicit vector(const allocator_type& alloc) noexcept
+    :alloc_(alloc)
+  { try_init(); }
+
+  explicit vector(size_type n, const allocator_type& alloc = allocator_type())
+    :alloc_(alloc)
   { fill_init(n, value_type()); }
 
-  vector(size_type n, const value_type& value)
+  vector(size_type n, const value_type& value,
+         const allocator_type& alloc = allocator_type())
+    :alloc_(alloc)
   { fill_init(n, value); }
 
   template <class Iter, typename std::enable_if<
     mystl::is_input_iterator<Iter>::value, int>::type = 0>
-  vector(Iter first, Iter last)
+  vector(Iter first, Iter last, const allocator_type& alloc = allocator_type())
+    :alloc_(alloc)
   {
     MYSTL_DEBUG(!(last < first));
     range_init(first, last);
   }
 
   vector(const vector& rhs)
+    :alloc_(alloc_traits::select_on_container_copy_construction(rhs.alloc_))
+  {
+    range_init(rhs.begin_, rhs.end_);
+  }
+
+  vector(const vector& rhs, const allocator_type& alloc)
+    :alloc_(alloc)
   {
     range_init(rhs.begin_, rhs.end_);
   }
@@ -95,24 +211,31 @@ public:
   vector(vector&& rhs) noexcept
     :begin_(rhs.begin_),
     end_(rhs.end_),
-    cap_(rhs.cap_)
+    cap_(rhs.cap_),
+    alloc_(mystl::move(rhs.alloc_))
   {
     rhs.begin_ = nullptr;
     rhs.end_ = nullptr;
     rhs.cap_ = nullptr;
   }
 
-  vector(std::initializer_list<value_type> ilist)
+  vector(vector&& rhs, const allocator_type& alloc);
+
+  vector(std::initializer_list<value_type> ilist,
+         const allocator_type& alloc = allocator_type())
+    :alloc_(alloc)
   {
     range_init(ilist.begin(), ilist.end());
   }
 
   vector& operator=(const vector& rhs);
-  vector& operator=(vector&& rhs) noexcept;
+  vector& operator=(vector&& rhs) noexcept(
+    alloc_traits::propagate_on_container_move_assignment::value ||
+    alloc_traits::is_always_equal::value);
 
   vector& operator=(std::initializer_list<value_type> ilist)
   {
-    vector tmp(ilist.begin(), ilist.end());
+    vector tmp(ilist.begin(), ilist.end(), alloc_);
     swap(tmp);
     return *this;
   }
@@ -262,9 +385,28 @@ public:
   void     insert(const_iterator pos, Iter first, Iter last)
   {
     MYSTL_DEBUG(pos >= begin() && pos <= end() && !(last < first));
-    copy_insert(const_cast<iterator>(pos), first, last);
+    if (pos == end_)
+      append_range_aux(first, last, iterator_category(first));
+    else
+      copy_insert(const_cast<iterator>(pos), first, last);
   }
 
+  // append_range / resize_uninitialized
+
+  // 在尾部追加 [first, last)，前向迭代器只计算一次长度，最多扩容一次
+  template <class Iter, typename std::enable_if<
+    mystl::is_input_iterator<Iter>::value, int>::type = 0>
+  void     append_range(Iter first, Iter last)
+  {
+    append_range_aux(first, last, iterator_category(first));
+  }
+
+  void     append_range(std::initializer_list<value_type> il)
+  { append_range_aux(il.begin(), il.end(), mystl::forward_iterator_tag{}); }
+
+  // 改变大小，新增的元素不初始化，由调用者直接写入，只能用于平凡类型
+  void     resize_uninitialized(size_type new_size);
+
   // erase / clear
   iterator erase(const_iterator pos);
   iterator erase(const_iterator first, const_iterator last);
@@ -291,8 +433,6 @@ private:
   template <class Iter>
   void      range_init(Iter first, Iter last);
 
-  void      destroy_and_recover(iterator first, iterator last, size_type n);
-
   // calculate the growth size
   size_type get_new_cap(size_type add_size);
 
@@ -308,16 +448,41 @@ private:
 
   // reallocate
 
+  void      reallocate_buffer(size_type new_cap, std::true_type);
+  void      reallocate_buffer(size_type new_cap, std::false_type);
+  iterator  reallocate_gap(iterator pos, size_type n);
+  void      close_gap(iterator pos, size_type n) noexcept;
+
   template <class... Args>
   void      reallocate_emplace(iterator pos, Args&& ...args);
+  template <class... Args>
+  void      reallocate_emplace_aux(std::true_type, iterator pos, Args&& ...args);
+  template <class... Args>
+  void      reallocate_emplace_aux(std::false_type, iterator pos, Args&& ...args);
   void      reallocate_insert(iterator pos, const value_type& value);
 
   // insert
 
   iterator  fill_insert(iterator pos, size_type n, const value_type& value);
+  void      fill_insert_realloc(iterator pos, size_type n, const value_type& value,
+                                std::true_type);
+  void      fill_insert_realloc(iterator pos, size_type n, const value_type& value,
+                                std::false_type);
   template <class IIter>
   void      copy_insert(iterator pos, IIter first, IIter last);
 
+  // append_range
+
+  template <class IIter>
+  void      append_range_aux(IIter first, IIter last, input_iterator_tag);
+  template <class FIter>
+  void      append_range_aux(FIter first, FIter last, forward_iterator_tag);
+  template <class FIter>
+  bool      range_may_alias(FIter first, std::true_type) const noexcept;
+  template <class FIter>
+  bool      range_may_alias(FIter, std::false_type) const noexcept
+  { return true; }
+
   // shrink_to_fit
 
   void      reinsert(size_type size);
@@ -326,68 +491,104 @@ private:
 /*****************************************************************************************/
 
 // 复制赋值操作符
-template <class T>
-vector<T>& vector<T>::operator=(const vector& rhs)
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>& vector<T, Alloc, Growth>::operator=(const vector& rhs)
 {
   if (this != &rhs)
   {
+    if (mystl::alloc_copy_needs_reset(alloc_, rhs.alloc_))
+    { // 原有空间必须由原来的分配器释放
+      destroy_and_recover(begin_, end_, cap_ - begin_);
+      begin_ = end_ = cap_ = nullptr;
+    }
+    mystl::alloc_on_copy_assign(alloc_, rhs.alloc_);
     const auto len = rhs.size();
     if (len > capacity())
     { 
-      vector tmp(rhs.begin(), rhs.end());
-      swap(tmp);
+      vector tmp(rhs.begin(), rhs.end(), alloc_);
+      adopt(tmp);
     }
     else if (size() >= len)
     {
       auto i = mystl::copy(rhs.begin(), rhs.end(), begin());
-      data_allocator::destroy(i, end_);
+      alloc_traits::destroy(alloc_, i, end_);
       end_ = begin_ + len;
     }
     else
     { 
       mystl::copy(rhs.begin(), rhs.begin() + size(), begin_);
       mystl::uninitialized_copy(rhs.begin() + size(), rhs.end(), end_);
-      cap_ = end_ = begin_ + len;
+      end_ = begin_ + len;
     }
   }
   return *this;
 }
 
+// 指定分配器的移动构造函数，分配器不相等时只能逐个移动元素
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>::vector(vector&& rhs, const allocator_type& alloc)
+  :alloc_(alloc)
+{
+  if (alloc_ == rhs.alloc_)
+  {
+    begin_ = rhs.begin_;
+    end_ = rhs.end_;
+    cap_ = rhs.cap_;
+    rhs.begin_ = nullptr;
+    rhs.end_ = nullptr;
+    rhs.cap_ = nullptr;
+  }
+  else
+  {
+    const size_type len = rhs.size();
+    init_space(len, mystl::max(len, init_cap()));
+    mystl::uninitialized_move(rhs.begin_, rhs.end_, begin_);
+  }
+}
+
 // 移动赋值操作符
-template <class T>
-vector<T>& vector<T>::operator=(vector&& rhs) noexcept
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>& vector<T, Alloc, Growth>::operator=(vector&& rhs) noexcept(
+  alloc_traits::propagate_on_container_move_assignment::value ||
+  alloc_traits::is_always_equal::value)
 {
-  destroy_and_recover(begin_, end_, cap_ - begin_);
-  begin_ = rhs.begin_;
-  end_ = rhs.end_;
-  cap_ = rhs.cap_;
-  rhs.begin_ = nullptr;
-  rhs.end_ = nullptr;
-  rhs.cap_ = nullptr;
+  if (this == &rhs)
+    return *this;
+  if (mystl::alloc_move_can_steal(alloc_, rhs.alloc_))
+  {
+    destroy_and_recover(begin_, end_, cap_ - begin_);
+    mystl::alloc_on_move_assign(alloc_, rhs.alloc_);
+    begin_ = rhs.begin_;
+    end_ = rhs.end_;
+    cap_ = rhs.cap_;
+    rhs.begin_ = nullptr;
+    rhs.end_ = nullptr;
+    rhs.cap_ = nullptr;
+  }
+  else
+  { // 分配器不相等且不传递，不能接管对方的空间
+    clear();
+    reserve(rhs.size());
+    end_ = mystl::uninitialized_move(rhs.begin_, rhs.end_, begin_);
+  }
   return *this;
 }
 
 // 预留空间大小，当原容量小于要求大小时，才会重新分配
-template <class T>
-void vector<T>::reserve(size_type n)
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::reserve(size_type n)
 {
   if (capacity() < n)
   {
     THROW_LENGTH_ERROR_IF(n > max_size(),
                           "n can not larger than max_size() in vector<T>::reserve(n)");
-    const auto old_size = size();
-    auto tmp = data_allocator::allocate(n);
-    mystl::uninitialized_move(begin_, end_, tmp);
-    data_allocator::deallocate(begin_, cap_ - begin_);
-    begin_ = tmp;
-    end_ = tmp + old_size;
-    cap_ = begin_ + n;
+    reallocate_buffer(n, bitwise_relocatable());
   }
 }
 
 // 放弃多余的容量
-template <class T>
-void vector<T>::shrink_to_fit()
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::shrink_to_fit()
 {
   if (end_ < cap_)
   {
@@ -396,23 +597,23 @@ void vector<T>::shrink_to_fit()
 }
 
 // 在 pos 位置就地构造元素，避免额外的复制或移动开销
-template <class T>
+template <class T, class Alloc, class Growth>
 template <class ...Args>
-typename vector<T>::iterator
-vector<T>::emplace(const_iterator pos, Args&& ...args)
+typename vector<T, Alloc, Growth>::iterator
+vector<T, Alloc, Growth>::emplace(const_iterator pos, Args&& ...args)
 {
   MYSTL_DEBUG(pos >= begin() && pos <= end());
   iterator xpos = const_cast<iterator>(pos);
   const size_type n = xpos - begin_;
   if (end_ != cap_ && xpos == end_)
   {
-    data_allocator::construct(mystl::address_of(*end_), mystl::forward<Args>(args)...);
+    alloc_traits::construct(alloc_, mystl::address_of(*end_), mystl::forward<Args>(args)...);
     ++end_;
   }
   else if (end_ != cap_)
   {
     auto new_end = end_;
-    data_allocator::construct(mystl::address_of(*end_), *(end_ - 1));
+    alloc_traits::construct(alloc_, mystl::address_of(*end_), *(end_ - 1));
     ++new_end;
     mystl::copy_backward(xpos, end_ - 1, end_);
     *xpos = value_type(mystl::forward<Args>(args)...);
@@ -426,13 +627,13 @@ vector<T>::emplace(const_iterator pos, Args&& ...args)
 }
 
 // 在尾部就地构造元素，避免额外的复制或移动开销
-template <class T>
+template <class T, class Alloc, class Growth>
 template <class ...Args>
-void vector<T>::emplace_back(Args&& ...args)
+void vector<T, Alloc, Growth>::emplace_back(Args&& ...args)
 {
   if (end_ < cap_)
   {
-    data_allocator::construct(mystl::address_of(*end_), mystl::forward<Args>(args)...);
+    alloc_traits::construct(alloc_, mystl::address_of(*end_), mystl::forward<Args>(args)...);
     ++end_;
   }
   else
@@ -442,12 +643,12 @@ void vector<T>::emplace_back(Args&& ...args)
 }
 
 // 在尾部插入元素
-template <class T>
-void vector<T>::push_back(const value_type& value)
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::push_back(const value_type& value)
 {
   if (end_ != cap_)
   {
-    data_allocator::construct(mystl::address_of(*end_), value);
+    alloc_traits::construct(alloc_, mystl::address_of(*end_), value);
     ++end_;
   }
   else
@@ -457,31 +658,31 @@ void vector<T>::push_back(const value_type& value)
 }
 
 // 弹出尾部元素
-template <class T>
-void vector<T>::pop_back()
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::pop_back()
 {
   MYSTL_DEBUG(!empty());
-  data_allocator::destroy(end_ - 1);
+  alloc_traits::destroy(alloc_, end_ - 1);
   --end_;
 }
 
 // 在 pos 处插入元素
-template <class T>
-typename vector<T>::iterator
-vector<T>::insert(const_iterator pos, const value_type& value)
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::iterator
+vector<T, Alloc, Growth>::insert(const_iterator pos, const value_type& value)
 {
   MYSTL_DEBUG(pos >= begin() && pos <= end());
   iterator xpos = const_cast<iterator>(pos);
   const size_type n = pos - begin_;
   if (end_ != cap_ && xpos == end_)
   {
-    data_allocator::construct(mystl::address_of(*end_), value);
+    alloc_traits::construct(alloc_, mystl::address_of(*end_), value);
     ++end_;
   }
   else if (end_ != cap_)
   {
     auto new_end = end_;
-    data_allocator::construct(mystl::address_of(*end_), *(end_ - 1));
+    alloc_traits::construct(alloc_, mystl::address_of(*end_), *(end_ - 1));
     ++new_end;
     auto value_copy = value;  // 避免元素因以下复制操作而被改变
     mystl::copy_backward(xpos, end_ - 1, end_);
@@ -496,34 +697,34 @@ vector<T>::insert(const_iterator pos, const value_type& value)
 }
 
 // 删除 pos 位置上的元素
-template <class T>
-typename vector<T>::iterator
-vector<T>::erase(const_iterator pos)
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::iterator
+vector<T, Alloc, Growth>::erase(const_iterator pos)
 {
   MYSTL_DEBUG(pos >= begin() && pos < end());
   iterator xpos = begin_ + (pos - begin());
   mystl::move(xpos + 1, end_, xpos);
-  data_allocator::destroy(end_ - 1);
+  alloc_traits::destroy(alloc_, end_ - 1);
   --end_;
   return xpos;
 }
 
 // 删除[first, last)上的元素
-template <class T>
-typename vector<T>::iterator
-vector<T>::erase(const_iterator first, const_iterator last)
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::iterator
+vector<T, Alloc, Growth>::erase(const_iterator first, const_iterator last)
 {
   MYSTL_DEBUG(first >= begin() && last <= end() && !(last < first));
   const auto n = first - begin();
   iterator r = begin_ + (first - begin());
-  data_allocator::destroy(mystl::move(r + (last - first), end_, r), end_);
+  alloc_traits::destroy(alloc_, mystl::move(r + (last - first), end_, r), end_);
   end_ = end_ - (last - first);
   return begin_ + n;
 }
 
 // 重置容器大小
-template <class T>
-void vector<T>::resize(size_type new_size, const value_type& value)
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::resize(size_type new_size, const value_type& value)
 {
   if (new_size < size())
   {
@@ -535,15 +736,32 @@ void vector<T>::resize(size_type new_size, const value_type& value)
   }
 }
 
+// 重置容器大小，新增的元素不初始化
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::resize_uninitialized(size_type new_size)
+{
+  static_assert(std::is_trivially_default_constructible<T>::value &&
+                std::is_trivially_destructible<T>::value,
+                "resize_uninitialized requires a trivial value_type");
+  if (new_size > capacity())
+  {
+    THROW_LENGTH_ERROR_IF(new_size > max_size(),
+                          "n can not larger than max_size() in vector<T>::resize_uninitialized(n)");
+    reallocate_buffer(get_new_cap(new_size - capacity()), bitwise_relocatable());
+  }
+  end_ = begin_ + new_size;
+}
+
 // 与另一个 vector 交换
-template <class T>
-void vector<T>::swap(vector<T>& rhs) noexcept
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::swap(vector<T, Alloc, Growth>& rhs) noexcept
 {
   if (this != &rhs)
   {
     mystl::swap(begin_, rhs.begin_);
     mystl::swap(end_, rhs.end_);
     mystl::swap(cap_, rhs.cap_);
+    mystl::alloc_on_swap(alloc_, rhs.alloc_);
   }
 }
 
@@ -551,14 +769,14 @@ void vector<T>::swap(vector<T>& rhs) noexcept
 // helper function
 
 // try_init 函数，若分配失败则忽略，不抛出异常
-template <class T>
-void vector<T>::try_init() noexcept
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::try_init() noexcept
 {
   try
   {
-    begin_ = data_allocator::allocate(16);
+    begin_ = alloc_traits::allocate(alloc_, init_cap());
     end_ = begin_;
-    cap_ = begin_ + 16;
+    cap_ = begin_ + init_cap();
   }
   catch (...)
   {
@@ -569,12 +787,12 @@ void vector<T>::try_init() noexcept
 }
 
 // init_space 函数
-template <class T>
-void vector<T>::init_space(size_type size, size_type cap)
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::init_space(size_type size, size_type cap)
 {
   try
   {
-    begin_ = data_allocator::allocate(cap);
+    begin_ = alloc_traits::allocate(alloc_, cap);
     end_ = begin_ + size;
     cap_ = begin_ + cap;
   }
@@ -588,65 +806,73 @@ void vector<T>::init_space(size_type size, size_type cap)
 }
 
 // fill_init 函数
-template <class T>
-void vector<T>::
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::
 fill_init(size_type n, const value_type& value)
 {
-  const size_type init_size = mystl::max(static_cast<size_type>(16), n);
+  const size_type init_size = mystl::max(init_cap(), n);
   init_space(n, init_size);
   mystl::uninitialized_fill_n(begin_, n, value);
 }
 
 // range_init 函数
-template <class T>
+template <class T, class Alloc, class Growth>
 template <class Iter>
-void vector<T>::
+void vector<T, Alloc, Growth>::
 range_init(Iter first, Iter last)
 {
   const size_type len = mystl::distance(first, last);
-  const size_type init_size = mystl::max(len, static_cast<size_type>(16));
+  const size_type init_size = mystl::max(len, init_cap());
   init_space(len, init_size);
   mystl::uninitialized_copy(first, last, begin_);
 }
 
 // destroy_and_recover 函数
-template <class T>
-void vector<T>::
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::
 destroy_and_recover(iterator first, iterator last, size_type n)
 {
-  data_allocator::destroy(first, last);
-  data_allocator::deallocate(first, n);
+  alloc_traits::destroy(alloc_, first, last);
+  alloc_traits::deallocate(alloc_, first, n);
+}
+
+// adopt 函数
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::
+adopt(vector& rhs) noexcept
+{
+  destroy_and_recover(begin_, end_, cap_ - begin_);
+  begin_ = rhs.begin_;
+  end_ = rhs.end_;
+  cap_ = rhs.cap_;
+  rhs.begin_ = nullptr;
+  rhs.end_ = nullptr;
+  rhs.cap_ = nullptr;
 }
 
 // get_new_cap 函数
-template <class T>
-typename vector<T>::size_type 
-vector<T>::
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::size_type 
+vector<T, Alloc, Growth>::
 get_new_cap(size_type add_size)
 {
   const auto old_size = capacity();
   THROW_LENGTH_ERROR_IF(old_size > max_size() - add_size,
                         "vector<T>'s size too big");
-  if (old_size > max_size() - old_size / 2)
-  {
-    return old_size + add_size > max_size() - 16
-      ? old_size + add_size : old_size + add_size + 16;
-  }
-  const size_type new_size = old_size == 0
-    ? mystl::max(add_size, static_cast<size_type>(16))
-    : mystl::max(old_size + old_size / 2, old_size + add_size);
-  return new_size;
+  if (old_size == 0)
+    return mystl::max(add_size, init_cap());
+  return Growth::next_capacity(alloc_, old_size, old_size + add_size, max_size());
 }
 
 // fill_assign 函数
-template <class T>
-void vector<T>::
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::
 fill_assign(size_type n, const value_type& value)
 {
   if (n > capacity())
   {
-    vector tmp(n, value);
-    swap(tmp);
+    vector tmp(n, value, alloc_);
+    adopt(tmp);
   }
   else if (n > size())
   {
@@ -660,9 +886,9 @@ fill_assign(size_type n, const value_type& value)
 }
 
 // copy_assign 函数
-template <class T>
+template <class T, class Alloc, class Growth>
 template <class IIter>
-void vector<T>::
+void vector<T, Alloc, Growth>::
 copy_assign(IIter first, IIter last, input_iterator_tag)
 {
   auto cur = begin_;
@@ -681,21 +907,21 @@ copy_assign(IIter first, IIter last, input_iterator_tag)
 }
 
 // 用 [first, last) 为容器赋值
-template <class T>
+template <class T, class Alloc, class Growth>
 template <class FIter>
-void vector<T>::
+void vector<T, Alloc, Growth>::
 copy_assign(FIter first, FIter last, forward_iterator_tag)
 {
   const size_type len = mystl::distance(first, last);
   if (len > capacity())
   {
-    vector tmp(first, last);
-    swap(tmp);
+    vector tmp(first, last, alloc_);
+    adopt(tmp);
   }
   else if (size() >= len)
   {
     auto new_end = mystl::copy(first, last, begin_);
-    data_allocator::destroy(new_end, end_);
+    alloc_traits::destroy(alloc_, new_end, end_);
     end_ = new_end;
   }
   else
@@ -708,51 +934,113 @@ copy_assign(FIter first, FIter last, forward_iterator_tag)
   }
 }
 
+// 把容量调整为 new_cap，元素按字节搬移，由分配器决定原地扩展、重新映射还是复制
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::
+reallocate_buffer(size_type new_cap, std::true_type)
+{
+  const auto old_size = size();
+  begin_ = alloc_traits::reallocate(alloc_, begin_, cap_ - begin_, new_cap);
+  end_ = begin_ + old_size;
+  cap_ = begin_ + new_cap;
+}
+
+// 把容量调整为 new_cap，不能原地扩展时逐个移动元素
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::
+reallocate_buffer(size_type new_cap, std::false_type)
+{
+  if (alloc_traits::try_expand(alloc_, begin_, cap_ - begin_, new_cap))
+  {
+    cap_ = begin_ + new_cap;
+    return;
+  }
+  const auto old_size = size();
+  auto tmp = alloc_traits::allocate(alloc_, new_cap);
+  try
+  {
+    mystl::uninitialized_relocate(begin_, end_, tmp);
+  }
+  catch (...)
+  {
+    alloc_traits::deallocate(alloc_, tmp, new_cap);
+    throw;
+  }
+  alloc_traits::deallocate(alloc_, begin_, cap_ - begin_);
+  begin_ = tmp;
+  end_ = tmp + old_size;
+  cap_ = begin_ + new_cap;
+}
+
+// 扩容并在 pos 处空出 n 个未初始化的位置，返回空位的起点，只用于可以平凡搬移的元素
+// 空位计入 [begin_, end_)，调用者构造失败时用 close_gap 收回
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::iterator
+vector<T, Alloc, Growth>::
+reallocate_gap(iterator pos, size_type n)
+{
+  const auto xpos = pos - begin_;
+  reallocate_buffer(get_new_cap(n), std::true_type());
+  pos = begin_ + xpos;
+  mystl::uninitialized_relocate_backward(pos, end_, end_ + n);
+  end_ += n;
+  return pos;
+}
+
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::
+close_gap(iterator pos, size_type n) noexcept
+{
+  mystl::uninitialized_relocate(pos + n, end_, pos);
+  end_ -= n;
+}
+
 // 重新分配空间并在 pos 处就地构造元素
-template <class T>
+template <class T, class Alloc, class Growth>
 template <class ...Args>
-void vector<T>::
+void vector<T, Alloc, Growth>::
 reallocate_emplace(iterator pos, Args&& ...args)
 {
-  const auto new_size = get_new_cap(1);
-  auto new_begin = data_allocator::allocate(new_size);
-  auto new_end = new_begin;
+  reallocate_emplace_aux(bitwise_relocatable(), pos, mystl::forward<Args>(args)...);
+}
+
+// 元素可以按字节搬移：先构造新元素（参数可能引用容器中的元素），再扩容并空出 pos
+template <class T, class Alloc, class Growth>
+template <class ...Args>
+void vector<T, Alloc, Growth>::
+reallocate_emplace_aux(std::true_type, iterator pos, Args&& ...args)
+{
+  value_type tmp(mystl::forward<Args>(args)...);
+  pos = reallocate_gap(pos, 1);
   try
   {
-    new_end = mystl::uninitialized_move(begin_, pos, new_begin);
-    data_allocator::construct(mystl::address_of(*new_end), mystl::forward<Args>(args)...);
-    ++new_end;
-    new_end = mystl::uninitialized_move(pos, end_, new_end);
+    alloc_traits::construct(alloc_, mystl::address_of(*pos), mystl::move(tmp));
   }
   catch (...)
   {
-    data_allocator::deallocate(new_begin, new_size);
+    close_gap(pos, 1);
     throw;
   }
-  destroy_and_recover(begin_, end_, cap_ - begin_);
-  begin_ = new_begin;
-  end_ = new_end;
-  cap_ = new_begin + new_size;
 }
 
-// 重新分配空间并在 pos 处插入元素
-template <class T>
-void vector<T>::reallocate_insert(iterator pos, const value_type& value)
+template <class T, class Alloc, class Growth>
+template <class ...Args>
+void vector<T, Alloc, Growth>::
+reallocate_emplace_aux(std::false_type, iterator pos, Args&& ...args)
 {
   const auto new_size = get_new_cap(1);
-  auto new_begin = data_allocator::allocate(new_size);
+  auto new_begin = alloc_traits::allocate(alloc_, new_size);
   auto new_end = new_begin;
-  const value_type& value_copy = value;
   try
   {
     new_end = mystl::uninitialized_move(begin_, pos, new_begin);
-    data_allocator::construct(mystl::address_of(*new_end), value_copy);
+    alloc_traits::construct(alloc_, mystl::address_of(*new_end), mystl::forward<Args>(args)...);
     ++new_end;
     new_end = mystl::uninitialized_move(pos, end_, new_end);
   }
   catch (...)
   {
-    data_allocator::deallocate(new_begin, new_size);
+    alloc_traits::deallocate(alloc_, new_begin, new_size);
     throw;
   }
   destroy_and_recover(begin_, end_, cap_ - begin_);
@@ -761,10 +1049,17 @@ void vector<T>::reallocate_insert(iterator pos, const value_type& value)
   cap_ = new_begin + new_size;
 }
 
+// 重新分配空间并在 pos 处插入元素
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::reallocate_insert(iterator pos, const value_type& value)
+{
+  reallocate_emplace(pos, value);
+}
+
 // fill_insert 函数
-template <class T>
-typename vector<T>::iterator 
-vector<T>::
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::iterator 
+vector<T, Alloc, Growth>::
 fill_insert(iterator pos, size_type n, const value_type& value)
 {
   if (n == 0)
@@ -780,43 +1075,67 @@ fill_insert(iterator pos, size_type n, const value_type& value)
       mystl::uninitialized_copy(end_ - n, end_, end_);
       end_ += n;
       mystl::move_backward(pos, old_end - n, old_end);
-      mystl::uninitialized_fill_n(pos, n, value_copy);
+      mystl::fill_n(pos, n, value_copy);
     }
     else
     {
       end_ = mystl::uninitialized_fill_n(end_, n - after_elems, value_copy);
       end_ = mystl::uninitialized_move(pos, old_end, end_);
-      mystl::uninitialized_fill_n(pos, after_elems, value_copy);
+      mystl::fill_n(pos, after_elems, value_copy);
     }
   }
   else
   { // 如果备用空间不足
-    const auto new_size = get_new_cap(n);
-    auto new_begin = data_allocator::allocate(new_size);
-    auto new_end = new_begin;
-    try
-    {
-      new_end = mystl::uninitialized_move(begin_, pos, new_begin);
-      new_end = mystl::uninitialized_fill_n(new_end, n, value);
-      new_end = mystl::uninitialized_move(pos, end_, new_end);
-    }
-    catch (...)
-    {
-      destroy_and_recover(new_begin, new_end, new_size);
-      throw;
-    }
-    data_allocator::deallocate(begin_, cap_ - begin_);
-    begin_ = new_begin;
-    end_ = new_end;
-    cap_ = begin_ + new_size;
+    fill_insert_realloc(pos, n, value_copy, bitwise_relocatable());
   }
   return begin_ + xpos;
 }
 
+// 扩容后在 pos 处填充 n 个 value：元素可以平凡搬移时先空出位置再填充
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::
+fill_insert_realloc(iterator pos, size_type n, const value_type& value, std::true_type)
+{
+  pos = reallocate_gap(pos, n);
+  try
+  {
+    mystl::uninitialized_fill_n(pos, n, value);
+  }
+  catch (...)
+  {
+    close_gap(pos, n);
+    throw;
+  }
+}
+
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::
+fill_insert_realloc(iterator pos, size_type n, const value_type& value, std::false_type)
+{
+  const auto new_size = get_new_cap(n);
+  auto new_begin = alloc_traits::allocate(alloc_, new_size);
+  auto new_end = new_begin;
+  try
+  {
+    new_end = mystl::uninitialized_move(begin_, pos, new_begin);
+    new_end = mystl::uninitialized_fill_n(new_end, n, value);
+    new_end = mystl::uninitialized_move(pos, end_, new_end);
+  }
+  catch (...)
+  {
+    destroy_and_recover(new_begin, new_end, new_size);
+    throw;
+  }
+  destroy_and_recover(begin_, end_, cap_ - begin_);
+  begin_ = new_begin;
+  end_ = new_end;
+  cap_ = begin_ + new_size;
+}
+
 // copy_insert 函数
-template <class T>
+template <class T, class Alloc, class Growth>
 template <class IIter>
-void vector<T>::
+void vector<T, Alloc, Growth>::
 copy_insert(iterator pos, IIter first, IIter last)
 {
   if (first == last)
@@ -830,7 +1149,7 @@ copy_insert(iterator pos, IIter first, IIter last)
     {
       end_ = mystl::uninitialized_copy(end_ - n, end_, end_);
       mystl::move_backward(pos, old_end - n, old_end);
-      mystl::uninitialized_copy(first, last, pos);
+      mystl::copy(first, last, pos);
     }
     else
     {
@@ -838,13 +1157,13 @@ copy_insert(iterator pos, IIter first, IIter last)
       mystl::advance(mid, after_elems);
       end_ = mystl::uninitialized_copy(mid, last, end_);
       end_ = mystl::uninitialized_move(pos, old_end, end_);
-      mystl::uninitialized_copy(first, mid, pos);
+      mystl::copy(first, mid, pos);
     }
   }
   else
-  { // 备用空间不足
+  { // 备用空间不足，[first, last) 可能指向容器本身，所以总是先复制到新的空间
     const auto new_size = get_new_cap(n);
-    auto new_begin = data_allocator::allocate(new_size);
+    auto new_begin = alloc_traits::allocate(alloc_, new_size);
     auto new_end = new_begin;
     try
     {
@@ -857,28 +1176,104 @@ copy_insert(iterator pos, IIter first, IIter last)
       destroy_and_recover(new_begin, new_end, new_size);
       throw;
     }
-    data_allocator::deallocate(begin_, cap_ - begin_);
+    destroy_and_recover(begin_, end_, cap_ - begin_);
     begin_ = new_begin;
     end_ = new_end;
     cap_ = begin_ + new_size;
   }
 }
 
+// 在尾部逐个追加输入迭代器区间中的元素
+template <class T, class Alloc, class Growth>
+template <class IIter>
+void vector<T, Alloc, Growth>::
+append_range_aux(IIter first, IIter last, input_iterator_tag)
+{
+  for (; first != last; ++first)
+    emplace_back(*first);
+}
+
+// 空间足够时直接复制到尾部；不够时一次扩容到位。[first, last) 不在容器中时先扩容
+// （可能原地扩展或重新映射），再复制到尾部；可能指向容器本身时，先把新元素复制到新的空间，
+// 再把原有元素搬移过去
+template <class T, class Alloc, class Growth>
+template <class FIter>
+void vector<T, Alloc, Growth>::
+append_range_aux(FIter first, FIter last, forward_iterator_tag)
+{
+  const size_type n = mystl::distance(first, last);
+  if (n == 0)
+    return;
+  if (static_cast<size_type>(cap_ - end_) >= n)
+  {
+    end_ = mystl::uninitialized_copy(first, last, end_);
+    return;
+  }
+  typedef typename iterator_traits<FIter>::reference ref;
+  typedef std::integral_constant<bool, std::is_lvalue_reference<ref>::value &&
+    std::is_same<typename std::remove_cv<typename std::remove_reference<ref>::type>::type,
+                 T>::value> points_to_value;
+  if (!range_may_alias(first, points_to_value()))
+  {
+    // 复制失败时只多出了容量，容器内容不变
+    reallocate_buffer(get_new_cap(n), bitwise_relocatable());
+    end_ = mystl::uninitialized_copy(first, last, end_);
+    return;
+  }
+  const auto old_size = size();
+  const auto new_size = get_new_cap(n);
+  auto new_begin = alloc_traits::allocate(alloc_, new_size);
+  auto new_end = new_begin + old_size;
+  try
+  {
+    new_end = mystl::uninitialized_copy(first, last, new_end);
+    try
+    {
+      mystl::uninitialized_relocate(begin_, end_, new_begin);
+    }
+    catch (...)
+    {
+      alloc_traits::destroy(alloc_, new_begin + old_size, new_end);
+      throw;
+    }
+  }
+  catch (...)
+  {
+    alloc_traits::deallocate(alloc_, new_begin, new_size);
+    throw;
+  }
+  alloc_traits::deallocate(alloc_, begin_, cap_ - begin_);
+  begin_ = new_begin;
+  end_ = new_end;
+  cap_ = new_begin + new_size;
+}
+
+// 区间的元素是 T 的左值时，看首个元素是否位于 [begin_, end_) 中；
+// 其它区间（如按值返回的迭代器）无法判断，都按可能指向容器处理
+template <class T, class Alloc, class Growth>
+template <class FIter>
+bool vector<T, Alloc, Growth>::
+range_may_alias(FIter first, std::true_type) const noexcept
+{
+  const T* p = mystl::address_of(*first);
+  return !std::less<const T*>()(p, begin_) && std::less<const T*>()(p, end_);
+}
+
 // reinsert 函数
-template <class T>
-void vector<T>::reinsert(size_type size)
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::reinsert(size_type size)
 {
-  auto new_begin = data_allocator::allocate(size);
+  auto new_begin = alloc_traits::allocate(alloc_, size);
   try
   {
-    mystl::uninitialized_move(begin_, end_, new_begin);
+    mystl::uninitialized_relocate(begin_, end_, new_begin);
   }
   catch (...)
   {
-    data_allocator::deallocate(new_begin, size);
+    alloc_traits::deallocate(alloc_, new_begin, size);
     throw;
   }
-  data_allocator::deallocate(begin_, cap_ - begin_);
+  alloc_traits::deallocate(alloc_, begin_, cap_ - begin_);
   begin_ = new_begin;
   end_ = begin_ + size;
   cap_ = begin_ + size;
@@ -887,50 +1282,59 @@ void vector<T>::reinsert(size_type size)
 /*****************************************************************************************/
 // 重载比较操作符
 
-template <class T>
-bool operator==(const vector<T>& lhs, const vector<T>& rhs)
+template <class T, class Alloc, class Growth>
+bool operator==(const vector<T, Alloc, Growth>& lhs, const vector<T, Alloc, Growth>& rhs)
 {
   return lhs.size() == rhs.size() &&
     mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template <class T>
-bool operator<(const vector<T>& lhs, const vector<T>& rhs)
+template <class T, class Alloc, class Growth>
+bool operator<(const vector<T, Alloc, Growth>& lhs, const vector<T, Alloc, Growth>& rhs)
 {
   return mystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
-template <class T>
-bool operator!=(const vector<T>& lhs, const vector<T>& rhs)
+template <class T, class Alloc, class Growth>
+bool operator!=(const vector<T, Alloc, Growth>& lhs, const vector<T, Alloc, Growth>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class T>
-bool operator>(const vector<T>& lhs, const vector<T>& rhs)
+template <class T, class Alloc, class Growth>
+bool operator>(const vector<T, Alloc, Growth>& lhs, const vector<T, Alloc, Growth>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class T>
-bool operator<=(const vector<T>& lhs, const vector<T>& rhs)
+template <class T, class Alloc, class Growth>
+bool operator<=(const vector<T, Alloc, Growth>& lhs, const vector<T, Alloc, Growth>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class T>
-bool operator>=(const vector<T>& lhs, const vector<T>& rhs)
+template <class T, class Alloc, class Growth>
+bool operator>=(const vector<T, Alloc, Growth>& lhs, const vector<T, Alloc, Growth>& rhs)
 {
   return !(lhs < rhs);
 }
 
 // 重载 mystl 的 swap
-template <class T>
-void swap(vector<T>& lhs, vector<T>& rhs)
+template <class T, class Alloc, class Growth>
+void swap(vector<T, Alloc, Growth>& lhs, vector<T, Alloc, Growth>& rhs)
 {
   lhs.swap(rhs);
 }
 
+// vector 只保存指向堆上空间的指针，分配器可以平凡搬移时 vector 也可以
+template <class T, class Alloc, class Growth>
+struct is_trivially_relocatable<vector<T, Alloc, Growth>>
+  : mystl::is_trivially_relocatable<Alloc> {};
+
+// data() 按 Align bytes 对齐、空间补齐到 Align 整数倍的 vector，供 SIMD 代码使用
+template <class T, size_t Align = ESimdAlign>
+using aligned_vector = vector<T, aligned_allocator<T, Align>>;
+
 } // namespace mystl
 #endif // !MYTINYSTL_VECTOR_H_
 
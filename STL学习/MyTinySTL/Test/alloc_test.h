@@ -0,0 +1,373 @@
+#ifndef MYTINYSTL_ALLOC_TEST_H_
+#define MYTINYSTL_ALLOC_TEST_H_
+
+// alloc test : 测试内存池 alloc 与 pthread_allocator 的正确性，以及与 ::operator new 分配节点大小区块的性能
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../MyTinySTL/alloc.h"
+#include "../MyTinySTL/large_alloc.h"
+#include "../MyTinySTL/list.h"
+#include "../MyTinySTL/pthread_alloc.h"
+#include "../MyTinySTL/vector.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace alloc_test
+{
+
+// 每个 size class 的区块都可以完整写入，且互不重叠
+TEST(alloc_size_class_test)
+{
+  std::vector<char*> blocks;
+  std::vector<size_t> sizes;
+  for (size_t n = 1; n <= 4096 + 64; n += 7)
+  {
+    char* p = static_cast<char*>(mystl::alloc::allocate(n));
+    std::memset(p, static_cast<int>(n & 0x7f), n);
+    blocks.push_back(p);
+    sizes.push_back(n);
+  }
+  bool ok = true;
+  for (size_t i = 0; i < blocks.size(); ++i)
+  {
+    for (size_t j = 0; j < sizes[i]; ++j)
+    {
+      if (blocks[i][j] != static_cast<char>(sizes[i] & 0x7f))
+        ok = false;
+    }
+    if (reinterpret_cast<size_t>(blocks[i]) % 8 != 0)
+      ok = false;
+  }
+  EXPECT_TRUE(ok);
+  for (size_t i = 0; i < blocks.size(); ++i)
+    mystl::alloc::deallocate(blocks[i], sizes[i]);
+}
+
+// 释放后的区块会被同一线程再次复用
+TEST(alloc_reuse_test)
+{
+  void* p = mystl::alloc::allocate(24);
+  mystl::alloc::deallocate(p, 24);
+  void* q = mystl::alloc::allocate(20);
+  EXPECT_EQ(p, q);
+  mystl::alloc::deallocate(q, 20);
+
+  char* s = static_cast<char*>(mystl::alloc::allocate(10));
+  std::memcpy(s, "abcdefghi", 10);
+  s = static_cast<char*>(mystl::alloc::reallocate(s, 10, 100));
+  EXPECT_STREQ("abcdefghi", s);
+  s = static_cast<char*>(mystl::alloc::reallocate(s, 100, 8000));
+  EXPECT_STREQ("abcdefghi", s);
+  mystl::alloc::deallocate(s, 8000);
+}
+
+// 一个线程分配，另一个线程释放，再由多个线程并发分配释放
+TEST(alloc_cross_thread_test)
+{
+  const size_t count = 100000;
+  std::vector<void*> blocks(count);
+  std::thread producer([&]() {
+    for (size_t i = 0; i < count; ++i)
+    {
+      blocks[i] = mystl::alloc::allocate(48);
+      *static_cast<size_t*>(blocks[i]) = i;
+    }
+  });
+  producer.join();
+  bool ok = true;
+  std::thread consumer([&]() {
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (*static_cast<size_t*>(blocks[i]) != i)
+        ok = false;
+      mystl::alloc::deallocate(blocks[i], 48);
+    }
+  });
+  consumer.join();
+  EXPECT_TRUE(ok);
+
+  std::vector<std::thread> workers;
+  std::vector<int> results(4, 1);
+  for (size_t t = 0; t < 4; ++t)
+  {
+    workers.push_back(std::thread([&results, t]() {
+      std::vector<size_t*> v;
+      for (size_t round = 0; round < 20; ++round)
+      {
+        for (size_t i = 0; i < 5000; ++i)
+        {
+          size_t* p = static_cast<size_t*>(mystl::alloc::allocate(32));
+          p[0] = t;
+          p[1] = i;
+          v.push_back(p);
+        }
+        for (size_t i = 0; i < v.size(); ++i)
+        {
+          if (v[i][0] != t || v[i][1] != i)
+            results[t] = 0;
+          mystl::alloc::deallocate(v[i], 32);
+        }
+        v.clear();
+      }
+    }));
+  }
+  for (auto& w : workers)
+    w.join();
+  std::vector<int> expect(4, 1);
+  EXPECT_CON_EQ(expect, results);
+}
+
+// 线程缓存中长期不用的区块会被定期归还仓库
+TEST(alloc_scavenge_test)
+{
+  size_t before = 0, after = 0;
+  std::thread t([&]() {
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < 100; ++i)
+      blocks.push_back(mystl::alloc::allocate(200));
+    for (size_t i = 0; i < blocks.size(); ++i)
+      mystl::alloc::deallocate(blocks[i], 200);
+    before = mystl::alloc::cached_blocks(200);
+    // 只使用另一个 size class，200 bytes 的区块一直闲置
+    for (size_t i = 0; i < 8 * mystl::EScavengeInterval; ++i)
+      mystl::alloc::deallocate(mystl::alloc::allocate(16), 16);
+    after = mystl::alloc::cached_blocks(200);
+  });
+  t.join();
+  EXPECT_TRUE(before > 0);
+  EXPECT_TRUE(after < before / 8 + 1);
+}
+
+// 大块内存按页对齐，达到 2M 时按 2M 对齐，可以完整读写
+TEST(large_alloc_test)
+{
+  const size_t sizes[] = { 5000, mystl::large_alloc::threshold(), 3 * mystl::large_alloc::threshold() + 123 };
+  for (size_t k = 0; k < 3; ++k)
+  {
+    const size_t n = sizes[k];
+    char* p = static_cast<char*>(mystl::large_alloc::allocate(n));
+    std::memset(p, 0x5a, n);
+    EXPECT_TRUE(p[0] == 0x5a && p[n - 1] == 0x5a);
+#if MYSTL_LARGE_ALLOC_MMAP
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % mystl::EPageBytes);
+    if (n >= static_cast<size_t>(mystl::EHugePageBytes))
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % mystl::EHugePageBytes);
+#endif
+    mystl::large_alloc::deallocate(p, n);
+  }
+  // 绑定到 0 号节点，节点不存在时退回 first-touch
+  mystl::large_alloc::set_numa_node(0);
+  char* q = static_cast<char*>(mystl::large_alloc::allocate(4 << 20));
+  q[0] = 1;
+  q[(4 << 20) - 1] = 1;
+  mystl::large_alloc::deallocate(q, 4 << 20);
+  mystl::large_alloc::set_numa_node(-1);
+  EXPECT_EQ(-1, mystl::large_alloc::numa_node());
+
+  // mremap 调整映射后内容不变
+  const size_t m = 4 << 20;
+  char* r = static_cast<char*>(mystl::large_alloc::allocate(m));
+  r[0] = 1;
+  r[m - 1] = 2;
+  if (mystl::large_alloc::try_expand(r, m, 2 * m))
+    r[2 * m - 1] = 3;
+  else
+    r = static_cast<char*>(mystl::large_alloc::reallocate(r, m, 2 * m));
+  r = static_cast<char*>(mystl::large_alloc::reallocate(r, 2 * m, 16 * m));
+  EXPECT_EQ(1, r[0]);
+  EXPECT_EQ(2, r[m - 1]);
+  r[16 * m - 1] = 4;
+  r = static_cast<char*>(mystl::large_alloc::reallocate(r, 16 * m, m));
+  EXPECT_EQ(2, r[m - 1]);
+  mystl::large_alloc::deallocate(r, m);
+
+  mystl::vector<int> v(3 * mystl::large_alloc::threshold() / sizeof(int), 1);
+  v.push_back(2);
+  EXPECT_EQ(2, v.back());
+  EXPECT_EQ(1, v.front());
+}
+
+// 生产者线程构造链表，交给消费者线程销毁
+TEST(pthread_allocator_test)
+{
+  typedef mystl::list<int, mystl::pthread_allocator<int>> list_type;
+  std::mutex m;
+  std::condition_variable cv;
+  std::vector<list_type*> queue;
+  bool done = false;
+  long long sum = 0;
+  std::thread consumer([&]() {
+    for (;;)
+    {
+      std::unique_lock<std::mutex> lk(m);
+      cv.wait(lk, [&]() { return done || !queue.empty(); });
+      if (queue.empty())
+        break;
+      list_type* l = queue.back();
+      queue.pop_back();
+      lk.unlock();
+      for (auto x : *l)
+        sum += x;
+      delete l;
+    }
+  });
+  for (int i = 0; i < 100; ++i)
+  {
+    list_type* l = new list_type;
+    for (int j = 0; j < 1000; ++j)
+      l->push_back(j);
+    std::lock_guard<std::mutex> lk(m);
+    queue.push_back(l);
+    cv.notify_one();
+  }
+  {
+    std::lock_guard<std::mutex> lk(m);
+    done = true;
+  }
+  cv.notify_one();
+  consumer.join();
+  EXPECT_EQ(100LL * 999 * 1000 / 2, sum);
+
+  mystl::pthread_allocator<double> a;
+  mystl::pthread_allocator<char> b(a);
+  EXPECT_TRUE(a == b);
+  double* p = a.allocate(10);
+  p[9] = 1.0;
+  a.deallocate(p, 10);
+}
+
+// 分配 count 个 size 大小的区块，再全部释放，重复 rounds 次
+#define ALLOC_DO_TEST(allocate_fun, deallocate_fun, size, count) do {  \
+  char buf[10];                                                        \
+  clock_t start, end;                                                  \
+  std::vector<void*> blocks(count);                                    \
+  start = clock();                                                     \
+  for (size_t round = 0; round < 10; ++round) {                        \
+    for (size_t i = 0; i < count; ++i)                                 \
+      blocks[i] = allocate_fun(size);                                  \
+    for (size_t i = 0; i < count; ++i)                                 \
+      deallocate_fun(blocks[i], size);                                 \
+  }                                                                    \
+  end = clock();                                                       \
+  int n = static_cast<int>(static_cast<double>(end - start)            \
+      / CLOCKS_PER_SEC * 1000);                                        \
+  std::snprintf(buf, sizeof(buf), "%d", n);                            \
+  std::string t = buf;                                                 \
+  t += "ms    |";                                                      \
+  std::cout << std::setw(WIDE) << t;                                   \
+} while(0)
+
+inline void* operator_new_allocate(size_t n)
+{
+  return ::operator new(n);
+}
+
+inline void operator_delete_deallocate(void* p, size_t)
+{
+  ::operator delete(p);
+}
+
+#define ALLOC_TEST(size, len1, len2, len3)                                       \
+  TEST_LEN(len1, len2, len3, WIDE);                                              \
+  std::cout << "|    operator new     |";                                        \
+  ALLOC_DO_TEST(operator_new_allocate, operator_delete_deallocate, size, len1);  \
+  ALLOC_DO_TEST(operator_new_allocate, operator_delete_deallocate, size, len2);  \
+  ALLOC_DO_TEST(operator_new_allocate, operator_delete_deallocate, size, len3);  \
+  std::cout << "\n|     mystl::alloc    |";                                     \
+  ALLOC_DO_TEST(mystl::alloc::allocate, mystl::alloc::deallocate, size, len1);   \
+  ALLOC_DO_TEST(mystl::alloc::allocate, mystl::alloc::deallocate, size, len2);   \
+  ALLOC_DO_TEST(mystl::alloc::allocate, mystl::alloc::deallocate, size, len3);
+
+// 生产者线程构造 count 个节点（每个链表 1000 个），消费者线程销毁，返回耗时
+template <class Alloc>
+void handoff_do_test(size_t count)
+{
+  typedef mystl::list<int, Alloc> list_type;
+  char buf[10];
+  clock_t start, end;
+  std::mutex m;
+  std::condition_variable cv;
+  std::vector<list_type*> queue;
+  bool done = false;
+  start = clock();
+  std::thread consumer([&]() {
+    for (;;)
+    {
+      std::unique_lock<std::mutex> lk(m);
+      cv.wait(lk, [&]() { return done || !queue.empty(); });
+      if (queue.empty())
+        break;
+      std::vector<list_type*> batch;
+      batch.swap(queue);
+      lk.unlock();
+      for (size_t i = 0; i < batch.size(); ++i)
+        delete batch[i];
+    }
+  });
+  for (size_t i = 0; i < count / 1000; ++i)
+  {
+    list_type* l = new list_type;
+    for (int j = 0; j < 1000; ++j)
+      l->push_back(j);
+    std::lock_guard<std::mutex> lk(m);
+    queue.push_back(l);
+    cv.notify_one();
+  }
+  {
+    std::lock_guard<std::mutex> lk(m);
+    done = true;
+  }
+  cv.notify_one();
+  consumer.join();
+  end = clock();
+  int n = static_cast<int>(static_cast<double>(end - start) / CLOCKS_PER_SEC * 1000);
+  std::snprintf(buf, sizeof(buf), "%d", n);
+  std::string t = buf;
+  t += "ms    |";
+  std::cout << std::setw(WIDE) << t;
+}
+
+void alloc_test()
+{
+  std::cout << "[===============================================================]\n";
+  std::cout << "[------------------ Run allocator test : alloc -----------------]\n";
+#if PERFORMANCE_TEST_ON
+  std::cout << "[--------------------- Performance Testing ---------------------]\n";
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  std::cout << "|   24 bytes x 10     |";
+  ALLOC_TEST(24, SCALE_SS(LEN1), SCALE_SS(LEN2), SCALE_SS(LEN3));
+  std::cout << "\n";
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  std::cout << "|   48 bytes x 10     |";
+  ALLOC_TEST(48, SCALE_SS(LEN1), SCALE_SS(LEN2), SCALE_SS(LEN3));
+  std::cout << "\n";
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  std::cout << "|  list handoff x 1   |";
+  TEST_LEN(LEN1, LEN2, LEN3, WIDE);
+  std::cout << "|  mystl::allocator   |";
+  handoff_do_test<mystl::allocator<int>>(LEN1);
+  handoff_do_test<mystl::allocator<int>>(LEN2);
+  handoff_do_test<mystl::allocator<int>>(LEN3);
+  std::cout << "\n|  pthread_allocator  |";
+  handoff_do_test<mystl::pthread_allocator<int>>(LEN1);
+  handoff_do_test<mystl::pthread_allocator<int>>(LEN2);
+  handoff_do_test<mystl::pthread_allocator<int>>(LEN3);
+  std::cout << "\n";
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  PASSED;
+#endif
+  std::cout << "[------------------ End allocator test : alloc -----------------]\n";
+}
+
+} // namespace alloc_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_ALLOC_TEST_H_
+
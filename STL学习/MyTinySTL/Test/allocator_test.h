@@ -0,0 +1,599 @@
+﻿#ifndef MYTINYSTL_ALLOCATOR_TEST_H_
+#define MYTINYSTL_ALLOCATOR_TEST_H_
+
+// allocator test : 测试容器对带状态分配器的支持，以及 allocator_traits 的传递规则
+
+#include <new>
+#include <memory>
+#include <vector>
+
+#include "../MyTinySTL/alloc_stats.h"
+#include "../MyTinySTL/astring.h"
+#include "../MyTinySTL/deque.h"
+#include "../MyTinySTL/list.h"
+#include "../MyTinySTL/map.h"
+#include "../MyTinySTL/node_slab.h"
+#include "../MyTinySTL/set.h"
+#include "../MyTinySTL/unordered_map.h"
+#include "../MyTinySTL/unordered_set.h"
+#include "../MyTinySTL/vector.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace allocator_test
+{
+
+// 一个简单的 bump arena：只向前分配，析构时一次性释放所有内存
+class arena
+{
+public:
+  explicit arena(size_t chunk = 4096)
+    :chunk_(chunk), cur_(nullptr), left_(0), live_(0), total_(0)
+  {
+  }
+  ~arena()
+  {
+    for (size_t i = 0; i < chunks_.size(); ++i)
+      ::operator delete(chunks_[i]);
+  }
+
+  arena(const arena&) = delete;
+  arena& operator=(const arena&) = delete;
+
+  void* allocate(size_t n)
+  {
+    n = (n + 15) & ~static_cast<size_t>(15);
+    if (n > left_)
+    {
+      const size_t sz = n > chunk_ ? n : chunk_;
+      cur_ = static_cast<char*>(::operator new(sz));
+      chunks_.push_back(cur_);
+      left_ = sz;
+    }
+    void* p = cur_;
+    cur_ += n;
+    left_ -= n;
+    ++live_;
+    ++total_;
+    return p;
+  }
+  void deallocate(void* p)
+  {
+    if (p != nullptr)
+      --live_;
+  }
+
+  size_t live() const  { return live_; }   // 尚未归还的区块数
+  size_t total() const { return total_; }  // 累计分配次数
+
+private:
+  size_t             chunk_;
+  char*              cur_;
+  size_t             left_;
+  size_t             live_;
+  size_t             total_;
+  std::vector<char*> chunks_;
+};
+
+// 从 arena 分配内存的分配器，不同 arena 的分配器互不相等，且不随容器赋值/交换传递
+template <class T>
+class arena_allocator
+{
+public:
+  typedef T         value_type;
+  typedef T*        pointer;
+  typedef const T*  const_pointer;
+  typedef size_t    size_type;
+  typedef ptrdiff_t difference_type;
+
+  template <class U>
+  friend class arena_allocator;
+
+  explicit arena_allocator(arena* a) noexcept : arena_(a) {}
+  template <class U>
+  arena_allocator(const arena_allocator<U>& rhs) noexcept : arena_(rhs.arena_) {}
+
+  T* allocate(size_type n)
+  {
+    if (n == 0)
+      return nullptr;
+    return static_cast<T*>(arena_->allocate(n * sizeof(T)));
+  }
+  void deallocate(T* p, size_type)
+  { arena_->deallocate(p); }
+
+  arena* resource() const noexcept { return arena_; }
+
+  template <class U>
+  bool operator==(const arena_allocator<U>& rhs) const noexcept
+  { return arena_ == rhs.arena_; }
+  template <class U>
+  bool operator!=(const arena_allocator<U>& rhs) const noexcept
+  { return arena_ != rhs.arena_; }
+
+private:
+  arena* arena_;
+};
+
+// 与 arena_allocator 相同，但在赋值与交换时随容器传递
+template <class T>
+class propagating_allocator : public arena_allocator<T>
+{
+public:
+  typedef std::true_type propagate_on_container_copy_assignment;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+
+  template <class U>
+  struct rebind { typedef propagating_allocator<U> other; };
+
+  explicit propagating_allocator(arena* a) noexcept : arena_allocator<T>(a) {}
+  template <class U>
+  propagating_allocator(const propagating_allocator<U>& rhs) noexcept
+    : arena_allocator<T>(arena_allocator<U>(rhs)) {}
+};
+
+TEST(allocator_traits_test)
+{
+  typedef mystl::allocator_traits<mystl::allocator<int>>  std_traits;
+  typedef mystl::allocator_traits<arena_allocator<int>>   arena_traits;
+  typedef arena_traits::rebind_alloc<double>              rebound;
+  typedef mystl::allocator_traits<propagating_allocator<int>>::rebind_alloc<char> prebound;
+  EXPECT_TRUE(std_traits::is_always_equal::value);
+  EXPECT_FALSE(arena_traits::is_always_equal::value);
+  EXPECT_FALSE(arena_traits::propagate_on_container_swap::value);
+  EXPECT_TRUE((std::is_same<rebound, arena_allocator<double>>::value));
+  EXPECT_TRUE((std::is_same<prebound, propagating_allocator<char>>::value));
+  EXPECT_TRUE(mystl::allocator_traits<prebound>::propagate_on_container_move_assignment::value);
+}
+
+// 每种容器都从 arena 分配内存，析构后归还所有区块
+TEST(allocator_container_test)
+{
+  arena ar;
+  {
+    arena_allocator<int> a(&ar);
+    mystl::vector<int, arena_allocator<int>> v(a);
+    for (int i = 0; i < 100; ++i)
+      v.push_back(i);
+    mystl::list<int, arena_allocator<int>> l(v.begin(), v.end(), a);
+    mystl::deque<int, arena_allocator<int>> d(v.begin(), v.end(), a);
+    typedef mystl::pair<const int, int> value_t;
+    mystl::map<int, int, mystl::less<int>, arena_allocator<value_t>> m{ arena_allocator<value_t>(a) };
+    mystl::unordered_map<int, int, mystl::hash<int>, mystl::equal_to<int>,
+      arena_allocator<value_t>> um{ arena_allocator<value_t>(a) };
+    mystl::set<int, mystl::less<int>, arena_allocator<int>> s(v.begin(), v.end(), a);
+    mystl::basic_string<char, mystl::char_traits<char>, arena_allocator<char>>
+      str("arena string", arena_allocator<char>(a));
+    for (int i = 0; i < 100; ++i)
+    {
+      m[i] = i;
+      um[i] = i;
+      d.push_front(i);
+      str += 'x';
+    }
+    EXPECT_EQ(100, v.size());
+    EXPECT_EQ(100, l.size());
+    EXPECT_EQ(200, d.size());
+    EXPECT_EQ(100, m.size());
+    EXPECT_EQ(100, um.size());
+    EXPECT_EQ(100, s.size());
+    EXPECT_EQ(112, str.size());
+    EXPECT_TRUE(&ar == v.get_allocator().resource());
+    EXPECT_TRUE(&ar == l.get_allocator().resource());
+    EXPECT_TRUE(&ar == str.get_allocator().resource());
+    EXPECT_TRUE(ar.total() > 100);  // map、set、unordered_map 的节点成批分配
+    auto v2 = v;  // 复制构造沿用原容器的分配器
+    EXPECT_TRUE(&ar == v2.get_allocator().resource());
+  }
+  EXPECT_EQ(0, ar.live());
+}
+
+// 分配器不传递且不相等时，赋值只移动/复制元素，不接管对方的内存
+TEST(allocator_no_propagate_test)
+{
+  arena ar1, ar2;
+  {
+    typedef arena_allocator<int> alloc_t;
+    mystl::vector<int, alloc_t> v1(10, 1, alloc_t(&ar1));
+    mystl::vector<int, alloc_t> v2(20, 2, alloc_t(&ar2));
+    v1 = mystl::move(v2);
+    EXPECT_EQ(20, v1.size());
+    EXPECT_EQ(2, v1[19]);
+    EXPECT_TRUE(&ar1 == v1.get_allocator().resource());
+
+    mystl::list<int, alloc_t> l1(5, 1, alloc_t(&ar1));
+    mystl::list<int, alloc_t> l2(8, 2, alloc_t(&ar2));
+    l1 = l2;
+    EXPECT_EQ(8, l1.size());
+    l1 = mystl::move(l2);
+    EXPECT_EQ(8, l1.size());
+    EXPECT_TRUE(&ar1 == l1.get_allocator().resource());
+
+    mystl::deque<int, alloc_t> d1(5, 1, alloc_t(&ar1));
+    mystl::deque<int, alloc_t> d2(300, 2, alloc_t(&ar2));
+    d1 = mystl::move(d2);
+    EXPECT_EQ(300, d1.size());
+    EXPECT_TRUE(&ar1 == d1.get_allocator().resource());
+
+    mystl::set<int, mystl::less<int>, alloc_t> s1{ alloc_t(&ar1) };
+    mystl::set<int, mystl::less<int>, alloc_t> s2{ alloc_t(&ar2) };
+    for (int i = 0; i < 50; ++i)
+      s2.insert(i);
+    s1 = mystl::move(s2);
+    EXPECT_EQ(50, s1.size());
+    EXPECT_TRUE(&ar1 == s1.get_allocator().resource());
+  }
+  EXPECT_EQ(0, ar1.live());
+  EXPECT_EQ(0, ar2.live());
+}
+
+// 分配器传递时，赋值与交换会连同分配器一起接管对方的内存
+TEST(allocator_propagate_test)
+{
+  arena ar1, ar2;
+  {
+    typedef propagating_allocator<int> alloc_t;
+    mystl::vector<int, alloc_t> v1(10, 1, alloc_t(&ar1));
+    mystl::vector<int, alloc_t> v2(20, 2, alloc_t(&ar2));
+    auto p = v2.data();
+    v1 = mystl::move(v2);
+    EXPECT_TRUE(p == v1.data());
+    EXPECT_TRUE(&ar2 == v1.get_allocator().resource());
+
+    mystl::vector<int, alloc_t> v3(5, 3, alloc_t(&ar1));
+    v3 = v1;
+    EXPECT_EQ(20, v3.size());
+    EXPECT_TRUE(&ar2 == v3.get_allocator().resource());
+
+    mystl::list<int, alloc_t> l1(5, 1, alloc_t(&ar1));
+    mystl::list<int, alloc_t> l2(8, 2, alloc_t(&ar2));
+    l1.swap(l2);
+    EXPECT_EQ(8, l1.size());
+    EXPECT_TRUE(&ar2 == l1.get_allocator().resource());
+    EXPECT_TRUE(&ar1 == l2.get_allocator().resource());
+
+    typedef mystl::pair<const int, int> value_t;
+    typedef propagating_allocator<value_t> map_alloc_t;
+    mystl::unordered_map<int, int, mystl::hash<int>, mystl::equal_to<int>, map_alloc_t>
+      um1{ map_alloc_t(&ar1) }, um2{ map_alloc_t(&ar2) };
+    for (int i = 0; i < 50; ++i)
+      um2[i] = i;
+    um1 = um2;
+    EXPECT_EQ(50, um1.size());
+    EXPECT_EQ(49, um1[49]);
+    um1 = mystl::move(um2);
+    EXPECT_EQ(50, um1.size());
+  }
+  EXPECT_EQ(0, ar1.live());
+  EXPECT_EQ(0, ar2.live());
+}
+
+// 扩容时元素按字节搬移，插入的元素可能引用原空间
+TEST(allocator_reallocate_test)
+{
+  typedef mystl::allocator_traits<mystl::allocator<int>> traits;
+  mystl::allocator<int> a;
+  int* p = traits::allocate(a, 10);
+  for (int i = 0; i < 10; ++i)
+    p[i] = i;
+  p = traits::reallocate(a, p, 10, 100000);
+  EXPECT_EQ(9, p[9]);
+  EXPECT_FALSE(traits::try_expand(a, nullptr, 0, 10));
+  traits::deallocate(a, p, 100000);
+
+  // 分配器没有提供 reallocate 时退回分配、复制、释放
+  arena ar;
+  typedef mystl::allocator_traits<arena_allocator<int>> atraits;
+  arena_allocator<int> aa(&ar);
+  int* q = atraits::allocate(aa, 4);
+  q[3] = 3;
+  q = atraits::reallocate(aa, q, 4, 8);
+  EXPECT_EQ(3, q[3]);
+  EXPECT_FALSE(atraits::try_expand(aa, q, 8, 16));
+  atraits::deallocate(aa, q, 8);
+
+  mystl::vector<int> v;
+  v.push_back(7);
+  for (int i = 0; i < 1000; ++i)
+    v.push_back(v[0]);
+  EXPECT_EQ(1001, v.size());
+  EXPECT_EQ(7, v.back());
+  v.shrink_to_fit();
+  v.insert(v.begin() + 1, v[1000] + 1);
+  EXPECT_EQ(8, v[1]);
+  EXPECT_EQ(7, v[2]);
+  v.shrink_to_fit();
+  v.emplace(v.begin(), 5);
+  EXPECT_EQ(5, v[0]);
+  EXPECT_EQ(8, v[2]);
+  v.reserve(5000);
+  EXPECT_EQ(5000, v.capacity());
+  EXPECT_EQ(1003, v.size());
+  EXPECT_EQ(7, v.back());
+
+  mystl::vector<mystl::string> vs;
+  for (int i = 0; i < 100; ++i)
+    vs.emplace_back("a string that is long enough to live on the heap");
+  vs.reserve(1000);
+  EXPECT_TRUE(vs[99] == vs[0]);
+
+  mystl::string s("abc");
+  for (int i = 0; i < 10; ++i)
+    s += s;
+  s.reserve(100000);
+  EXPECT_EQ(3 * 1024, s.size());
+  EXPECT_EQ(0, s.compare(3069, 3, "abc"));
+}
+
+// 节点从连续的区块中切出，释放的节点被复用，clear 时区块归还分配器
+TEST(node_slab_test)
+{
+  arena ar;
+  typedef arena_allocator<int> alloc_t;
+  {
+    mystl::node_slab<mystl::rb_tree_node<int>, arena_allocator<mystl::rb_tree_node<int>>> slab;
+    arena_allocator<mystl::rb_tree_node<int>> a(&ar);
+    auto p1 = slab.allocate(a);
+    auto p2 = slab.allocate(a);
+    EXPECT_TRUE(p2 == p1 + 1);
+    EXPECT_EQ(1, slab.chunk_count());
+    slab.deallocate(p1);
+    EXPECT_TRUE(slab.allocate(a) == p1);
+    for (int i = 0; i < 100; ++i)
+      slab.allocate(a);
+    EXPECT_TRUE(slab.chunk_count() > 1);
+    slab.release(a);
+    EXPECT_EQ(0, slab.chunk_count());
+    EXPECT_EQ(0, ar.live());
+  }
+
+  const size_t before = ar.total();
+  {
+    mystl::set<int, mystl::less<int>, alloc_t> s{ alloc_t(&ar) };
+    mystl::unordered_set<int, mystl::hash<int>, mystl::equal_to<int>, alloc_t> us{ alloc_t(&ar) };
+    for (int i = 0; i < 1000; ++i)
+    {
+      s.insert(i);
+      us.insert(i);
+    }
+    // 1000 个节点只需要二十多个区块
+    EXPECT_TRUE(ar.total() - before < 100);
+    auto first = s.begin();
+    auto second = first;
+    ++second;
+    EXPECT_TRUE(reinterpret_cast<const char*>(&*second) - reinterpret_cast<const char*>(&*first) ==
+                sizeof(mystl::rb_tree_node<int>));
+    for (int i = 0; i < 1000; i += 2)
+    {
+      s.erase(i);
+      us.erase(i);
+    }
+    const size_t mid = ar.total();
+    for (int i = 0; i < 1000; i += 2)
+    {
+      s.insert(i);
+      us.insert(i);
+    }
+    EXPECT_TRUE(ar.total() - mid < 10);  // 只有 bucket 可能重新分配
+    EXPECT_EQ(1000, s.size());
+    EXPECT_EQ(1000, us.size());
+
+    auto s2 = mystl::move(s);
+    mystl::set<int, mystl::less<int>, alloc_t> s3{ alloc_t(&ar) };
+    s3.insert(-1);
+    s3.swap(s2);
+    EXPECT_EQ(1000, s3.size());
+    EXPECT_EQ(1, s2.size());
+    s3.clear();
+    s3.insert(5);
+    EXPECT_EQ(1, s3.size());
+  }
+  EXPECT_EQ(0, ar.live());
+}
+
+// 持有 unique_ptr 的类型，声明为可以平凡搬移
+struct owner
+{
+  std::unique_ptr<int> p;
+  explicit owner(int v) : p(new int(v)) {}
+};
+
+// 记录构造与析构次数的类型，不能平凡搬移
+struct tracked
+{
+  static int alive;
+  int v;
+  tracked(int x) : v(x) { ++alive; }
+  tracked(const tracked& rhs) : v(rhs.v) { ++alive; }
+  tracked(tracked&& rhs) noexcept : v(rhs.v) { ++alive; }
+  tracked& operator=(const tracked& rhs) { v = rhs.v; return *this; }
+  ~tracked() { --alive; }
+};
+int tracked::alive = 0;
+
+} // namespace allocator_test
+} // namespace test
+
+template <>
+struct is_trivially_relocatable<test::allocator_test::owner> : std::true_type {};
+
+namespace test
+{
+namespace allocator_test
+{
+
+TEST(uninitialized_relocate_test)
+{
+  static_assert(mystl::is_trivially_relocatable<int>::value, "");
+  static_assert(!mystl::is_trivially_relocatable<std::string>::value, "");
+  static_assert(mystl::is_trivially_relocatable<std::unique_ptr<int>>::value, "");
+  static_assert(mystl::is_trivially_relocatable<mystl::vector<std::string>>::value, "");
+  static_assert(mystl::is_trivially_relocatable<mystl::pair<int, mystl::string>>::value, "");
+  static_assert(!mystl::is_trivially_relocatable<mystl::pair<int, std::string>>::value, "");
+  static_assert(mystl::is_trivially_relocatable<mystl::vector<int, arena_allocator<int>>>::value, "");
+
+  // 可以平凡搬移：整段搬移，原来的对象不再析构
+  int a[6] = { 1, 2, 3, 4, 0, 0 };
+  EXPECT_TRUE(mystl::uninitialized_relocate(a, a + 4, a + 1) == a + 5);
+  EXPECT_EQ(4, a[4]);
+  EXPECT_TRUE(mystl::uninitialized_relocate_backward(a + 1, a + 5, a + 6) == a + 2);
+  EXPECT_EQ(1, a[2]);
+  EXPECT_EQ(4, a[5]);
+
+  // 不能平凡搬移：移动构造后析构原来的对象
+  {
+    mystl::vector<tracked> v;
+    for (int i = 0; i < 100; ++i)
+      v.emplace_back(i);
+    v.reserve(1000);
+    v.insert(v.begin(), 10, tracked(-1));
+    v.shrink_to_fit();
+    EXPECT_EQ(110, tracked::alive);
+    EXPECT_EQ(99, v.back().v);
+  }
+  EXPECT_EQ(0, tracked::alive);
+
+  mystl::vector<owner> vo;
+  for (int i = 0; i < 1000; ++i)
+    vo.emplace_back(i);
+  vo.reserve(5000);
+  vo.shrink_to_fit();
+  vo.emplace_back(-1);
+  EXPECT_EQ(1001, vo.size());
+  EXPECT_EQ(0, *vo[0].p);
+  EXPECT_EQ(999, *vo[999].p);
+  EXPECT_EQ(-1, *vo.back().p);
+
+  mystl::vector<mystl::vector<int>> vv(3, mystl::vector<int>(3, 7));
+  vv.insert(vv.begin(), 100, mystl::vector<int>(1, 1));
+  EXPECT_EQ(103, vv.size());
+  EXPECT_EQ(7, vv.back().back());
+
+  mystl::deque<int> d;
+  for (int i = 0; i < 100000; ++i)
+    d.push_front(i);
+  for (int i = 0; i < 100000; ++i)
+    d.push_back(i);
+  EXPECT_EQ(99999, d.front());
+  EXPECT_EQ(99999, d.back());
+
+  mystl::string s("abcdef");
+  s.shrink_to_fit();
+  s.insert(s.begin() + 3, 100, 'x');
+  EXPECT_EQ(106, s.size());
+  EXPECT_EQ('c', s[2]);
+  EXPECT_EQ('x', s[102]);
+  EXPECT_EQ('d', s[103]);
+}
+
+// 地址是否按 align bytes 对齐
+inline bool is_aligned(const void* p, size_t align)
+{
+  return reinterpret_cast<uintptr_t>(p) % align == 0;
+}
+
+TEST(aligned_allocator_test)
+{
+  typedef mystl::aligned_allocator<float> float_alloc;
+  EXPECT_EQ(64, float_alloc::alignment);
+  EXPECT_EQ(64, float_alloc::padded_bytes(5));
+  EXPECT_EQ(128, float_alloc::padded_bytes(17));
+  EXPECT_EQ(16, float_alloc::good_size(5));
+  EXPECT_EQ(0, float_alloc::good_size(0));
+  float* p = float_alloc::allocate(5);
+  EXPECT_TRUE(is_aligned(p, 64));
+  p[15] = 1.0f;  // 补齐的部分同样属于这块空间
+  float_alloc::deallocate(p, 5);
+
+  // vector 每次扩容后 data() 都对齐
+  mystl::aligned_vector<float> v;
+  bool aligned = true;
+  for (int i = 0; i < 100000; ++i)
+  {
+    v.push_back(static_cast<float>(i));
+    aligned = aligned && is_aligned(v.data(), 64);
+  }
+  v.shrink_to_fit();
+  EXPECT_TRUE(aligned && is_aligned(v.data(), 64));
+  EXPECT_EQ(99999.0f, v.back());
+  mystl::aligned_vector<double, 128> w(3, 1.5);
+  EXPECT_TRUE(is_aligned(w.data(), 128));
+  mystl::aligned_vector<std::string> s(10, "abc");
+  s.insert(s.begin(), 100, "x");
+  EXPECT_TRUE(is_aligned(s.data(), 64) && s[100] == "abc");
+  mystl::vector<float, float_alloc, mystl::vector_growth_size_class> g;
+  g.push_back(1.0f);
+  EXPECT_EQ(0, g.capacity() % 16);
+
+  // deque 的每一个缓冲区都对齐
+  mystl::aligned_deque<int> d;
+  for (int i = 0; i < 20000; ++i)
+  {
+    d.push_back(i);
+    d.push_front(-i);
+  }
+  aligned = true;
+  for (auto it = d.begin(); it < d.end(); it += static_cast<ptrdiff_t>(d.buffer_size))
+    aligned = aligned && is_aligned(it.first, 64);
+  EXPECT_TRUE(aligned);
+  EXPECT_EQ(19999, d.back());
+  EXPECT_EQ(-19999, d.front());
+}
+
+// 只用于统计测试的类型，保证有独立的统计记录
+struct stats_probe
+{
+  int a[4];
+};
+
+TEST(alloc_stats_test)
+{
+  EXPECT_EQ(0, mystl::alloc_stats::bucket(1));
+  EXPECT_EQ(3, mystl::alloc_stats::bucket(8));
+  EXPECT_EQ(3, mystl::alloc_stats::bucket(15));
+  EXPECT_EQ(EStatsBuckets - 1, mystl::alloc_stats::bucket(static_cast<size_t>(-1)));
+
+  auto& e = mystl::alloc_stats::entry<stats_probe>();
+  EXPECT_TRUE(&e == &mystl::alloc_stats::entry<stats_probe>());
+  EXPECT_TRUE(std::strstr(e.name, "stats_probe") != nullptr);
+  bool found = false;
+  for (auto p = mystl::alloc_stats::head(); p != nullptr; p = p->next)
+    found = found || p == &e;
+  EXPECT_TRUE(found);
+
+  const size_t allocs = e.allocs.load();
+  const size_t live = e.live_bytes.load();
+  mystl::alloc_stats::record_allocate(e, 100);
+  mystl::alloc_stats::record_allocate(e, 300);
+  mystl::alloc_stats::record_deallocate(e, 100);
+  EXPECT_EQ(allocs + 2, e.allocs.load());
+  EXPECT_EQ(live + 300, e.live_bytes.load());
+  EXPECT_TRUE(e.peak_bytes.load() >= live + 400);
+  EXPECT_TRUE(e.hist[mystl::alloc_stats::bucket(300)].load() >= 1);
+  mystl::alloc_stats::record_deallocate(e, 300);
+  EXPECT_EQ(live, e.live_bytes.load());
+
+#ifdef MYSTL_ALLOC_STATS
+  // mystl::allocator 记录每一次分配，容器析构后没有未释放的空间
+  const size_t before = e.allocs.load();
+  {
+    mystl::vector<stats_probe> v;
+    for (int i = 0; i < 100; ++i)
+      v.push_back(stats_probe());
+    EXPECT_TRUE(e.allocs.load() > before);
+    EXPECT_EQ(v.capacity() * sizeof(stats_probe), e.live_bytes.load() - live);
+  }
+  EXPECT_EQ(live, e.live_bytes.load());
+  EXPECT_EQ(e.allocs.load(), e.deallocs.load());
+#endif // MYSTL_ALLOC_STATS
+}
+
+} // namespace allocator_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_ALLOCATOR_TEST_H_
+
@@ -1,11 +1,18 @@
 ﻿#ifndef MYTINYSTL_DEQUE_TEST_H_
 #define MYTINYSTL_DEQUE_TEST_H_
 
-// deque test : 测试 deque 的接口和 push_front/push_back 的性能
+// deque test : 测试 deque 的接口和 push_front/push_back、队列式 push_back/pop_front、逐段算法、批量放入取出的性能
 
 #include <deque>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
+#include "../MyTinySTL/algorithm.h"
 #include "../MyTinySTL/deque.h"
+#include "../MyTinySTL/numeric.h"
+#include "../MyTinySTL/vector.h"
 #include "test.h"
 
 namespace mystl
@@ -15,12 +22,315 @@ namespace test
 namespace deque_test
 {
 
+// 统计 allocate 调用次数的分配器，每种 T 单独计数
+template <class T>
+class counting_allocator
+{
+public:
+  typedef T         value_type;
+  typedef T*        pointer;
+  typedef const T*  const_pointer;
+  typedef size_t    size_type;
+  typedef ptrdiff_t difference_type;
+
+  counting_allocator() noexcept {}
+  template <class U>
+  counting_allocator(const counting_allocator<U>&) noexcept {}
+
+  static size_t& count()
+  {
+    static size_t n = 0;
+    return n;
+  }
+
+  T* allocate(size_type n)
+  {
+    ++count();
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+  }
+  void deallocate(T* p, size_type)
+  { ::operator delete(p); }
+};
+
+template <class T, class U>
+bool operator==(const counting_allocator<T>&, const counting_allocator<U>&) noexcept
+{ return true; }
+template <class T, class U>
+bool operator!=(const counting_allocator<T>&, const counting_allocator<U>&) noexcept
+{ return false; }
+
+// 指定缓冲区大小后，与 std::deque 做相同的操作
+TEST(deque_block_size_test)
+{
+  mystl::deque<int, mystl::allocator<int>, 4> d;
+  std::deque<int> ref;
+  EXPECT_EQ(4, d.buffer_size);
+  srand(17);
+  for (int i = 0; i < 2000; ++i)
+  {
+    const int op = rand() % 6;
+    if (op < 2)
+    {
+      d.push_back(i);
+      ref.push_back(i);
+    }
+    else if (op < 4)
+    {
+      d.push_front(i);
+      ref.push_front(i);
+    }
+    else if (op == 4 && !ref.empty())
+    {
+      d.pop_front();
+      ref.pop_front();
+    }
+    else if (!ref.empty())
+    {
+      d.pop_back();
+      ref.pop_back();
+    }
+  }
+  EXPECT_CON_EQ(ref, d);
+  d.insert(d.begin() + d.size() / 2, 10, -1);
+  ref.insert(ref.begin() + ref.size() / 2, 10, -1);
+  d.erase(d.begin() + 3, d.begin() + 20);
+  ref.erase(ref.begin() + 3, ref.begin() + 20);
+  EXPECT_CON_EQ(ref, d);
+  mystl::deque<int, mystl::allocator<int>, 4> c(d);
+  d.shrink_to_fit();
+  EXPECT_TRUE(c == d);
+  d.clear();
+  EXPECT_TRUE(d.empty());
+}
+
+// 队列式的 push_back / pop_front 复用空闲缓冲区与 map，不再反复申请
+TEST(deque_buffer_reuse_test)
+{
+  typedef counting_allocator<int>  alloc_t;
+  typedef counting_allocator<int*> map_alloc_t;
+  {
+    mystl::deque<int, alloc_t, 16> q;
+    for (int i = 0; i < 40; ++i)
+      q.push_back(i);
+    const size_t buffers = alloc_t::count();
+    const size_t maps = map_alloc_t::count();
+    for (int i = 0; i < 100000; ++i)
+    {
+      q.push_back(i);
+      q.pop_front();
+    }
+    EXPECT_EQ(40, q.size());
+    EXPECT_EQ(99999, q.back());
+    EXPECT_TRUE(alloc_t::count() - buffers <= 2);
+    EXPECT_TRUE(map_alloc_t::count() - maps <= 1);
+    q.clear();
+    for (int i = 0; i < 40; ++i)
+      q.push_back(i);
+    EXPECT_TRUE(alloc_t::count() - buffers <= 3);
+  }
+}
+
+// 逐段处理的 copy / copy_backward / fill / find / accumulate 与逐个元素处理的结果相同
+TEST(deque_segmented_algorithm_test)
+{
+  typedef mystl::deque<int, mystl::allocator<int>, 8> deque_t;
+  std::vector<int> src(100);
+  std::iota(src.begin(), src.end(), 0);
+  deque_t d(src.data(), src.data() + src.size());
+  std::deque<int> ref(src.begin(), src.end());
+  for (int i = 0; i < 3; ++i)
+  { // 让首元素不在缓冲区开头
+    d.push_front(-1);
+    ref.push_front(-1);
+  }
+
+  deque_t out(d.size(), 0);
+  EXPECT_TRUE(mystl::copy(d.begin(), d.end(), out.begin()) == out.end());
+  EXPECT_CON_EQ(ref, out);
+  std::vector<int> v(d.size());
+  EXPECT_TRUE(mystl::copy(d.begin() + 5, d.end(), v.data()) == v.data() + d.size() - 5);
+  EXPECT_TRUE(std::equal(ref.begin() + 5, ref.end(), v.begin()));
+  auto it = mystl::copy(src.data(), src.data() + 20, out.begin() + 7);
+  EXPECT_TRUE(it == out.begin() + 27);
+  EXPECT_EQ(19, *(it - 1));
+
+  // 同一个 deque 中重叠的区间
+  mystl::copy(d.begin() + 10, d.end(), d.begin() + 1);
+  std::copy(ref.begin() + 10, ref.end(), ref.begin() + 1);
+  EXPECT_CON_EQ(ref, d);
+  EXPECT_TRUE(mystl::copy_backward(d.begin(), d.begin() + 50, d.begin() + 61) == d.begin() + 11);
+  std::copy_backward(ref.begin(), ref.begin() + 50, ref.begin() + 61);
+  EXPECT_CON_EQ(ref, d);
+  mystl::copy_backward(src.data(), src.data() + 30, d.end());
+  std::copy_backward(src.begin(), src.begin() + 30, ref.end());
+  EXPECT_CON_EQ(ref, d);
+
+  mystl::fill(d.begin() + 3, d.begin() + 40, 7);
+  std::fill(ref.begin() + 3, ref.begin() + 40, 7);
+  EXPECT_TRUE(mystl::fill_n(d.begin() + 41, 2, 9) == d.begin() + 43);
+  std::fill_n(ref.begin() + 41, 2, 9);
+  EXPECT_CON_EQ(ref, d);
+
+  EXPECT_EQ(std::accumulate(ref.begin(), ref.end(), 0),
+            mystl::accumulate(d.begin(), d.end(), 0));
+  EXPECT_EQ(std::accumulate(ref.begin() + 9, ref.begin() + 12, 1, std::multiplies<int>()),
+            mystl::accumulate(d.begin() + 9, d.begin() + 12, 1, std::multiplies<int>()));
+  EXPECT_TRUE(mystl::find(d.begin(), d.end(), 9) == d.begin() + 41);
+  EXPECT_TRUE(mystl::find(d.begin(), d.end(), 1000) == d.end());
+  EXPECT_TRUE(mystl::find(d.begin() + 44, d.begin() + 60, 9) == d.begin() + 60);
+  const deque_t& cd = d;
+  EXPECT_TRUE(mystl::find(cd.begin(), cd.end(), ref.back()) == cd.end() - 1);
+
+  mystl::deque<std::string> sd(20, "a");
+  mystl::fill(sd.begin() + 2, sd.end(), std::string("b"));
+  mystl::deque<std::string> sc(20);
+  mystl::copy(sd.begin(), sd.end(), sc.begin());
+  EXPECT_TRUE(sc[1] == "a" && sc[19] == "b");
+}
+
+// push_back_n / pop_front_n 跨越多个缓冲区，结果与逐个 push_back / pop_front 相同
+TEST(deque_bulk_test)
+{
+  typedef mystl::deque<int, mystl::allocator<int>, 8> deque_t;
+  std::vector<int> src(100);
+  std::iota(src.begin(), src.end(), 0);
+  deque_t d;
+  std::deque<int> ref;
+  d.push_back(-1);
+  d.pop_front();
+  d.push_back_n(src.data(), src.data() + 3);
+  d.push_back_n(src.data(), src.data() + 100);
+  ref.insert(ref.end(), src.begin(), src.begin() + 3);
+  ref.insert(ref.end(), src.begin(), src.end());
+  EXPECT_CON_EQ(ref, d);
+
+  std::vector<int> out(103, 0);
+  EXPECT_TRUE(d.pop_front_n(out.data(), 5) == out.data() + 5);
+  EXPECT_TRUE(d.pop_front_n(out.data() + 5, 45) == out.data() + 50);
+  EXPECT_TRUE(std::equal(ref.begin(), ref.begin() + 50, out.begin()));
+  ref.erase(ref.begin(), ref.begin() + 50);
+  EXPECT_CON_EQ(ref, d);
+  d.pop_front_n(out.data(), d.size());
+  EXPECT_TRUE(d.empty());
+  d.push_back_n(src.data(), src.data() + 20);
+  EXPECT_EQ(20, d.size());
+  EXPECT_EQ(19, d.back());
+
+  mystl::deque<std::string, mystl::allocator<std::string>, 4> sd;
+  mystl::vector<std::string> strs(10, "bulk");
+  sd.push_back_n(strs.begin(), strs.end());
+  std::vector<std::string> sout(7);
+  sd.pop_front_n(sout.begin(), 7);
+  EXPECT_TRUE(sd.size() == 3 && sd.front() == "bulk" && sout[6] == "bulk");
+
+  // 构造中途抛出异常时 deque 不变
+  mystl::deque<throw_on_copy, mystl::allocator<throw_on_copy>, 4> td;
+  td.push_back(throw_on_copy(1));
+  std::vector<throw_on_copy> tsrc(src.begin(), src.begin() + 10);
+  throw_on_copy::copies() = 7;
+  bool thrown = false;
+  try
+  {
+    td.push_back_n(tsrc.data(), tsrc.data() + 10);
+  }
+  catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  EXPECT_TRUE(thrown);
+  EXPECT_EQ(1, td.size());
+  EXPECT_EQ(1, td.back().value);
+  throw_on_copy::copies() = 0;
+}
+
+// 性能测试：保持 live 个元素，反复 push_back / pop_front，共 n 次
+#define DEQUE_CHURN_TEST(live, n, ...) do {                  \
+  __VA_ARGS__ q;                                             \
+  for (size_t i = 0; i < live; ++i)                          \
+    q.push_back(static_cast<int>(i));                        \
+  clock_t start, end;                                        \
+  char buf[10];                                              \
+  start = clock();                                           \
+  for (size_t i = 0; i < n; ++i)                             \
+  {                                                          \
+    q.push_back(static_cast<int>(i));                        \
+    q.pop_front();                                           \
+  }                                                          \
+  end = clock();                                             \
+  int t = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", t);                  \
+  std::string s = buf;                                       \
+  s += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << s;                         \
+} while(0)
+
+// 性能测试：每批 batch 个元素，用 fun 放入后再全部取出，共 n 个元素
+#define DEQUE_BATCH_TEST(fun, batch, n, ...) do {            \
+  std::vector<int> in(batch, 1), out(batch);                 \
+  __VA_ARGS__ q;                                             \
+  clock_t start, end;                                        \
+  char buf[10];                                              \
+  start = clock();                                           \
+  for (size_t r = 0; r < n / batch; ++r)                     \
+  {                                                          \
+    fun(q, in, out, batch);                                  \
+  }                                                          \
+  end = clock();                                             \
+  int t = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", t);                  \
+  std::string s = buf;                                       \
+  s += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << s;                         \
+} while(0)
+
+// 逐个元素放入、取出
+template <class Deque>
+void batch_one_by_one(Deque& q, std::vector<int>& in, std::vector<int>& out, size_t batch)
+{
+  for (size_t i = 0; i < batch; ++i)
+    q.push_back(in[i]);
+  for (size_t i = 0; i < batch; ++i)
+  {
+    out[i] = q.front();
+    q.pop_front();
+  }
+}
+
+// 使用 push_back_n / pop_front_n
+template <class Deque>
+void batch_bulk(Deque& q, std::vector<int>& in, std::vector<int>& out, size_t batch)
+{
+  q.push_back_n(in.data(), in.data() + batch);
+  q.pop_front_n(out.data(), batch);
+}
+
+// 性能测试：把语句重复执行 20 次
+#define DEQUE_ALGO_TEST(...) do {                            \
+  clock_t start, end;                                        \
+  char buf[10];                                              \
+  start = clock();                                           \
+  for (int r = 0; r < 20; ++r)                               \
+  {                                                          \
+    __VA_ARGS__;                                             \
+  }                                                          \
+  end = clock();                                             \
+  int t = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", t);                  \
+  std::string s = buf;                                       \
+  s += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << s;                         \
+} while(0)
+
 void deque_test()
 {
   std::cout << "[===============================================================]" << std::endl;
   std::cout << "[----------------- Run container test : deque ------------------]" << std::endl;
   std::cout << "[-------------------------- API test ---------------------------]" << std::endl;
   int a[] = { 1,2,3,4,5 };
+  int b[5] = {};
   mystl::deque<int> d1;
   mystl::deque<int> d2(5);
   mystl::deque<int> d3(5, 1);
@@ -51,6 +361,8 @@ void deque_test()
   FUN_AFTER(d1, d1.push_back(2));
   FUN_AFTER(d1, d1.pop_back());
   FUN_AFTER(d1, d1.pop_front());
+  FUN_AFTER(d1, d1.push_back_n(a, a + 5));
+  FUN_AFTER(d1, d1.pop_front_n(b, 2));
   FUN_AFTER(d1, d1.shrink_to_fit());
   FUN_AFTER(d1, d1.resize(5));
   FUN_AFTER(d1, d1.resize(8, 8));
@@ -91,6 +403,68 @@ void deque_test()
   std::cout << std::endl;
   std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
   PASSED;
+  // 队列长度在缓冲区边界附近来回变化
+  const size_t churn = SCALE_LL(LEN3);
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|" << std::setw(12) << churn / 1000000 << "M churn |" << std::setw(WIDE) << "std::deque |"
+    << std::setw(WIDE) << "deque    |" << std::setw(WIDE) << "deque<,,64> |" << std::endl;
+  std::cout << "|   around a block    |";
+  DEQUE_CHURN_TEST(1, churn, std::deque<int>);
+  DEQUE_CHURN_TEST(1, churn, mystl::deque<int>);
+  DEQUE_CHURN_TEST(1, churn, mystl::deque<int, mystl::allocator<int>, 64>);
+  std::cout << std::endl << "|   1000 in flight    |";
+  DEQUE_CHURN_TEST(1000, churn, std::deque<int>);
+  DEQUE_CHURN_TEST(1000, churn, mystl::deque<int>);
+  DEQUE_CHURN_TEST(1000, churn, mystl::deque<int, mystl::allocator<int>, 64>);
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
+  // vector、deque 逐个元素、deque 逐段
+  const size_t len = LEN3;
+  mystl::vector<int> sv(len, 1), tv(len);
+  mystl::deque<int> sd(len, 1), td(len);
+  volatile size_t sink = 0;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|" << std::setw(8) << len / 1000000 << "M ints x 20  |" << std::setw(WIDE) << "vector   |"
+    << std::setw(WIDE) << "deque elem |" << std::setw(WIDE) << "deque seg  |" << std::endl;
+  std::cout << "|        copy         |";
+  DEQUE_ALGO_TEST(mystl::copy(sv.begin(), sv.end(), tv.begin()));
+  DEQUE_ALGO_TEST(mystl::copy_from_segments(sd.begin(), sd.end(), td.begin(), std::false_type()));
+  DEQUE_ALGO_TEST(mystl::copy(sd.begin(), sd.end(), td.begin()));
+  std::cout << std::endl << "|        fill         |";
+  DEQUE_ALGO_TEST(mystl::fill(tv.begin(), tv.end(), 2));
+  DEQUE_ALGO_TEST(mystl::fill_dispatch(td.begin(), td.end(), 2, std::false_type()));
+  DEQUE_ALGO_TEST(mystl::fill(td.begin(), td.end(), 2));
+  std::cout << std::endl << "|        find         |";
+  DEQUE_ALGO_TEST(sink = sink + (mystl::find(sv.begin(), sv.end(), 0) - sv.begin()));
+  DEQUE_ALGO_TEST(sink = sink + (mystl::find_dispatch(sd.begin(), sd.end(), 0, std::false_type())
+                                 - sd.begin()));
+  DEQUE_ALGO_TEST(sink = sink + (mystl::find(sd.begin(), sd.end(), 0) - sd.begin()));
+  std::cout << std::endl << "|     accumulate      |";
+  DEQUE_ALGO_TEST(sink = sink + mystl::accumulate(sv.begin(), sv.end(), 0));
+  DEQUE_ALGO_TEST(sink = sink + mystl::accumulate_plus_dispatch(sd.begin(), sd.end(), 0,
+                                                                std::false_type()));
+  DEQUE_ALGO_TEST(sink = sink + mystl::accumulate(sd.begin(), sd.end(), 0));
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  (void)sink;
+  PASSED;
+  // 批量放入、取出
+  const size_t nbatch = LEN3;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|" << std::setw(8) << nbatch / 1000000 << "M ints batch |" << std::setw(WIDE) << "std::deque |"
+    << std::setw(WIDE) << "deque one  |" << std::setw(WIDE) << "deque bulk |" << std::endl;
+  std::cout << "|     batch of 16     |";
+  DEQUE_BATCH_TEST(batch_one_by_one, 16, nbatch, std::deque<int>);
+  DEQUE_BATCH_TEST(batch_one_by_one, 16, nbatch, mystl::deque<int>);
+  DEQUE_BATCH_TEST(batch_bulk, 16, nbatch, mystl::deque<int>);
+  std::cout << std::endl << "|    batch of 4096    |";
+  DEQUE_BATCH_TEST(batch_one_by_one, 4096, nbatch, std::deque<int>);
+  DEQUE_BATCH_TEST(batch_one_by_one, 4096, nbatch, mystl::deque<int>);
+  DEQUE_BATCH_TEST(batch_bulk, 4096, nbatch, mystl::deque<int>);
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
 #endif
   std::cout << "[----------------- End container test : deque ------------------]" << std::endl;
 }
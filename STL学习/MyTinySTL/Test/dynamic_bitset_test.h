@@ -0,0 +1,234 @@
+#ifndef MYTINYSTL_DYNAMIC_BITSET_TEST_H_
+#define MYTINYSTL_DYNAMIC_BITSET_TEST_H_
+
+// dynamic_bitset test : 测试 dynamic_bitset 的接口，以及逐字与 AVX2 实现的 count、查找、位运算的性能
+
+#include <algorithm>
+#include <vector>
+
+#include "../MyTinySTL/dynamic_bitset.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace dynamic_bitset_test
+{
+
+// 与 std::vector<bool> 对照：设置、统计、查找、改变大小
+TEST(dynamic_bitset_basic_test)
+{
+  const size_t n = 1000;
+  mystl::dynamic_bitset<> b(n);
+  std::vector<bool> ref(n);
+  srand(7);
+  for (size_t i = 0; i < 200; ++i)
+  {
+    const size_t pos = static_cast<size_t>(rand()) % n;
+    b[pos] = true;
+    ref[pos] = true;
+  }
+  b.flip(3);
+  ref[3] = !ref[3];
+  EXPECT_EQ(static_cast<size_t>(std::count(ref.begin(), ref.end(), true)), b.count());
+
+  std::vector<size_t> expect, found;
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (ref[i])
+      expect.push_back(i);
+  }
+  for (size_t i = b.find_first(); i != b.npos; i = b.find_next(i))
+    found.push_back(i);
+  EXPECT_CON_EQ(expect, found);
+
+  b.resize(1030, true);
+  EXPECT_EQ(expect.size() + 30, b.count());
+  EXPECT_TRUE(b[1029] && b.test(1000));
+  b.resize(999);
+  EXPECT_EQ(999, b.size());
+  EXPECT_EQ(expect.size() - (ref[999] ? 1 : 0), b.count());
+  b.push_back(true);
+  b.push_back(false);
+  EXPECT_TRUE(b[999] && !b[1000]);
+  b.pop_back();
+  EXPECT_EQ(1000, b.size());
+
+  mystl::dynamic_bitset<> f(130, true);
+  EXPECT_TRUE(f.all());
+  EXPECT_EQ(130, f.count());
+  f.flip();
+  EXPECT_TRUE(f.none());
+  EXPECT_EQ(f.npos, f.find_first());
+  f.set(129);
+  EXPECT_EQ(129, f.find_first());
+  EXPECT_EQ(f.npos, f.find_next(129));
+  EXPECT_EQ(129, (~f).count());
+}
+
+// 位运算，多余的位保持为 0
+TEST(dynamic_bitset_bitwise_test)
+{
+  mystl::dynamic_bitset<> a(300), b(300);
+  for (size_t i = 0; i < 300; i += 2)
+    a.set(i);
+  for (size_t i = 0; i < 300; i += 3)
+    b.set(i);
+  EXPECT_EQ(50, (a & b).count());
+  EXPECT_EQ(200, (a | b).count());
+  EXPECT_EQ(150, (a ^ b).count());
+  EXPECT_EQ(100, (a - b).count());
+  EXPECT_EQ(150, (~a).count());
+  mystl::dynamic_bitset<> c(a);
+  c ^= a;
+  EXPECT_TRUE(c.none());
+  c |= a;
+  EXPECT_TRUE(c == a);
+  c.reset(0);
+  EXPECT_TRUE(c != a);
+  mystl::dynamic_bitset<> d(std::move(c));
+  EXPECT_TRUE(c.empty());
+  EXPECT_EQ(149, d.count());
+  mystl::swap(a, d);
+  EXPECT_EQ(149, a.count());
+}
+
+// 逐字与 AVX2 的实现结果相同
+TEST(dynamic_bitset_kernel_test)
+{
+  std::vector<uint64_t> x(1027), y(1027);
+  srand(11);
+  for (size_t i = 0; i < x.size(); ++i)
+  {
+    x[i] = (static_cast<uint64_t>(rand()) << 33) ^ (static_cast<uint64_t>(rand()) << 11) ^ rand();
+    y[i] = (static_cast<uint64_t>(rand()) << 31) ^ rand();
+  }
+  x[500] = 0;
+  EXPECT_EQ(mystl::bit_kernel::count_word(x.data(), x.size()),
+            mystl::bit_kernel::count(x.data(), x.size()));
+  std::vector<uint64_t> sparse(1027);
+  sparse[1026] = 4;
+  sparse[700] = 1;
+  EXPECT_EQ(700, mystl::bit_kernel::find_nonzero(sparse.data(), sparse.size(), 0));
+  EXPECT_EQ(1026, mystl::bit_kernel::find_nonzero(sparse.data(), sparse.size(), 701));
+  EXPECT_EQ(1026, mystl::bit_kernel::find_nonzero(sparse.data(), 1026, 701));
+  std::vector<uint64_t> a1 = x, a2 = x;
+  mystl::bit_kernel::and_words(a1.data(), y.data(), x.size());
+  mystl::bit_kernel::and_words_word(a2.data(), y.data(), x.size());
+  EXPECT_CON_EQ(a1, a2);
+  mystl::bit_kernel::xor_words(a1.data(), x.data(), x.size());
+  mystl::bit_kernel::xor_words_word(a2.data(), x.data(), x.size());
+  EXPECT_CON_EQ(a1, a2);
+  mystl::bit_kernel::or_words(a1.data(), y.data(), x.size());
+  mystl::bit_kernel::or_words_word(a2.data(), y.data(), x.size());
+  EXPECT_CON_EQ(a1, a2);
+  mystl::bit_kernel::andnot_words(a1.data(), x.data(), x.size());
+  mystl::bit_kernel::andnot_words_word(a2.data(), x.data(), x.size());
+  EXPECT_CON_EQ(a1, a2);
+}
+
+// 逐个查找置位的元素，返回找到的个数
+size_t scan_bits(const std::vector<bool>& v)
+{
+  size_t hits = 0;
+  for (auto it = std::find(v.begin(), v.end(), true); it != v.end();
+       it = std::find(it + 1, v.end(), true))
+    ++hits;
+  return hits;
+}
+
+// 逐个查找不为 0 的字，返回找到的个数
+template <class Find>
+size_t scan_words(const uint64_t* p, size_t n, Find find)
+{
+  size_t hits = 0;
+  for (size_t i = find(p, n, 0); i != n; i = find(p, n, i + 1))
+    ++hits;
+  return hits;
+}
+
+void dynamic_bitset_test()
+{
+  std::cout << "[===============================================================]\n";
+  std::cout << "[------------- Run container test : dynamic_bitset -------------]\n";
+  std::cout << "[-------------------------- API test ---------------------------]\n";
+  mystl::dynamic_bitset<> b1(70);
+  FUN_VALUE(b1.size());
+  FUN_VALUE(b1.num_words());
+  b1.set(1).set(64).set(69);
+  FUN_VALUE(b1.count());
+  FUN_VALUE(b1.find_first());
+  FUN_VALUE(b1.find_next(1));
+  FUN_VALUE(b1.find_next(64));
+  FUN_VALUE((b1.find_next(69) == b1.npos));
+  b1.flip();
+  FUN_VALUE(b1.count());
+  b1.resize(200, true);
+  FUN_VALUE(b1.count());
+  std::cout << std::boolalpha;
+  FUN_VALUE(mystl::bit_kernel::has_avx2());
+  std::cout << std::noboolalpha;
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  const size_t bits = static_cast<size_t>(SCALE_LL(LEN3));
+  std::vector<bool> sv(bits);
+  mystl::dynamic_bitset<> mb(bits), mc(bits);
+  for (size_t i = 0; i < bits; i += 1000)
+  {
+    sv[i] = true;
+    mb.set(i);
+    mc.set(i + 1);
+  }
+  const uint64_t* p = mb.data();
+  uint64_t* q = mc.data();
+  const size_t words = mb.num_words();
+  volatile size_t sink = 0;
+  std::cout << "[--------------------- Performance Testing ---------------------]\n";
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  std::cout << "|" << std::setw(9) << bits / 1000000 << "M bits x 10 |" << std::setw(WIDE) << "vector<bool> |"
+    << std::setw(WIDE) << "word   |" << std::setw(WIDE) << "avx2   |" << "\n";
+  std::cout << "|        count        |";
+  TIME_DO_TEST(for (int r = 0; r < 10; ++r) { sink = sink + static_cast<size_t>(std::count(sv.begin(), sv.end(), true)); });
+  TIME_DO_TEST(for (int r = 0; r < 10; ++r) { sink = sink + mystl::bit_kernel::count_word(p, words); });
+#if MYSTL_BITSET_AVX2
+  if (mystl::bit_kernel::has_avx2())
+    TIME_DO_TEST(for (int r = 0; r < 10; ++r) { sink = sink + mystl::bit_kernel::count_avx2(p, words); });
+  else
+#endif
+    std::cout << std::setw(WIDE) << "-    |";
+  std::cout << "\n|      find_next      |";
+  TIME_DO_TEST(for (int r = 0; r < 10; ++r) { sink = sink + scan_bits(sv); });
+  TIME_DO_TEST(for (int r = 0; r < 10; ++r) { sink = sink + scan_words(p, words, mystl::bit_kernel::find_nonzero_word); });
+#if MYSTL_BITSET_AVX2
+  if (mystl::bit_kernel::has_avx2())
+    TIME_DO_TEST(for (int r = 0; r < 10; ++r) { sink = sink + scan_words(p, words, mystl::bit_kernel::find_nonzero_avx2); });
+  else
+#endif
+    std::cout << std::setw(WIDE) << "-    |";
+  std::cout << "\n|       or / xor      |";
+  std::cout << std::setw(WIDE) << "-    |";
+  TIME_DO_TEST(for (int r = 0; r < 10; ++r) {
+    mystl::bit_kernel::or_words_word(q, p, words);
+    mystl::bit_kernel::xor_words_word(q, p, words); });
+#if MYSTL_BITSET_AVX2
+  if (mystl::bit_kernel::has_avx2())
+    TIME_DO_TEST(for (int r = 0; r < 10; ++r) {
+      mystl::bit_kernel::or_words_avx2(q, p, words);
+      mystl::bit_kernel::xor_words_avx2(q, p, words); });
+  else
+#endif
+    std::cout << std::setw(WIDE) << "-    |";
+  std::cout << "\n";
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  (void)sink;
+  PASSED;
+#endif
+  std::cout << "[------------- End container test : dynamic_bitset -------------]\n";
+}
+
+} // namespace dynamic_bitset_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_DYNAMIC_BITSET_TEST_H_
+
@@ -0,0 +1,326 @@
+#ifndef MYTINYSTL_FLAT_HASH_MAP_TEST_H_
+#define MYTINYSTL_FLAT_HASH_MAP_TEST_H_
+
+// flat_hash_map test : 测试 flat_hash_map, flat_hash_set 的接口，以及与 unordered_map 的 insert/find/erase 性能对比
+
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <string>
+#include <vector>
+
+#include "../MyTinySTL/flat_hash_map.h"
+#include "../MyTinySTL/flat_hash_set.h"
+#include "../MyTinySTL/unordered_map.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace flat_hash_map_test
+{
+
+// 随机的插入、删除、查找，结果与 std::unordered_map 相同
+TEST(flat_hash_map_random_test)
+{
+  mystl::flat_hash_map<int, int> m;
+  std::unordered_map<int, int> ref;
+  srand(21);
+  bool ok = true;
+  for (int i = 0; i < 200000; ++i)
+  {
+    const int key = rand() % 5000;
+    switch (rand() % 4)
+    {
+      case 0:
+      case 1:
+        ok = ok && m.insert(mystl::make_pair(key, i)).second == ref.insert(std::make_pair(key, i)).second;
+        break;
+      case 2:
+        ok = ok && m.erase(key) == ref.erase(key);
+        break;
+      default:
+      {
+        auto it = m.find(key);
+        auto r = ref.find(key);
+        ok = ok && (it == m.end()) == (r == ref.end()) && (it == m.end() || it->second == r->second);
+      }
+    }
+  }
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(ref.size(), m.size());
+  size_t n = 0;
+  for (auto it = m.begin(); it != m.end(); ++it, ++n)
+    ok = ok && ref.count(it->first) == 1 && ref[it->first] == it->second;
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(ref.size(), n);
+  EXPECT_TRUE(m.load_factor() <= m.max_load_factor());
+
+  // 反复插入、删除不会让表无限增长
+  mystl::flat_hash_map<int, int> churn;
+  for (int i = 0; i < 100000; ++i)
+  {
+    churn[i] = i;
+    if (i >= 50)
+      churn.erase(i - 50);
+  }
+  EXPECT_EQ(50, churn.size());
+  EXPECT_TRUE(churn.bucket_count() < 1024);
+  EXPECT_EQ(99999, churn.at(99999));
+}
+
+// 构造、复制、移动、修改、比较
+TEST(flat_hash_map_modify_test)
+{
+  typedef mystl::flat_hash_map<std::string, std::string, std::hash<std::string>> smap;
+  smap m{ { "a", "1" }, { "b", "2" } };
+  EXPECT_EQ(2, m.size());
+  m["c"] = "3";
+  EXPECT_TRUE(m.at("c") == "3");
+  EXPECT_FALSE(m.try_emplace("a", "x").second);
+  EXPECT_TRUE(m["a"] == "1");
+  EXPECT_TRUE(m.try_emplace("d", 3, 'z').first->second == "zzz");
+  EXPECT_FALSE(m.emplace("d", "w").second);
+  EXPECT_TRUE(m.insert(mystl::make_pair(std::string("e"), std::string("5"))).second);
+  bool thrown = false;
+  try
+  {
+    m.at("none");
+  }
+  catch (const std::out_of_range&)
+  {
+    thrown = true;
+  }
+  EXPECT_TRUE(thrown);
+  EXPECT_EQ(1, m.count("e"));
+  EXPECT_EQ(0, m.count("f"));
+  auto r = m.equal_range("b");
+  EXPECT_TRUE(r.first != r.second && r.first->second == "2");
+
+  smap c(m);
+  EXPECT_TRUE(c == m);
+  c["a"] = "changed";
+  EXPECT_TRUE(c != m);
+  smap mv(mystl::move(c));
+  EXPECT_TRUE(c.empty() && mv["a"] == "changed");
+  c = m;
+  EXPECT_TRUE(c == m);
+  mv = mystl::move(c);
+  EXPECT_TRUE(mv == m && c.empty());
+  mystl::swap(mv, c);
+  EXPECT_TRUE(mv.empty() && c == m);
+
+  for (int i = 0; i < 1000; ++i)
+    c[std::to_string(i)] = std::to_string(i * 2);
+  EXPECT_TRUE(c["999"] == "1998");
+  c.erase(c.begin(), c.end());
+  EXPECT_TRUE(c.empty());
+  c.reserve(5000);
+  const size_t cap = c.bucket_count();
+  for (int i = 0; i < 5000; ++i)
+    c.emplace(std::to_string(i), "v");
+  EXPECT_EQ(cap, c.bucket_count());
+  c.clear();
+  c.rehash(0);
+  EXPECT_EQ(0, c.bucket_count());
+  EXPECT_TRUE(c.begin() == c.end());
+}
+
+// flat_hash_set
+TEST(flat_hash_set_test)
+{
+  int a[] = { 5, 3, 5, 1, 3, 9 };
+  mystl::flat_hash_set<int> s(a, a + 6);
+  std::unordered_set<int> ref(a, a + 6);
+  EXPECT_EQ(ref.size(), s.size());
+  EXPECT_TRUE(s.count(9) == 1 && s.count(2) == 0);
+  EXPECT_FALSE(s.insert(1).second);
+  EXPECT_TRUE(s.emplace(2).second);
+  EXPECT_EQ(1, s.erase(5));
+  EXPECT_EQ(0, s.erase(5));
+  s.erase(s.find(3));
+  mystl::flat_hash_set<int> t{ 1, 2, 9 };
+  EXPECT_TRUE(s == t);
+  mystl::vector<int> v;
+  for (auto it = s.begin(); it != s.end(); ++it)
+    v.push_back(*it);
+  mystl::sort(v.begin(), v.end());
+  int expect[] = { 1, 2, 9 };
+  EXPECT_CON_EQ(expect, v);
+}
+
+// 移动构造可能抛出异常的元素，moves_throw() 为 true 时移动构造抛出异常
+struct throwing_move
+{
+  static bool& moves_throw()
+  {
+    static bool on = false;
+    return on;
+  }
+  int value;
+  throwing_move(int v = 0) : value(v) {}
+  throwing_move(const throwing_move& rhs) : value(rhs.value) {}
+  throwing_move(throwing_move&& rhs) : value(rhs.value)
+  {
+    if (moves_throw())
+      throw std::runtime_error("throwing_move");
+  }
+  throwing_move& operator=(const throwing_move& rhs)
+  {
+    value = rhs.value;
+    return *this;
+  }
+  bool operator==(const throwing_move& rhs) const { return value == rhs.value; }
+};
+
+struct throwing_move_hash
+{
+  size_t operator()(const throwing_move& x) const { return static_cast<size_t>(x.value); }
+};
+
+// 扩容时移动构造可能抛出异常的元素被复制过去；移动赋值在分配器总是相等时不抛出异常
+TEST(flat_hash_set_resize_test)
+{
+  typedef mystl::flat_hash_set<throwing_move, throwing_move_hash> set_t;
+  set_t s;
+  for (int i = 0; i < 100; ++i)
+    s.insert(throwing_move(i));
+  throwing_move::moves_throw() = true;
+  bool thrown = false;
+  try
+  {
+    s.reserve(1000);
+  }
+  catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  throwing_move::moves_throw() = false;
+  EXPECT_FALSE(thrown);
+  EXPECT_EQ(100, s.size());
+  EXPECT_TRUE(s.bucket_count() >= 1000);
+  bool found = true;
+  for (int i = 0; i < 100; ++i)
+    found = found && s.count(throwing_move(i)) == 1;
+  EXPECT_TRUE(found);
+
+  EXPECT_TRUE(std::is_nothrow_move_assignable<set_t>::value);
+  typedef mystl::flat_hash_map<int, std::string> map_t;
+  EXPECT_TRUE(std::is_nothrow_move_assignable<map_t>::value);
+}
+
+// 性能测试：n 个键值，重复 rounds 次 插入全部键值、查找全部键值、删除全部键值，分别计时
+struct hash_bench_time
+{
+  clock_t insert_t;
+  clock_t find_t;
+  clock_t erase_t;
+};
+
+template <class Map>
+hash_bench_time hash_bench(const std::vector<size_t>& keys, size_t n, size_t rounds)
+{
+  hash_bench_time t = { 0, 0, 0 };
+  size_t hit = 0;
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    Map m;
+    const size_t* k = keys.data() + (r * n) % (keys.size() - n + 1);
+    clock_t start = clock();
+    for (size_t i = 0; i < n; ++i)
+      m[k[i]] = i;
+    clock_t mid = clock();
+    for (size_t i = 0; i < n; ++i)
+      hit += m.count(k[i]);
+    clock_t end = clock();
+    t.insert_t += mid - start;
+    t.find_t += end - mid;
+    for (size_t i = 0; i < n; ++i)
+      m.erase(k[i]);
+    t.erase_t += clock() - end;
+  }
+  if (hit != n * rounds)
+    std::cout << "hash_bench: lost keys\n";
+  return t;
+}
+
+inline void hash_bench_print(clock_t t)
+{
+  char buf[10];
+  std::snprintf(buf, sizeof(buf), "%d",
+                static_cast<int>(static_cast<double>(t) / CLOCKS_PER_SEC * 1000));
+  std::string s = buf;
+  s += "ms    |";
+  std::cout << std::setw(WIDE) << s;
+}
+
+void hash_bench_rows(const std::vector<size_t>& keys, size_t n, size_t rounds, const char* label)
+{
+  typedef mystl::unordered_map<size_t, size_t> um_t;
+  typedef std::unordered_map<size_t, size_t>   sm_t;
+  typedef mystl::flat_hash_map<size_t, size_t> fm_t;
+  const hash_bench_time a = hash_bench<um_t>(keys, n, rounds);
+  const hash_bench_time b = hash_bench<sm_t>(keys, n, rounds);
+  const hash_bench_time c = hash_bench<fm_t>(keys, n, rounds);
+  std::cout << "| insert " << label << " |";
+  hash_bench_print(a.insert_t);
+  hash_bench_print(b.insert_t);
+  hash_bench_print(c.insert_t);
+  std::cout << "\n| find   " << label << " |";
+  hash_bench_print(a.find_t);
+  hash_bench_print(b.find_t);
+  hash_bench_print(c.find_t);
+  std::cout << "\n| erase  " << label << " |";
+  hash_bench_print(a.erase_t);
+  hash_bench_print(b.erase_t);
+  hash_bench_print(c.erase_t);
+  std::cout << "\n";
+}
+
+void flat_hash_map_test()
+{
+  std::cout << "[===============================================================]\n";
+  std::cout << "[------------- Run container test : flat_hash_map --------------]\n";
+  std::cout << "[-------------------------- API test ---------------------------]\n";
+  mystl::flat_hash_map<int, int> m1;
+  FUN_VALUE(m1.bucket_count());
+  for (int i = 0; i < 20; ++i)
+    m1[i] = i * i;
+  FUN_VALUE(m1.size());
+  FUN_VALUE(m1.bucket_count());
+  FUN_VALUE(m1.load_factor());
+  FUN_VALUE(m1.at(7));
+  FUN_VALUE(m1.count(20));
+  FUN_VALUE(m1.erase(7));
+  FUN_VALUE(m1.size());
+  m1.reserve(1000);
+  FUN_VALUE(m1.bucket_count());
+  mystl::flat_hash_set<int> s1{ 1, 2, 3 };
+  FUN_VALUE(s1.size());
+  FUN_VALUE(s1.count(2));
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  // 键值互不相同，且散布在整个 64 位空间
+  const size_t total = LEN3;
+  std::vector<size_t> keys(total);
+  for (size_t i = 0; i < total; ++i)
+    keys[i] = (i + 1) * static_cast<size_t>(0x9e3779b97f4a7c15ULL);
+  std::cout << "[--------------------- Performance Testing ---------------------]\n";
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  std::cout << "|    keys x rounds    |" << std::setw(WIDE) << "unordered  |"
+    << std::setw(WIDE) << "std::unord |" << std::setw(WIDE) << "flat_hash  |" << "\n";
+  hash_bench_rows(keys, 1000, total / 1000, "1K x 10K    ");
+  hash_bench_rows(keys, total / 100, 100, "100K x 100  ");
+  hash_bench_rows(keys, total, 1, "10M x 1     ");
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  PASSED;
+#endif
+  std::cout << "[------------- End container test : flat_hash_map --------------]\n";
+}
+
+} // namespace flat_hash_map_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_FLAT_HASH_MAP_TEST_H_
+
@@ -0,0 +1,214 @@
+#ifndef MYTINYSTL_MEMORY_RESOURCE_TEST_H_
+#define MYTINYSTL_MEMORY_RESOURCE_TEST_H_
+
+// memory resource test : 测试 pmr 内存资源与 polymorphic_allocator，
+// 以及请求级容器在 arena 上构造、销毁的性能
+
+#include "../MyTinySTL/memory_resource.h"
+#include "../MyTinySTL/astring.h"
+#include "../MyTinySTL/list.h"
+#include "../MyTinySTL/map.h"
+#include "../MyTinySTL/unordered_map.h"
+#include "../MyTinySTL/vector.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace memory_resource_test
+{
+
+// 记录上游分配与释放的内存资源
+class counting_resource : public mystl::pmr::memory_resource
+{
+public:
+  size_t allocs = 0;
+  size_t deallocs = 0;
+  size_t bytes = 0;
+
+private:
+  void* do_allocate(size_t n, size_t alignment) override
+  {
+    ++allocs;
+    bytes += n;
+    return mystl::pmr::new_delete_resource()->allocate(n, alignment);
+  }
+  void do_deallocate(void* p, size_t n, size_t alignment) override
+  {
+    ++deallocs;
+    bytes -= n;
+    mystl::pmr::new_delete_resource()->deallocate(p, n, alignment);
+  }
+  bool do_is_equal(const mystl::pmr::memory_resource& other) const noexcept override
+  { return this == &other; }
+};
+
+TEST(monotonic_buffer_resource_test)
+{
+  char buf[256];
+  counting_resource up;
+  {
+    mystl::pmr::monotonic_buffer_resource mr(buf, sizeof(buf), &up);
+    void* p1 = mr.allocate(16, 8);
+    void* p2 = mr.allocate(10, 1);
+    void* p3 = mr.allocate(32, 32);
+    EXPECT_TRUE(p1 == buf);
+    EXPECT_TRUE(static_cast<char*>(p2) == buf + 16);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p3) % 32);
+    EXPECT_EQ(0, up.allocs);  // 给定的缓冲区足够时不访问上游
+    mr.deallocate(p1, 16, 8);
+    void* p4 = mr.allocate(1000, 64);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p4) % 64);
+    EXPECT_EQ(1, up.allocs);
+    for (int i = 0; i < 100; ++i)
+      mr.allocate(100);
+    EXPECT_TRUE(up.allocs < 8);  // 缓冲区按几何级数增长
+    mr.release();
+    EXPECT_EQ(up.allocs, up.deallocs);
+    EXPECT_TRUE(mr.allocate(16) == buf);
+  }
+  EXPECT_EQ(up.allocs, up.deallocs);
+  EXPECT_EQ(0, up.bytes);
+
+  mystl::pmr::monotonic_buffer_resource strict(buf, sizeof(buf),
+                                               mystl::pmr::null_memory_resource());
+  bool thrown = false;
+  try
+  {
+    strict.allocate(sizeof(buf) + 1);
+  }
+  catch (std::bad_alloc&)
+  {
+    thrown = true;
+  }
+  EXPECT_TRUE(thrown);
+}
+
+TEST(unsynchronized_pool_resource_test)
+{
+  counting_resource up;
+  {
+    mystl::pmr::pool_options opts;
+    opts.largest_required_pool_block = 512;
+    mystl::pmr::unsynchronized_pool_resource mr(opts, &up);
+    EXPECT_EQ(512, mr.options().largest_required_pool_block);
+    void* p = mr.allocate(24, 8);
+    mr.deallocate(p, 24, 8);
+    void* q = mr.allocate(20, 4);
+    EXPECT_TRUE(p == q);  // 同一级的区块被复用
+    void* a = mr.allocate(64, 64);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(a) % 64);
+    const size_t before = up.allocs;
+    void* big = mr.allocate(10000, 128);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(big) % 128);
+    EXPECT_EQ(before + 1, up.allocs);
+    mr.deallocate(big, 10000, 128);
+    EXPECT_EQ(1, up.deallocs);  // 大区块直接归还上游
+    mr.allocate(20000);         // 未释放的大区块在 release 时归还
+    mr.release();
+    EXPECT_EQ(up.allocs, up.deallocs);
+  }
+  EXPECT_EQ(0, up.bytes);
+}
+
+TEST(polymorphic_allocator_test)
+{
+  counting_resource up;
+  {
+    mystl::pmr::monotonic_buffer_resource mr(&up);
+    mystl::pmr::vector<int> v(&mr);
+    for (int i = 0; i < 1000; ++i)
+      v.push_back(i);
+    mystl::pmr::map<int, mystl::pmr::string> m(&mr);
+    mystl::pmr::unordered_map<int, int> um(&mr);
+    mystl::pmr::list<mystl::pmr::string> l(&mr);
+    for (int i = 0; i < 100; ++i)
+    {
+      m[i] = "value";
+      um[i] = i;
+      l.emplace_back("a string long enough to need its own buffer");
+    }
+    EXPECT_EQ(1000, v.size());
+    EXPECT_EQ(100, m.size());
+    EXPECT_EQ(100, um.size());
+    EXPECT_TRUE(v.get_allocator().resource() == &mr);
+    EXPECT_TRUE(m.get_allocator().resource() == &mr);
+    // 容器中的 pmr::string 使用同一个资源
+    EXPECT_TRUE(l.front().get_allocator().resource() == &mr);
+    EXPECT_TRUE(up.allocs > 0);
+    // 复制构造得到的容器使用默认资源
+    auto v2 = v;
+    EXPECT_TRUE(v2.get_allocator().resource() == mystl::pmr::get_default_resource());
+    EXPECT_CON_EQ(v, v2);
+  }
+  EXPECT_EQ(up.allocs, up.deallocs);
+
+  counting_resource def;
+  auto old = mystl::pmr::set_default_resource(&def);
+  {
+    mystl::pmr::string s("default resource");
+    EXPECT_TRUE(s.get_allocator().resource() == &def);
+  }
+  mystl::pmr::set_default_resource(old);
+  EXPECT_TRUE(def.allocs > 0);
+  EXPECT_EQ(def.allocs, def.deallocs);
+}
+
+#define REQUEST_FILL(m, v, count)                                      \
+  for (size_t i = 0; i < count; ++i) {                                 \
+    m.emplace(static_cast<int>(i), static_cast<int>(i));               \
+    v.push_back(static_cast<int>(i));                                  \
+  }
+
+#define REQUEST_BODY_alloc(count) {                                    \
+  mystl::map<int, int> m;                                              \
+  mystl::vector<int> v;                                                \
+  REQUEST_FILL(m, v, count);                                           \
+}
+
+#define REQUEST_BODY_pool(count) {                                     \
+  mystl::pmr::unsynchronized_pool_resource mr;                         \
+  mystl::pmr::map<int, int> m(&mr);                                    \
+  mystl::pmr::vector<int> v(&mr);                                      \
+  REQUEST_FILL(m, v, count);                                           \
+}
+
+#define REQUEST_BODY_monotonic(count) {                                \
+  mystl::pmr::monotonic_buffer_resource mr;                            \
+  mystl::pmr::map<int, int> m(&mr);                                    \
+  mystl::pmr::vector<int> v(&mr);                                      \
+  REQUEST_FILL(m, v, count);                                           \
+}
+
+// 构造一个 len 个元素的 map 与 vector 再销毁，重复 10 次
+#define REQUEST_TEST(mode, name, len1, len2, len3)                     \
+  std::cout << name;                                                   \
+  TIME_DO_TEST(for (size_t r = 0; r < 10; ++r) REQUEST_BODY_##mode(len1)); \
+  TIME_DO_TEST(for (size_t r = 0; r < 10; ++r) REQUEST_BODY_##mode(len2)); \
+  TIME_DO_TEST(for (size_t r = 0; r < 10; ++r) REQUEST_BODY_##mode(len3)); \
+  std::cout << "\n";
+
+void memory_resource_test()
+{
+  std::cout << "[===============================================================]\n";
+  std::cout << "[--------------- Run memory resource test : pmr ----------------]\n";
+#if PERFORMANCE_TEST_ON
+  std::cout << "[--------------------- Performance Testing ---------------------]\n";
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  std::cout << "|  map + vector x 10  |";
+  TEST_LEN(SCALE_SS(LEN1), SCALE_SS(LEN2), SCALE_SS(LEN3), WIDE);
+  REQUEST_TEST(alloc,     "|   mystl::allocator  |", SCALE_SS(LEN1), SCALE_SS(LEN2), SCALE_SS(LEN3));
+  REQUEST_TEST(pool,      "|    pool resource    |", SCALE_SS(LEN1), SCALE_SS(LEN2), SCALE_SS(LEN3));
+  REQUEST_TEST(monotonic, "|  monotonic resource |", SCALE_SS(LEN1), SCALE_SS(LEN2), SCALE_SS(LEN3));
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  PASSED;
+#endif
+  std::cout << "[--------------- End memory resource test : pmr ----------------]\n";
+}
+
+} // namespace memory_resource_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_MEMORY_RESOURCE_TEST_H_
+
@@ -15,6 +15,25 @@ namespace test
 namespace queue_test
 {
 
+// push_range / pop_range 与逐个 push / pop 的结果相同
+TEST(queue_range_test)
+{
+  int a[] = { 1,2,3,4,5 };
+  mystl::queue<int> q{ 0 };
+  q.push_range(a, a + 5);
+  q.push_range(a, a + 5);
+  EXPECT_EQ(11, q.size());
+  EXPECT_EQ(5, q.back());
+  int out[8] = {};
+  EXPECT_TRUE(q.pop_range(out, 6) == out + 6);
+  EXPECT_EQ(0, out[0]);
+  EXPECT_EQ(5, out[5]);
+  EXPECT_EQ(5, q.size());
+  EXPECT_EQ(1, q.front());
+  q.pop_range(out, q.size());
+  EXPECT_TRUE(q.empty());
+}
+
 void queue_print(mystl::queue<int> q)
 {
   while (!q.empty())
@@ -92,6 +111,8 @@ void queue_test()
   QUEUE_FUN_AFTER(q1, q1.pop());
   QUEUE_FUN_AFTER(q1, q1.emplace(4));
   QUEUE_FUN_AFTER(q1, q1.emplace(5));
+  QUEUE_FUN_AFTER(q1, q1.push_range(a, a + 5));
+  QUEUE_FUN_AFTER(q1, q1.pop_range(a, 3));
   std::cout << std::boolalpha;
   FUN_VALUE(q1.empty());
   std::cout << std::noboolalpha;
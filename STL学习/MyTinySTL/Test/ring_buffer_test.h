@@ -0,0 +1,270 @@
+#ifndef MYTINYSTL_RING_BUFFER_TEST_H_
+#define MYTINYSTL_RING_BUFFER_TEST_H_
+
+// ring_buffer test : 测试 spsc_ring、mpmc_ring 的接口，以及与 mutex + deque 的多线程吞吐量对比
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../MyTinySTL/deque.h"
+#include "../MyTinySTL/queue.h"
+#include "../MyTinySTL/ring_buffer.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace ring_buffer_test
+{
+
+// 单线程：容量、满、空，以及作为 queue 的底层容器
+TEST(ring_buffer_basic_test)
+{
+  mystl::spsc_ring<std::string> r(5);
+  EXPECT_EQ(8, r.capacity());
+  for (int i = 0; i < 8; ++i)
+    EXPECT_TRUE(r.try_push(std::to_string(i)));
+  EXPECT_TRUE(r.full());
+  EXPECT_FALSE(r.try_push("x"));
+  std::string s;
+  EXPECT_TRUE(r.try_pop(s));
+  EXPECT_TRUE(s == "0");
+  EXPECT_TRUE(r.try_emplace(3, 'z'));
+  EXPECT_TRUE(r.back() == "zzz");
+  EXPECT_TRUE(r.front() == "1");
+  r.pop_front();
+  EXPECT_EQ(7, r.size());
+
+  mystl::mpmc_ring<std::string> m(4);
+  EXPECT_TRUE(m.try_push("a") && m.try_push("b") && m.try_emplace(2, 'c') && m.try_push("d"));
+  EXPECT_FALSE(m.try_push("e"));
+  EXPECT_TRUE(m.front() == "a");
+  m.pop_front();
+  EXPECT_TRUE(m.try_pop(s) && s == "b");
+  m.push_back("e");
+  m.clear();
+  EXPECT_TRUE(m.empty());
+  EXPECT_FALSE(m.try_pop(s));
+
+  mystl::queue<int, mystl::spsc_ring<int>> q(16);
+  mystl::queue<int, mystl::mpmc_ring<int>> mq;
+  for (int i = 0; i < 40; ++i)
+  { // 环绕多次
+    q.push(i);
+    mq.emplace(i);
+    q.pop();
+    EXPECT_EQ(i, mq.front());
+    mq.pop();
+  }
+  q.push(1);
+  EXPECT_TRUE(q.front() == 1 && q.back() == 1);
+  EXPECT_TRUE(mq.empty() && q.size() == 1);
+}
+
+// 一个生产者、一个消费者，元素按顺序到达
+TEST(spsc_ring_thread_test)
+{
+  const size_t n = 200000;
+  mystl::spsc_ring<size_t> r(64);
+  size_t sum = 0;
+  bool ordered = true;
+  std::thread consumer([&]() {
+    size_t v = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+      r.pop(v);
+      ordered = ordered && v == i;
+      sum += v;
+    }
+  });
+  for (size_t i = 0; i < n; ++i)
+    r.push_back(i);
+  consumer.join();
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(n * (n - 1) / 2, sum);
+  EXPECT_TRUE(r.empty());
+}
+
+// 多个生产者、多个消费者，每个元素恰好被取出一次
+TEST(mpmc_ring_thread_test)
+{
+  const size_t per = 50000;
+  const size_t threads = 3;
+  mystl::mpmc_ring<size_t> r(128);
+  std::vector<size_t> seen(per * threads);
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t)
+  {
+    workers.push_back(std::thread([&r, t, per]() {
+      for (size_t i = 0; i < per; ++i)
+        r.push_back(t * per + i);
+    }));
+  }
+  std::vector<std::vector<size_t>> got(threads);
+  for (size_t t = 0; t < threads; ++t)
+  {
+    workers.push_back(std::thread([&r, &got, t, per]() {
+      size_t v = 0;
+      for (size_t i = 0; i < per; ++i)
+      {
+        r.pop(v);
+        got[t].push_back(v);
+      }
+    }));
+  }
+  for (auto& w : workers)
+    w.join();
+  bool once = true;
+  for (size_t t = 0; t < threads; ++t)
+  {
+    for (size_t i = 0; i < got[t].size(); ++i)
+      ++seen[got[t][i]];
+  }
+  for (size_t i = 0; i < seen.size(); ++i)
+    once = once && seen[i] == 1;
+  EXPECT_TRUE(once);
+  EXPECT_TRUE(r.empty());
+}
+
+// 性能测试：producers 个线程各放入 n 个元素，consumers 个线程一共取出同样多的元素
+// 以 mutex 保护的 deque 作为对照
+class locked_deque
+{
+public:
+  void push_back(size_t v)
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    d_.push_back(v);
+  }
+  void pop(size_t& v)
+  {
+    unsigned spins = 0;
+    for (;;)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!d_.empty())
+        {
+          v = d_.front();
+          d_.pop_front();
+          return;
+        }
+      }
+      mystl::ring_pause(spins);
+    }
+  }
+
+private:
+  std::mutex          mtx_;
+  mystl::deque<size_t> d_;
+};
+
+template <class Queue>
+size_t ring_transfer(Queue& q, size_t producers, size_t consumers, size_t n)
+{
+  std::vector<std::thread> workers;
+  std::vector<size_t> sums(consumers);
+  for (size_t t = 0; t < producers; ++t)
+  {
+    workers.push_back(std::thread([&q, n]() {
+      for (size_t i = 0; i < n; ++i)
+        q.push_back(i);
+    }));
+  }
+  const size_t each = n * producers / consumers;
+  for (size_t t = 0; t < consumers; ++t)
+  {
+    workers.push_back(std::thread([&q, &sums, t, each]() {
+      size_t v = 0;
+      for (size_t i = 0; i < each; ++i)
+      {
+        q.pop(v);
+        sums[t] += v;
+      }
+    }));
+  }
+  for (auto& w : workers)
+    w.join();
+  size_t sum = 0;
+  for (size_t t = 0; t < consumers; ++t)
+    sum += sums[t];
+  return sum;
+}
+
+#define RING_DO_TEST(...) do {                                            \
+  auto start = std::chrono::steady_clock::now();                          \
+  __VA_ARGS__;                                                            \
+  auto end = std::chrono::steady_clock::now();                            \
+  char buf[10];                                                           \
+  int t = static_cast<int>(std::chrono::duration_cast<                    \
+    std::chrono::milliseconds>(end - start).count());                     \
+  std::snprintf(buf, sizeof(buf), "%d", t);                               \
+  std::string s = buf;                                                    \
+  s += "ms    |";                                                         \
+  std::cout << std::setw(WIDE) << s;                                      \
+} while(0)
+
+void ring_buffer_test()
+{
+  std::cout << "[===============================================================]\n";
+  std::cout << "[-------------- Run container test : ring_buffer ---------------]\n";
+  std::cout << "[-------------------------- API test ---------------------------]\n";
+  mystl::spsc_ring<int> r1(100);
+  FUN_VALUE(r1.capacity());
+  r1.push_back(1);
+  r1.push_back(2);
+  r1.emplace_back(3);
+  FUN_VALUE(r1.size());
+  FUN_VALUE(r1.front());
+  FUN_VALUE(r1.back());
+  r1.pop_front();
+  FUN_VALUE(r1.front());
+  mystl::mpmc_ring<int> r2;
+  FUN_VALUE(r2.capacity());
+  r2.push_back(7);
+  int v = 0;
+  FUN_VALUE(r2.try_pop(v));
+  FUN_VALUE(v);
+  FUN_VALUE(r2.try_pop(v));
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  const size_t n = LEN3;
+  volatile size_t sink = 0;
+  std::cout << "[--------------------- Performance Testing ---------------------]\n";
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  std::cout << "|" << std::setw(6) << n / 1000000 << "M per producer |" << std::setw(WIDE)
+    << "mutex+deque |" << std::setw(WIDE) << "spsc_ring  |" << std::setw(WIDE) << "mpmc_ring  |" << "\n";
+  std::cout << "|        1P / 1C      |";
+  {
+    locked_deque a;
+    mystl::spsc_ring<size_t> b(ERingDefaultCapacity);
+    mystl::mpmc_ring<size_t> c(ERingDefaultCapacity);
+    RING_DO_TEST(sink = sink + ring_transfer(a, 1, 1, n));
+    RING_DO_TEST(sink = sink + ring_transfer(b, 1, 1, n));
+    RING_DO_TEST(sink = sink + ring_transfer(c, 1, 1, n));
+  }
+  std::cout << "\n|        2P / 2C      |";
+  {
+    locked_deque a;
+    mystl::mpmc_ring<size_t> c(ERingDefaultCapacity);
+    RING_DO_TEST(sink = sink + ring_transfer(a, 2, 2, n));
+    std::cout << std::setw(WIDE) << "-    |";
+    RING_DO_TEST(sink = sink + ring_transfer(c, 2, 2, n));
+  }
+  std::cout << "\n";
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  (void)sink;
+  PASSED;
+#endif
+  std::cout << "[-------------- End container test : ring_buffer ---------------]\n";
+}
+
+} // namespace ring_buffer_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_RING_BUFFER_TEST_H_
+
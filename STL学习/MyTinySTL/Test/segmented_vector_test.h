@@ -0,0 +1,255 @@
+#ifndef MYTINYSTL_SEGMENTED_VECTOR_TEST_H_
+#define MYTINYSTL_SEGMENTED_VECTOR_TEST_H_
+
+// segmented_vector test : 测试 segmented_vector 的接口、扩容时元素地址不变，以及与 vector、deque 的性能对比
+
+#include <string>
+#include <vector>
+
+#include "../MyTinySTL/algorithm.h"
+#include "../MyTinySTL/deque.h"
+#include "../MyTinySTL/segmented_vector.h"
+#include "../MyTinySTL/vector.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace segmented_vector_test
+{
+
+// 扩容时已有元素的地址不变，下标与迭代器跨越多个分段
+TEST(segmented_vector_stable_test)
+{
+  mystl::segmented_vector<int> v;
+  std::vector<int*> addr;
+  std::vector<int> ref;
+  for (int i = 0; i < 5000; ++i)
+  {
+    v.push_back(i * 3);
+    ref.push_back(i * 3);
+    addr.push_back(&v.back());
+  }
+  bool stable = true;
+  for (size_t i = 0; i < addr.size(); ++i)
+    stable = stable && addr[i] == &v[i] && *addr[i] == ref[i];
+  EXPECT_TRUE(stable);
+  EXPECT_CON_EQ(ref, v);
+  EXPECT_EQ(ref.size(), static_cast<size_t>(v.end() - v.begin()));
+
+  bool ok = true;
+  auto it = v.begin();
+  for (size_t i = 0; i < ref.size(); i += 37)
+  {
+    ok = ok && it[i] == ref[i] && *(v.begin() + i) == ref[i];
+    ok = ok && *(v.end() - (i + 1)) == ref[ref.size() - i - 1];
+  }
+  auto rit = v.end();
+  for (size_t i = ref.size(); i > 0; --i)
+    ok = ok && *--rit == ref[i - 1];
+  EXPECT_TRUE(ok);
+  EXPECT_TRUE(rit == v.begin());
+
+  size_t total = 0;
+  for (size_t k = 0; k < v.segment_count(); ++k)
+    total += v.segment_size(k);
+  EXPECT_EQ(v.size(), total);
+  EXPECT_EQ(v.first_size, v.segment_size(0));
+
+  // 迭代器在 push_back 之后仍然有效
+  auto mid = v.begin() + 100;
+  for (int i = 0; i < 3000; ++i)
+    v.push_back(i);
+  EXPECT_EQ(ref[100], *mid);
+  EXPECT_EQ(2999, *(mid + (8000 - 1 - 100)));
+}
+
+// 复制赋值中途抛出异常后，已复制的元素保留，容器仍可继续使用
+TEST(segmented_vector_copy_throw_test)
+{
+  {
+    mystl::segmented_vector<throw_on_copy> src;
+    for (int i = 0; i < 5000; ++i)
+      src.push_back(throw_on_copy(i));
+    mystl::segmented_vector<throw_on_copy> dst;
+    dst.push_back(throw_on_copy(-1));
+    throw_on_copy::copies() = 4000;
+    bool thrown = false;
+    try
+    {
+      dst = src;
+    }
+    catch (const std::runtime_error&)
+    {
+      thrown = true;
+    }
+    throw_on_copy::copies() = 0;
+    EXPECT_TRUE(thrown);
+    EXPECT_TRUE(dst.size() < 4000);
+    const size_t n = dst.size();
+    dst.push_back(throw_on_copy(-2));
+    dst.emplace_back(-3);
+    EXPECT_EQ(n + 2, dst.size());
+    bool ok = true;
+    for (size_t i = 0; i < n; ++i)
+      ok = ok && dst[i].value == static_cast<int>(i);
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(-2, dst[n].value);
+    EXPECT_EQ(-3, dst.back().value);
+    EXPECT_EQ(static_cast<int>(src.size() + dst.size()), throw_on_copy::live());
+
+    throw_on_copy::copies() = 5;
+    thrown = false;
+    try
+    {
+      dst = { throw_on_copy(1), throw_on_copy(2), throw_on_copy(3), throw_on_copy(4),
+              throw_on_copy(5), throw_on_copy(6), throw_on_copy(7), throw_on_copy(8) };
+    }
+    catch (const std::runtime_error&)
+    {
+      thrown = true;
+    }
+    throw_on_copy::copies() = 0;
+    EXPECT_TRUE(thrown);
+    dst.push_back(throw_on_copy(9));
+    EXPECT_EQ(9, dst.back().value);
+    EXPECT_EQ(static_cast<int>(src.size() + dst.size()), throw_on_copy::live());
+  }
+  EXPECT_EQ(0, throw_on_copy::live());
+}
+
+// 删除、改变大小、复制、移动
+TEST(segmented_vector_modify_test)
+{
+  mystl::segmented_vector<std::string> v(3, "abc");
+  EXPECT_EQ(3, v.size());
+  v.resize(100, "x");
+  EXPECT_TRUE(v[2] == "abc" && v[99] == "x");
+  v.push_back(v[0]);
+  EXPECT_TRUE(v.back() == "abc");
+  v.pop_back();
+  v.resize(10);
+  EXPECT_EQ(10, v.size());
+  EXPECT_TRUE(v[9] == "x");
+  const size_t cap = v.capacity();
+  v.shrink_to_fit();
+  EXPECT_TRUE(v.capacity() < cap && v.capacity() >= v.size());
+  v.reserve(1000);
+  EXPECT_TRUE(v.capacity() >= 1000);
+
+  mystl::segmented_vector<std::string> c(v);
+  EXPECT_TRUE(c == v);
+  c[0] = "changed";
+  EXPECT_TRUE(c != v);
+  EXPECT_TRUE(v < c);
+  mystl::segmented_vector<std::string> m(std::move(c));
+  EXPECT_TRUE(c.empty());
+  EXPECT_TRUE(m[0] == "changed");
+  c = m;
+  EXPECT_TRUE(c == m);
+  v = std::move(m);
+  EXPECT_TRUE(v == c && m.empty());
+  mystl::swap(v, m);
+  EXPECT_TRUE(v.empty() && m.size() == 10);
+  bool thrown = false;
+  try
+  {
+    v.at(0);
+  }
+  catch (const std::out_of_range&)
+  {
+    thrown = true;
+  }
+  EXPECT_TRUE(thrown);
+  m.clear();
+  EXPECT_TRUE(m.empty());
+
+  int a[] = { 1, 2, 3, 4, 5 };
+  mystl::segmented_vector<int> r(a, a + 5);
+  mystl::segmented_vector<int> il = { 1, 2, 3, 4, 5 };
+  EXPECT_TRUE(r == il);
+  mystl::reverse(r.begin(), r.end());
+  EXPECT_EQ(5, r.front());
+  mystl::sort(r.begin(), r.end());
+  EXPECT_CON_EQ(il, r);
+}
+
+// 按 idx 中的下标逐个读取，返回元素之和
+template <class Con>
+size_t sum_at(const Con& c, const std::vector<size_t>& idx)
+{
+  size_t s = 0;
+  for (size_t i = 0; i < idx.size(); ++i)
+    s += c[idx[i]];
+  return s;
+}
+
+template <class Con>
+size_t sum_all(const Con& c)
+{
+  size_t s = 0;
+  for (auto it = c.begin(); it != c.end(); ++it)
+    s += *it;
+  return s;
+}
+
+void segmented_vector_test()
+{
+  std::cout << "[===============================================================]\n";
+  std::cout << "[------------ Run container test : segmented_vector ------------]\n";
+  std::cout << "[-------------------------- API test ---------------------------]\n";
+  mystl::segmented_vector<int> v1;
+  FUN_VALUE(v1.first_size);
+  FUN_VALUE(v1.capacity());
+  for (int i = 0; i < 100; ++i)
+    v1.push_back(i);
+  FUN_VALUE(v1.size());
+  FUN_VALUE(v1.capacity());
+  FUN_VALUE(v1.segment_count());
+  FUN_VALUE(v1.segment_size(1));
+  FUN_VALUE(v1[70]);
+  FUN_VALUE(*(v1.end() - 1));
+  v1.resize(20);
+  v1.shrink_to_fit();
+  FUN_VALUE(v1.capacity());
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  const size_t n = LEN3;
+  std::vector<size_t> idx(n);
+  srand(9);
+  for (size_t i = 0; i < n; ++i)
+    idx[i] = static_cast<size_t>(rand()) % n;
+  mystl::vector<size_t> a;
+  mystl::deque<size_t> b;
+  mystl::segmented_vector<size_t> c;
+  volatile size_t sink = 0;
+  std::cout << "[--------------------- Performance Testing ---------------------]\n";
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  std::cout << "|" << std::setw(12) << n / 1000000 << "M elems |" << std::setw(WIDE) << "vector   |"
+    << std::setw(WIDE) << "deque    |" << std::setw(WIDE) << "segmented  |" << "\n";
+  std::cout << "|      push_back      |";
+  TIME_DO_TEST(for (size_t i = 0; i < n; ++i) a.push_back(i));
+  TIME_DO_TEST(for (size_t i = 0; i < n; ++i) b.push_back(i));
+  TIME_DO_TEST(for (size_t i = 0; i < n; ++i) c.push_back(i));
+  std::cout << "\n|    random index     |";
+  TIME_DO_TEST(sink = sink + sum_at(a, idx));
+  TIME_DO_TEST(sink = sink + sum_at(b, idx));
+  TIME_DO_TEST(sink = sink + sum_at(c, idx));
+  std::cout << "\n|  iterate x 10       |";
+  TIME_DO_TEST(for (int r = 0; r < 10; ++r) sink = sink + sum_all(a));
+  TIME_DO_TEST(for (int r = 0; r < 10; ++r) sink = sink + sum_all(b));
+  TIME_DO_TEST(for (int r = 0; r < 10; ++r) sink = sink + sum_all(c));
+  std::cout << "\n";
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  (void)sink;
+  PASSED;
+#endif
+  std::cout << "[------------ End container test : segmented_vector ------------]\n";
+}
+
+} // namespace segmented_vector_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_SEGMENTED_VECTOR_TEST_H_
+
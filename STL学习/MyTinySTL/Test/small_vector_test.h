@@ -0,0 +1,193 @@
+#ifndef MYTINYSTL_SMALL_VECTOR_TEST_H_
+#define MYTINYSTL_SMALL_VECTOR_TEST_H_
+
+// small_vector test : 测试 small_vector 的接口，以及 0~64 个元素时与 vector 的性能
+
+#include <string>
+#include <vector>
+
+#include "../MyTinySTL/memory_resource.h"
+#include "../MyTinySTL/small_vector.h"
+#include "../MyTinySTL/vector.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace small_vector_test
+{
+
+// 不超过 N 个元素时留在缓冲区，超出后搬到堆上，shrink_to_fit 可以搬回缓冲区
+TEST(small_vector_spill_test)
+{
+  mystl::small_vector<int, 4> v;
+  EXPECT_TRUE(v.is_small());
+  EXPECT_EQ(4, v.capacity());
+  for (int i = 0; i < 4; ++i)
+    v.push_back(i);
+  EXPECT_TRUE(v.is_small());
+  v.push_back(4);
+  EXPECT_FALSE(v.is_small());
+  EXPECT_EQ(5, v.size());
+  for (int i = 0; i < 5; ++i)
+    EXPECT_EQ(i, v[i]);
+  v.insert(v.begin() + 2, 10, 7);
+  EXPECT_EQ(15, v.size());
+  EXPECT_EQ(7, v[2]);
+  EXPECT_EQ(2, v[12]);
+  v.erase(v.begin() + 2, v.begin() + 13);
+  v.shrink_to_fit();
+  EXPECT_TRUE(v.is_small());
+  EXPECT_EQ(4, v.size());
+  EXPECT_EQ(4, v.capacity());
+  EXPECT_EQ(0, v[0]);
+  EXPECT_EQ(4, v[3]);
+
+  mystl::small_vector<std::string, 2> s{ "a", "b" };
+  EXPECT_TRUE(s.is_small());
+  s.emplace(s.begin(), "c");
+  EXPECT_FALSE(s.is_small());
+  EXPECT_TRUE(s[0] == "c" && s[1] == "a" && s[2] == "b");
+  s.assign(5, "x");
+  EXPECT_EQ(5, s.size());
+  EXPECT_TRUE(s[4] == "x");
+}
+
+// 在堆上时移动直接接管空间，在缓冲区中时逐个搬移，之后源对象为空且仍可使用
+TEST(small_vector_move_test)
+{
+  mystl::small_vector<std::string, 3> a{ "a", "b", "c", "d" };
+  const std::string* p = a.data();
+  mystl::small_vector<std::string, 3> b(std::move(a));
+  EXPECT_TRUE(b.data() == p);
+  EXPECT_TRUE(a.empty() && a.is_small());
+  a.push_back("e");
+  EXPECT_EQ(1, a.size());
+
+  mystl::small_vector<std::string, 3> c{ "x", "y" };
+  mystl::small_vector<std::string, 3> d(std::move(c));
+  EXPECT_TRUE(d.is_small() && c.empty());
+  EXPECT_TRUE(d[0] == "x" && d[1] == "y");
+
+  d = std::move(b);
+  EXPECT_TRUE(d.data() == p && b.is_small() && b.empty());
+  EXPECT_EQ(4, d.size());
+  b = d;
+  EXPECT_TRUE(b == d);
+
+  mystl::small_vector<std::string, 3> e{ "1" };
+  e.swap(d);
+  EXPECT_EQ(4, e.size());
+  EXPECT_EQ(1, d.size());
+  EXPECT_TRUE(e.data() == p && d.is_small());
+  mystl::swap(d, e);
+  EXPECT_TRUE(d.data() == p);
+  EXPECT_TRUE(e[0] == "1");
+  e = { "q", "r", "s", "t", "u" };
+  EXPECT_EQ(5, e.size());
+  EXPECT_TRUE(e > d);
+
+  // 上游分配器可能不相等时，移动构造可能分配空间，不是 noexcept
+  EXPECT_TRUE((std::is_nothrow_move_constructible<mystl::small_vector<int, 4>>::value));
+  EXPECT_FALSE((std::is_nothrow_move_constructible<
+    mystl::small_vector<int, 4, mystl::pmr::polymorphic_allocator<int>>>::value));
+}
+
+// 小容器的性能：每次构造一个容器，插入 n 个元素后析构，重复 count 次
+template <class Con>
+void small_do_test(size_t n, size_t count)
+{
+  char buf[10];
+  clock_t start, end;
+  size_t sum = 0;
+  start = clock();
+  for (size_t i = 0; i < count; ++i)
+  {
+    Con c;
+    for (size_t j = 0; j < n; ++j)
+      c.push_back(static_cast<int>(i + j));
+    sum += c.size();
+  }
+  end = clock();
+  int t = static_cast<int>(static_cast<double>(end - start) / CLOCKS_PER_SEC * 1000);
+  std::snprintf(buf, sizeof(buf), "%d", t);
+  std::string s = buf;
+  s += sum == n * count ? "ms    |" : "ms   !|";
+  std::cout << std::setw(WIDE) << s;
+}
+
+#define SMALL_TEST(n, count)                                     \
+  std::cout << "|" << std::setw(12) << n << "         |";         \
+  small_do_test<std::vector<int>>(n, count);                     \
+  small_do_test<mystl::vector<int>>(n, count);                   \
+  small_do_test<mystl::small_vector<int, 8>>(n, count);          \
+  std::cout << "\n";
+
+void small_vector_test()
+{
+  std::cout << "[===============================================================]\n";
+  std::cout << "[-------------- Run container test : small_vector --------------]\n";
+  std::cout << "[-------------------------- API test ---------------------------]\n";
+  int a[] = { 1,2,3,4,5 };
+  mystl::small_vector<int, 8> v1;
+  mystl::small_vector<int, 8> v2(10);
+  mystl::small_vector<int, 8> v3(10, 1);
+  mystl::small_vector<int, 8> v4(a, a + 5);
+  mystl::small_vector<int, 8> v5(v2);
+  mystl::small_vector<int, 8> v6(std::move(v2));
+  mystl::small_vector<int, 8> v7{ 1,2,3,4,5,6,7,8,9 };
+  mystl::small_vector<int, 8> v8, v9, v10;
+  v8 = v3;
+  v9 = std::move(v3);
+  v10 = { 1,2,3,4,5,6,7,8,9 };
+
+  FUN_AFTER(v1, v1.assign(8, 8));
+  FUN_AFTER(v1, v1.assign(a, a + 5));
+  FUN_AFTER(v1, v1.emplace(v1.begin(), 0));
+  FUN_AFTER(v1, v1.emplace_back(6));
+  FUN_AFTER(v1, v1.push_back(6));
+  FUN_AFTER(v1, v1.insert(v1.end(), 7));
+  FUN_AFTER(v1, v1.insert(v1.begin() + 3, 2, 3));
+  FUN_AFTER(v1, v1.insert(v1.begin(), a, a + 5));
+  FUN_AFTER(v1, v1.pop_back());
+  FUN_AFTER(v1, v1.erase(v1.begin()));
+  FUN_AFTER(v1, v1.erase(v1.begin(), v1.begin() + 2));
+  FUN_AFTER(v1, v1.reverse());
+  FUN_AFTER(v1, v1.swap(v4));
+  FUN_VALUE(v1.front());
+  FUN_VALUE(v1.back());
+  FUN_VALUE(v1.at(1));
+  std::cout << std::boolalpha;
+  FUN_VALUE(v1.is_small());
+  FUN_VALUE(v4.is_small());
+  std::cout << std::noboolalpha;
+  FUN_VALUE(v1.size());
+  FUN_VALUE(v1.capacity());
+  FUN_AFTER(v4, v4.resize(6, 6));
+  FUN_AFTER(v4, v4.shrink_to_fit());
+  FUN_VALUE(v4.capacity());
+  FUN_AFTER(v4, v4.clear());
+  FUN_VALUE(v4.size());
+  FUN_VALUE(v4.capacity());
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  std::cout << "[--------------------- Performance Testing ---------------------]\n";
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  std::cout << "|   push_back x n     |" << std::setw(WIDE) << "std   |"
+    << std::setw(WIDE) << "mystl   |" << std::setw(WIDE) << "small<8>  |" << "\n";
+  for (size_t n = 0; n <= 64; n = n < 8 ? n + 2 : n * 2)
+  {
+    SMALL_TEST(n, LEN2);
+  }
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  PASSED;
+#endif
+  std::cout << "[-------------- End container test : small_vector --------------]\n";
+}
+
+} // namespace small_vector_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_SMALL_VECTOR_TEST_H_
+
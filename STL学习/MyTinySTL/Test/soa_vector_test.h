@@ -0,0 +1,243 @@
+#ifndef MYTINYSTL_SOA_VECTOR_TEST_H_
+#define MYTINYSTL_SOA_VECTOR_TEST_H_
+
+// soa_vector test : 测试 soa_vector 的接口，以及只访问部分字段时按行存储与按列存储的性能
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../MyTinySTL/algorithm.h"
+#include "../MyTinySTL/soa_vector.h"
+#include "../MyTinySTL/vector.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace soa_vector_test
+{
+
+// 各列等长，按行读写、删除、改变大小
+TEST(soa_vector_basic_test)
+{
+  mystl::soa_vector<int, std::string> v;
+  EXPECT_TRUE(v.empty());
+  v.emplace_back(1, "one");
+  v.push_back(std::make_tuple(2, std::string("two")));
+  v.emplace_back(3, "three");
+  EXPECT_EQ(3, v.size());
+  EXPECT_EQ(3, v.column<1>().size());
+  EXPECT_EQ(2, std::get<0>(v[1]));
+  EXPECT_TRUE(std::get<1>(v.back()) == "three");
+  std::get<1>(v[0]) = "uno";
+  EXPECT_TRUE(v.column<1>()[0] == "uno");
+  v[2] = std::make_tuple(30, std::string("thirty"));
+  EXPECT_EQ(30, v.data<0>()[2]);
+  v.erase(v.begin());
+  EXPECT_EQ(2, v.size());
+  EXPECT_EQ(2, std::get<0>(v.front()));
+  v.resize(4, std::make_tuple(7, std::string("seven")));
+  EXPECT_EQ(4, v.column<1>().size());
+  EXPECT_TRUE(std::get<1>(v[3]) == "seven");
+  v.pop_back();
+  v.resize(1);
+  EXPECT_EQ(1, v.size());
+  EXPECT_EQ(1, v.column<1>().size());
+  mystl::soa_vector<int, std::string> w(std::move(v));
+  EXPECT_TRUE(v.empty());
+  EXPECT_TRUE(w.size() == 1 && std::get<1>(w[0]) == "two");
+  mystl::soa_vector<int, std::string> x{ std::make_tuple(2, std::string("two")) };
+  EXPECT_TRUE(x == w);
+  x.clear();
+  EXPECT_TRUE(x != w);
+}
+
+// 后面的列构造失败时，前面各列已追加的元素被撤销，各列仍然等长
+TEST(soa_vector_throw_test)
+{
+  {
+    mystl::soa_vector<std::string, throw_on_copy> v;
+    v.emplace_back("a", 1);
+    v.emplace_back("b", 2);
+    throw_on_copy t(3);
+    bool thrown = false;
+    throw_on_copy::copies() = 1;
+    try
+    {
+      v.emplace_back("c", t);
+    }
+    catch (const std::runtime_error&)
+    {
+      thrown = true;
+    }
+    EXPECT_TRUE(thrown);
+    EXPECT_EQ(2, v.size());
+    EXPECT_EQ(2, v.column<0>().size());
+    EXPECT_EQ(2, v.column<1>().size());
+
+    thrown = false;
+    throw_on_copy::copies() = 3;
+    try
+    {
+      v.resize(6, std::make_tuple(std::string("d"), t));
+    }
+    catch (const std::runtime_error&)
+    {
+      thrown = true;
+    }
+    EXPECT_TRUE(thrown);
+    EXPECT_EQ(2, v.column<0>().size());
+    EXPECT_EQ(2, v.column<1>().size());
+
+    throw_on_copy::copies() = 0;
+    v.emplace_back("c", t);
+    EXPECT_EQ(3, v.size());
+    EXPECT_EQ(3, v.column<1>().back().value);
+    EXPECT_TRUE(v.column<0>().back() == "c");
+  }
+  EXPECT_EQ(0, throw_on_copy::live());
+}
+
+// 行迭代器交给 mystl 的算法使用
+TEST(soa_vector_algorithm_test)
+{
+  mystl::soa_vector<int, double> v;
+  std::vector<int> keys;
+  srand(5);
+  for (int i = 0; i < 500; ++i)
+  {
+    const int k = rand() % 300;
+    v.emplace_back(k, k * 0.5);
+    keys.push_back(k);
+  }
+  mystl::sort(v.begin(), v.end(), mystl::soa_field_less<0>());
+  std::sort(keys.begin(), keys.end());
+  bool ok = true;
+  for (size_t i = 0; i < keys.size(); ++i)
+    ok = ok && v.data<0>()[i] == keys[i] && v.data<1>()[i] == keys[i] * 0.5;
+  EXPECT_TRUE(ok);
+
+  mystl::reverse(v.begin(), v.end());
+  EXPECT_EQ(keys.back(), std::get<0>(v[0]));
+  mystl::sort(v.begin(), v.end());
+  EXPECT_TRUE(mystl::is_sorted(v.begin(), v.end()));
+  mystl::partial_sort(v.begin(), v.begin() + 10, v.end(), mystl::soa_field_less<1>());
+  EXPECT_EQ(keys[9], std::get<0>(v[9]));
+
+  auto it = mystl::find_if(v.begin(), v.end(),
+                           [](std::tuple<int&, double&> r) { return std::get<0>(r) > 100; });
+  EXPECT_TRUE(it != v.end() && std::get<0>(*it) > 100);
+  mystl::transform(v.begin(), v.end(), v.begin(),
+                   [](std::tuple<int&, double&> r) { return std::make_tuple(std::get<0>(r), 1.0); });
+  EXPECT_EQ(500.0, mystl::accumulate(v.data<1>(), v.data<1>() + v.size(), 0.0));
+}
+
+// 性能测试：AoS(vector<record>) 与 SoA 的行迭代器、列数组
+struct record
+{
+  int    key;
+  double price;
+  double qty;
+  char   name[40];
+};
+
+struct pad40
+{
+  char c[40];
+};
+
+struct record_key_less
+{
+  bool operator()(const record& lhs, const record& rhs) const
+  { return lhs.key < rhs.key; }
+};
+
+void soa_vector_test()
+{
+  std::cout << "[===============================================================]\n";
+  std::cout << "[--------------- Run container test : soa_vector ---------------]\n";
+  std::cout << "[-------------------------- API test ---------------------------]\n";
+  mystl::soa_vector<int, char> v1;
+  v1.emplace_back(3, 'c');
+  v1.emplace_back(1, 'a');
+  v1.emplace_back(2, 'b');
+  FUN_VALUE(v1.size());
+  FUN_VALUE(std::get<1>(v1[0]));
+  mystl::sort(v1.begin(), v1.end());
+  FUN_VALUE(std::get<1>(v1.front()));
+  FUN_VALUE(std::get<1>(v1.back()));
+  FUN_VALUE(v1.column<0>()[1]);
+  v1.pop_back();
+  FUN_VALUE(v1.size());
+  FUN_VALUE(v1.column<1>().size());
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  const size_t n = LEN3;
+  const size_t rounds = 20;
+  mystl::vector<record> aos;
+  mystl::soa_vector<int, double, double, pad40> soa;
+  aos.reserve(n);
+  soa.reserve(n);
+  srand(3);
+  for (size_t i = 0; i < n; ++i)
+  {
+    record r = { rand(), static_cast<double>(i % 100), 1.0, { 0 } };
+    aos.push_back(r);
+    soa.emplace_back(r.key, r.price, r.qty, pad40());
+  }
+  volatile double dsink = 0;
+  volatile size_t sink = 0;
+  std::cout << "[--------------------- Performance Testing ---------------------]\n";
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  std::cout << "|" << std::setw(7) << n / 1000000 << "M rows (64B) |" << std::setw(WIDE) << "aos   |"
+    << std::setw(WIDE) << "soa rows  |" << std::setw(WIDE) << "soa column |" << "\n";
+
+  std::cout << "|  sum(price) x 20    |";
+  TIME_DO_TEST(for (size_t r = 0; r < rounds; ++r) {
+    double s = 0;
+    for (size_t i = 0; i < n; ++i) s += aos[i].price;
+    dsink = dsink + s; });
+  TIME_DO_TEST(for (size_t r = 0; r < rounds; ++r) {
+    double s = 0;
+    for (auto it = soa.begin(); it != soa.end(); ++it) s += std::get<1>(*it);
+    dsink = dsink + s; });
+  TIME_DO_TEST(for (size_t r = 0; r < rounds; ++r) {
+    const double* p = soa.data<1>();
+    double s = 0;
+    for (size_t i = 0; i < n; ++i) s += p[i];
+    dsink = dsink + s; });
+
+  std::cout << "\n|  find(key) x 20     |";
+  TIME_DO_TEST(for (size_t r = 0; r < rounds; ++r) {
+    sink = sink + static_cast<size_t>(mystl::find_if(aos.begin(), aos.end(),
+      [](const record& x) { return x.key == -1; }) - aos.begin()); });
+  TIME_DO_TEST(for (size_t r = 0; r < rounds; ++r) {
+    sink = sink + static_cast<size_t>(mystl::find_if(soa.begin(), soa.end(),
+      [](std::tuple<int&, double&, double&, pad40&> x) { return std::get<0>(x) == -1; })
+      - soa.begin()); });
+  TIME_DO_TEST(for (size_t r = 0; r < rounds; ++r) {
+    sink = sink + static_cast<size_t>(mystl::find(soa.data<0>(), soa.data<0>() + n, -1)
+      - soa.data<0>()); });
+
+  std::cout << "\n|  sort by key        |";
+  TIME_DO_TEST(mystl::sort(aos.begin(), aos.end(), record_key_less()));
+  TIME_DO_TEST(mystl::sort(soa.begin(), soa.end(), mystl::soa_field_less<0>()));
+  std::cout << std::setw(WIDE) << "-    |";
+  std::cout << "\n";
+  std::cout << "|---------------------|-------------|-------------|-------------|\n";
+  (void)dsink;
+  (void)sink;
+  PASSED;
+#endif
+  std::cout << "[--------------- End container test : soa_vector ---------------]\n";
+}
+
+} // namespace soa_vector_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_SOA_VECTOR_TEST_H_
+
@@ -1,9 +1,11 @@
 ﻿#ifndef MYTINYSTL_STRING_TEST_H_
 #define MYTINYSTL_STRING_TEST_H_
 
-// string test : 测试 string 的接口和 insert 的性能
+// string test : 测试 string 的接口和 insert 的性能，以及字符串哈希的吞吐量
 
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "../MyTinySTL/astring.h"
 #include "test.h"
@@ -15,6 +17,109 @@ namespace test
 namespace string_test
 {
 
+// 字符串与整数的哈希
+TEST(string_hash_test)
+{
+  mystl::hash<mystl::string> h;
+  EXPECT_EQ(h(mystl::string("hash")), h(mystl::string("hash")));
+  EXPECT_NE(h(mystl::string("hash")), h(mystl::string("hasH")));
+
+  // 与起始地址是否对齐无关
+  unsigned char buf[300];
+  for (int i = 0; i < 300; ++i)
+    buf[i] = static_cast<unsigned char>(i * 7 + 1);
+  bool ok = true;
+  for (size_t len = 0; len <= 200; ++len)
+  {
+    unsigned char moved[208];
+    std::memcpy(moved + 3, buf, len);
+    ok = ok && mystl::hash_bytes(buf, len) == mystl::hash_bytes(moved + 3, len);
+  }
+  EXPECT_TRUE(ok);
+
+  // 各个长度的前缀，以及翻转任意一位，哈希值都不同
+  std::unordered_set<size_t> seen;
+  for (size_t len = 0; len <= 200; ++len)
+    seen.insert(mystl::hash_bytes(buf, len));
+  for (size_t bit = 0; bit < 100 * 8; ++bit)
+  {
+    buf[bit / 8] ^= static_cast<unsigned char>(1u << (bit % 8));
+    seen.insert(mystl::hash_bytes(buf, 100));
+    buf[bit / 8] ^= static_cast<unsigned char>(1u << (bit % 8));
+  }
+  EXPECT_EQ(201 + 800, seen.size());
+  EXPECT_EQ(mystl::hash_bytes(buf, 20), mystl::hash_bytes(buf, 20, 0));
+  EXPECT_NE(mystl::hash_bytes(buf, 20), mystl::hash_bytes(buf, 20, 1));
+
+  // 连续的整数经过 mix_hash 后，低 7 位取遍所有的值
+  mystl::mix_hash<int> mh;
+  bool low[128] = {};
+  for (int i = 0; i < 4096; ++i)
+    low[mh(i) & 127] = true;
+  int n = 0;
+  for (int i = 0; i < 128; ++i)
+    n += low[i];
+  EXPECT_EQ(128, n);
+#ifndef MYSTL_HASH_MIX
+  EXPECT_EQ(12345, mystl::hash<int>()(12345));
+  EXPECT_EQ(mystl::hash_mix(12345), mh(12345));
+#else
+  EXPECT_EQ(mystl::hash_mix(12345), mystl::hash<int>()(12345));
+#endif
+}
+
+// 性能测试：对长度为 len 的键值反复求哈希，共处理 total 个字节
+inline void hash_perf_print(clock_t t)
+{
+  char buf[10];
+  std::snprintf(buf, sizeof(buf), "%d",
+                static_cast<int>(static_cast<double>(t) / CLOCKS_PER_SEC * 1000));
+  std::string s = buf;
+  s += "ms    |";
+  std::cout << std::setw(WIDE) << s;
+}
+
+void hash_perf_row(size_t len, size_t total)
+{
+  // 64 个不同的键值，避免同一个键值的结果被提升到循环外
+  std::vector<std::string> skeys;
+  std::vector<mystl::string> mkeys;
+  for (size_t k = 0; k < 64; ++k)
+  {
+    std::string str(len, 'a');
+    for (size_t i = 0; i < len; ++i)
+      str[i] = static_cast<char>('a' + (i * 31 + k) % 26);
+    skeys.push_back(str);
+    mkeys.push_back(mystl::string(str.c_str(), len));
+  }
+  const size_t calls = total / len;
+  size_t sum = 0;
+  clock_t start = clock();
+  for (size_t i = 0; i < calls; ++i)
+  {
+    const mystl::string& key = mkeys[i & 63];
+    sum += mystl::bitwise_hash(reinterpret_cast<const unsigned char*>(key.data()), len);
+  }
+  const clock_t fnv_t = clock() - start;
+  mystl::hash<mystl::string> mh;
+  start = clock();
+  for (size_t i = 0; i < calls; ++i)
+    sum += mh(mkeys[i & 63]);
+  const clock_t bytes_t = clock() - start;
+  std::hash<std::string> sh;
+  start = clock();
+  for (size_t i = 0; i < calls; ++i)
+    sum += sh(skeys[i & 63]);
+  const clock_t std_t = clock() - start;
+  char label[32];
+  std::snprintf(label, sizeof(label), "| key length %-8d |", static_cast<int>(len));
+  std::cout << label;
+  hash_perf_print(fnv_t);
+  hash_perf_print(bytes_t);
+  hash_perf_print(std_t);
+  std::cout << (sum == 0 ? " " : "") << std::endl;
+}
+
 void string_test()
 {
   std::cout << "[===============================================================]" << std::endl;
@@ -197,6 +302,15 @@ void string_test()
   std::cout << std::endl;
   std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
   PASSED;
+  // 每行共对 256MB 的数据求哈希
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|    hash 256MB data  |" << std::setw(WIDE) << "FNV-1a    |"
+    << std::setw(WIDE) << "hash_bytes |" << std::setw(WIDE) << "std::hash  |" << std::endl;
+  const size_t lens[] = { 4, 16, 64, 256, 4096 };
+  for (size_t i = 0; i < 5; ++i)
+    hash_perf_row(lens[i], static_cast<size_t>(256) << 20);
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
 #endif
   std::cout << "[----------------- End container test : string -----------------]" << std::endl;
 }
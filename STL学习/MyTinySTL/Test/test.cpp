@@ -9,8 +9,16 @@
 #endif // check memory leaks
 
 #include "algorithm_performance_test.h"
+#include "alloc_test.h"
+#include "allocator_test.h"
+#include "memory_resource_test.h"
 #include "algorithm_test.h"
 #include "vector_test.h"
+#include "small_vector_test.h"
+#include "dynamic_bitset_test.h"
+#include "soa_vector_test.h"
+#include "segmented_vector_test.h"
+#include "ring_buffer_test.h"
 #include "list_test.h"
 #include "deque_test.h"
 #include "queue_test.h"
@@ -19,6 +27,7 @@
 #include "set_test.h"
 #include "unordered_map_test.h"
 #include "unordered_set_test.h"
+#include "flat_hash_map_test.h"
 #include "string_test.h"
 #include "iterator_test.h"
 
@@ -31,7 +40,14 @@ int main()
   RUN_ALL_TESTS();
   algorithm_performance_test::algorithm_performance_test();
   iterator_test::stream_iterator_test();
+  alloc_test::alloc_test();
+  memory_resource_test::memory_resource_test();
   vector_test::vector_test();
+  small_vector_test::small_vector_test();
+  dynamic_bitset_test::dynamic_bitset_test();
+  soa_vector_test::soa_vector_test();
+  segmented_vector_test::segmented_vector_test();
+  ring_buffer_test::ring_buffer_test();
   list_test::list_test();
   deque_test::deque_test();
   queue_test::queue_test();
@@ -45,6 +61,7 @@ int main()
   unordered_map_test::unordered_multimap_test();
   unordered_set_test::unordered_set_test();
   unordered_set_test::unordered_multiset_test();
+  flat_hash_map_test::flat_hash_map_test();
   string_test::string_test();
 
 #if defined(_MSC_VER) && defined(_DEBUG)
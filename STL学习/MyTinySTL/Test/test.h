@@ -4,6 +4,7 @@
 // 一个简单的单元测试框架，定义了两个类 TestCase 和 UnitTest，以及一系列用于测试的宏
 
 #include <ctime>
+#include <stdexcept>
 #include <cstring>
 #include <cstdio>
 #include <iostream>
@@ -613,6 +614,21 @@ void test_len(size_t len1, size_t len2, size_t len3, size_t wide)
   std::cout << std::setw(WIDE) << t;                         \
 } while(0)
 
+// 计时执行任意语句，输出耗费的毫秒数，用于上面两个宏不能表达的性能测试
+#define TIME_DO_TEST(...) do {                               \
+  clock_t start, end;                                        \
+  char buf[10];                                              \
+  start = clock();                                           \
+  __VA_ARGS__;                                               \
+  end = clock();                                             \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
 #define LIST_SORT_DO_TEST(mode, count) do {                  \
   srand((int)time(0));                                       \
   clock_t start, end;                                        \
@@ -701,6 +717,38 @@ void test_len(size_t len1, size_t len2, size_t len3, size_t wide)
 #define RUN_ALL_TESTS() \
   mystl::test::UnitTest::GetInstance()->Run()
 
+// 测试异常安全用的元素：复制到第 copies() 次时抛出异常，live() 记录存活的对象个数
+// copies() 不大于 0 时复制不会抛出异常，用完后应重置为 0
+struct throw_on_copy
+{
+  static int& copies()
+  {
+    static int n = 0;
+    return n;
+  }
+  static int& live()
+  {
+    static int n = 0;
+    return n;
+  }
+  int value;
+  throw_on_copy(int v = 0) : value(v) { ++live(); }
+  throw_on_copy(const throw_on_copy& rhs) : value(rhs.value)
+  {
+    if (--copies() == 0)
+      throw std::runtime_error("throw_on_copy");
+    ++live();
+  }
+  throw_on_copy& operator=(const throw_on_copy& rhs)
+  {
+    value = rhs.value;
+    return *this;
+  }
+  ~throw_on_copy() { --live(); }
+  bool operator==(const throw_on_copy& rhs) const { return value == rhs.value; }
+  bool operator!=(const throw_on_copy& rhs) const { return value != rhs.value; }
+};
+
 // 是否开启性能测试
 #ifndef PERFORMANCE_TEST_ON
 #define PERFORMANCE_TEST_ON 1
@@ -1,9 +1,13 @@
 ﻿#ifndef MYTINYSTL_UNORDERED_MAP_TEST_H_
 #define MYTINYSTL_UNORDERED_MAP_TEST_H_
 
-// unordered_map test : 测试 unordered_map, unordered_multimap 的接口与它们 insert 的性能
+// unordered_map test : 测试 unordered_map, unordered_multimap 的接口与它们 insert 的性能，
+// 不同 bucket 下标策略的查找性能，节点缓存哈希值对遍历、rehash 的影响，以及增量 rehash 的插入延迟
 
+#include <algorithm>
 #include <unordered_map>
+#include <string>
+#include <vector>
 
 #include "../MyTinySTL/unordered_map.h"
 #include "map_test.h"
@@ -16,6 +20,593 @@ namespace test
 namespace unordered_map_test
 {
 
+// 使用不同 bucket 下标策略的 unordered_map
+template <class Policy, class Key = int>
+struct policy_map
+{
+  typedef mystl::unordered_map<Key, int, mystl::hash<Key>, mystl::equal_to<Key>,
+                               mystl::allocator<mystl::pair<const Key, int>>, Policy> type;
+};
+
+// 随机的插入、删除、查找，与 std::unordered_map 的结果相同
+template <class Map>
+bool policy_random_check()
+{
+  Map m;
+  std::unordered_map<int, int> ref;
+  srand(23);
+  bool ok = true;
+  for (int i = 0; i < 100000 && ok; ++i)
+  {
+    const int key = rand() % 20000 - 10000;
+    switch (rand() % 3)
+    {
+      case 0:
+        ok = m.insert(mystl::make_pair(key, i)).second == ref.insert(std::make_pair(key, i)).second;
+        break;
+      case 1:
+        ok = m.erase(key) == ref.erase(key);
+        break;
+      default:
+        ok = (m.find(key) == m.end()) == (ref.find(key) == ref.end()) && m.bucket(key) < m.bucket_count();
+    }
+  }
+  size_t n = 0;
+  for (auto it = m.begin(); it != m.end(); ++it, ++n)
+    ok = ok && ref.count(it->first) == 1 && ref[it->first] == it->second;
+  ok = ok && n == ref.size() && m.size() == ref.size();
+  // 复制、扩大、缩小之后内容不变
+  Map c(m);
+  c.rehash(c.bucket_count() * 4);
+  ok = ok && c == m;
+  c.erase(c.begin(), c.end());
+  for (int i = 0; i < 10; ++i)
+    c.emplace(i, i);
+  c.rehash(0);
+  ok = ok && c.size() == 10 && c.bucket_count() < m.bucket_count() * 4 && c.at(9) == 9;
+  return ok;
+}
+
+TEST(unordered_map_policy_test)
+{
+  EXPECT_TRUE(policy_random_check<policy_map<mystl::ht_prime_policy>::type>());
+  EXPECT_TRUE(policy_random_check<policy_map<mystl::ht_fastmod_policy>::type>());
+  EXPECT_TRUE(policy_random_check<policy_map<mystl::ht_pow2_policy>::type>());
+
+  // fastmod 与对折叠后的哈希值取模的结果相同
+  mystl::ht_fastmod_policy f;
+  bool ok = true;
+  for (size_t i = 0; i < PRIME_NUM && mystl::ht_prime_list[i] <= 0xffffffffull; ++i)
+  {
+    const size_t p = mystl::ht_prime_list[i];
+    f.reset(p);
+    for (uint64_t h = 0x9e3779b97f4a7c15ull * (i + 1), k = 0; k < 1000; ++k, h = h * 6364136223846793005ull + 1)
+    {
+#if defined(__SIZEOF_INT128__)
+      const size_t expect = static_cast<uint32_t>(h ^ (h >> 32)) % p;
+#else
+      const size_t expect = static_cast<size_t>(h) % p;
+#endif
+      ok = ok && f.index(static_cast<size_t>(h), p) == expect;
+    }
+  }
+  EXPECT_TRUE(ok);
+
+  // 2 的幂个 bucket，连续的整数与低位全为 0 的整数都能散开
+  policy_map<mystl::ht_pow2_policy, size_t>::type pm;
+  for (size_t i = 0; i < 4096; ++i)
+    pm[i << 20] = 1;
+  const size_t bc = pm.bucket_count();
+  EXPECT_TRUE((bc & (bc - 1)) == 0);
+  size_t longest = 0;
+  for (size_t b = 0; b < bc; ++b)
+    longest = mystl::max(longest, pm.bucket_size(b));
+  EXPECT_TRUE(longest < 16);
+
+  mystl::unordered_multimap<int, int, mystl::hash<int>, mystl::equal_to<int>,
+    mystl::allocator<mystl::pair<const int, int>>, mystl::ht_pow2_policy> mm;
+  for (int i = 0; i < 1000; ++i)
+    mm.emplace(i % 100, i);
+  EXPECT_EQ(10, mm.count(42));
+  auto mc = mm;
+  EXPECT_TRUE(mc == mm);
+  EXPECT_EQ(10, mm.erase(42));
+  EXPECT_EQ(990, mm.size());
+  EXPECT_TRUE(mc != mm);
+}
+
+// 记录调用次数的字符串哈希函数
+struct counting_string_hash
+{
+  static size_t& calls()
+  {
+    static size_t n = 0;
+    return n;
+  }
+  size_t operator()(const std::string& s) const
+  {
+    ++calls();
+    return std::hash<std::string>()(s);
+  }
+};
+
+// 同上，但不在节点中缓存哈希值，用于对照
+struct nocache_string_hash :public counting_string_hash
+{
+};
+
+} // namespace unordered_map_test
+} // namespace test
+
+template <>
+struct ht_cache_hash<test::unordered_map_test::nocache_string_hash> :public std::false_type
+{
+};
+
+namespace test
+{
+namespace unordered_map_test
+{
+
+TEST(unordered_map_cache_hash_test)
+{
+  EXPECT_FALSE(mystl::ht_cache_hash<mystl::hash<int>>::value);
+  EXPECT_FALSE(mystl::ht_cache_hash<mystl::hash<int*>>::value);
+  EXPECT_FALSE(mystl::ht_cache_hash<mystl::mix_hash<size_t>>::value);
+  EXPECT_TRUE(mystl::ht_cache_hash<std::hash<std::string>>::value);
+  EXPECT_TRUE(mystl::ht_cache_hash<counting_string_hash>::value);
+  EXPECT_FALSE(mystl::ht_cache_hash<nocache_string_hash>::value);
+  // 不缓存时节点不会变大
+  EXPECT_EQ(2 * sizeof(void*), sizeof(mystl::hashtable_node<int*, false>));
+  EXPECT_EQ(3 * sizeof(void*), sizeof(mystl::hashtable_node<int*, true>));
+
+  typedef mystl::unordered_map<std::string, int, counting_string_hash> smap;
+  smap m;
+  auto& calls = counting_string_hash::calls();
+  calls = 0;
+  for (int i = 0; i < 2000; ++i)
+    m.emplace("key" + std::to_string(i), i);
+  EXPECT_EQ(2000, calls);  // 每次插入只计算一次，包括其间的 rehash
+
+  // 遍历、rehash、复制、按迭代器删除都不调用哈希函数
+  calls = 0;
+  size_t n = 0;
+  long sum = 0;
+  for (auto it = m.begin(); it != m.end(); ++it, ++n)
+    sum += it->second;
+  EXPECT_EQ(2000, n);
+  EXPECT_EQ(1999L * 2000 / 2, sum);
+  m.rehash(m.bucket_count() * 4);
+  smap c(m);
+  for (auto it = c.begin(); it != c.end(); )
+  {
+    auto next = it;
+    ++next;
+    if (it->second % 2 == 0)
+      c.erase(it);
+    it = next;
+  }
+  EXPECT_EQ(0, calls);
+  EXPECT_EQ(1000, c.size());
+
+  bool ok = true;
+  for (int i = 0; i < 2000; ++i)
+  {
+    const std::string key = "key" + std::to_string(i);
+    ok = ok && m.at(key) == i && c.count(key) == static_cast<size_t>(i % 2);
+  }
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(4000, calls);
+
+  // 与不缓存的表结果相同
+  mystl::unordered_map<std::string, int, nocache_string_hash> u;
+  for (auto it = m.begin(); it != m.end(); ++it)
+    u.insert(*it);
+  calls = 0;
+  n = 0;
+  for (auto it = u.begin(); it != u.end(); ++it, ++n) {}
+  EXPECT_EQ(2000, n);
+  EXPECT_TRUE(calls > 0);
+
+  // 键值重复的表，rehash 之后相同的键值仍然相邻
+  mystl::unordered_multimap<std::string, int, counting_string_hash> mm;
+  for (int i = 0; i < 3000; ++i)
+    mm.emplace(std::to_string(i % 300), i);
+  mm.rehash(mm.bucket_count() * 3);
+  EXPECT_EQ(10, mm.count("42"));
+  auto r = mm.equal_range("42");
+  EXPECT_EQ(10, mystl::distance(r.first, r.second));
+  EXPECT_EQ(10, mm.erase("42"));
+  EXPECT_EQ(2990, mm.size());
+  auto mc = mm;
+  EXPECT_TRUE(mc == mm);
+}
+
+// 增量 rehash：迁移进行中的插入、删除、查找、遍历，结果与 std::unordered_map 相同
+template <class Map>
+bool incremental_random_check()
+{
+  Map m;
+  m.incremental_rehash(true);
+  std::unordered_map<int, int> ref;
+  srand(25);
+  bool ok = true;
+  size_t checked = 0;  // 迁移进行中遍历的次数
+  for (int i = 0; i < 200000 && ok; ++i)
+  {
+    const int key = rand() % 50000;
+    switch (rand() % 4)
+    {
+      case 0:
+      case 1:
+        ok = m.emplace(key, i).second == ref.emplace(key, i).second;
+        break;
+      case 2:
+        ok = m.erase(key) == ref.erase(key);
+        break;
+      default:
+      {
+        auto it = m.find(key);
+        auto r = ref.find(key);
+        ok = (it == m.end()) == (r == ref.end()) && (it == m.end() || it->second == r->second);
+      }
+    }
+    if (m.rehashing() && i % 64 == 0)
+    { // 新旧两个数组中的元素都恰好遍历一次
+      ++checked;
+      std::vector<int> keys;
+      for (auto it = m.begin(); it != m.end() && ok; ++it)
+      {
+        keys.push_back(it->first);
+        auto r = ref.find(it->first);
+        ok = r != ref.end() && r->second == it->second;
+      }
+      std::sort(keys.begin(), keys.end());
+      ok = ok && keys.size() == ref.size() &&
+        std::unique(keys.begin(), keys.end()) == keys.end();
+    }
+  }
+  return ok && checked > 0 && m.size() == ref.size();
+}
+
+// 每次扩容只多出约 1/16 的 bucket，用来检查迁移能否在下一次扩容前完成
+struct slow_growth_policy
+{
+  static size_t next_size(size_t n) noexcept { return n + n / 16 + 1; }
+  static size_t max_size()          noexcept { return static_cast<size_t>(-1) / 2; }
+
+  void   reset(size_t /*n*/)             noexcept {}
+  size_t index(size_t h, size_t n) const noexcept { return h % n; }
+};
+
+TEST(unordered_map_incremental_rehash_test)
+{
+  typedef mystl::unordered_map<int, int> map_t;
+  typedef mystl::unordered_map<int, int, mystl::mix_hash<int>> mix_map_t;
+  EXPECT_TRUE(incremental_random_check<map_t>());
+  EXPECT_TRUE(incremental_random_check<policy_map<mystl::ht_pow2_policy>::type>());
+  EXPECT_TRUE(incremental_random_check<mix_map_t>());
+  EXPECT_TRUE(incremental_random_check<policy_map<slow_growth_policy>::type>());
+
+  // bucket 数组增长很慢时，下一次扩容之前上一次迁移已经完成，不会一次做完剩下的迁移
+  policy_map<slow_growth_policy>::type sm;
+  sm.incremental_rehash(true);
+  size_t grows = 0, stalls = 0;
+  for (int i = 0; i < 20000; ++i)
+  {
+    const bool was_rehashing = sm.rehashing();
+    const size_t bc = sm.bucket_count();
+    sm[i] = i;
+    if (sm.bucket_count() != bc)
+    {
+      ++grows;
+      if (was_rehashing)
+        ++stalls;
+    }
+  }
+  EXPECT_TRUE(grows > 10);
+  EXPECT_EQ(0, stalls);
+  EXPECT_EQ(20000, sm.size());
+  EXPECT_EQ(19999, sm[19999]);
+
+  // 插到开始迁移为止
+  mystl::unordered_multimap<int, int> mm;
+  mm.incremental_rehash(true);
+  EXPECT_TRUE(mm.incremental_rehash());
+  const size_t buckets = mm.bucket_count();
+  int n = 0;
+  for (; !mm.rehashing(); ++n)
+    mm.emplace(n % 97, n);
+  EXPECT_TRUE(mm.bucket_count() > buckets);
+  EXPECT_EQ(static_cast<size_t>((n + 96 - 5) / 97), mm.count(5));
+  auto r = mm.equal_range(5);
+  EXPECT_EQ(mm.count(5), static_cast<size_t>(mystl::distance(r.first, r.second)));
+  bool ok = true;
+  for (auto it = r.first; it != r.second; ++it)
+    ok = ok && it->first == 5;
+  EXPECT_TRUE(ok);
+
+  // 迁移中复制、移动、交换
+  auto copy = mm;
+  EXPECT_FALSE(copy.rehashing());
+  EXPECT_TRUE(copy == mm);
+  auto moved = mystl::move(mm);
+  EXPECT_TRUE(moved.rehashing());
+  EXPECT_TRUE(mm.empty() && !mm.rehashing());
+  mm.swap(moved);
+  EXPECT_TRUE(mm.rehashing() && moved.empty());
+  EXPECT_TRUE(copy == mm);
+
+  // 迁移中边遍历边删除
+  const size_t total = mm.size();
+  size_t erased = 0;
+  for (auto it = mm.begin(); it != mm.end(); )
+  {
+    if (it->second % 2 == 0)
+    {
+      auto next = it;
+      ++next;
+      mm.erase(it);
+      it = next;
+      ++erased;
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  EXPECT_EQ(total - erased, mm.size());
+  EXPECT_EQ(mm.size(), static_cast<size_t>(mystl::distance(mm.begin(), mm.end())));
+  EXPECT_TRUE(mm.rehashing());
+
+  // 完成迁移之后 bucket 接口包含所有元素
+  mm.finish_rehash();
+  EXPECT_FALSE(mm.rehashing());
+  size_t in_buckets = 0;
+  for (size_t b = 0; b < mm.bucket_count(); ++b)
+    in_buckets += mm.bucket_size(b);
+  EXPECT_EQ(mm.size(), in_buckets);
+
+  // 迁移中 clear，关闭增量 rehash 时立即完成迁移
+  mystl::unordered_map<int, int> um;
+  um.incremental_rehash(true);
+  for (int i = 0; !um.rehashing(); ++i)
+    um.emplace(i, i);
+  um.clear();
+  EXPECT_TRUE(um.empty() && !um.rehashing() && um.begin() == um.end());
+  for (int i = 0; !um.rehashing(); ++i)
+    um.emplace(i, i);
+  um.incremental_rehash(false);
+  EXPECT_FALSE(um.rehashing() || um.incremental_rehash());
+  EXPECT_EQ(1, um.count(0));
+
+  // 迁移中复制时元素的复制抛出异常，异常传给调用者
+  typedef mystl::unordered_map<int, throw_on_copy> tmap;
+  tmap tm;
+  tm.incremental_rehash(true);
+  for (int i = 0; !tm.rehashing(); ++i)
+    tm.emplace(i, throw_on_copy(i));
+  throw_on_copy::copies() = static_cast<int>(tm.size() / 2);
+  bool thrown = false;
+  try
+  {
+    tmap tc(tm);
+  }
+  catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  EXPECT_TRUE(thrown);
+  tmap ta;
+  ta.emplace(-1, throw_on_copy(-1));
+  throw_on_copy::copies() = static_cast<int>(tm.size() / 2);
+  thrown = false;
+  try
+  {
+    ta = tm;
+  }
+  catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  throw_on_copy::copies() = 0;
+  EXPECT_TRUE(thrown);
+  EXPECT_TRUE(ta.empty() && ta.begin() == ta.end());
+  ta.emplace(1, throw_on_copy(1));
+  EXPECT_EQ(1, ta.at(1).value);
+  EXPECT_TRUE(tm.rehashing());
+  tmap tb(tm);
+  EXPECT_TRUE(tb == tm);
+}
+
+// 性能测试：n 个键值的表中做 total 次查找，查找的键值随机排列
+template <class Map>
+clock_t policy_find_time(const Map& m, const std::vector<size_t>& queries, size_t total)
+{
+  size_t hit = 0;
+  clock_t start = clock();
+  for (size_t done = 0; done < total; done += queries.size())
+  {
+    for (size_t i = 0; i < queries.size(); ++i)
+      hit += m.count(queries[i]);
+  }
+  const clock_t t = clock() - start;
+  if (hit == 0)
+    std::cout << "policy_find_time: no hit\n";
+  return t;
+}
+
+template <class Map>
+void policy_fill(Map& m, const std::vector<size_t>& keys)
+{
+  for (size_t i = 0; i < keys.size(); ++i)
+    m[keys[i]] = static_cast<int>(i);
+}
+
+inline void policy_print(clock_t t)
+{
+  char buf[10];
+  std::snprintf(buf, sizeof(buf), "%d",
+                static_cast<int>(static_cast<double>(t) / CLOCKS_PER_SEC * 1000));
+  std::string s = buf;
+  s += "ms    |";
+  std::cout << std::setw(WIDE) << s;
+}
+
+void policy_find_row(size_t n, size_t total, const char* label)
+{
+  // hash_mix 是双射，得到互不相同且随机分布的键值
+  std::vector<size_t> keys(n);
+  for (size_t i = 0; i < n; ++i)
+    keys[i] = mystl::hash_mix(i + 1);
+  std::vector<size_t> queries(mystl::min(n * 4, static_cast<size_t>(1) << 20));
+  srand(7);
+  for (size_t i = 0; i < queries.size(); ++i)
+    queries[i] = keys[(static_cast<size_t>(rand()) * RAND_MAX + rand()) % n];
+  // 三个表都建好之后轮流计时，每种策略取三次中最短的时间，减少机器负载变化的影响
+  policy_map<mystl::ht_prime_policy, size_t>::type   pm;
+  policy_map<mystl::ht_fastmod_policy, size_t>::type fm;
+  policy_map<mystl::ht_pow2_policy, size_t>::type    wm;
+  policy_fill(pm, keys);
+  policy_fill(fm, keys);
+  policy_fill(wm, keys);
+  clock_t t[3] = { 0, 0, 0 };
+  for (int round = 0; round < 3; ++round)
+  {
+    const clock_t r[3] = { policy_find_time(pm, queries, total),
+                           policy_find_time(fm, queries, total),
+                           policy_find_time(wm, queries, total) };
+    for (int i = 0; i < 3; ++i)
+      t[i] = round == 0 || r[i] < t[i] ? r[i] : t[i];
+  }
+  std::cout << "| " << label << " |";
+  policy_print(t[0]);
+  policy_print(t[1]);
+  policy_print(t[2]);
+  std::cout << std::endl;
+}
+
+// 性能测试：字符串键值的表，遍历 rounds 次与 rehash 到 4 倍 bucket 的时间
+template <class Map>
+clock_t cache_scan_time(const Map& m, size_t rounds)
+{
+  size_t sum = 0;
+  clock_t start = clock();
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    for (auto it = m.begin(); it != m.end(); ++it)
+      sum += static_cast<size_t>(it->second);
+  }
+  const clock_t t = clock() - start;
+  if (sum == 0)
+    std::cout << "cache_scan_time: empty\n";
+  return t;
+}
+
+template <class Map>
+clock_t cache_rehash_time(Map& m)
+{
+  clock_t start = clock();
+  m.rehash(m.bucket_count() * 4);
+  return clock() - start;
+}
+
+void cache_hash_rows(size_t n, size_t rounds)
+{
+  std::vector<std::string> keys(n);
+  for (size_t i = 0; i < n; ++i)
+    keys[i] = "user:" + std::to_string(mystl::hash_mix(i + 1));
+  typedef mystl::unordered_map<std::string, int, nocache_string_hash> u_t;
+  typedef mystl::unordered_map<std::string, int, std::hash<std::string>> c_t;
+  typedef std::unordered_map<std::string, int> s_t;
+  clock_t scan[3] = { 0, 0, 0 };
+  clock_t grow[3] = { 0, 0, 0 };
+  for (int round = 0; round < 3; ++round)
+  { // 轮流计时，每种表取三次中最短的时间
+    u_t u;
+    c_t c;
+    s_t s;
+    for (size_t i = 0; i < n; ++i)
+    {
+      u.emplace(keys[i], 1);
+      c.emplace(keys[i], 1);
+      s.emplace(keys[i], 1);
+    }
+    const clock_t a[3] = { cache_scan_time(u, rounds), cache_scan_time(c, rounds),
+                           cache_scan_time(s, rounds) };
+    const clock_t b[3] = { cache_rehash_time(u), cache_rehash_time(c), cache_rehash_time(s) };
+    for (int i = 0; i < 3; ++i)
+    {
+      scan[i] = round == 0 || a[i] < scan[i] ? a[i] : scan[i];
+      grow[i] = round == 0 || b[i] < grow[i] ? b[i] : grow[i];
+    }
+  }
+  std::cout << "| scan " << std::setw(7) << n << " x " << std::setw(4) << rounds << " |";
+  for (int i = 0; i < 3; ++i)
+    policy_print(scan[i]);
+  std::cout << "\n| rehash " << std::setw(7) << n << " keys |";
+  for (int i = 0; i < 3; ++i)
+    policy_print(grow[i]);
+  std::cout << std::endl;
+}
+
+// 性能测试：逐个插入 keys，每 batch 个插入计时一次，记录总时间与最慢一批的时间
+template <class Map>
+void latency_run(Map& m, const std::vector<size_t>& keys, size_t batch,
+                 clock_t& total, clock_t& worst)
+{
+  total = 0;
+  worst = 0;
+  for (size_t i = 0; i < keys.size(); i += batch)
+  {
+    const size_t last = mystl::min(i + batch, keys.size());
+    clock_t start = clock();
+    for (size_t j = i; j < last; ++j)
+      m.emplace(keys[j], 1);
+    const clock_t t = clock() - start;
+    total += t;
+    worst = mystl::max(worst, t);
+  }
+}
+
+inline void latency_print(clock_t t)
+{
+  char buf[16];
+  std::snprintf(buf, sizeof(buf), "%d",
+                static_cast<int>(static_cast<double>(t) / CLOCKS_PER_SEC * 1000000));
+  std::string s = buf;
+  s += "us    |";
+  std::cout << std::setw(WIDE) << s;
+}
+
+void latency_rows(size_t n)
+{
+  std::vector<size_t> keys(n);
+  for (size_t i = 0; i < n; ++i)
+    keys[i] = mystl::hash_mix(i + 1);
+  clock_t total[3], worst[3];
+  {
+    mystl::unordered_map<size_t, int> m;
+    latency_run(m, keys, 1000, total[0], worst[0]);
+  }
+  {
+    mystl::unordered_map<size_t, int> m;
+    m.incremental_rehash(true);
+    latency_run(m, keys, 1000, total[1], worst[1]);
+  }
+  {
+    std::unordered_map<size_t, int> m;
+    latency_run(m, keys, 1000, total[2], worst[2]);
+  }
+  std::cout << "| insert " << std::setw(7) << n << " keys |";
+  for (int i = 0; i < 3; ++i)
+    policy_print(total[i]);
+  std::cout << "\n| worst 1K inserts    |";
+  for (int i = 0; i < 3; ++i)
+    latency_print(worst[i]);
+  std::cout << std::endl;
+}
+
 void unordered_map_test()
 {
   std::cout << "[===============================================================]" << std::endl;
@@ -103,6 +694,31 @@ void unordered_map_test()
   std::cout << std::endl;
   std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
   PASSED;
+  // 每行做 LEN3 * 2 次 find
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|   find, keys in map |" << std::setw(WIDE) << "prime %    |"
+    << std::setw(WIDE) << "fastmod    |" << std::setw(WIDE) << "pow2       |" << std::endl;
+  policy_find_row(1000, LEN3 * 2, "1K keys            ");
+  policy_find_row(100000, LEN3 * 2, "100K keys          ");
+  policy_find_row(LEN3 / 2, LEN3 * 2, "5M keys            ");
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
+  // 字符串键值，节点中不缓存、缓存哈希值
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|    string keys      |" << std::setw(WIDE) << "no cache   |"
+    << std::setw(WIDE) << "cached     |" << std::setw(WIDE) << "std::unord |" << std::endl;
+  cache_hash_rows(LEN2 / 10, 100);
+  cache_hash_rows(LEN2, 10);
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
+  // 逐个插入时一次性 rehash 与增量 rehash 的总时间和最慢的 1000 次插入
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|    growth latency   |" << std::setw(WIDE) << "full       |"
+    << std::setw(WIDE) << "incremental|" << std::setw(WIDE) << "std::unord |" << std::endl;
+  latency_rows(LEN2);
+  latency_rows(LEN3 / 2);
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
 #endif
   std::cout << "[-------------- End container test : unordered_map -------------]" << std::endl;
 }
@@ -3,8 +3,14 @@
 
 // vector test : 测试 vector 的接口与 push_back 的性能
 
+#include <cstdint>
+#include <sstream>
+#include <string>
 #include <vector>
 
+#include "../MyTinySTL/alloc_stats.h"
+#include "../MyTinySTL/large_alloc.h"
+#include "../MyTinySTL/stream_iterator.h"
 #include "../MyTinySTL/vector.h"
 #include "test.h"
 
@@ -15,6 +21,149 @@ namespace test
 namespace vector_test
 {
 
+// 各个扩容策略得到的容量不小于需要的容量，元素保持不变
+TEST(vector_growth_policy_test)
+{
+  mystl::vector<int, mystl::allocator<int>, mystl::vector_growth_2x> v2;
+  mystl::vector<int, mystl::allocator<int>, mystl::vector_growth_page> vp;
+  mystl::vector<int, mystl::allocator<int>, mystl::vector_growth_size_class> vs;
+  size_t grow2 = 0;
+  bool page_ok = true;
+  for (int i = 0; i < 100000; ++i)
+  {
+    const size_t cap = v2.capacity();
+    v2.push_back(i);
+    vp.push_back(i);
+    vs.push_back(i);
+    if (v2.capacity() != cap)
+    {
+      ++grow2;
+      EXPECT_EQ(cap * 2, v2.capacity());
+    }
+    const size_t bytes = vp.capacity() * sizeof(int);
+    if (bytes >= mystl::EVectorPageBytes && bytes % mystl::EVectorPageBytes != 0)
+      page_ok = false;
+  }
+  EXPECT_TRUE(page_ok);
+  EXPECT_TRUE(grow2 < 14);
+  EXPECT_EQ(mystl::allocator<int>::good_size(vs.capacity()), vs.capacity());
+  const size_t big = mystl::large_alloc::threshold() / sizeof(int) + 1;
+  EXPECT_TRUE(mystl::allocator<int>::good_size(big) >= big);
+  bool same = true;
+  for (int i = 0; i < 100000; ++i)
+  {
+    if (v2[i] != i || vp[i] != i || vs[i] != i)
+      same = false;
+  }
+  EXPECT_TRUE(same);
+}
+
+// append_range 一次扩容到位，区间可以是容器本身；resize_uninitialized 不初始化新增的元素
+TEST(vector_append_range_test)
+{
+  mystl::vector<int> v{ 1, 2, 3 };
+  v.shrink_to_fit();
+  v.append_range(v.begin(), v.end());
+  int expect[] = { 1, 2, 3, 1, 2, 3 };
+  EXPECT_PTR_RANGE_EQ(expect, v.data(), 6);
+  v.append_range({ 7, 8 });
+  EXPECT_EQ(8, v.size());
+  EXPECT_EQ(8, v.back());
+  v.shrink_to_fit();
+  v.append_range(v.begin() + 6, v.end());
+  v.shrink_to_fit();
+  typedef mystl::reverse_iterator<int*> rit;
+  v.append_range(rit(v.begin() + 3), rit(v.begin()));
+  int expect2[] = { 1, 2, 3, 1, 2, 3, 7, 8, 7, 8, 3, 2, 1 };
+  EXPECT_PTR_RANGE_EQ(expect2, v.data(), 13);
+  mystl::vector<int> u{ 9, 10 };
+  u.shrink_to_fit();
+  u.append_range(v.begin(), v.end());
+  EXPECT_EQ(15, u.size());
+  EXPECT_EQ(9, u.front());
+  EXPECT_EQ(1, u.back());
+
+  std::istringstream is("4 5 6");
+  mystl::vector<int> w;
+  w.append_range(mystl::istream_iterator<int>(is), mystl::istream_iterator<int>());
+  EXPECT_EQ(3, w.size());
+  EXPECT_EQ(6, w.back());
+
+  mystl::vector<std::string> s{ "a" };
+  s.shrink_to_fit();
+  std::string more[] = { "b", "c", "d" };
+  s.insert(s.end(), more, more + 3);
+  EXPECT_EQ(4, s.size());
+  EXPECT_TRUE(s[0] == "a" && s[3] == "d");
+  s.shrink_to_fit();
+  s.append_range(more, more + 3);
+  s.shrink_to_fit();
+  s.append_range(s.begin() + 1, s.begin() + 4);
+  EXPECT_EQ(10, s.size());
+  EXPECT_TRUE(s[6] == "d" && s[7] == "b" && s[9] == "d");
+
+  mystl::vector<int> r;
+  r.resize_uninitialized(1000);
+  EXPECT_EQ(1000, r.size());
+  for (int i = 0; i < 1000; ++i)
+    r[i] = i;
+  r.resize_uninitialized(10);
+  EXPECT_EQ(10, r.size());
+  EXPECT_EQ(9, r.back());
+}
+
+// 只用于大块分配测试的类型，保证有独立的统计记录
+struct large_probe
+{
+  int a[4];
+};
+
+// 容量超过 large_alloc 的阈值后，扩容与释放走大块内存的路径，元素保持不变
+TEST(vector_large_alloc_test)
+{
+  const size_t threshold = mystl::large_alloc::threshold();
+  auto& e = mystl::alloc_stats::entry<large_probe>();
+  const size_t live = e.live_bytes.load();
+  {
+    mystl::vector<large_probe> v;
+    int n = 0;
+    while (v.capacity() * sizeof(large_probe) < 2 * threshold)
+    {
+      large_probe p = { { n, n + 1, n + 2, n + 3 } };
+      v.push_back(p);
+      ++n;
+    }
+    const size_t bytes = v.capacity() * sizeof(large_probe);
+    EXPECT_TRUE(bytes >= 2 * threshold);
+    bool same = true;
+    for (int i = 0; i < n; ++i)
+    {
+      if (v[i].a[0] != i || v[i].a[3] != i + 3)
+        same = false;
+    }
+    EXPECT_TRUE(same);
+#if defined(MYSTL_USE_LARGE_ALLOC) && MYSTL_LARGE_ALLOC_MMAP
+    // 由 large_alloc 映射的空间按页对齐；mremap 移动后的空间不再保证按 2M 对齐，
+    // 只有新映射的空间达到 2M 时按 2M 对齐
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(v.data()) % mystl::EPageBytes);
+    {
+      mystl::vector<large_probe> w;
+      w.reserve(v.capacity());
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(w.data()) % mystl::EPageBytes);
+      if (bytes >= static_cast<size_t>(mystl::EHugePageBytes))
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(w.data()) % mystl::EHugePageBytes);
+    }
+#endif
+#ifdef MYSTL_ALLOC_STATS
+    // 当前的空间经由 mystl::allocator 按超过阈值的大小记录
+    EXPECT_EQ(bytes, e.live_bytes.load() - live);
+    EXPECT_TRUE(e.peak_bytes.load() >= live + bytes);
+    EXPECT_TRUE(e.hist[mystl::alloc_stats::bucket(bytes)].load() >= 1);
+#endif // MYSTL_ALLOC_STATS
+  }
+  EXPECT_EQ(live, e.live_bytes.load());
+}
+
 void vector_test()
 {
   std::cout << "[===============================================================]\n";
@@ -41,6 +190,7 @@ void vector_test()
   FUN_AFTER(v1, v1.insert(v1.end(), 7));
   FUN_AFTER(v1, v1.insert(v1.begin() + 3, 2, 3));
   FUN_AFTER(v1, v1.insert(v1.begin(), a, a + 5));
+  FUN_AFTER(v1, v1.append_range(a, a + 3));
   FUN_AFTER(v1, v1.pop_back());
   FUN_AFTER(v1, v1.erase(v1.begin()));
   FUN_AFTER(v1, v1.erase(v1.begin(), v1.begin() + 2));